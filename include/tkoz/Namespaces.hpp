@@ -12,6 +12,9 @@ namespace tkoz
     {
         /// \brief template metaprogramming tools
         namespace meta {}
+
+        /// \brief vectorized kernels with runtime instruction set dispatch
+        namespace simd {}
     }
 
     /// \brief contains strings for coloring and formatting terminal output
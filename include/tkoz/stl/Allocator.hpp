@@ -0,0 +1,611 @@
+///
+/// memory allocators (global new, bump arena, size class pool)
+///
+
+#pragma once
+
+#include <tkoz/stl/Concepts.hpp>
+#include <tkoz/stl/Types.hpp>
+#include <tkoz/stl/Utils.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+namespace tkoz::stl
+{
+
+namespace concepts
+{
+
+/// \brief type allocates arrays of Type
+///
+/// allocate(n) returns storage for n objects of Type (for trivial types such
+/// as characters, objects are not constructed) and deallocate(p) frees it
+/// without needing the size. deallocate(nullptr) must do nothing.
+template <typename AllocType, typename Type>
+concept isAllocator = requires (AllocType alloc, usize_t n, Type *p)
+{
+    { alloc.allocate(n) } -> isSame<Type*>;
+    { alloc.deallocate(p) } noexcept;
+};
+
+} // namespace concepts
+
+/// \brief allocator using the global new[] and delete[]
+/// \tparam Type type of array elements
+///
+/// This is stateless so it takes no space as a [[no_unique_address]] member.
+template <typename Type>
+struct NewAllocator
+{
+    /// \brief allocate an array with new[]
+    /// \param n number of elements
+    /// \return pointer to the array
+    [[nodiscard]] inline Type* allocate(const usize_t n) const
+    {
+        return new Type[n];
+    }
+
+    /// \brief free an array with delete[]
+    /// \param ptr pointer from allocate() or nullptr
+    inline void deallocate(Type * const ptr) const noexcept
+    {
+        delete[] ptr;
+    }
+
+    /// \brief all instances are interchangeable
+    [[nodiscard]] friend inline bool operator==(
+        const NewAllocator&, const NewAllocator&) noexcept
+    {
+        return true;
+    }
+};
+
+/// \brief bump allocator freeing everything at once
+///
+/// Memory is taken from large blocks by advancing a pointer, which is much
+/// cheaper than the global heap for many small short lived objects. Individual
+/// allocations are never freed, instead reset() or destruction frees all of
+/// them together. Large requests get a dedicated block so they do not waste
+/// the rest of the current block. This class is not thread safe.
+class Arena
+{
+private:
+
+    /// header at the start of each block (followed by the usable memory)
+    struct _Block
+    {
+        _Block *next;
+        usize_t size;
+    };
+
+    /// bytes reserved at the start of each block for the header
+    static constexpr usize_t _cHeader = 2 * alignof(std::max_align_t);
+
+    static_assert(sizeof(_Block) <= _cHeader);
+
+    /// list of allocated blocks (current block first)
+    _Block *_blocks;
+
+    /// next free byte in the current block
+    uintptr_t _cur;
+
+    /// end of the current block
+    uintptr_t _end;
+
+    /// size of standard blocks (including header)
+    usize_t _blockSize;
+
+    /// bytes handed out by allocate()
+    usize_t _used;
+
+    /// bytes allocated for blocks
+    usize_t _reserved;
+
+    /// allocate a block with at least size bytes (including header)
+    inline _Block* _newBlock(const usize_t size)
+    {
+        _Block *block = static_cast<_Block*>(::operator new(size));
+        block->size = size;
+        _reserved += size;
+        return block;
+    }
+
+    /// free a list of blocks
+    static inline void _freeBlocks(_Block *block) noexcept
+    {
+        while (block)
+        {
+            _Block *next = block->next;
+            ::operator delete(block);
+            block = next;
+        }
+    }
+
+    /// allocate when the current block does not have space
+    inline void* _allocSlow(const usize_t bytes, const usize_t align)
+    {
+        const usize_t need = _cHeader + bytes + align;
+        if (need > _blockSize / 4)
+        {
+            // dedicated block after the current one
+            _Block *block = _newBlock(need);
+            if (_blocks)
+            {
+                block->next = _blocks->next;
+                _blocks->next = block;
+            }
+            else
+            {
+                block->next = nullptr;
+                _blocks = block;
+                _cur = _end = reinterpret_cast<uintptr_t>(block) + need;
+            }
+            const uintptr_t start = reinterpret_cast<uintptr_t>(block)
+                + _cHeader;
+            _used += bytes;
+            return reinterpret_cast<void*>((start + align - 1) & ~(align - 1));
+        }
+        _Block *block = _newBlock(_blockSize);
+        block->next = _blocks;
+        _blocks = block;
+        _cur = reinterpret_cast<uintptr_t>(block) + _cHeader;
+        _end = reinterpret_cast<uintptr_t>(block) + _blockSize;
+        return allocate(bytes,align);
+    }
+
+public:
+
+    /// default size of standard blocks
+    static constexpr usize_t cDefaultBlockSize = 64 * 1024;
+
+    /// \brief initialize without allocating any memory
+    /// \param blockSize size of blocks to allocate
+    [[nodiscard]] inline explicit Arena(
+        const usize_t blockSize = cDefaultBlockSize) noexcept
+        : _blocks(nullptr), _cur(0), _end(0),
+          _blockSize(blockSize < 4 * _cHeader ? 4 * _cHeader : blockSize),
+          _used(0), _reserved(0) {}
+
+    /// \brief free all memory
+    inline ~Arena()
+    {
+        _freeBlocks(_blocks);
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /// \brief move constructor
+    /// \param other another Arena (empty afterward)
+    [[nodiscard]] inline Arena(Arena &&other) noexcept
+        : _blocks(other._blocks), _cur(other._cur), _end(other._end),
+          _blockSize(other._blockSize), _used(other._used),
+          _reserved(other._reserved)
+    {
+        other._blocks = nullptr;
+        other._cur = other._end = 0;
+        other._used = other._reserved = 0;
+    }
+
+    /// \brief move assignment
+    /// \param other another Arena
+    /// \return reference to *this
+    inline Arena& operator=(Arena &&other) noexcept
+    {
+        swap(_blocks,other._blocks);
+        swap(_cur,other._cur);
+        swap(_end,other._end);
+        swap(_blockSize,other._blockSize);
+        swap(_used,other._used);
+        swap(_reserved,other._reserved);
+        return *this;
+    }
+
+    /// \brief allocate memory
+    /// \param bytes number of bytes
+    /// \param align alignment (power of 2)
+    /// \return pointer to the memory (valid until reset or destruction)
+    [[nodiscard]] inline void* allocate(const usize_t bytes,
+        const usize_t align = alignof(std::max_align_t))
+    {
+        const uintptr_t p = (_cur + align - 1) & ~(align - 1);
+        if (p + bytes <= _end && _cur) [[likely]]
+        {
+            _cur = p + bytes;
+            _used += bytes;
+            return reinterpret_cast<void*>(p);
+        }
+        return _allocSlow(bytes,align);
+    }
+
+    /// \brief free all allocations
+    ///
+    /// One standard block is kept for reuse, all other blocks are freed.
+    inline void reset() noexcept
+    {
+        _Block *keep = nullptr;
+        _Block *block = _blocks;
+        while (block)
+        {
+            _Block *next = block->next;
+            if (!keep && block->size == _blockSize)
+                keep = block;
+            else
+            {
+                _reserved -= block->size;
+                ::operator delete(block);
+            }
+            block = next;
+        }
+        _blocks = keep;
+        _used = 0;
+        if (keep)
+        {
+            keep->next = nullptr;
+            _cur = reinterpret_cast<uintptr_t>(keep) + _cHeader;
+            _end = reinterpret_cast<uintptr_t>(keep) + _blockSize;
+        }
+        else
+            _cur = _end = 0;
+    }
+
+    /// \brief total bytes handed out since the last reset
+    [[nodiscard]] inline usize_t bytesUsed() const noexcept
+    {
+        return _used;
+    }
+
+    /// \brief total bytes of blocks allocated from the global heap
+    [[nodiscard]] inline usize_t bytesReserved() const noexcept
+    {
+        return _reserved;
+    }
+};
+
+/// \brief allocator handle for an Arena
+/// \tparam Type type of array elements (should be trivially destructible)
+///
+/// deallocate() does nothing, memory is freed when the arena is reset or
+/// destroyed. The arena must outlive everything allocated from it.
+template <typename Type>
+class ArenaAllocator
+{
+private:
+
+    template <typename>
+    friend class ArenaAllocator;
+
+    /// arena providing memory
+    Arena *_arena;
+
+public:
+
+    /// \brief allocate from an arena
+    /// \param arena the arena
+    [[nodiscard]] inline ArenaAllocator(Arena &arena) noexcept
+        : _arena(&arena) {}
+
+    /// \brief rebind from another element type
+    template <typename OtherType>
+    [[nodiscard]] inline explicit ArenaAllocator(
+        const ArenaAllocator<OtherType> &other) noexcept
+        : _arena(other._arena) {}
+
+    /// \brief allocate an array (elements are not constructed)
+    /// \param n number of elements
+    /// \return pointer to the array
+    [[nodiscard]] inline Type* allocate(const usize_t n) const
+    {
+        return static_cast<Type*>(
+            _arena->allocate(n * sizeof(Type),alignof(Type)));
+    }
+
+    /// \brief does nothing (memory is freed with the arena)
+    inline void deallocate(Type * const) const noexcept {}
+
+    /// \brief the arena used for allocation
+    [[nodiscard]] inline Arena& arena() const noexcept
+    {
+        return *_arena;
+    }
+
+    /// \brief allocators are equal if they use the same arena
+    [[nodiscard]] friend inline bool operator==(
+        const ArenaAllocator &left, const ArenaAllocator &right) noexcept
+    {
+        return left._arena == right._arena;
+    }
+};
+
+/// \brief allocator with free lists for size classes
+///
+/// Small requests are rounded up to a size class and taken from that class's
+/// free list, or carved from a slab dedicated to that class. Freed memory goes
+/// back to the free list for reuse, so repeated allocation of similar sizes
+/// does not touch the global heap. Slabs are aligned to their size so the
+/// size class of a pointer is found from the slab header and deallocate()
+/// does not need the size. Requests above cMaxSmall get their own allocation.
+/// Destruction frees all memory. This class is not thread safe.
+class Pool
+{
+public:
+
+    /// size (and alignment) of slabs
+    static constexpr usize_t cSlabSize = 64 * 1024;
+
+    /// largest request served from a size class
+    static constexpr usize_t cMaxSmall = 4096;
+
+    /// number of size classes
+    static constexpr usize_t cNumClasses = 13;
+
+    /// alignment of allocated memory
+    static constexpr usize_t cAlign = 16;
+
+private:
+
+    /// header at the start of each slab or large allocation
+    struct _Slab
+    {
+        _Slab *prev;
+        _Slab *next;
+        usize_t sizeClass;
+        usize_t size;
+    };
+
+    /// bytes reserved at the start of each slab for the header
+    static constexpr usize_t _cHeader = 64;
+
+    /// size class value marking a large allocation
+    static constexpr usize_t _cLarge = static_cast<usize_t>(-1);
+
+    static_assert(sizeof(_Slab) <= _cHeader);
+
+    /// node in a free list (stored in the freed memory)
+    struct _FreeNode
+    {
+        _FreeNode *next;
+    };
+
+    /// free list for each size class
+    _FreeNode *_free[cNumClasses];
+
+    /// next unused byte of the current slab for each size class
+    uintptr_t _bump[cNumClasses];
+
+    /// end of the current slab for each size class
+    uintptr_t _bumpEnd[cNumClasses];
+
+    /// all slabs and large allocations
+    _Slab *_slabs;
+
+    /// bytes handed out (rounded to size class) and not freed
+    usize_t _inUse;
+
+    /// bytes allocated from the global heap
+    usize_t _reserved;
+
+    /// allocate size bytes aligned to cSlabSize and link a header
+    inline _Slab* _newSlab(const usize_t size, const usize_t sizeClass)
+    {
+        _Slab *slab = static_cast<_Slab*>(
+            ::operator new(size,std::align_val_t(cSlabSize)));
+        slab->prev = nullptr;
+        slab->next = _slabs;
+        slab->sizeClass = sizeClass;
+        slab->size = size;
+        if (_slabs)
+            _slabs->prev = slab;
+        _slabs = slab;
+        _reserved += size;
+        return slab;
+    }
+
+    /// unlink and free a slab
+    inline void _freeSlab(_Slab * const slab) noexcept
+    {
+        if (slab->prev)
+            slab->prev->next = slab->next;
+        else
+            _slabs = slab->next;
+        if (slab->next)
+            slab->next->prev = slab->prev;
+        _reserved -= slab->size;
+        ::operator delete(slab,std::align_val_t(cSlabSize));
+    }
+
+    /// allocate from a size class when its free list is empty
+    inline void* _allocSlow(const usize_t c)
+    {
+        const usize_t size = classSize(c);
+        if (_bump[c] + size > _bumpEnd[c])
+        {
+            const uintptr_t slab =
+                reinterpret_cast<uintptr_t>(_newSlab(cSlabSize,c));
+            _bump[c] = slab + _cHeader;
+            _bumpEnd[c] = slab + cSlabSize;
+        }
+        void *ret = reinterpret_cast<void*>(_bump[c]);
+        _bump[c] += size;
+        return ret;
+    }
+
+public:
+
+    /// \brief initialize without allocating any memory
+    [[nodiscard]] inline Pool() noexcept
+        : _slabs(nullptr), _inUse(0), _reserved(0)
+    {
+        for (usize_t c = 0; c < cNumClasses; ++c)
+        {
+            _free[c] = nullptr;
+            _bump[c] = _bumpEnd[c] = 0;
+        }
+    }
+
+    /// \brief free all memory
+    inline ~Pool()
+    {
+        while (_slabs)
+            _freeSlab(_slabs);
+    }
+
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+
+    /// \brief pool shared by everything on the calling thread
+    /// \return owning handle to the pool (the reference itself is valid
+    /// until the thread exits)
+    ///
+    /// Containers that are not given a pool keep a copy of this handle, so
+    /// each container does not reserve its own slabs, and the pool is freed
+    /// when both the thread has exited and the last copy is destroyed. This
+    /// keeps it alive for static objects, which are destroyed after thread
+    /// local ones. The pool is not synchronized, so memory from it must only
+    /// be used on one thread at a time.
+    [[nodiscard]] static inline const std::shared_ptr<Pool>& threadLocal()
+    {
+        static thread_local const std::shared_ptr<Pool> pool =
+            std::make_shared<Pool>();
+        return pool;
+    }
+
+    /// \brief size (in bytes) of a size class
+    /// \param c size class index (less than cNumClasses)
+    /// \return multiples of 16 up to 128, then powers of 2 up to cMaxSmall
+    [[nodiscard]] static inline constexpr usize_t classSize(
+        const usize_t c) noexcept
+    {
+        return c < 8 ? 16 * (c + 1) : usize_t(128) << (c - 7);
+    }
+
+    /// \brief size class for a request
+    /// \param bytes requested size (at most cMaxSmall)
+    /// \return smallest size class index that fits bytes
+    [[nodiscard]] static inline constexpr usize_t sizeClass(
+        const usize_t bytes) noexcept
+    {
+        if (bytes <= 128)
+            return bytes ? (bytes + 15) / 16 - 1 : 0;
+        // bit width of bytes-1 is 8 for 129..256
+        return 8 + static_cast<usize_t>(64 - __builtin_clzll(bytes - 1)) - 8;
+    }
+
+    /// \brief allocate memory
+    /// \param bytes number of bytes
+    /// \return pointer to memory aligned to cAlign
+    [[nodiscard]] inline void* allocate(const usize_t bytes)
+    {
+        if (bytes > cMaxSmall) [[unlikely]]
+        {
+            _Slab *slab = _newSlab(_cHeader + bytes,_cLarge);
+            _inUse += bytes;
+            return reinterpret_cast<char*>(slab) + _cHeader;
+        }
+        const usize_t c = sizeClass(bytes);
+        _inUse += classSize(c);
+        if (_free[c]) [[likely]]
+        {
+            _FreeNode *node = _free[c];
+            _free[c] = node->next;
+            return node;
+        }
+        return _allocSlow(c);
+    }
+
+    /// \brief free memory from allocate()
+    /// \param ptr pointer from allocate() of this pool or nullptr
+    inline void deallocate(void * const ptr) noexcept
+    {
+        if (!ptr)
+            return;
+        _Slab *slab = reinterpret_cast<_Slab*>(
+            reinterpret_cast<uintptr_t>(ptr) & ~(cSlabSize - 1));
+        if (slab->sizeClass == _cLarge) [[unlikely]]
+        {
+            _inUse -= slab->size - _cHeader;
+            _freeSlab(slab);
+            return;
+        }
+        const usize_t c = slab->sizeClass;
+        _inUse -= classSize(c);
+        _FreeNode *node = static_cast<_FreeNode*>(ptr);
+        node->next = _free[c];
+        _free[c] = node;
+    }
+
+    /// \brief bytes handed out and not freed (rounded up to size classes)
+    [[nodiscard]] inline usize_t bytesInUse() const noexcept
+    {
+        return _inUse;
+    }
+
+    /// \brief bytes allocated from the global heap
+    [[nodiscard]] inline usize_t bytesReserved() const noexcept
+    {
+        return _reserved;
+    }
+};
+
+/// \brief allocator handle for a Pool
+/// \tparam Type type of array elements (should be trivially destructible)
+///
+/// The pool must outlive everything allocated from it.
+template <typename Type>
+class PoolAllocator
+{
+private:
+
+    static_assert(alignof(Type) <= Pool::cAlign);
+
+    template <typename>
+    friend class PoolAllocator;
+
+    /// pool providing memory
+    Pool *_pool;
+
+public:
+
+    /// \brief allocate from a pool
+    /// \param pool the pool
+    [[nodiscard]] inline PoolAllocator(Pool &pool) noexcept
+        : _pool(&pool) {}
+
+    /// \brief rebind from another element type
+    template <typename OtherType>
+    [[nodiscard]] inline explicit PoolAllocator(
+        const PoolAllocator<OtherType> &other) noexcept
+        : _pool(other._pool) {}
+
+    /// \brief allocate an array (elements are not constructed)
+    /// \param n number of elements
+    /// \return pointer to the array
+    [[nodiscard]] inline Type* allocate(const usize_t n) const
+    {
+        return static_cast<Type*>(_pool->allocate(n * sizeof(Type)));
+    }
+
+    /// \brief return an array to the pool
+    /// \param ptr pointer from allocate() or nullptr
+    inline void deallocate(Type * const ptr) const noexcept
+    {
+        _pool->deallocate(ptr);
+    }
+
+    /// \brief the pool used for allocation
+    [[nodiscard]] inline Pool& pool() const noexcept
+    {
+        return *_pool;
+    }
+
+    /// \brief allocators are equal if they use the same pool
+    [[nodiscard]] friend inline bool operator==(
+        const PoolAllocator &left, const PoolAllocator &right) noexcept
+    {
+        return left._pool == right._pool;
+    }
+};
+
+} // namespace tkoz::stl
@@ -0,0 +1,139 @@
+///
+/// atomic 48 bit pointer with a 16 bit modification counter
+///
+
+#pragma once
+
+#include <tkoz/stl/TaggedPointer.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <atomic>
+
+namespace tkoz::stl
+{
+
+/// \brief atomic pointer with a counter to prevent the ABA problem
+/// \tparam Type the type pointed to
+///
+/// Like SixBytePointer, this relies on the top 16 bits of x86_64 user space
+/// addresses being zero. They hold a counter that every successful
+/// modification increments, and the pointer and counter are in one 64 bit
+/// word, so a single word compare and swap detects that the pointer changed
+/// and changed back (A to B to A) in between a load and a compare and swap.
+/// This is what makes lock free stacks and free lists correct without double
+/// width compare and swap. The counter wraps around after 65536 modifications,
+/// so a thread that is preempted for that many can still suffer from ABA.
+///
+/// Values are TaggedPointer with the counter as the high tag.
+template <typename Type>
+class AtomicSixBytePointer
+{
+public:
+
+    /// pointer with the counter as its high tag
+    using ValueType = TaggedPointer<Type,0,48>;
+
+    /// true if operations never use a lock
+    static constexpr bool cIsAlwaysLockFree =
+        std::atomic<uint64_t>::is_always_lock_free;
+
+private:
+
+    /// pointer and counter
+    std::atomic<uint64_t> _bits;
+
+    /// the value replacing current when storing ptr
+    [[nodiscard]] static inline uint64_t _next(const ValueType current,
+        Type * const ptr) noexcept
+    {
+        return ValueType(ptr,static_cast<typename ValueType::HighTagType>(
+            current.highTag() + 1)).bits();
+    }
+
+public:
+
+    /// \brief initialize as null pointer with counter 0
+    [[nodiscard]] inline AtomicSixBytePointer() noexcept: _bits(0) {}
+
+    /// \brief initialize with a pointer and counter 0
+    /// \param ptr the pointer (below 2^48)
+    [[nodiscard]] inline explicit AtomicSixBytePointer(Type * const ptr)
+        noexcept: _bits(ValueType(ptr).bits()) {}
+
+    AtomicSixBytePointer(const AtomicSixBytePointer&) = delete;
+    AtomicSixBytePointer& operator=(const AtomicSixBytePointer&) = delete;
+
+    /// \brief read the pointer and counter
+    /// \param order memory order
+    /// \return current value
+    [[nodiscard]] inline ValueType load(
+        const std::memory_order order = std::memory_order_seq_cst)
+        const noexcept
+    {
+        return ValueType::fromBits(_bits.load(order));
+    }
+
+    /// \brief replace the pointer and increment the counter
+    /// \param ptr the new pointer
+    /// \param order memory order
+    /// \return previous value
+    inline ValueType exchange(Type * const ptr,
+        const std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+        uint64_t old = _bits.load(std::memory_order_relaxed);
+        while (!_bits.compare_exchange_weak(old,
+                _next(ValueType::fromBits(old),ptr),order,
+                std::memory_order_relaxed));
+        return ValueType::fromBits(old);
+    }
+
+    /// \brief replace the pointer and increment the counter
+    /// \param ptr the new pointer
+    /// \param order memory order
+    inline void store(Type * const ptr,
+        const std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+        (void)exchange(ptr,order);
+    }
+
+    /// \brief replace the pointer if pointer and counter are unchanged
+    /// \param expected value previously loaded (updated to the current
+    /// value on failure)
+    /// \param desired the new pointer (stored with the counter incremented)
+    /// \param success memory order if the value is replaced
+    /// \param failure memory order if the value is not replaced
+    /// \return true if the value was replaced
+    ///
+    /// May fail spuriously, so it should be used in a loop.
+    inline bool compareExchangeWeak(ValueType &expected, Type * const desired,
+        const std::memory_order success = std::memory_order_seq_cst,
+        const std::memory_order failure = std::memory_order_seq_cst) noexcept
+    {
+        uint64_t old = expected.bits();
+        const bool ret = _bits.compare_exchange_weak(old,
+            _next(expected,desired),success,failure);
+        expected = ValueType::fromBits(old);
+        return ret;
+    }
+
+    /// \brief replace the pointer if pointer and counter are unchanged
+    /// \param expected value previously loaded (updated to the current
+    /// value on failure)
+    /// \param desired the new pointer (stored with the counter incremented)
+    /// \param success memory order if the value is replaced
+    /// \param failure memory order if the value is not replaced
+    /// \return true if the value was replaced
+    inline bool compareExchangeStrong(ValueType &expected,
+        Type * const desired,
+        const std::memory_order success = std::memory_order_seq_cst,
+        const std::memory_order failure = std::memory_order_seq_cst) noexcept
+    {
+        uint64_t old = expected.bits();
+        const bool ret = _bits.compare_exchange_strong(old,
+            _next(expected,desired),success,failure);
+        expected = ValueType::fromBits(old);
+        return ret;
+    }
+};
+
+} // namespace tkoz::stl
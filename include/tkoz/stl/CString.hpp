@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <tkoz/stl/Allocator.hpp>
+#include <tkoz/stl/CStringSimd.hpp>
 #include <tkoz/stl/Concepts.hpp>
 #include <tkoz/stl/Exceptions.hpp>
 #include <tkoz/stl/Types.hpp>
@@ -12,9 +14,13 @@
 namespace tkoz::stl
 {
 
+template <typename StringType, usize_t count>
+class CStringConcat;
+
 /// \brief extended C string
 /// \tparam CharType character type
 /// \tparam allowNull whether to allow a null C string
+/// \tparam AllocType allocator for the character array (see Allocator.hpp)
 ///
 /// This class wraps a dynamically allocated C string (a null-terminated array
 /// of characters) and manages the memory. It may also store the null pointer
@@ -24,7 +30,14 @@ namespace tkoz::stl
 /// This string is mutable but cannot be resized except by assignment with
 /// another string. Operations with regular C strings are supported, and in most
 /// contexts assume the length of the C string is unknown.
-template <typename _CharType = char, bool _allowNull = true>
+///
+/// Memory is obtained from an allocator stored in the string, so strings can
+/// use an Arena or Pool instead of the global heap. Stateless allocators such
+/// as the default NewAllocator take no space. Copies use the allocator of the
+/// string being copied.
+template <typename _CharType = char, bool _allowNull = true,
+    typename _AllocType = NewAllocator<_CharType>>
+    requires concepts::isAllocator<_AllocType,_CharType>
 class CString
 {
 public:
@@ -35,11 +48,23 @@ public:
     /// is null pointer allowed
     static constexpr bool allowNull = _allowNull;
 
+    /// allocator type
+    using AllocType = _AllocType;
+
+    /// index value meaning not found
+    static constexpr usize_t npos = static_cast<usize_t>(-1);
+
 private:
 
     /// pointer to the null terminated string value or nullptr
     CharType *_ptr;
 
+    /// allocator for _ptr
+    [[no_unique_address]] AllocType _alloc;
+
+    template <typename, usize_t>
+    friend class CStringConcat;
+
     /// copy pointer to member value
     inline void _copyFrom(const CString &other)
     {
@@ -51,15 +76,16 @@ private:
                 return;
             }
         }
-        const usize_t l = ptrLen(other._ptr);
-        _ptr = new CharType[l+1];
-        ptrCopy(other._ptr,_ptr);
+        const usize_t l = simd::strLen(other._ptr);
+        _ptr = _alloc.allocate(l+1);
+        simd::copyChars(_ptr,other._ptr,l+1);
     }
 
     /// swap with other
     inline void _swapWith(CString &other) noexcept
     {
         swap(_ptr,other._ptr);
+        swap(_alloc,other._alloc);
     }
 
     /// copies ptr to destination
@@ -73,18 +99,26 @@ private:
             if (!src)
                 return;
         }
-        while (*src)
-            *(dst++) = *(src++);
+        const usize_t l = simd::strLen(src);
+        simd::copyChars(dst,src,l);
+        dst += l;
     }
 
 public:
 
     /// \brief initialize as null string
-    [[nodiscard]] inline CString() noexcept: _ptr(nullptr) {}
+    [[nodiscard]] inline CString() noexcept: _ptr(nullptr), _alloc() {}
+
+    /// \brief initialize as null string
+    /// \param alloc allocator to use
+    [[nodiscard]] inline explicit CString(const AllocType &alloc) noexcept
+        : _ptr(nullptr), _alloc(alloc) {}
 
     /// \brief initialize from a C string
     /// \param ptr a null-terminated C string, or nullptr
-    [[nodiscard]] inline CString(const CharType *ptr)
+    /// \param alloc allocator to use
+    [[nodiscard]] inline CString(const CharType *ptr,
+        const AllocType &alloc = AllocType()): _alloc(alloc)
     {
         if constexpr (allowNull)
         {
@@ -94,19 +128,35 @@ public:
                 return;
             }
         }
-        const usize_t l = ptrLen(ptr);
-        _ptr = new CharType[l+1];
-        ptrCopy(ptr,_ptr);
+        const usize_t l = simd::strLen(ptr);
+        _ptr = _alloc.allocate(l+1);
+        simd::copyChars(_ptr,ptr,l+1);
+    }
+
+    /// \brief initialize from characters with a known length
+    /// \param ptr pointer to len characters (not null, no null characters)
+    /// \param len number of characters to copy
+    /// \param alloc allocator to use
+    ///
+    /// The copy is null-terminated, ptr does not need to be.
+    [[nodiscard]] inline CString(const CharType * const ptr, const usize_t len,
+        const AllocType &alloc = AllocType()): _alloc(alloc)
+    {
+        _ptr = _alloc.allocate(len+1);
+        simd::copyChars(_ptr,ptr,len);
+        _ptr[len] = static_cast<CharType>(0);
     }
 
     /// \brief initialize with a repeated character
     /// \param count string length
     /// \param value character value
+    /// \param alloc allocator to use
     ///
     /// Character value must be nonzero.
-    [[nodiscard]] inline CString(const usize_t count, const CharType value)
+    [[nodiscard]] inline CString(const usize_t count, const CharType value,
+        const AllocType &alloc = AllocType()): _alloc(alloc)
     {
-        _ptr = new CharType[count+1];
+        _ptr = _alloc.allocate(count+1);
         for (usize_t i = 0; i < count; ++i)
             _ptr[i] = value;
         _ptr[count] = static_cast<CharType>(0);
@@ -115,12 +165,12 @@ public:
     /// \brief destructor
     inline ~CString()
     {
-        delete[] _ptr;
+        _alloc.deallocate(_ptr);
     }
 
     /// \brief copy constructor
-    /// \param other another CString
-    [[nodiscard]] inline CString(const CString &other)
+    /// \param other another CString (its allocator is copied)
+    [[nodiscard]] inline CString(const CString &other): _alloc(other._alloc)
     {
         _copyFrom(other);
     }
@@ -138,6 +188,7 @@ public:
     /// \brief move constructor
     /// \param other another CString
     [[nodiscard]] inline CString(CString &&other) noexcept
+        : _alloc(other._alloc)
     {
         _ptr = other._ptr;
         other._ptr = nullptr;
@@ -190,6 +241,13 @@ public:
             return _ptr[0];
     }
 
+    /// \brief allocator used by this string
+    /// \return copy of the allocator
+    [[nodiscard]] inline AllocType allocator() const noexcept
+    {
+        return _alloc;
+    }
+
     /// \brief is string null (not the same as the empty string)
     /// \return true if the string stored is nullptr
     /// \note this function should be avoidid if allowNull == false
@@ -207,7 +265,8 @@ public:
     /// \return true if both C strings are equal
     ///
     /// Corresponding characters are compared sequentially until the end of one
-    /// or mismatched characters.
+    /// or mismatched characters. Byte sized characters are compared with
+    /// vector instructions (see simd::strMismatch()).
     [[nodiscard]] static inline bool ptrCmpEq(
         const CharType *s1, const CharType *s2) noexcept
     {
@@ -218,10 +277,7 @@ public:
             if (!s2)
                 return false;
         }
-        while (*s1 && *s2)
-            if (*(s1++) != *(s2++))
-                return false;
-        return *s1 == *s2;
+        return simd::strCmpEq(s1,s2);
     }
 
     /// \brief compare 2 null-terminated C strings for inequality
@@ -253,13 +309,7 @@ public:
             if (!s1 || !s2)
                 return s1 <=> s2;
         }
-        while (*s1 && *s2)
-        {
-            if (*s1 != *s2)
-                return *s1 <=> *s2;
-            ++s1, ++s2;
-        }
-        return *s1 <=> *s2;
+        return simd::strCmp3way(s1,s2);
     }
 
     /// \brief compare 2 null-terminated C strings (less than)
@@ -303,6 +353,47 @@ public:
         return ptrCmp3way(s1,s2) >= 0;
     }
 
+    /// \brief compare 2 null-terminated C strings ignoring ASCII case
+    /// \param s1 first string
+    /// \param s2 second string
+    /// \return true if both C strings are equal after lowering A-Z
+    ///
+    /// Same as ptrCmpEq() but the letters A-Z and a-z are equal. Byte sized
+    /// characters are compared with vector instructions (see
+    /// simd::strMismatchIgnoreCase()).
+    [[nodiscard]] static inline bool ptrCmpEqIgnoreCase(
+        const CharType *s1, const CharType *s2) noexcept
+    {
+        if constexpr (allowNull)
+        {
+            if (!s1)
+                return !s2;
+            if (!s2)
+                return false;
+        }
+        return simd::strCmpEqIgnoreCase(s1,s2);
+    }
+
+    /// \brief compare 2 null-terminated C strings ignoring ASCII case
+    /// (3 way compare)
+    /// \param s1 first string
+    /// \param s2 second string
+    /// \return 3 way ordering of the 2 C strings after lowering A-Z
+    ///
+    /// Same as ptrCmp3way() but characters are compared after mapping A-Z to
+    /// a-z, so "B" is greater than "a" and "_" (between the upper and lower
+    /// case letters) is less than "a".
+    [[nodiscard]] static inline auto ptrCmp3wayIgnoreCase(
+        const CharType *s1, const CharType *s2) noexcept
+    {
+        if constexpr (allowNull)
+        {
+            if (!s1 || !s2)
+                return s1 <=> s2;
+        }
+        return simd::strCmp3wayIgnoreCase(s1,s2);
+    }
+
     /// \brief compare equality
     /// \param left a CString
     /// \param right a CString
@@ -365,20 +456,36 @@ public:
 
     /// \brief create CString from an existing C string
     /// \param ptr the C string to wrap
+    /// \param alloc allocator that allocated ptr
     ///
     /// This class becomes the owner of the memory once this is done.
-    /// It must be safe to delete[] ptr.
-    [[nodiscard]] static inline CString ptrWrap(CharType * const ptr) noexcept
+    /// It must be safe to free ptr with alloc.deallocate().
+    [[nodiscard]] static inline CString ptrWrap(CharType * const ptr,
+        const AllocType &alloc = AllocType()) noexcept
     {
-        CString ret;
+        CString ret(alloc);
         ret._ptr = ptr;
         return ret;
     }
 
+    /// \brief give up ownership of the C string
+    /// \return the stored pointer, which must be freed by allocator()
+    ///
+    /// This string is null afterward (with allowNull == false, the value is
+    /// undefined like a moved from string).
+    [[nodiscard]] inline CharType* release() noexcept
+    {
+        CharType *ptr = _ptr;
+        _ptr = nullptr;
+        return ptr;
+    }
+
     /// \brief find the length of a C string
     /// \param ptr string to find length of
     ///
     /// The length excludes the null terminator. Null pointers have length 0.
+    /// Byte sized characters are scanned with vector instructions (see
+    /// simd::strLen()).
     [[nodiscard]] static inline usize_t ptrLen(const CharType *ptr) noexcept
     {
         if constexpr (allowNull)
@@ -386,29 +493,28 @@ public:
             if (!ptr)
                 return 0;
         }
-        usize_t l = 0;
-        while (*ptr)
-            ++ptr, ++l;
-        return l;
+        return simd::strLen(ptr);
     }
 
     /// \brief allocate another string with the same value
     /// \param s string to copy
+    /// \param alloc allocator for the result
     ///
     /// The string is copied including null terminator. If nullCheck is false,
     /// the given pointer must not be null. If nullCheck is true, then nullptr
     /// is returned if given a null string. The pointer returned, if not null,
-    /// must be deallocated with delete[].
-    [[nodiscard]] static inline CharType* ptrCopyNew(const CharType * const ptr)
+    /// must be deallocated with alloc.
+    [[nodiscard]] static inline CharType* ptrCopyNew(const CharType * const ptr,
+        AllocType alloc = AllocType())
     {
         if constexpr (allowNull)
         {
             if (!ptr)
                 return nullptr;
         }
-        usize_t l = CString<CharType,false>::ptrLen(ptr);
-        CharType *t = new CharType[l+1];
-        ptrCopy(ptr,t);
+        const usize_t l = simd::strLen(ptr);
+        CharType *t = alloc.allocate(l+1);
+        simd::copyChars(t,ptr,l+1);
         return t;
     }
 
@@ -421,39 +527,34 @@ public:
     /// Both pointers must not be null.
     static inline void ptrCopy(const CharType *src, CharType *dst) noexcept
     {
-        while (*src)
-            *(dst++) = *(src++);
-        *dst = static_cast<CharType>(0);
+        simd::strCopy(src,dst);
     }
 
     /// \brief allocate a new string with the concatenated result
     /// \param s1 first string
     /// \param s2 second string
+    /// \param alloc allocator for the result
     ///
     /// Concatenates 2 strings into a newly allocated result. If nullCheck is
     /// true, then nullptr is returned when both inputs are null. If nullCheck
     /// is false, then both inputs must not be null. If the result is non null,
-    /// it must be deallocated with delete[]. Result is only null if both inputs
+    /// it must be deallocated with alloc. Result is only null if both inputs
     /// are null. If non null, result is null terminated.
     [[nodiscard]] static inline CharType* ptrConcatNew(
-        const CharType *s1, const CharType *s2)
+        const CharType *s1, const CharType *s2, AllocType alloc = AllocType())
     {
         if constexpr (allowNull)
         {
             if (!s1)
-                return ptrCopyNew(s2);
+                return ptrCopyNew(s2,alloc);
             if (!s2)
-                return CString<CharType,false>::ptrCopyNew(s1);
+                return CString<CharType,false,AllocType>::ptrCopyNew(s1,alloc);
         }
         const usize_t l1 = CString<CharType,false>::ptrLen(s1);
         const usize_t l2 = CString<CharType,false>::ptrLen(s2);
-        CharType *t = new CharType[l1+l2+1];
-        CharType *p = t;
-        while (*s1)
-            *(p++) = *(s1++);
-        while (*s2)
-            *(p++) = *(s2++);
-        *p = static_cast<CharType>(0);
+        CharType *t = alloc.allocate(l1+l2+1);
+        simd::copyChars(t,s1,l1);
+        simd::copyChars(t+l1,s2,l2+1);
         return t;
     }
 
@@ -473,58 +574,75 @@ public:
         *dst = static_cast<CharType>(0);
     }
 
-    /// \brief concatenate 2 strings (both of this class)
-    [[nodiscard]] friend inline CString operator+(
-        const CString &left, const CString &right)
+    /// \brief allocate a new string concatenating an array of strings
+    /// \tparam count number of strings
+    /// \param ptrs the strings to concatenate (null pointers allowed if
+    /// allowNull is true, treated as empty strings)
+    /// \param alloc allocator for the result
+    ///
+    /// Each string is measured once, then the result is allocated once and
+    /// each string is copied once. Result is only null if all inputs are null.
+    /// If the result is non null, it must be deallocated with alloc.
+    template <usize_t count>
+    [[nodiscard]] static inline CharType* ptrConcatNew(
+        const CharType * const (&ptrs)[count], AllocType alloc = AllocType())
     {
+        usize_t lens[count];
+        usize_t total = 0;
+        bool anyNonNull = false;
+        for (usize_t i = 0; i < count; ++i)
+        {
+            if constexpr (allowNull)
+            {
+                if (!ptrs[i])
+                {
+                    lens[i] = 0;
+                    continue;
+                }
+            }
+            anyNonNull = true;
+            lens[i] = simd::strLen(ptrs[i]);
+            total += lens[i];
+        }
         if constexpr (allowNull)
         {
-            if (!left._ptr)
-                return right;
-            if (!right._ptr)
-                return left;
+            if (!anyNonNull)
+                return nullptr;
         }
-        const usize_t l1 = CString<CharType,false>::ptrLen(left._ptr);
-        const usize_t l2 = CString<CharType,false>::ptrLen(right._ptr);
-        CharType *s = new CharType[l1+l2+1];
-        ptrConcat(left._ptr,right._ptr,s);
-        return ptrWrap(s);
+        CharType *t = alloc.allocate(total+1);
+        CharType *p = t;
+        for (usize_t i = 0; i < count; ++i)
+        {
+            if (lens[i])
+                simd::copyChars(p,ptrs[i],lens[i]);
+            p += lens[i];
+        }
+        *p = static_cast<CharType>(0);
+        return t;
+    }
+
+    /// \brief concatenate 2 strings (both of this class)
+    /// \return lazy concatenation, see CStringConcat
+    [[nodiscard]] friend inline CStringConcat<CString,2> operator+(
+        const CString &left, const CString &right) noexcept
+    {
+        return CStringConcat<CString,2>({left._ptr,right._ptr},left._alloc);
     }
 
     /// \brief concatenate 2 strings (c string on left)
-    [[nodiscard]] friend inline CString operator+(
-        const CharType * const left, const CString &right)
+    /// \return lazy concatenation, see CStringConcat
+    [[nodiscard]] friend inline CStringConcat<CString,2> operator+(
+        const CharType * const left, const CString &right) noexcept
     {
-        if constexpr (allowNull)
-        {
-            if (!left)
-                return right;
-            if (!right._ptr)
-                return CString(left);
-        }
-        const usize_t l1 = CString<CharType,false>::ptrLen(left);
-        const usize_t l2 = CString<CharType,false>::ptrLen(right._ptr);
-        CharType *s = new CharType[l1+l2+1];
-        ptrConcat(left,right._ptr,s);
-        return ptrWrap(s);
+        return CStringConcat<CString,2>({left,right._ptr},right._alloc);
     }
 
     /// \brief concatenate 2 strings (c string on right)
-    [[nodiscard]] friend inline CString operator+(
-        const CString &left, const CharType * const right)
+    /// \return lazy concatenation, see CStringConcat
+    [[nodiscard]] friend inline CStringConcat<CString,2> operator+(
+        const CString &left, const CharType * const right) noexcept
     {
-        if constexpr (allowNull)
-        {
-            if (!left._ptr)
-                return CString(right);
-            if (!right)
-                return left;
-        }
-        const usize_t l1 = CString<CharType,false>::ptrLen(left._ptr);
-        const usize_t l2 = CString<CharType,false>::ptrLen(right);
-        CharType *s = new CharType[l1+l2+1];
-        ptrConcat(left._ptr,right,s);
-        return ptrWrap(s);
+        return CStringConcat<CString,2>({left._ptr,right},left._alloc);
     }
 
     /// \brief concatenate another string to the end
@@ -535,13 +653,13 @@ public:
             if (!other)
                 return *this;
             if (!_ptr)
-                return (*this = CString(other));
+                return (*this = CString(other,_alloc));
         }
         const usize_t l1 = CString<CharType,false>::ptrLen(_ptr);
         const usize_t l2 = CString<CharType,false>::ptrLen(other);
-        CharType *ptr = new CharType[l1+l2+1];
+        CharType *ptr = _alloc.allocate(l1+l2+1);
         CString<CharType,false>::ptrConcat(_ptr,other,ptr);
-        delete[] _ptr;
+        _alloc.deallocate(_ptr);
         _ptr = ptr;
         return *this;
     }
@@ -552,6 +670,16 @@ public:
         return (*this += other._ptr);
     }
 
+    /// \brief concatenate a lazy concatenation to the end
+    ///
+    /// The result is allocated once for this string and all of the operands,
+    /// using the allocator of this string.
+    template <usize_t count>
+    inline CString& operator+=(const CStringConcat<CString,count> &other)
+    {
+        return (*this = (_ptr + other).toCString(_alloc));
+    }
+
     /// \brief (non const) access to a character
     /// \param i the index
     /// \return reference to ith character
@@ -633,6 +761,95 @@ public:
         return const_cast<CString*>(this)->at(i);
     }
 
+    /// \brief index of the first occurrence of a substring in a C string
+    /// \param hay string to search
+    /// \param needle string to find
+    /// \return index of needle or npos if not found (a null string is treated
+    /// as empty)
+    ///
+    /// Both lengths are measured once, then searched with simd::memFind().
+    [[nodiscard]] static inline usize_t ptrFind(const CharType * const hay,
+        const CharType * const needle) noexcept
+    {
+        return simd::memFind(hay,ptrLen(hay),needle,ptrLen(needle));
+    }
+
+    /// \brief index of the first occurrence of a substring
+    /// \param needle string to find (null is treated as empty)
+    /// \return index of needle or npos if not found
+    [[nodiscard]] inline usize_t find(const CharType * const needle)
+        const noexcept
+    {
+        return ptrFind(_ptr,needle);
+    }
+
+    /// \brief index of the first occurrence of a CString
+    template <bool allowNull2, typename AllocType2>
+    [[nodiscard]] inline usize_t find(
+        const CString<CharType,allowNull2,AllocType2> &needle) const noexcept
+    {
+        return ptrFind(_ptr,needle.ptr());
+    }
+
+    /// \brief does the string contain a substring
+    /// \param needle string to find (null is treated as empty)
+    [[nodiscard]] inline bool contains(const CharType * const needle)
+        const noexcept
+    {
+        return find(needle) != npos;
+    }
+
+    /// \brief map ASCII letters to lower case in place
+    /// \return reference to *this
+    ///
+    /// Only A-Z are changed. Byte sized characters are mapped with vector
+    /// instructions (see simd::memToLowerCase()). A null string is unchanged.
+    inline CString& toLowerCase() noexcept
+    {
+        if (!isNull())
+            simd::memToLowerCase(_ptr,_ptr,simd::strLen(_ptr));
+        return *this;
+    }
+
+    /// \brief map ASCII letters to upper case in place
+    /// \return reference to *this
+    ///
+    /// Only a-z are changed. A null string is unchanged.
+    inline CString& toUpperCase() noexcept
+    {
+        if (!isNull())
+            simd::memToUpperCase(_ptr,_ptr,simd::strLen(_ptr));
+        return *this;
+    }
+
+    /// \brief copy with ASCII letters mapped to lower case
+    /// \return new string using the allocator of this string (null if this
+    /// string is null)
+    ///
+    /// The characters are mapped while copying (they are read once).
+    [[nodiscard]] inline CString lowerCase() const
+    {
+        if (isNull())
+            return CString(_alloc);
+        const usize_t l = simd::strLen(_ptr);
+        CharType *ptr = _alloc.allocate(l+1);
+        simd::memToLowerCase(ptr,_ptr,l+1);
+        return ptrWrap(ptr,_alloc);
+    }
+
+    /// \brief copy with ASCII letters mapped to upper case
+    /// \return new string using the allocator of this string (null if this
+    /// string is null)
+    [[nodiscard]] inline CString upperCase() const
+    {
+        if (isNull())
+            return CString(_alloc);
+        const usize_t l = simd::strLen(_ptr);
+        CharType *ptr = _alloc.allocate(l+1);
+        simd::memToUpperCase(ptr,_ptr,l+1);
+        return ptrWrap(ptr,_alloc);
+    }
+
     /// \todo precondition and postcondition assert macros
     /// invariant test after each mutator
     /// conditionally enabled at compile time
@@ -651,16 +868,14 @@ public:
     /// - iterators
     /// - istream,ostream (>> and <<)
     /// - constexpr where appropriate
-    /// - find, rfind, replace, substr
-    /// - split, join, lowerCase, upperCase
-    /// - eqIgnoreCase, cmpIgnoreCase
+    /// - rfind, replace, substr
+    /// - split, join
     /// - startsWith, endsWith
     /// - user defined suffix operator""
-    /// - variable args ptrConcatNew and ptrConcatSrcDst
+    /// - variable args ptrConcatSrcDst
     /// - see std::basic_string for more ideas
 
     /// \todo further string ideas
-    /// - CStringView (non owning C string)
     /// - StaticString (fixed length string allowing nulls)
     /// - DynamicString (implementation closer to that of std::string)
     /// - StringView (non owning view of StaticString or DynamicString)
@@ -668,4 +883,173 @@ public:
     /// - RegexString (for matching to patterns)
 };
 
+/// \brief lazy concatenation of CStrings and C strings
+/// \tparam StringType the CString type of the result
+/// \tparam count number of strings being concatenated
+///
+/// This is the result of operator+ on CString. Further uses of operator+ add
+/// more operands without allocating memory, and converting to StringType
+/// measures each operand once and makes a single allocation for the whole
+/// chain, so a + b + c + d allocates once instead of 3 times.
+///
+/// The result uses the allocator of the left-most CString operand unless one
+/// is given to toCString(), so allocators that cannot be default constructed
+/// (such as ArenaAllocator) work with operator+.
+///
+/// Operands are stored as pointers so the strings must outlive the expression.
+/// This is safe when the expression is converted within the same full
+/// expression (such as initializing or assigning a CString) but it should not
+/// be stored with auto when any operand is a temporary.
+template <typename StringType, usize_t count>
+class CStringConcat
+{
+public:
+
+    /// character type
+    using CharType = StringType::CharType;
+
+    /// allocator type
+    using AllocType = StringType::AllocType;
+
+private:
+
+    static_assert(count >= 2, "concatenation requires at least 2 strings");
+
+    template <typename, usize_t>
+    friend class CStringConcat;
+
+    /// operand strings (null pointers allowed if StringType::allowNull)
+    const CharType *_ptrs[count];
+
+    /// allocator of the left-most CString operand
+    const AllocType *_alloc;
+
+    /// copy operands with an additional string at the end
+    [[nodiscard]] inline CStringConcat<StringType,count+1> _append(
+        const CharType * const right) const noexcept
+    {
+        CStringConcat<StringType,count+1> ret;
+        for (usize_t i = 0; i < count; ++i)
+            ret._ptrs[i] = _ptrs[i];
+        ret._ptrs[count] = right;
+        ret._alloc = _alloc;
+        return ret;
+    }
+
+    /// copy operands with an additional string at the beginning
+    /// \param alloc allocator of left if it is a CString, otherwise nullptr
+    [[nodiscard]] inline CStringConcat<StringType,count+1> _prepend(
+        const CharType * const left,
+        const AllocType * const alloc) const noexcept
+    {
+        CStringConcat<StringType,count+1> ret;
+        ret._ptrs[0] = left;
+        for (usize_t i = 0; i < count; ++i)
+            ret._ptrs[i+1] = _ptrs[i];
+        ret._alloc = alloc ? alloc : _alloc;
+        return ret;
+    }
+
+    /// copy operands followed by the operands of another concatenation
+    template <usize_t otherCount>
+    [[nodiscard]] inline CStringConcat<StringType,count+otherCount> _join(
+        const CStringConcat<StringType,otherCount> &right) const noexcept
+    {
+        CStringConcat<StringType,count+otherCount> ret;
+        for (usize_t i = 0; i < count; ++i)
+            ret._ptrs[i] = _ptrs[i];
+        for (usize_t i = 0; i < otherCount; ++i)
+            ret._ptrs[count+i] = right._ptrs[i];
+        ret._alloc = _alloc;
+        return ret;
+    }
+
+    /// uninitialized operands (only used by other concatenations)
+    [[nodiscard]] inline CStringConcat() noexcept = default;
+
+public:
+
+    /// \brief initialize from an array of operands
+    /// \param ptrs strings to concatenate in order
+    /// \param alloc allocator for the result (must outlive this object)
+    [[nodiscard]] inline explicit CStringConcat(
+        const CharType * const (&ptrs)[count],
+        const AllocType &alloc) noexcept
+        : _alloc(&alloc)
+    {
+        for (usize_t i = 0; i < count; ++i)
+            _ptrs[i] = ptrs[i];
+    }
+
+    /// \brief total length of the concatenation (linear time)
+    /// \return sum of the operand lengths
+    [[nodiscard]] inline usize_t len() const noexcept
+    {
+        usize_t total = 0;
+        for (usize_t i = 0; i < count; ++i)
+            total += StringType::ptrLen(_ptrs[i]);
+        return total;
+    }
+
+    /// \brief allocate the concatenated string
+    /// \param alloc allocator for the result
+    /// \return the concatenation (null only if every operand is null)
+    [[nodiscard]] inline StringType toCString(const AllocType &alloc) const
+    {
+        return StringType::ptrWrap(StringType::ptrConcatNew(_ptrs,alloc),alloc);
+    }
+
+    /// \brief allocate the concatenated string with the allocator of the
+    /// left-most CString operand
+    /// \return the concatenation (null only if every operand is null)
+    [[nodiscard]] inline StringType toCString() const
+    {
+        return toCString(*_alloc);
+    }
+
+    /// \brief allocate the concatenated string, see toCString()
+    /// \return the concatenation (null only if every operand is null)
+    [[nodiscard]] inline operator StringType() const
+    {
+        return toCString(*_alloc);
+    }
+
+    /// \brief add a CString to the end
+    [[nodiscard]] friend inline CStringConcat<StringType,count+1> operator+(
+        const CStringConcat &left, const StringType &right) noexcept
+    {
+        return left._append(right.ptr());
+    }
+
+    /// \brief add a C string to the end
+    [[nodiscard]] friend inline CStringConcat<StringType,count+1> operator+(
+        const CStringConcat &left, const CharType * const right) noexcept
+    {
+        return left._append(right);
+    }
+
+    /// \brief add a CString to the beginning
+    [[nodiscard]] friend inline CStringConcat<StringType,count+1> operator+(
+        const StringType &left, const CStringConcat &right) noexcept
+    {
+        return right._prepend(left.ptr(),&left._alloc);
+    }
+
+    /// \brief add a C string to the beginning
+    [[nodiscard]] friend inline CStringConcat<StringType,count+1> operator+(
+        const CharType * const left, const CStringConcat &right) noexcept
+    {
+        return right._prepend(left,nullptr);
+    }
+
+    /// \brief join 2 concatenations
+    template <usize_t otherCount>
+    [[nodiscard]] friend inline CStringConcat<StringType,count+otherCount>
+    operator+(const CStringConcat &left,
+        const CStringConcat<StringType,otherCount> &right) noexcept
+    {
+        return left._join(right);
+    }
+};
+
 } // namespace tkoz::stl
@@ -0,0 +1,381 @@
+///
+/// growable buffer for building a CString
+///
+
+#pragma once
+
+#include <tkoz/stl/Allocator.hpp>
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/CStringSimd.hpp>
+#include <tkoz/stl/Exceptions.hpp>
+#include <tkoz/stl/Types.hpp>
+#include <tkoz/stl/Utils.hpp>
+
+namespace tkoz::stl
+{
+
+/// \brief growable string for building a CString by appending
+/// \tparam CharType character type
+/// \tparam allowNull null parameter of the CString that is built
+/// \tparam AllocType allocator for the buffer (passed to the built CString)
+///
+/// CString::operator+= allocates and copies the whole string for every
+/// append, which takes quadratic time when building a string in a loop. This
+/// class stores the length and capacity and grows the capacity geometrically
+/// so appending takes amortized time proportional to the appended length.
+/// When finished, build() hands the buffer to a CString without copying it.
+///
+/// The value is always null-terminated, so ptr() can be used as a C string at
+/// any time. Appending a null pointer (if allowNull is true) does nothing.
+template <typename _CharType = char, bool _allowNull = true,
+    typename _AllocType = NewAllocator<_CharType>>
+    requires concepts::isAllocator<_AllocType,_CharType>
+class CStringBuilder
+{
+public:
+
+    /// character type
+    using CharType = _CharType;
+
+    /// is null pointer allowed as an argument
+    static constexpr bool allowNull = _allowNull;
+
+    /// allocator type
+    using AllocType = _AllocType;
+
+    /// the string type that is built
+    using StringType = CString<CharType,allowNull,AllocType>;
+
+    /// smallest capacity allocated
+    static constexpr usize_t cMinCapacity = 16;
+
+private:
+
+    /// empty string used before any memory is allocated
+    static constexpr CharType _cEmpty[1] = {static_cast<CharType>(0)};
+
+    /// buffer (null terminated) or nullptr if nothing is allocated
+    CharType *_ptr;
+
+    /// string length (excludes null terminator)
+    usize_t _len;
+
+    /// allocated size of buffer (includes null terminator)
+    usize_t _cap;
+
+    /// allocator for _ptr
+    [[no_unique_address]] AllocType _alloc;
+
+    /// new buffer of exactly cap characters holding the current value
+    /// (cap must exceed the length, the old buffer is not changed)
+    [[nodiscard]] inline CharType* _copyTo(const usize_t cap)
+    {
+        CharType *ptr = _alloc.allocate(cap);
+        if (_ptr)
+            simd::copyChars(ptr,_ptr,_len+1);
+        else
+            ptr[0] = static_cast<CharType>(0);
+        return ptr;
+    }
+
+    /// use ptr (with cap characters) as the buffer and free the old one
+    /// (the old buffer is freed last so nothing reads it afterward)
+    inline void _replace(CharType * const ptr, const usize_t cap) noexcept
+    {
+        CharType * const old = _ptr;
+        _ptr = ptr;
+        _cap = cap;
+        _alloc.deallocate(old);
+    }
+
+    /// capacity to allocate when need characters (with null terminator) do
+    /// not fit, doubling so appending takes amortized linear time
+    [[nodiscard]] inline usize_t _grownCapacity(const usize_t need)
+        const noexcept
+    {
+        usize_t cap = _cap < cMinCapacity ? cMinCapacity : _cap;
+        while (cap < need)
+            cap *= 2;
+        return cap;
+    }
+
+    /// append count characters that do not fit in the buffer
+    ///
+    /// Not inlined so the common case in append() stays small, and so gcc
+    /// does not combine this path with the length of a literal argument.
+    [[gnu::noinline]] void _appendGrow(
+        const CharType * const ptr, const usize_t count)
+    {
+        // ptr may point into the old buffer so copy before freeing it
+        const usize_t cap = _grownCapacity(_len + count + 1);
+        CharType *buf = _copyTo(cap);
+        simd::copyChars(buf+_len,ptr,count);
+        _len += count;
+        buf[_len] = static_cast<CharType>(0);
+        _replace(buf,cap);
+    }
+
+public:
+
+    /// \brief initialize as the empty string (does not allocate)
+    [[nodiscard]] inline CStringBuilder() noexcept
+        : _ptr(nullptr), _len(0), _cap(0), _alloc() {}
+
+    /// \brief initialize as the empty string (does not allocate)
+    /// \param alloc allocator to use
+    [[nodiscard]] inline explicit CStringBuilder(
+        const AllocType &alloc) noexcept
+        : _ptr(nullptr), _len(0), _cap(0), _alloc(alloc) {}
+
+    /// \brief initialize as the empty string with reserved space
+    /// \param capacity number of characters to reserve (excludes terminator)
+    /// \param alloc allocator to use
+    [[nodiscard]] inline explicit CStringBuilder(const usize_t capacity,
+        const AllocType &alloc = AllocType())
+        : CStringBuilder(alloc)
+    {
+        reserve(capacity);
+    }
+
+    /// \brief initialize with a copy of a C string
+    /// \param ptr a null-terminated C string (or nullptr if allowNull)
+    /// \param alloc allocator to use
+    [[nodiscard]] inline explicit CStringBuilder(const CharType * const ptr,
+        const AllocType &alloc = AllocType())
+        : CStringBuilder(alloc)
+    {
+        append(ptr);
+    }
+
+    /// \brief take the buffer of a CString without copying it
+    /// \param str the CString, which is null (or undefined) afterward
+    ///
+    /// The capacity is the length of str since it is not stored by CString.
+    /// The allocator of str is used.
+    [[nodiscard]] inline explicit CStringBuilder(StringType &&str) noexcept
+        : CStringBuilder(str.allocator())
+    {
+        if constexpr (allowNull)
+        {
+            if (str.isNull())
+                return;
+        }
+        _len = str.len();
+        _cap = _len + 1;
+        _ptr = str.release();
+    }
+
+    /// \brief destructor
+    inline ~CStringBuilder()
+    {
+        _alloc.deallocate(_ptr);
+    }
+
+    /// \brief copy constructor (capacity is not copied, allocator is)
+    /// \param other another CStringBuilder
+    [[nodiscard]] inline CStringBuilder(const CStringBuilder &other)
+        : CStringBuilder(other._alloc)
+    {
+        if (!other._len)
+            return;
+        // other._ptr is not null and holds _len + 1 characters
+        const usize_t cap = other._len + 1;
+        _ptr = _alloc.allocate(cap);
+        simd::copyChars(_ptr,other._ptr,cap);
+        _len = other._len;
+        _cap = cap;
+    }
+
+    /// \brief copy assignment
+    /// \param other another CStringBuilder
+    /// \return reference to *this
+    inline CStringBuilder& operator=(const CStringBuilder &other)
+    {
+        if (this != &other)
+        {
+            clear();
+            append(other.ptr(),other._len);
+        }
+        return *this;
+    }
+
+    /// \brief move constructor
+    /// \param other another CStringBuilder (empty afterward)
+    [[nodiscard]] inline CStringBuilder(CStringBuilder &&other) noexcept
+        : _ptr(other._ptr), _len(other._len), _cap(other._cap),
+          _alloc(other._alloc)
+    {
+        other._ptr = nullptr;
+        other._len = 0;
+        other._cap = 0;
+    }
+
+    /// \brief move assignment
+    /// \param other another CStringBuilder
+    /// \return reference to *this
+    inline CStringBuilder& operator=(CStringBuilder &&other) noexcept
+    {
+        swap(_ptr,other._ptr);
+        swap(_len,other._len);
+        swap(_cap,other._cap);
+        swap(_alloc,other._alloc);
+        return *this;
+    }
+
+    /// \brief length of the string (constant time)
+    /// \return number of characters (excludes null terminator)
+    [[nodiscard]] inline usize_t len() const noexcept
+    {
+        return _len;
+    }
+
+    /// \brief length of the string (constant time)
+    /// \return number of characters (excludes null terminator)
+    [[nodiscard]] inline usize_t size() const noexcept
+    {
+        return _len;
+    }
+
+    /// \brief number of characters that fit without reallocating
+    /// \return capacity (excludes null terminator)
+    [[nodiscard]] inline usize_t capacity() const noexcept
+    {
+        return _cap ? _cap - 1 : 0;
+    }
+
+    /// \brief const pointer to the null-terminated value
+    /// \return C string pointer (never null)
+    [[nodiscard]] inline const CharType* ptr() const noexcept
+    {
+        return _ptr ? _ptr : _cEmpty;
+    }
+
+    /// \brief ensure space for a total number of characters
+    /// \param capacity characters to reserve (excludes null terminator)
+    inline void reserve(const usize_t capacity)
+    {
+        if (capacity + 1 > _cap)
+            _replace(_copyTo(capacity + 1),capacity + 1);
+    }
+
+    /// \brief set to the empty string (keeps the allocated capacity)
+    inline void clear() noexcept
+    {
+        _len = 0;
+        if (_ptr)
+            _ptr[0] = static_cast<CharType>(0);
+    }
+
+    /// \brief append characters with a known length
+    /// \param ptr pointer to at least count characters (not null)
+    /// \param count number of characters (must not include null characters)
+    /// \return reference to *this
+    inline CStringBuilder& append(
+        const CharType * const ptr, const usize_t count)
+    {
+        if (!count)
+            return *this;
+        // _len < _cap unless nothing is allocated (both are 0)
+        if (count >= _cap - _len)
+            _appendGrow(ptr,count);
+        else
+        {
+            simd::copyChars(_ptr+_len,ptr,count);
+            _len += count;
+            _ptr[_len] = static_cast<CharType>(0);
+        }
+        return *this;
+    }
+
+    /// \brief append a null-terminated C string
+    /// \param ptr the string (nothing is appended if null and allowNull)
+    /// \return reference to *this
+    inline CStringBuilder& append(const CharType * const ptr)
+    {
+        if constexpr (allowNull)
+        {
+            if (!ptr)
+                return *this;
+        }
+        return append(ptr,simd::strLen(ptr));
+    }
+
+    /// \brief append a repeated character
+    /// \param count number of times to append it
+    /// \param value character value (must be nonzero)
+    /// \return reference to *this
+    inline CStringBuilder& append(const usize_t count, const CharType value)
+    {
+        if (!count)
+            return *this;
+        if (count >= _cap - _len)
+        {
+            const usize_t cap = _grownCapacity(_len + count + 1);
+            _replace(_copyTo(cap),cap);
+        }
+        for (usize_t i = 0; i < count; ++i)
+            _ptr[_len+i] = value;
+        _len += count;
+        _ptr[_len] = static_cast<CharType>(0);
+        return *this;
+    }
+
+    /// \brief append a C string
+    inline CStringBuilder& operator+=(const CharType * const ptr)
+    {
+        return append(ptr);
+    }
+
+    /// \brief append a CString
+    inline CStringBuilder& operator+=(const StringType &str)
+    {
+        return append(str.ptr());
+    }
+
+    /// \brief append another builder
+    inline CStringBuilder& operator+=(const CStringBuilder &other)
+    {
+        return append(other.ptr(),other._len);
+    }
+
+    /// \brief append a single character (must be nonzero)
+    inline CStringBuilder& operator+=(const CharType value)
+    {
+        return append(1,value);
+    }
+
+    /// \brief (non const) access to a character
+    /// \param i the index (valid range is [0,len()), undefined otherwise)
+    /// \return reference to ith character
+    [[nodiscard]] inline CharType& operator[](const usize_t i) noexcept
+    {
+        return _ptr[i];
+    }
+
+    /// \brief (const) access to a character
+    /// \param i the index (valid range is [0,len()])
+    /// \return reference to ith character
+    [[nodiscard]] inline const CharType& operator[](
+        const usize_t i) const noexcept
+    {
+        return ptr()[i];
+    }
+
+    /// \brief hand the buffer to a CString without copying
+    /// \return the built string (never null)
+    ///
+    /// The builder is empty afterward with no memory allocated. Extra capacity
+    /// stays allocated with the CString and is freed with it.
+    [[nodiscard]] inline StringType build()
+    {
+        if (!_ptr)
+            _replace(_copyTo(1),1);
+        CharType *ptr = _ptr;
+        _ptr = nullptr;
+        _len = 0;
+        _cap = 0;
+        return StringType::ptrWrap(ptr,_alloc);
+    }
+};
+
+} // namespace tkoz::stl
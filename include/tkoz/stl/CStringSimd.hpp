@@ -0,0 +1,1410 @@
+///
+/// vectorized kernels for null-terminated C strings
+///
+
+#pragma once
+
+#include <tkoz/stl/Meta.hpp>
+#include <tkoz/stl/Simd.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <compare>
+
+#if __x86_64__
+#include <immintrin.h>
+#endif
+
+namespace tkoz::stl::simd
+{
+
+/// \brief character types processed as bytes by the vectorized kernels
+/// \tparam CharType character type
+///
+/// Other character types (such as wchar_t or int) use scalar loops.
+template <typename CharType>
+concept isByteChar = meta::isSameAsAny<meta::RemoveCV<CharType>,
+    char,signed char,unsigned char,char8_t>;
+
+/// \brief set of byte values for vectorized searches (see memFindAny())
+///
+/// Besides a 256 bit membership bitmap, this keeps 2 tables indexed by the
+/// low 4 bits of a byte giving a bit for each high 4 bits value in the set
+/// (high values 0-7 and 8-15), so vector kernels can test 32 bytes with a few
+/// shuffles instead of comparing with each member.
+class ByteSet
+{
+private:
+
+    /// membership bitmap
+    uint64_t _bits[4];
+
+    /// nibble tables for high values 0-7 and 8-15
+    alignas(16) uchar_t _nibbles[2][16];
+
+public:
+
+    /// \brief initialize the empty set
+    [[nodiscard]] inline constexpr ByteSet() noexcept
+        : _bits{}, _nibbles{} {}
+
+    /// \brief initialize with characters from an array
+    /// \param chars array of byte sized characters
+    /// \param n number of characters
+    template <isByteChar CharType>
+    [[nodiscard]] inline constexpr ByteSet(
+        const CharType * const chars, const usize_t n) noexcept
+        : ByteSet()
+    {
+        for (usize_t i = 0; i < n; ++i)
+            add(static_cast<uchar_t>(chars[i]));
+    }
+
+    /// \brief initialize with characters from a C string
+    /// \param chars null-terminated string (the null is not added)
+    template <isByteChar CharType>
+    [[nodiscard]] inline constexpr explicit ByteSet(
+        const CharType * const chars) noexcept
+        : ByteSet()
+    {
+        for (const CharType *p = chars; *p; ++p)
+            add(static_cast<uchar_t>(*p));
+    }
+
+    /// \brief ASCII whitespace (space, \\t, \\n, \\v, \\f, \\r)
+    [[nodiscard]] static inline constexpr ByteSet whitespace() noexcept
+    {
+        return ByteSet(" \t\n\v\f\r");
+    }
+
+    /// \brief add a byte value
+    inline constexpr void add(const uchar_t b) noexcept
+    {
+        _bits[b >> 6] |= uint64_t(1) << (b & 63);
+        _nibbles[b >> 7][b & 15] |= static_cast<uchar_t>(1u << ((b >> 4) & 7));
+    }
+
+    /// \brief add all byte values in an inclusive range
+    inline constexpr void addRange(const uchar_t lo, const uchar_t hi) noexcept
+    {
+        for (uint_t b = lo; b <= hi; ++b)
+            add(static_cast<uchar_t>(b));
+    }
+
+    /// \brief is a byte value in the set
+    [[nodiscard]] inline constexpr bool contains(const uchar_t b) const noexcept
+    {
+        return (_bits[b >> 6] >> (b & 63)) & 1;
+    }
+
+    /// \brief nibble table for high values 0-7 (i = 0) or 8-15 (i = 1)
+    [[nodiscard]] inline constexpr const uchar_t* nibbleTable(
+        const usize_t i) const noexcept
+    {
+        return _nibbles[i];
+    }
+};
+
+namespace _detail
+{
+
+//
+// scalar implementations (reference behavior for all kernels)
+//
+
+template <typename CharType>
+[[nodiscard]] inline usize_t _strLenScalar(const CharType *ptr) noexcept
+{
+    usize_t l = 0;
+    while (ptr[l])
+        ++l;
+    return l;
+}
+
+// index of the first mismatched pair or the null terminator of s1
+template <typename CharType>
+[[nodiscard]] inline usize_t _strMismatchScalar(
+    const CharType *s1, const CharType *s2) noexcept
+{
+    usize_t i = 0;
+    while (s1[i] && s1[i] == s2[i])
+        ++i;
+    return i;
+}
+
+/// index value for a failed search
+inline constexpr usize_t _cNotFound = static_cast<usize_t>(-1);
+
+// index of the first occurrence of needle (m >= 2 characters, m <= n)
+template <typename CharType>
+[[nodiscard]] inline usize_t _memFindScalar(const CharType *hay,
+    const usize_t n, const CharType *needle, const usize_t m) noexcept
+{
+    for (usize_t i = 0; i + m <= n; ++i)
+        if (hay[i] == needle[0] && hay[i+m-1] == needle[m-1]
+            && !__builtin_memcmp(hay+i+1,needle+1,(m-2)*sizeof(CharType)))
+            return i;
+    return _cNotFound;
+}
+
+// index of the first occurrence of a character (or n)
+template <typename CharType>
+[[nodiscard]] inline usize_t _memChrScalar(const CharType *hay,
+    const usize_t n, const CharType c) noexcept
+{
+    for (usize_t i = 0; i < n; ++i)
+        if (hay[i] == c)
+            return i;
+    return n;
+}
+
+// index of the first byte in a set (or n)
+[[nodiscard]] inline usize_t _memFindAnyScalar(const uchar_t *hay,
+    const usize_t n, const ByteSet &set) noexcept
+{
+    for (usize_t i = 0; i < n; ++i)
+        if (set.contains(hay[i]))
+            return i;
+    return n;
+}
+
+// index of the first mismatched pair within n characters (or n)
+template <typename CharType>
+[[nodiscard]] inline usize_t _memMismatchScalar(
+    const CharType *s1, const CharType *s2, const usize_t n) noexcept
+{
+    usize_t i = 0;
+    while (i < n && s1[i] == s2[i])
+        ++i;
+    return i;
+}
+
+// ASCII letter case mapping (other characters are unchanged)
+template <typename CharType>
+[[nodiscard]] inline constexpr CharType _toLowerAscii(const CharType c)
+    noexcept
+{
+    return c >= CharType('A') && c <= CharType('Z')
+        ? static_cast<CharType>(c + 32) : c;
+}
+
+template <typename CharType>
+[[nodiscard]] inline constexpr CharType _toUpperAscii(const CharType c)
+    noexcept
+{
+    return c >= CharType('a') && c <= CharType('z')
+        ? static_cast<CharType>(c - 32) : c;
+}
+
+// index of the first pair mismatched ignoring ASCII case or the null
+// terminator of s1
+template <typename CharType>
+[[nodiscard]] inline usize_t _strMismatchIgnoreCaseScalar(
+    const CharType *s1, const CharType *s2) noexcept
+{
+    usize_t i = 0;
+    while (s1[i] && _toLowerAscii(s1[i]) == _toLowerAscii(s2[i]))
+        ++i;
+    return i;
+}
+
+// map n characters to lower (or upper) case, dst may be equal to src
+template <bool upper, typename CharType>
+inline void _memCaseScalar(CharType * const dst, const CharType * const src,
+    const usize_t n) noexcept
+{
+    for (usize_t i = 0; i < n; ++i)
+        dst[i] = upper ? _toUpperAscii(src[i]) : _toLowerAscii(src[i]);
+}
+
+#if __x86_64__
+
+//
+// The length kernels start with an aligned load (which cannot cross a page)
+// and discard the bytes before the string. The mismatch kernels use unaligned
+// loads and fall back to one scalar step whenever a load could touch the next
+// page. Bytes beyond the null terminator may be read but only within a page
+// that is already known to be mapped. Address and thread sanitizers cannot
+// know this (such bytes may belong to freed memory) so they are disabled for
+// these functions.
+//
+
+[[gnu::no_sanitize_address, gnu::no_sanitize_thread]]
+inline usize_t _strLenSse2(const char * const ptr) noexcept
+{
+    const uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
+    const char *block = reinterpret_cast<const char*>(addr & ~uintptr_t(15));
+    const __m128i zero = _mm_setzero_si128();
+    __m128i v = _mm_load_si128(reinterpret_cast<const __m128i*>(block));
+    uint_t mask = static_cast<uint_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(v,zero))) >> (addr & 15);
+    if (mask)
+        return static_cast<usize_t>(__builtin_ctz(mask));
+    for (;;)
+    {
+        block += 16;
+        v = _mm_load_si128(reinterpret_cast<const __m128i*>(block));
+        mask = static_cast<uint_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v,zero)));
+        if (mask)
+            return static_cast<usize_t>(block - ptr) + __builtin_ctz(mask);
+    }
+}
+
+[[gnu::target("avx2"), gnu::no_sanitize_address,
+    gnu::no_sanitize_thread]]
+inline usize_t _strLenAvx2(const char * const ptr) noexcept
+{
+    const uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
+    const char *block = reinterpret_cast<const char*>(addr & ~uintptr_t(31));
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i v = _mm256_load_si256(reinterpret_cast<const __m256i*>(block));
+    uint_t mask = static_cast<uint_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(v,zero))) >> (addr & 31);
+    if (mask)
+        return static_cast<usize_t>(__builtin_ctz(mask));
+    for (;;)
+    {
+        block += 32;
+        v = _mm256_load_si256(reinterpret_cast<const __m256i*>(block));
+        mask = static_cast<uint_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(v,zero)));
+        if (mask)
+            return static_cast<usize_t>(block - ptr) + __builtin_ctz(mask);
+    }
+}
+
+[[gnu::target("avx512f,avx512bw"), gnu::no_sanitize_address,
+    gnu::no_sanitize_thread]]
+inline usize_t _strLenAvx512(const char * const ptr) noexcept
+{
+    const uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
+    const char *block = reinterpret_cast<const char*>(addr & ~uintptr_t(63));
+    __m512i v = _mm512_load_si512(reinterpret_cast<const void*>(block));
+    u64 mask = static_cast<u64>(_mm512_testn_epi8_mask(v,v)) >> (addr & 63);
+    if (mask)
+        return static_cast<usize_t>(__builtin_ctzll(mask));
+    for (;;)
+    {
+        block += 64;
+        v = _mm512_load_si512(reinterpret_cast<const void*>(block));
+        mask = static_cast<u64>(_mm512_testn_epi8_mask(v,v));
+        if (mask)
+            return static_cast<usize_t>(block - ptr) + __builtin_ctzll(mask);
+    }
+}
+
+[[gnu::no_sanitize_address, gnu::no_sanitize_thread]]
+inline usize_t _strMismatchSse2(
+    const char * const s1, const char * const s2) noexcept
+{
+    const __m128i zero = _mm_setzero_si128();
+    usize_t i = 0;
+    for (;;)
+    {
+        if (crossesPage(s1+i,16) || crossesPage(s2+i,16)) [[unlikely]]
+        {
+            if (!s1[i] || s1[i] != s2[i])
+                return i;
+            ++i;
+            continue;
+        }
+        const __m128i a = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(s1+i));
+        const __m128i b = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(s2+i));
+        const uint_t ne = ~static_cast<uint_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(a,b))) & 0xFFFFu;
+        const uint_t nul = static_cast<uint_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(a,zero)));
+        if (ne | nul)
+            return i + static_cast<usize_t>(__builtin_ctz(ne | nul));
+        i += 16;
+    }
+}
+
+[[gnu::target("avx2"), gnu::no_sanitize_address,
+    gnu::no_sanitize_thread]]
+inline usize_t _strMismatchAvx2(
+    const char * const s1, const char * const s2) noexcept
+{
+    const __m256i zero = _mm256_setzero_si256();
+    usize_t i = 0;
+    for (;;)
+    {
+        if (crossesPage(s1+i,32) || crossesPage(s2+i,32)) [[unlikely]]
+        {
+            if (!s1[i] || s1[i] != s2[i])
+                return i;
+            ++i;
+            continue;
+        }
+        const __m256i a = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(s1+i));
+        const __m256i b = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(s2+i));
+        const uint_t ne = ~static_cast<uint_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(a,b)));
+        const uint_t nul = static_cast<uint_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(a,zero)));
+        if (ne | nul)
+            return i + static_cast<usize_t>(__builtin_ctz(ne | nul));
+        i += 32;
+    }
+}
+
+[[gnu::target("avx512f,avx512bw"), gnu::no_sanitize_address,
+    gnu::no_sanitize_thread]]
+inline usize_t _strMismatchAvx512(
+    const char * const s1, const char * const s2) noexcept
+{
+    usize_t i = 0;
+    for (;;)
+    {
+        if (crossesPage(s1+i,64) || crossesPage(s2+i,64)) [[unlikely]]
+        {
+            if (!s1[i] || s1[i] != s2[i])
+                return i;
+            ++i;
+            continue;
+        }
+        const __m512i a = _mm512_loadu_si512(
+            reinterpret_cast<const void*>(s1+i));
+        const __m512i b = _mm512_loadu_si512(
+            reinterpret_cast<const void*>(s2+i));
+        const u64 mask = static_cast<u64>(_mm512_cmpneq_epi8_mask(a,b))
+            | static_cast<u64>(_mm512_testn_epi8_mask(a,a));
+        if (mask)
+            return i + static_cast<usize_t>(__builtin_ctzll(mask));
+        i += 64;
+    }
+}
+
+//
+// The known length mismatch kernels only read within both arrays. The
+// remainder after the last full vector is handled by a scalar loop, except
+// with AVX-512 which uses a masked load.
+//
+
+inline usize_t _memMismatchSse2(
+    const char * const s1, const char * const s2, const usize_t n) noexcept
+{
+    usize_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        const __m128i a = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(s1+i));
+        const __m128i b = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(s2+i));
+        const uint_t ne = ~static_cast<uint_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(a,b))) & 0xFFFFu;
+        if (ne)
+            return i + static_cast<usize_t>(__builtin_ctz(ne));
+    }
+    return i + _memMismatchScalar(s1+i,s2+i,n-i);
+}
+
+[[gnu::target("avx2")]]
+inline usize_t _memMismatchAvx2(
+    const char * const s1, const char * const s2, const usize_t n) noexcept
+{
+    usize_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        const __m256i a = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(s1+i));
+        const __m256i b = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(s2+i));
+        const uint_t ne = ~static_cast<uint_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(a,b)));
+        if (ne)
+            return i + static_cast<usize_t>(__builtin_ctz(ne));
+    }
+    return i + _memMismatchScalar(s1+i,s2+i,n-i);
+}
+
+[[gnu::target("avx512f,avx512bw")]]
+inline usize_t _memMismatchAvx512(
+    const char * const s1, const char * const s2, const usize_t n) noexcept
+{
+    usize_t i = 0;
+    for (; i + 64 <= n; i += 64)
+    {
+        const __m512i a = _mm512_loadu_si512(
+            reinterpret_cast<const void*>(s1+i));
+        const __m512i b = _mm512_loadu_si512(
+            reinterpret_cast<const void*>(s2+i));
+        const u64 mask = static_cast<u64>(_mm512_cmpneq_epi8_mask(a,b));
+        if (mask)
+            return i + static_cast<usize_t>(__builtin_ctzll(mask));
+    }
+    if (i == n)
+        return n;
+    // masked loads do not touch bytes outside the mask
+    const __mmask64 tail = (u64(1) << (n-i)) - 1;
+    const __m512i a = _mm512_maskz_loadu_epi8(tail,s1+i);
+    const __m512i b = _mm512_maskz_loadu_epi8(tail,s2+i);
+    const u64 mask = static_cast<u64>(_mm512_cmpneq_epi8_mask(a,b));
+    return mask ? i + static_cast<usize_t>(__builtin_ctzll(mask)) : n;
+}
+
+//
+// The substring search kernels compare the first and last needle characters
+// with 2 vectors of haystack positions and only verify positions where both
+// match, which skips most of the haystack with few comparisons.
+//
+
+inline usize_t _memFindSse2(const char * const hay, const usize_t n,
+    const char * const needle, const usize_t m) noexcept
+{
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[m-1]);
+    usize_t i = 0;
+    for (; i + m - 1 + 16 <= n; i += 16)
+    {
+        const __m128i a = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(hay+i));
+        const __m128i b = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(hay+i+m-1));
+        uint_t mask = static_cast<uint_t>(_mm_movemask_epi8(_mm_and_si128(
+            _mm_cmpeq_epi8(a,first),_mm_cmpeq_epi8(b,last))));
+        while (mask)
+        {
+            const usize_t j = i + static_cast<usize_t>(__builtin_ctz(mask));
+            if (!__builtin_memcmp(hay+j+1,needle+1,m-2))
+                return j;
+            mask &= mask - 1;
+        }
+    }
+    const usize_t j = _memFindScalar(hay+i,n-i,needle,m);
+    return j == _cNotFound ? j : i + j;
+}
+
+[[gnu::target("avx2")]]
+inline usize_t _memFindAvx2(const char * const hay, const usize_t n,
+    const char * const needle, const usize_t m) noexcept
+{
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[m-1]);
+    usize_t i = 0;
+    for (; i + m - 1 + 32 <= n; i += 32)
+    {
+        const __m256i a = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(hay+i));
+        const __m256i b = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(hay+i+m-1));
+        uint_t mask = static_cast<uint_t>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(a,first),
+                _mm256_cmpeq_epi8(b,last))));
+        while (mask)
+        {
+            const usize_t j = i + static_cast<usize_t>(__builtin_ctz(mask));
+            if (!__builtin_memcmp(hay+j+1,needle+1,m-2))
+                return j;
+            mask &= mask - 1;
+        }
+    }
+    const usize_t j = _memFindScalar(hay+i,n-i,needle,m);
+    return j == _cNotFound ? j : i + j;
+}
+
+inline usize_t _memChrSse2(const char * const hay, const usize_t n,
+    const char c) noexcept
+{
+    const __m128i vc = _mm_set1_epi8(c);
+    usize_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        const __m128i v = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(hay+i));
+        const uint_t mask = static_cast<uint_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(v,vc)));
+        if (mask)
+            return i + static_cast<usize_t>(__builtin_ctz(mask));
+    }
+    return i + _memChrScalar(hay+i,n-i,c);
+}
+
+[[gnu::target("avx2")]]
+inline usize_t _memChrAvx2(const char * const hay, const usize_t n,
+    const char c) noexcept
+{
+    const __m256i vc = _mm256_set1_epi8(c);
+    usize_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        const __m256i v = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(hay+i));
+        const uint_t mask = static_cast<uint_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(v,vc)));
+        if (mask)
+            return i + static_cast<usize_t>(__builtin_ctz(mask));
+    }
+    return i + _memChrScalar(hay+i,n-i,c);
+}
+
+// Each byte looks up its low 4 bits in the 2 nibble tables and its high 4
+// bits in 2 tables of single bits, and is in the set if either AND is nonzero.
+[[gnu::target("avx2")]]
+inline usize_t _memFindAnyAvx2(const uchar_t * const hay, const usize_t n,
+    const ByteSet &set) noexcept
+{
+    const __m256i tLo = _mm256_broadcastsi128_si256(_mm_load_si128(
+        reinterpret_cast<const __m128i*>(set.nibbleTable(0))));
+    const __m256i tHi = _mm256_broadcastsi128_si256(_mm_load_si128(
+        reinterpret_cast<const __m128i*>(set.nibbleTable(1))));
+    const __m256i bitLo = _mm256_setr_epi8(1,2,4,8,16,32,64,-128,
+        0,0,0,0,0,0,0,0,1,2,4,8,16,32,64,-128,0,0,0,0,0,0,0,0);
+    const __m256i bitHi = _mm256_setr_epi8(0,0,0,0,0,0,0,0,
+        1,2,4,8,16,32,64,-128,0,0,0,0,0,0,0,0,1,2,4,8,16,32,64,-128);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i zero = _mm256_setzero_si256();
+    usize_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        const __m256i v = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(hay+i));
+        const __m256i lo = _mm256_and_si256(v,nibble);
+        const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v,4),nibble);
+        const __m256i m = _mm256_or_si256(
+            _mm256_and_si256(_mm256_shuffle_epi8(tLo,lo),
+                _mm256_shuffle_epi8(bitLo,hi)),
+            _mm256_and_si256(_mm256_shuffle_epi8(tHi,lo),
+                _mm256_shuffle_epi8(bitHi,hi)));
+        const uint_t mask = ~static_cast<uint_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(m,zero)));
+        if (mask)
+            return i + static_cast<usize_t>(__builtin_ctz(mask));
+    }
+    return i + _memFindAnyScalar(hay+i,n-i,set);
+}
+
+//
+// The case kernels flip bit 0x20 of the bytes in a range of 26 letters
+// starting at first. After subtracting first, those bytes are the unsigned
+// values below 26, which SSE2 and AVX2 test with a signed compare after
+// also subtracting 128. Case insensitive mismatch lowers both strings and
+// otherwise works like the mismatch kernels (including page checks).
+//
+
+inline __m128i _flipCaseSse2(const __m128i v, const char first) noexcept
+{
+    const __m128i t = _mm_sub_epi8(v,
+        _mm_set1_epi8(static_cast<char>(first ^ 0x80)));
+    const __m128i m = _mm_cmplt_epi8(t,_mm_set1_epi8(-128 + 26));
+    return _mm_xor_si128(v,_mm_and_si128(m,_mm_set1_epi8(0x20)));
+}
+
+[[gnu::target("avx2")]]
+inline __m256i _flipCaseAvx2(const __m256i v, const char first) noexcept
+{
+    const __m256i t = _mm256_sub_epi8(v,
+        _mm256_set1_epi8(static_cast<char>(first ^ 0x80)));
+    const __m256i m = _mm256_cmpgt_epi8(_mm256_set1_epi8(-128 + 26),t);
+    return _mm256_xor_si256(v,_mm256_and_si256(m,_mm256_set1_epi8(0x20)));
+}
+
+[[gnu::target("avx512f,avx512bw")]]
+inline __m512i _flipCaseAvx512(const __m512i v, const char first) noexcept
+{
+    const __mmask64 m = _mm512_cmplt_epu8_mask(
+        _mm512_sub_epi8(v,_mm512_set1_epi8(first)),_mm512_set1_epi8(26));
+    return _mm512_mask_blend_epi8(m,v,
+        _mm512_xor_si512(v,_mm512_set1_epi8(0x20)));
+}
+
+[[gnu::no_sanitize_address, gnu::no_sanitize_thread]]
+inline usize_t _strMismatchIgnoreCaseSse2(
+    const char * const s1, const char * const s2) noexcept
+{
+    const __m128i zero = _mm_setzero_si128();
+    usize_t i = 0;
+    for (;;)
+    {
+        if (crossesPage(s1+i,16) || crossesPage(s2+i,16)) [[unlikely]]
+        {
+            if (!s1[i] || _toLowerAscii(s1[i]) != _toLowerAscii(s2[i]))
+                return i;
+            ++i;
+            continue;
+        }
+        const __m128i a = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(s1+i));
+        const __m128i b = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(s2+i));
+        const uint_t ne = ~static_cast<uint_t>(_mm_movemask_epi8(
+            _mm_cmpeq_epi8(_flipCaseSse2(a,'A'),_flipCaseSse2(b,'A'))))
+            & 0xFFFFu;
+        const uint_t nul = static_cast<uint_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(a,zero)));
+        if (ne | nul)
+            return i + static_cast<usize_t>(__builtin_ctz(ne | nul));
+        i += 16;
+    }
+}
+
+[[gnu::target("avx2"), gnu::no_sanitize_address,
+    gnu::no_sanitize_thread]]
+inline usize_t _strMismatchIgnoreCaseAvx2(
+    const char * const s1, const char * const s2) noexcept
+{
+    const __m256i zero = _mm256_setzero_si256();
+    usize_t i = 0;
+    for (;;)
+    {
+        if (crossesPage(s1+i,32) || crossesPage(s2+i,32)) [[unlikely]]
+        {
+            if (!s1[i] || _toLowerAscii(s1[i]) != _toLowerAscii(s2[i]))
+                return i;
+            ++i;
+            continue;
+        }
+        const __m256i a = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(s1+i));
+        const __m256i b = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(s2+i));
+        const uint_t ne = ~static_cast<uint_t>(_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_flipCaseAvx2(a,'A'),_flipCaseAvx2(b,'A'))));
+        const uint_t nul = static_cast<uint_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(a,zero)));
+        if (ne | nul)
+            return i + static_cast<usize_t>(__builtin_ctz(ne | nul));
+        i += 32;
+    }
+}
+
+[[gnu::target("avx512f,avx512bw"), gnu::no_sanitize_address,
+    gnu::no_sanitize_thread]]
+inline usize_t _strMismatchIgnoreCaseAvx512(
+    const char * const s1, const char * const s2) noexcept
+{
+    usize_t i = 0;
+    for (;;)
+    {
+        if (crossesPage(s1+i,64) || crossesPage(s2+i,64)) [[unlikely]]
+        {
+            if (!s1[i] || _toLowerAscii(s1[i]) != _toLowerAscii(s2[i]))
+                return i;
+            ++i;
+            continue;
+        }
+        const __m512i a = _mm512_loadu_si512(
+            reinterpret_cast<const void*>(s1+i));
+        const __m512i b = _mm512_loadu_si512(
+            reinterpret_cast<const void*>(s2+i));
+        const u64 mask = static_cast<u64>(_mm512_cmpneq_epi8_mask(
+                _flipCaseAvx512(a,'A'),_flipCaseAvx512(b,'A')))
+            | static_cast<u64>(_mm512_testn_epi8_mask(a,a));
+        if (mask)
+            return i + static_cast<usize_t>(__builtin_ctzll(mask));
+        i += 64;
+    }
+}
+
+template <bool upper>
+inline void _memCaseSse2(char * const dst, const char * const src,
+    const usize_t n) noexcept
+{
+    const char first = upper ? 'a' : 'A';
+    usize_t i = 0;
+    for (; i + 16 <= n; i += 16)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst+i),_flipCaseSse2(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src+i)),first));
+    _memCaseScalar<upper>(dst+i,src+i,n-i);
+}
+
+template <bool upper>
+[[gnu::target("avx2")]]
+inline void _memCaseAvx2(char * const dst, const char * const src,
+    const usize_t n) noexcept
+{
+    const char first = upper ? 'a' : 'A';
+    usize_t i = 0;
+    for (; i + 32 <= n; i += 32)
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst+i),
+            _flipCaseAvx2(_mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(src+i)),first));
+    _memCaseScalar<upper>(dst+i,src+i,n-i);
+}
+
+template <bool upper>
+[[gnu::target("avx512f,avx512bw")]]
+inline void _memCaseAvx512(char * const dst, const char * const src,
+    const usize_t n) noexcept
+{
+    const char first = upper ? 'a' : 'A';
+    usize_t i = 0;
+    for (; i + 64 <= n; i += 64)
+        _mm512_storeu_si512(reinterpret_cast<void*>(dst+i),_flipCaseAvx512(
+            _mm512_loadu_si512(reinterpret_cast<const void*>(src+i)),first));
+    if (i == n)
+        return;
+    // masked loads and stores do not touch bytes outside the mask
+    const __mmask64 tail = (u64(1) << (n-i)) - 1;
+    _mm512_mask_storeu_epi8(dst+i,tail,
+        _flipCaseAvx512(_mm512_maskz_loadu_epi8(tail,src+i),first));
+}
+
+#endif // __x86_64__
+
+//
+// selection of a kernel for a SIMD level
+//
+
+using _StrLenFn = usize_t (*)(const char*) noexcept;
+using _StrMismatchFn = usize_t (*)(const char*, const char*) noexcept;
+
+[[nodiscard]] inline _StrLenFn _selectStrLen(const SimdLevel level) noexcept
+{
+    switch (level)
+    {
+#if __x86_64__
+    case cSimdAvx512:
+        return _strLenAvx512;
+    case cSimdAvx2:
+        return _strLenAvx2;
+    case cSimdSse2:
+        return _strLenSse2;
+#endif
+    default:
+        return _strLenScalar<char>;
+    }
+}
+
+[[nodiscard]] inline _StrMismatchFn _selectStrMismatch(
+    const SimdLevel level) noexcept
+{
+    switch (level)
+    {
+#if __x86_64__
+    case cSimdAvx512:
+        return _strMismatchAvx512;
+    case cSimdAvx2:
+        return _strMismatchAvx2;
+    case cSimdSse2:
+        return _strMismatchSse2;
+#endif
+    default:
+        return _strMismatchScalar<char>;
+    }
+}
+
+using _MemMismatchFn = usize_t (*)(const char*, const char*, usize_t)
+    noexcept;
+
+[[nodiscard]] inline _MemMismatchFn _selectMemMismatch(
+    const SimdLevel level) noexcept
+{
+    switch (level)
+    {
+#if __x86_64__
+    case cSimdAvx512:
+        return _memMismatchAvx512;
+    case cSimdAvx2:
+        return _memMismatchAvx2;
+    case cSimdSse2:
+        return _memMismatchSse2;
+#endif
+    default:
+        return _memMismatchScalar<char>;
+    }
+}
+
+using _MemFindFn = usize_t (*)(const char*, usize_t, const char*, usize_t)
+    noexcept;
+
+// AVX-512 uses the AVX2 kernel (verification dominates with wider vectors)
+[[nodiscard]] inline _MemFindFn _selectMemFind(const SimdLevel level) noexcept
+{
+    switch (level)
+    {
+#if __x86_64__
+    case cSimdAvx512:
+    case cSimdAvx2:
+        return _memFindAvx2;
+    case cSimdSse2:
+        return _memFindSse2;
+#endif
+    default:
+        return _memFindScalar<char>;
+    }
+}
+
+using _MemChrFn = usize_t (*)(const char*, usize_t, char) noexcept;
+
+[[nodiscard]] inline _MemChrFn _selectMemChr(const SimdLevel level) noexcept
+{
+    switch (level)
+    {
+#if __x86_64__
+    case cSimdAvx512:
+    case cSimdAvx2:
+        return _memChrAvx2;
+    case cSimdSse2:
+        return _memChrSse2;
+#endif
+    default:
+        return _memChrScalar<char>;
+    }
+}
+
+using _MemFindAnyFn = usize_t (*)(const uchar_t*, usize_t, const ByteSet&)
+    noexcept;
+
+// shuffles need AVX2 (or SSSE3, which is not a separate level), so SSE2 uses
+// the scalar bitmap loop
+[[nodiscard]] inline _MemFindAnyFn _selectMemFindAny(
+    const SimdLevel level) noexcept
+{
+    switch (level)
+    {
+#if __x86_64__
+    case cSimdAvx512:
+    case cSimdAvx2:
+        return _memFindAnyAvx2;
+#endif
+    default:
+        return _memFindAnyScalar;
+    }
+}
+
+using _StrMismatchIgnoreCaseFn = _StrMismatchFn;
+
+[[nodiscard]] inline _StrMismatchIgnoreCaseFn _selectStrMismatchIgnoreCase(
+    const SimdLevel level) noexcept
+{
+    switch (level)
+    {
+#if __x86_64__
+    case cSimdAvx512:
+        return _strMismatchIgnoreCaseAvx512;
+    case cSimdAvx2:
+        return _strMismatchIgnoreCaseAvx2;
+    case cSimdSse2:
+        return _strMismatchIgnoreCaseSse2;
+#endif
+    default:
+        return _strMismatchIgnoreCaseScalar<char>;
+    }
+}
+
+using _MemCaseFn = void (*)(char*, const char*, usize_t) noexcept;
+
+template <bool upper>
+[[nodiscard]] inline _MemCaseFn _selectMemCase(const SimdLevel level) noexcept
+{
+    switch (level)
+    {
+#if __x86_64__
+    case cSimdAvx512:
+        return _memCaseAvx512<upper>;
+    case cSimdAvx2:
+        return _memCaseAvx2<upper>;
+    case cSimdSse2:
+        return _memCaseSse2<upper>;
+#endif
+    default:
+        return _memCaseScalar<upper,char>;
+    }
+}
+
+// kernels for the best supported level, selected on first use
+[[nodiscard]] inline usize_t _strLenDispatch(const char * const ptr) noexcept
+{
+    static const _StrLenFn sFn = _selectStrLen(simdLevel());
+    return sFn(ptr);
+}
+
+[[nodiscard]] inline usize_t _strMismatchDispatch(
+    const char * const s1, const char * const s2) noexcept
+{
+    static const _StrMismatchFn sFn = _selectStrMismatch(simdLevel());
+    return sFn(s1,s2);
+}
+
+[[nodiscard]] inline usize_t _memMismatchDispatch(
+    const char * const s1, const char * const s2, const usize_t n) noexcept
+{
+    static const _MemMismatchFn sFn = _selectMemMismatch(simdLevel());
+    return sFn(s1,s2,n);
+}
+
+[[nodiscard]] inline usize_t _memFindDispatch(const char * const hay,
+    const usize_t n, const char * const needle, const usize_t m) noexcept
+{
+    static const _MemFindFn sFn = _selectMemFind(simdLevel());
+    return sFn(hay,n,needle,m);
+}
+
+[[nodiscard]] inline usize_t _memChrDispatch(const char * const hay,
+    const usize_t n, const char c) noexcept
+{
+    static const _MemChrFn sFn = _selectMemChr(simdLevel());
+    return sFn(hay,n,c);
+}
+
+[[nodiscard]] inline usize_t _memFindAnyDispatch(const uchar_t * const hay,
+    const usize_t n, const ByteSet &set) noexcept
+{
+    static const _MemFindAnyFn sFn = _selectMemFindAny(simdLevel());
+    return sFn(hay,n,set);
+}
+
+[[nodiscard]] inline usize_t _strMismatchIgnoreCaseDispatch(
+    const char * const s1, const char * const s2) noexcept
+{
+    static const _StrMismatchIgnoreCaseFn sFn =
+        _selectStrMismatchIgnoreCase(simdLevel());
+    return sFn(s1,s2);
+}
+
+template <bool upper>
+inline void _memCaseDispatch(char * const dst, const char * const src,
+    const usize_t n) noexcept
+{
+    static const _MemCaseFn sFn = _selectMemCase<upper>(simdLevel());
+    sFn(dst,src,n);
+}
+
+// handle needles shorter than 2 characters, then call the kernel
+template <typename CharType, typename KernelType>
+[[nodiscard]] inline usize_t _memFind(const CharType * const hay,
+    const usize_t n, const CharType * const needle, const usize_t m,
+    KernelType kernel) noexcept
+{
+    if (m > n)
+        return _cNotFound;
+    if (!m)
+        return 0;
+    if (m == 1)
+    {
+        if constexpr (isByteChar<CharType>)
+        {
+            const void *p = __builtin_memchr(hay,
+                static_cast<unsigned char>(needle[0]),n);
+            return p ? static_cast<usize_t>(
+                static_cast<const CharType*>(p) - hay) : _cNotFound;
+        }
+        else
+        {
+            for (usize_t i = 0; i < n; ++i)
+                if (hay[i] == needle[0])
+                    return i;
+            return _cNotFound;
+        }
+    }
+    if constexpr (isByteChar<CharType>)
+        return kernel(reinterpret_cast<const char*>(hay),n,
+            reinterpret_cast<const char*>(needle),m);
+    else
+        return _memFindScalar(hay,n,needle,m);
+}
+
+} // namespace _detail
+
+/// \brief length of a null-terminated string
+/// \tparam CharType character type
+/// \param ptr the string (not null)
+/// \return number of characters before the null terminator
+///
+/// Byte sized characters use the best vector instructions available at
+/// runtime. Other character types use a scalar loop.
+template <typename CharType>
+[[nodiscard]] inline usize_t strLen(const CharType * const ptr) noexcept
+{
+    if constexpr (isByteChar<CharType>)
+        return _detail::_strLenDispatch(reinterpret_cast<const char*>(ptr));
+    else
+        return _detail::_strLenScalar(ptr);
+}
+
+/// \brief length of a null-terminated string using a specific SIMD level
+/// \tparam CharType character type
+/// \param ptr the string (not null)
+/// \param level SIMD level to use (limited to what the processor supports)
+/// \return number of characters before the null terminator
+template <typename CharType>
+[[nodiscard]] inline usize_t strLen(
+    const CharType * const ptr, const SimdLevel level) noexcept
+{
+    if constexpr (isByteChar<CharType>)
+        return _detail::_selectStrLen(clampSimdLevel(level))(
+            reinterpret_cast<const char*>(ptr));
+    else
+        return _detail::_strLenScalar(ptr);
+}
+
+/// \brief index of the first difference between 2 null-terminated strings
+/// \tparam CharType character type
+/// \param s1 first string (not null)
+/// \param s2 second string (not null)
+/// \return smallest index i with s1[i] != s2[i] or s1[i] == 0
+///
+/// Characters before the returned index are equal in both strings so it is
+/// enough to compare s1[i] and s2[i] to order or compare the strings.
+template <typename CharType>
+[[nodiscard]] inline usize_t strMismatch(
+    const CharType * const s1, const CharType * const s2) noexcept
+{
+    if constexpr (isByteChar<CharType>)
+        return _detail::_strMismatchDispatch(
+            reinterpret_cast<const char*>(s1),
+            reinterpret_cast<const char*>(s2));
+    else
+        return _detail::_strMismatchScalar(s1,s2);
+}
+
+/// \brief strMismatch() using a specific SIMD level
+/// \param level SIMD level to use (limited to what the processor supports)
+template <typename CharType>
+[[nodiscard]] inline usize_t strMismatch(
+    const CharType * const s1, const CharType * const s2,
+    const SimdLevel level) noexcept
+{
+    if constexpr (isByteChar<CharType>)
+        return _detail::_selectStrMismatch(clampSimdLevel(level))(
+            reinterpret_cast<const char*>(s1),
+            reinterpret_cast<const char*>(s2));
+    else
+        return _detail::_strMismatchScalar(s1,s2);
+}
+
+/// \brief compare 2 null-terminated strings for equality
+/// \param s1 first string (not null)
+/// \param s2 second string (not null)
+/// \return true if the strings are equal
+template <typename CharType>
+[[nodiscard]] inline bool strCmpEq(
+    const CharType * const s1, const CharType * const s2) noexcept
+{
+    const usize_t i = strMismatch(s1,s2);
+    return s1[i] == s2[i];
+}
+
+/// \brief compare 2 null-terminated strings (3 way)
+/// \param s1 first string (not null)
+/// \param s2 second string (not null)
+/// \return ordering of the first mismatched characters (or equal)
+template <typename CharType>
+[[nodiscard]] inline auto strCmp3way(
+    const CharType * const s1, const CharType * const s2) noexcept
+{
+    const usize_t i = strMismatch(s1,s2);
+    return s1[i] <=> s2[i];
+}
+
+/// \brief index of the first difference between 2 arrays of known length
+/// \tparam CharType character type
+/// \param s1 first array with at least n characters
+/// \param s2 second array with at least n characters
+/// \param n number of characters to compare
+/// \return smallest index i with s1[i] != s2[i], or n if there is none
+///
+/// Null characters are compared like any other character. Only the first n
+/// characters of each array are read.
+template <typename CharType>
+[[nodiscard]] inline usize_t memMismatch(const CharType * const s1,
+    const CharType * const s2, const usize_t n) noexcept
+{
+    if constexpr (isByteChar<CharType>)
+        return _detail::_memMismatchDispatch(
+            reinterpret_cast<const char*>(s1),
+            reinterpret_cast<const char*>(s2),n);
+    else
+        return _detail::_memMismatchScalar(s1,s2,n);
+}
+
+/// \brief memMismatch() using a specific SIMD level
+/// \param level SIMD level to use (limited to what the processor supports)
+template <typename CharType>
+[[nodiscard]] inline usize_t memMismatch(const CharType * const s1,
+    const CharType * const s2, const usize_t n, const SimdLevel level) noexcept
+{
+    if constexpr (isByteChar<CharType>)
+        return _detail::_selectMemMismatch(clampSimdLevel(level))(
+            reinterpret_cast<const char*>(s1),
+            reinterpret_cast<const char*>(s2),n);
+    else
+        return _detail::_memMismatchScalar(s1,s2,n);
+}
+
+/// \brief compare 2 arrays of known length for equality
+/// \param s1 first array
+/// \param l1 length of s1
+/// \param s2 second array
+/// \param l2 length of s2
+/// \return true if the lengths and characters are equal
+template <typename CharType>
+[[nodiscard]] inline bool memCmpEq(const CharType * const s1, const usize_t l1,
+    const CharType * const s2, const usize_t l2) noexcept
+{
+    return l1 == l2 && (!l1 || s1 == s2
+        || !__builtin_memcmp(s1,s2,l1*sizeof(CharType)));
+}
+
+/// \brief compare 2 arrays of known length (3 way)
+/// \param s1 first array
+/// \param l1 length of s1
+/// \param s2 second array
+/// \param l2 length of s2
+/// \return ordering of the first mismatched characters, or of the lengths
+///
+/// This orders the same way as strCmp3way() for strings without null
+/// characters (characters are compared as CharType, not as unsigned bytes).
+template <typename CharType>
+[[nodiscard]] inline std::strong_ordering memCmp3way(
+    const CharType * const s1, const usize_t l1,
+    const CharType * const s2, const usize_t l2) noexcept
+{
+    const usize_t n = l1 < l2 ? l1 : l2;
+    const usize_t i = memMismatch(s1,s2,n);
+    if (i < n)
+        return s1[i] <=> s2[i];
+    return l1 <=> l2;
+}
+
+/// \brief index of the first occurrence of a substring
+/// \tparam CharType character type
+/// \param hay array of n characters to search
+/// \param n length of hay
+/// \param needle array of m characters to find
+/// \param m length of needle
+/// \return smallest index of needle in hay, or static_cast<usize_t>(-1) if
+/// it does not occur (an empty needle is found at 0)
+///
+/// Byte sized characters use vector instructions to find positions where the
+/// first and last characters of needle match, then verify only those.
+template <typename CharType>
+[[nodiscard]] inline usize_t memFind(const CharType * const hay,
+    const usize_t n, const CharType * const needle, const usize_t m) noexcept
+{
+    return _detail::_memFind(hay,n,needle,m,_detail::_memFindDispatch);
+}
+
+/// \brief memFind() using a specific SIMD level
+/// \param level SIMD level to use (limited to what the processor supports)
+template <typename CharType>
+[[nodiscard]] inline usize_t memFind(const CharType * const hay,
+    const usize_t n, const CharType * const needle, const usize_t m,
+    const SimdLevel level) noexcept
+{
+    return _detail::_memFind(hay,n,needle,m,
+        _detail::_selectMemFind(clampSimdLevel(level)));
+}
+
+/// \brief index of the first occurrence of a character
+/// \tparam CharType character type
+/// \param hay array of n characters to search
+/// \param n length of hay
+/// \param c character to find
+/// \return smallest index of c in hay, or n if it does not occur
+template <typename CharType>
+[[nodiscard]] inline usize_t memChr(const CharType * const hay,
+    const usize_t n, const CharType c) noexcept
+{
+    if constexpr (isByteChar<CharType>)
+        return _detail::_memChrDispatch(reinterpret_cast<const char*>(hay),n,
+            static_cast<char>(c));
+    else
+        return _detail::_memChrScalar(hay,n,c);
+}
+
+/// \brief memChr() using a specific SIMD level
+/// \param level SIMD level to use (limited to what the processor supports)
+template <typename CharType>
+[[nodiscard]] inline usize_t memChr(const CharType * const hay,
+    const usize_t n, const CharType c, const SimdLevel level) noexcept
+{
+    if constexpr (isByteChar<CharType>)
+        return _detail::_selectMemChr(clampSimdLevel(level))(
+            reinterpret_cast<const char*>(hay),n,static_cast<char>(c));
+    else
+        return _detail::_memChrScalar(hay,n,c);
+}
+
+/// \brief index of the first character in a set
+/// \tparam CharType byte sized character type
+/// \param hay array of n characters to search
+/// \param n length of hay
+/// \param set byte values to find
+/// \return smallest index of a character in set, or n if there is none
+template <isByteChar CharType>
+[[nodiscard]] inline usize_t memFindAny(const CharType * const hay,
+    const usize_t n, const ByteSet &set) noexcept
+{
+    return _detail::_memFindAnyDispatch(
+        reinterpret_cast<const uchar_t*>(hay),n,set);
+}
+
+/// \brief memFindAny() using a specific SIMD level
+/// \param level SIMD level to use (limited to what the processor supports)
+template <isByteChar CharType>
+[[nodiscard]] inline usize_t memFindAny(const CharType * const hay,
+    const usize_t n, const ByteSet &set, const SimdLevel level) noexcept
+{
+    return _detail::_selectMemFindAny(clampSimdLevel(level))(
+        reinterpret_cast<const uchar_t*>(hay),n,set);
+}
+
+/// \brief lower case of an ASCII letter
+/// \param c a character
+/// \return c with A-Z mapped to a-z (other characters are unchanged)
+template <typename CharType>
+[[nodiscard]] inline constexpr CharType toLowerAscii(const CharType c)
+    noexcept
+{
+    return _detail::_toLowerAscii(c);
+}
+
+/// \brief upper case of an ASCII letter
+/// \param c a character
+/// \return c with a-z mapped to A-Z (other characters are unchanged)
+template <typename CharType>
+[[nodiscard]] inline constexpr CharType toUpperAscii(const CharType c)
+    noexcept
+{
+    return _detail::_toUpperAscii(c);
+}
+
+/// \brief strMismatch() ignoring ASCII case
+/// \tparam CharType character type
+/// \param s1 first string (not null)
+/// \param s2 second string (not null)
+/// \return smallest index i with toLowerAscii(s1[i]) != toLowerAscii(s2[i])
+/// or s1[i] == 0
+///
+/// Byte sized characters are lowered and compared 16 to 64 at a time.
+template <typename CharType>
+[[nodiscard]] inline usize_t strMismatchIgnoreCase(
+    const CharType * const s1, const CharType * const s2) noexcept
+{
+    if constexpr (isByteChar<CharType>)
+        return _detail::_strMismatchIgnoreCaseDispatch(
+            reinterpret_cast<const char*>(s1),
+            reinterpret_cast<const char*>(s2));
+    else
+        return _detail::_strMismatchIgnoreCaseScalar(s1,s2);
+}
+
+/// \brief strMismatchIgnoreCase() using a specific SIMD level
+/// \param level SIMD level to use (limited to what the processor supports)
+template <typename CharType>
+[[nodiscard]] inline usize_t strMismatchIgnoreCase(
+    const CharType * const s1, const CharType * const s2,
+    const SimdLevel level) noexcept
+{
+    if constexpr (isByteChar<CharType>)
+        return _detail::_selectStrMismatchIgnoreCase(clampSimdLevel(level))(
+            reinterpret_cast<const char*>(s1),
+            reinterpret_cast<const char*>(s2));
+    else
+        return _detail::_strMismatchIgnoreCaseScalar(s1,s2);
+}
+
+/// \brief compare 2 null-terminated strings for equality ignoring ASCII case
+/// \param s1 first string (not null)
+/// \param s2 second string (not null)
+/// \return true if the strings are equal after lowering ASCII letters
+template <typename CharType>
+[[nodiscard]] inline bool strCmpEqIgnoreCase(
+    const CharType * const s1, const CharType * const s2) noexcept
+{
+    const usize_t i = strMismatchIgnoreCase(s1,s2);
+    return toLowerAscii(s1[i]) == toLowerAscii(s2[i]);
+}
+
+/// \brief compare 2 null-terminated strings (3 way) ignoring ASCII case
+/// \param s1 first string (not null)
+/// \param s2 second string (not null)
+/// \return ordering of the first mismatched characters after lowering ASCII
+/// letters (or equal)
+template <typename CharType>
+[[nodiscard]] inline auto strCmp3wayIgnoreCase(
+    const CharType * const s1, const CharType * const s2) noexcept
+{
+    const usize_t i = strMismatchIgnoreCase(s1,s2);
+    return toLowerAscii(s1[i]) <=> toLowerAscii(s2[i]);
+}
+
+/// \brief map ASCII letters to lower case
+/// \tparam CharType character type
+/// \param dst destination with space for n characters (may be equal to src
+/// but must not otherwise overlap it)
+/// \param src source with n characters
+/// \param n number of characters
+///
+/// Byte sized characters are mapped 16 to 64 at a time.
+template <typename CharType>
+inline void memToLowerCase(CharType * const dst, const CharType * const src,
+    const usize_t n) noexcept
+{
+    if constexpr (isByteChar<CharType>)
+        _detail::_memCaseDispatch<false>(reinterpret_cast<char*>(dst),
+            reinterpret_cast<const char*>(src),n);
+    else
+        _detail::_memCaseScalar<false>(dst,src,n);
+}
+
+/// \brief memToLowerCase() using a specific SIMD level
+/// \param level SIMD level to use (limited to what the processor supports)
+template <typename CharType>
+inline void memToLowerCase(CharType * const dst, const CharType * const src,
+    const usize_t n, const SimdLevel level) noexcept
+{
+    if constexpr (isByteChar<CharType>)
+        _detail::_selectMemCase<false>(clampSimdLevel(level))(
+            reinterpret_cast<char*>(dst),
+            reinterpret_cast<const char*>(src),n);
+    else
+        _detail::_memCaseScalar<false>(dst,src,n);
+}
+
+/// \brief map ASCII letters to upper case (see memToLowerCase())
+template <typename CharType>
+inline void memToUpperCase(CharType * const dst, const CharType * const src,
+    const usize_t n) noexcept
+{
+    if constexpr (isByteChar<CharType>)
+        _detail::_memCaseDispatch<true>(reinterpret_cast<char*>(dst),
+            reinterpret_cast<const char*>(src),n);
+    else
+        _detail::_memCaseScalar<true>(dst,src,n);
+}
+
+/// \brief memToUpperCase() using a specific SIMD level
+/// \param level SIMD level to use (limited to what the processor supports)
+template <typename CharType>
+inline void memToUpperCase(CharType * const dst, const CharType * const src,
+    const usize_t n, const SimdLevel level) noexcept
+{
+    if constexpr (isByteChar<CharType>)
+        _detail::_selectMemCase<true>(clampSimdLevel(level))(
+            reinterpret_cast<char*>(dst),
+            reinterpret_cast<const char*>(src),n);
+    else
+        _detail::_memCaseScalar<true>(dst,src,n);
+}
+
+/// \brief copy characters between non overlapping arrays
+/// \param dst destination with space for n characters
+/// \param src source with n characters
+/// \param n number of characters
+template <typename CharType>
+inline void copyChars(CharType * const dst, const CharType * const src,
+    const usize_t n) noexcept
+{
+    __builtin_memcpy(dst,src,n*sizeof(CharType));
+}
+
+/// \brief copy a null-terminated string (including the terminator)
+/// \param src source string (not null)
+/// \param dst destination with enough space (not null)
+/// \return length of the copied string
+template <typename CharType>
+inline usize_t strCopy(
+    const CharType * const src, CharType * const dst) noexcept
+{
+    const usize_t l = strLen(src);
+    copyChars(dst,src,l+1);
+    return l;
+}
+
+} // namespace tkoz::stl::simd
@@ -0,0 +1,306 @@
+///
+/// non owning view of characters with a known length
+///
+
+#pragma once
+
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/CStringSimd.hpp>
+#include <tkoz/stl/Exceptions.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <compare>
+
+namespace tkoz::stl
+{
+
+namespace concepts
+{
+
+/// \brief string type with ptr() and len() (such as CString, SmallCString,
+/// CStringBuilder, InternedCString)
+template <typename StringType, typename CharType>
+concept isStringLike = requires (const StringType &str)
+{
+    { str.ptr() } -> isSame<const CharType*>;
+    { str.len() } -> isSame<usize_t>;
+};
+
+} // namespace concepts
+
+/// \brief borrowed array of characters with a known length
+/// \tparam CharType character type
+///
+/// This stores a pointer and a length and does not own the characters, which
+/// must outlive the view. Since the length is known, comparisons check the
+/// lengths first and compare characters with bulk kernels instead of looking
+/// for null terminators, and substrings are views of the same characters
+/// without allocating. A view of a whole C string is followed by a null
+/// terminator, but a substring generally is not, so ptr() should only be used
+/// as a C string when that is known. The null view (nullptr, length 0)
+/// compares equal to the empty view.
+template <typename _CharType = char>
+class CStringView
+{
+public:
+
+    /// character type
+    using CharType = _CharType;
+
+    /// index value meaning not found or until the end
+    static constexpr usize_t npos = static_cast<usize_t>(-1);
+
+private:
+
+    /// empty string for copying the null view
+    static constexpr CharType _cEmpty = static_cast<CharType>(0);
+
+    /// first character (may be nullptr if the length is 0)
+    const CharType *_ptr;
+
+    /// number of characters
+    usize_t _len;
+
+public:
+
+    /// \brief initialize as the null view
+    [[nodiscard]] inline constexpr CStringView() noexcept
+        : _ptr(nullptr), _len(0) {}
+
+    /// \brief view a null-terminated C string
+    /// \param ptr the string (or nullptr for the null view)
+    [[nodiscard]] inline CStringView(const CharType * const ptr) noexcept
+        : _ptr(ptr), _len(ptr ? simd::strLen(ptr) : 0) {}
+
+    /// \brief view characters with a known length
+    /// \param ptr pointer to len characters
+    /// \param len number of characters
+    [[nodiscard]] inline constexpr CStringView(
+        const CharType * const ptr, const usize_t len) noexcept
+        : _ptr(ptr), _len(len) {}
+
+    /// \brief view a string object (CString, SmallCString, ...)
+    /// \param str the string (which must outlive the view)
+    ///
+    /// This is linear time for CString (which does not store its length) and
+    /// constant time for string types storing the length.
+    template <concepts::isStringLike<CharType> StringType>
+    [[nodiscard]] inline CStringView(const StringType &str) noexcept
+        : _ptr(str.ptr()), _len(str.len()) {}
+
+    /// \brief pointer to the first character
+    [[nodiscard]] inline constexpr const CharType* ptr() const noexcept
+    {
+        return _ptr;
+    }
+
+    /// \brief pointer to the first character
+    [[nodiscard]] inline constexpr const CharType* data() const noexcept
+    {
+        return _ptr;
+    }
+
+    /// \brief number of characters (constant time)
+    [[nodiscard]] inline constexpr usize_t len() const noexcept
+    {
+        return _len;
+    }
+
+    /// \brief number of characters (constant time)
+    [[nodiscard]] inline constexpr usize_t size() const noexcept
+    {
+        return _len;
+    }
+
+    /// \brief is the length 0
+    [[nodiscard]] inline constexpr bool empty() const noexcept
+    {
+        return !_len;
+    }
+
+    /// \brief is this the null view
+    [[nodiscard]] inline constexpr bool isNull() const noexcept
+    {
+        return !_ptr;
+    }
+
+    /// \brief true if non empty
+    [[nodiscard]] inline constexpr explicit operator bool() const noexcept
+    {
+        return _len;
+    }
+
+    /// \brief iterator to the first character
+    [[nodiscard]] inline constexpr const CharType* begin() const noexcept
+    {
+        return _ptr;
+    }
+
+    /// \brief iterator past the last character
+    [[nodiscard]] inline constexpr const CharType* end() const noexcept
+    {
+        return _ptr + _len;
+    }
+
+    /// \brief access a character
+    /// \param i the index (valid range is [0,len()), undefined otherwise)
+    [[nodiscard]] inline constexpr const CharType& operator[](
+        const usize_t i) const noexcept
+    {
+        return _ptr[i];
+    }
+
+    /// \brief access a character with bounds checking
+    /// \param i the index
+    /// \throw IndexError if i is not less than len()
+    [[nodiscard]] inline const CharType& at(const usize_t i) const
+    {
+        if (i >= _len)
+            throw IndexError("index too large");
+        return _ptr[i];
+    }
+
+    /// \brief view of a range of characters (does not allocate)
+    /// \param pos first index
+    /// \param count maximum number of characters (limited to the end)
+    /// \return the substring
+    /// \throw IndexError if pos is greater than len()
+    [[nodiscard]] inline CStringView substr(
+        const usize_t pos, const usize_t count = npos) const
+    {
+        if (pos > _len)
+            throw IndexError("substring start out of range");
+        const usize_t rest = _len - pos;
+        return CStringView(_ptr + pos,count < rest ? count : rest);
+    }
+
+    /// \brief first n characters (or all if there are fewer)
+    [[nodiscard]] inline constexpr CStringView prefix(
+        const usize_t n) const noexcept
+    {
+        return CStringView(_ptr,n < _len ? n : _len);
+    }
+
+    /// \brief last n characters (or all if there are fewer)
+    [[nodiscard]] inline constexpr CStringView suffix(
+        const usize_t n) const noexcept
+    {
+        return n < _len ? CStringView(_ptr + _len - n,n) : *this;
+    }
+
+    /// \brief remove characters from the beginning
+    /// \param n number of characters (at most len())
+    inline constexpr void removePrefix(const usize_t n) noexcept
+    {
+        _ptr += n;
+        _len -= n;
+    }
+
+    /// \brief remove characters from the end
+    /// \param n number of characters (at most len())
+    inline constexpr void removeSuffix(const usize_t n) noexcept
+    {
+        _len -= n;
+    }
+
+    /// \brief does the view begin with another
+    [[nodiscard]] inline bool startsWith(const CStringView other) const noexcept
+    {
+        return prefix(other._len) == other;
+    }
+
+    /// \brief does the view end with another
+    [[nodiscard]] inline bool endsWith(const CStringView other) const noexcept
+    {
+        return suffix(other._len) == other;
+    }
+
+    /// \brief index of the first occurrence of a character
+    /// \param c character to find
+    /// \param pos index to start searching at
+    /// \return index of c or npos if not found
+    [[nodiscard]] inline usize_t find(
+        const CharType c, const usize_t pos = 0) const noexcept
+    {
+        if (pos >= _len)
+            return npos;
+        if constexpr (simd::isByteChar<CharType>)
+        {
+            const void *p = __builtin_memchr(_ptr + pos,
+                static_cast<uchar_t>(c),_len - pos);
+            return p ? static_cast<usize_t>(
+                static_cast<const CharType*>(p) - _ptr) : npos;
+        }
+        else
+        {
+            for (usize_t i = pos; i < _len; ++i)
+                if (_ptr[i] == c)
+                    return i;
+            return npos;
+        }
+    }
+
+    /// \brief index of the last occurrence of a character
+    /// \param c character to find
+    /// \return index of c or npos if not found
+    [[nodiscard]] inline usize_t rfind(const CharType c) const noexcept
+    {
+        for (usize_t i = _len; i > 0; --i)
+            if (_ptr[i-1] == c)
+                return i - 1;
+        return npos;
+    }
+
+    /// \brief index of the first occurrence of a substring
+    /// \param needle string to find
+    /// \param pos index to start searching at
+    /// \return index of needle or npos if not found (pos if needle is empty
+    /// and pos is at most len())
+    ///
+    /// Uses simd::memFind(). For many patterns, see AhoCorasick.
+    [[nodiscard]] inline usize_t find(
+        const CStringView needle, const usize_t pos = 0) const noexcept
+    {
+        if (pos > _len)
+            return npos;
+        const usize_t i = simd::memFind(_ptr + pos,_len - pos,
+            needle._ptr,needle._len);
+        return i == npos ? i : pos + i;
+    }
+
+    /// \brief does the view contain a substring
+    [[nodiscard]] inline bool contains(const CStringView needle) const noexcept
+    {
+        return find(needle) != npos;
+    }
+
+    /// \brief allocate a null-terminated copy
+    /// \tparam StringType CString type of the result
+    /// \return copy of the characters (null if this is the null view)
+    template <typename StringType = CString<CharType>>
+    [[nodiscard]] inline StringType toCString() const
+    {
+        if constexpr (StringType::allowNull)
+        {
+            if (!_ptr)
+                return StringType();
+        }
+        return StringType(_ptr ? _ptr : &_cEmpty,_len);
+    }
+
+    /// \brief compare equality (lengths first, then bulk compare)
+    [[nodiscard]] friend inline bool operator==(
+        const CStringView left, const CStringView right) noexcept
+    {
+        return simd::memCmpEq(left._ptr,left._len,right._ptr,right._len);
+    }
+
+    /// \brief compare 3 way (same order as CString)
+    [[nodiscard]] friend inline std::strong_ordering operator<=>(
+        const CStringView left, const CStringView right) noexcept
+    {
+        return simd::memCmp3way(left._ptr,left._len,right._ptr,right._len);
+    }
+};
+
+} // namespace tkoz::stl
@@ -0,0 +1,385 @@
+///
+/// number formatting and parsing without allocation (to_chars/from_chars)
+///
+
+#pragma once
+
+#include <tkoz/stl/Allocator.hpp>
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/CStringBuilder.hpp>
+#include <tkoz/stl/CStringView.hpp>
+#include <tkoz/stl/Concepts.hpp>
+#include <tkoz/stl/Exceptions.hpp>
+#include <tkoz/stl/ExplicitPrimitives.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <charconv>
+#include <limits>
+#include <system_error>
+
+namespace tkoz::stl
+{
+
+namespace concepts
+{
+
+/// type can be formatted and parsed by toChars() and fromChars()
+/// (integer and floating point primitives, not bool)
+template <typename T>
+concept isCharConvNumber = isPrimitiveNumber<T>;
+
+} // namespace concepts
+
+/// \brief maximum number of characters written by toChars()
+/// \tparam NumberType integer or floating point type
+///
+/// Integers need the digits and a sign. Shortest floating point values are
+/// at most as long as the scientific form of max_digits10 digits with a
+/// sign, a decimal point and an exponent of up to 4 digits.
+template <concepts::isCharConvNumber NumberType>
+inline constexpr usize_t cMaxNumberChars =
+    concepts::isPrimitiveInteger<NumberType>
+    ? std::numeric_limits<NumberType>::digits10 + 2
+    : std::numeric_limits<NumberType>::max_digits10 + 8;
+
+/// status of fromChars()
+enum ParseStatus
+{
+    /// a number was parsed
+    cParseOk,
+    /// the input does not start with a number
+    cParseInvalid,
+    /// the number does not fit in the type
+    cParseOutOfRange
+};
+
+/// \brief result of fromChars()
+struct ParseResult
+{
+    /// end of the parsed number (first if the status is cParseInvalid)
+    const char *ptr;
+
+    /// whether a number was parsed
+    ParseStatus status;
+
+    /// \brief true if a number was parsed
+    [[nodiscard]] inline explicit operator bool() const noexcept
+    {
+        return status == cParseOk;
+    }
+};
+
+namespace _detail
+{
+
+/// 2 digits for each value 0-99
+inline constexpr char _cDigitPairs[201] =
+    "000102030405060708091011121314151617181920212223242526272829303132"
+    "333435363738394041424344454647484950515253545556575859606162636465"
+    "666768697071727374757677787980818283848586878889909192939495969798"
+    "99";
+
+/// powers of 10 that fit in 64 bits
+inline constexpr uint64_t _cPow10[20] =
+{
+    1ull,10ull,100ull,1000ull,10000ull,100000ull,1000000ull,10000000ull,
+    100000000ull,1000000000ull,10000000000ull,100000000000ull,
+    1000000000000ull,10000000000000ull,100000000000000ull,
+    1000000000000000ull,10000000000000000ull,100000000000000000ull,
+    1000000000000000000ull,10000000000000000000ull
+};
+
+/// number of decimal digits (at least 1)
+[[nodiscard]] inline constexpr usize_t _decimalLen(const uint64_t v) noexcept
+{
+    // floor(log10(2^bits)) from the bit width (1233/4096 is about log10(2)),
+    // then correct for values below the power of 10
+    const uint64_t w = v | 1;
+    const usize_t t = static_cast<usize_t>(64 - __builtin_clzll(w)) * 1233
+        >> 12;
+    return t + 1 - (w < _cPow10[t]);
+}
+
+/// write the digits of v ending just before end (2 digits per division)
+template <typename UIntType>
+inline void _writeDigits(char *end, UIntType v) noexcept
+{
+    while (v >= 100)
+    {
+        const UIntType q = v / 100;
+        const usize_t r = static_cast<usize_t>(v - q * 100) * 2;
+        end -= 2;
+        end[0] = _cDigitPairs[r];
+        end[1] = _cDigitPairs[r+1];
+        v = q;
+    }
+    if (v >= 10)
+    {
+        end -= 2;
+        end[0] = _cDigitPairs[v*2];
+        end[1] = _cDigitPairs[v*2+1];
+    }
+    else
+        end[-1] = static_cast<char>('0' + v);
+}
+
+template <typename IntType>
+[[nodiscard]] inline char* _intToChars(char *dst, const IntType value)
+    noexcept
+{
+    using UIntType = meta::Conditional<(sizeof(IntType) <= 4),
+        uint32_t,uint64_t>;
+    UIntType u = static_cast<UIntType>(value);
+    if constexpr (concepts::isPrimitiveSignedInteger<IntType>)
+    {
+        if (value < 0)
+        {
+            *dst++ = '-';
+            // wraps to the magnitude (including the minimum value)
+            u = static_cast<UIntType>(0) - u;
+        }
+    }
+    const usize_t len = _decimalLen(u);
+    _writeDigits(dst + len,u);
+    return dst + len;
+}
+
+/// are the 8 bytes of v all decimal digits
+[[nodiscard]] inline constexpr bool _isEightDigits(const uint64_t v) noexcept
+{
+    return !(((v & 0xF0F0F0F0F0F0F0F0ull)
+        | (((v + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4))
+        ^ 0x3333333333333333ull);
+}
+
+/// value of 8 digits loaded little endian (first digit in the low byte)
+[[nodiscard]] inline constexpr uint64_t _parseEightDigits(uint64_t v) noexcept
+{
+    // combine adjacent digits, then pairs, then quadruples with multiplies
+    v -= 0x3030303030303030ull;
+    v = v * 10 + (v >> 8);
+    return (((v & 0x000000FF000000FFull) * (100 + (1000000ull << 32)))
+        + (((v >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32))))
+        >> 32;
+}
+
+template <typename IntType>
+[[nodiscard]] inline ParseResult _intFromChars(const char * const first,
+    const char * const last, IntType &value) noexcept
+{
+    const char *p = first;
+    bool negative = false;
+    if constexpr (concepts::isPrimitiveSignedInteger<IntType>)
+    {
+        if (p < last && *p == '-')
+        {
+            negative = true;
+            ++p;
+        }
+    }
+    const char * const digits = p;
+    uint64_t acc = 0;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // 8 digits per step for the first 16 digits (no overflow is possible)
+    while (last - p >= 8 && p - digits <= 8)
+    {
+        uint64_t chunk;
+        __builtin_memcpy(&chunk,p,8);
+        if (!_isEightDigits(chunk))
+            break;
+        acc = acc * 100000000ull + _parseEightDigits(chunk);
+        p += 8;
+    }
+#endif
+    bool overflow = false;
+    for (; p < last; ++p)
+    {
+        const uint_t d = static_cast<uint_t>(static_cast<uchar_t>(*p) - '0');
+        if (d > 9)
+            break;
+        overflow |= __builtin_mul_overflow(acc,10ull,&acc);
+        overflow |= __builtin_add_overflow(acc,d,&acc);
+    }
+    if (p == digits)
+        return {first,cParseInvalid};
+    using Limits = std::numeric_limits<IntType>;
+    const uint64_t maxValue = static_cast<uint64_t>(Limits::max())
+        + static_cast<uint64_t>(negative);
+    if (overflow || acc > maxValue)
+        return {p,cParseOutOfRange};
+    value = negative ? static_cast<IntType>(0ull - acc)
+        : static_cast<IntType>(acc);
+    return {p,cParseOk};
+}
+
+/// primitive value of a number or ExplicitPrimitive
+template <concepts::isCharConvNumber NumberType>
+[[nodiscard]] inline constexpr NumberType _numberValue(const NumberType value)
+    noexcept
+{
+    return value;
+}
+
+template <concepts::isCharConvNumber NumberType>
+[[nodiscard]] inline constexpr NumberType _numberValue(
+    const wrapper::ExplicitPrimitive<NumberType> value) noexcept
+{
+    return value.value();
+}
+
+} // namespace _detail
+
+/// \brief format a number in decimal
+/// \tparam NumberType integer or floating point type
+/// \param dst output with space for cMaxNumberChars<NumberType> characters
+/// \param value number to format
+/// \return end of the written characters (no null terminator is written)
+///
+/// Integers are written 2 digits at a time from a table of digit pairs after
+/// counting the digits. Floating point values use the shortest form that
+/// parses back to the same value (std::to_chars, which implements Ryu).
+template <concepts::isCharConvNumber NumberType>
+inline char* toChars(char * const dst, const NumberType value) noexcept
+{
+    if constexpr (concepts::isPrimitiveInteger<NumberType>)
+        return _detail::_intToChars(dst,value);
+    else
+        return std::to_chars(dst,dst + cMaxNumberChars<NumberType>,value).ptr;
+}
+
+/// \brief format an ExplicitPrimitive number (see the primitive overload)
+template <concepts::isCharConvNumber NumberType>
+inline char* toChars(char * const dst,
+    const wrapper::ExplicitPrimitive<NumberType> value) noexcept
+{
+    return toChars(dst,value.value());
+}
+
+/// \brief parse a decimal number
+/// \tparam NumberType integer or floating point type
+/// \param first start of the characters
+/// \param last end of the characters
+/// \param value set to the parsed number (unchanged unless status is
+/// cParseOk)
+/// \return end of the number and status
+///
+/// The format is the same as std::from_chars: an optional minus sign (for
+/// signed and floating point types) followed by digits, with no leading
+/// whitespace or plus sign. Integers are parsed 8 digits at a time. Floating
+/// point values use std::from_chars (correctly rounded).
+template <concepts::isCharConvNumber NumberType>
+inline ParseResult fromChars(const char * const first,
+    const char * const last, NumberType &value) noexcept
+{
+    if constexpr (concepts::isPrimitiveInteger<NumberType>)
+        return _detail::_intFromChars(first,last,value);
+    else
+    {
+        NumberType v;
+        const std::from_chars_result r = std::from_chars(first,last,v);
+        if (r.ec == std::errc::invalid_argument)
+            return {first,cParseInvalid};
+        if (r.ec == std::errc::result_out_of_range)
+            return {r.ptr,cParseOutOfRange};
+        value = v;
+        return {r.ptr,cParseOk};
+    }
+}
+
+/// \brief parse an ExplicitPrimitive number (see the primitive overload)
+template <concepts::isCharConvNumber NumberType>
+inline ParseResult fromChars(const char * const first,
+    const char * const last, wrapper::ExplicitPrimitive<NumberType> &value)
+    noexcept
+{
+    NumberType v;
+    const ParseResult r = fromChars(first,last,v);
+    if (r)
+        value = wrapper::ExplicitPrimitive<NumberType>(v);
+    return r;
+}
+
+/// \brief parse a whole string as a number
+/// \tparam NumberType integer or floating point type (or ExplicitPrimitive)
+/// \param str the string
+/// \return the number
+/// \throw FormatError if str is not exactly one number
+/// \throw OverflowError if the number does not fit in NumberType
+template <typename NumberType>
+[[nodiscard]] inline NumberType parseNumber(const CStringView<char> str)
+{
+    NumberType value{};
+    const char * const end = str.ptr() + str.len();
+    const ParseResult r = fromChars(str.ptr(),end,value);
+    if (r.status == cParseOutOfRange)
+        throw OverflowError("number out of range");
+    if (r.status != cParseOk || r.ptr != end)
+        throw FormatError("invalid number");
+    return value;
+}
+
+/// \brief format a number as a new CString
+/// \tparam NumberType integer or floating point type (or ExplicitPrimitive)
+/// \param value number to format
+/// \param alloc allocator for the string
+/// \return the string
+///
+/// The string is allocated once with its exact length. Integers are written
+/// directly into it.
+template <typename NumberType, typename AllocType = NewAllocator<char>>
+[[nodiscard]] inline CString<char,true,AllocType> numberToCString(
+    const NumberType value, const AllocType &alloc = AllocType())
+{
+    using StringType = CString<char,true,AllocType>;
+    using ValueType = decltype(_detail::_numberValue(value));
+    const ValueType v = _detail::_numberValue(value);
+    if constexpr (concepts::isPrimitiveInteger<ValueType>)
+    {
+        using UIntType = meta::Conditional<(sizeof(ValueType) <= 4),
+            uint32_t,uint64_t>;
+        UIntType u = static_cast<UIntType>(v);
+        usize_t len = 0;
+        if constexpr (concepts::isPrimitiveSignedInteger<ValueType>)
+        {
+            if (v < 0)
+            {
+                u = static_cast<UIntType>(0) - u;
+                len = 1;
+            }
+        }
+        len += _detail::_decimalLen(u);
+        char * const ptr = alloc.allocate(len+1);
+        ptr[0] = '-'; // overwritten by the digits if not negative
+        _detail::_writeDigits(ptr + len,u);
+        ptr[len] = '\0';
+        return StringType::ptrWrap(ptr,alloc);
+    }
+    else
+    {
+        char buf[cMaxNumberChars<ValueType>];
+        const char * const end = toChars(buf,v);
+        return StringType(buf,static_cast<usize_t>(end - buf),alloc);
+    }
+}
+
+/// \brief append a formatted number to a CStringBuilder
+/// \tparam NumberType integer or floating point type (or ExplicitPrimitive)
+/// \param builder the builder
+/// \param value number to format
+/// \return reference to builder
+///
+/// The number is formatted on the stack, so nothing is allocated unless the
+/// builder needs to grow.
+template <typename NumberType, bool allowNull, typename AllocType>
+inline CStringBuilder<char,allowNull,AllocType>& appendNumber(
+    CStringBuilder<char,allowNull,AllocType> &builder,
+    const NumberType value)
+{
+    using ValueType = decltype(_detail::_numberValue(value));
+    const ValueType v = _detail::_numberValue(value);
+    char buf[cMaxNumberChars<ValueType>];
+    const char * const end = toChars(buf,v);
+    return builder.append(buf,static_cast<usize_t>(end - buf));
+}
+
+} // namespace tkoz::stl
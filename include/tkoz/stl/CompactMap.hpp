@@ -0,0 +1,549 @@
+///
+/// ordered map (AVL tree) with 6 byte links and pooled nodes
+///
+
+#pragma once
+
+#include <tkoz/stl/Allocator.hpp>
+#include <tkoz/stl/SixBytePointer.hpp>
+#include <tkoz/stl/Types.hpp>
+#include <tkoz/stl/Utils.hpp>
+
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace tkoz::stl
+{
+
+/// \brief key and value stored in a compact container
+/// \tparam Key key type
+/// \tparam Value mapped type
+///
+/// The key must not be modified while the entry is in a container.
+template <typename Key, typename Value>
+struct CompactEntry
+{
+    Key key;
+    Value value;
+};
+
+/// \brief ordered map for many small entries
+/// \tparam Key key type
+/// \tparam Value mapped type
+/// \tparam Compare strict weak ordering of keys
+///
+/// An AVL tree without parent links. The child links are SixBytePointer and
+/// the subtree height is stored in the bytes that 8 byte links would use, so
+/// the node overhead is 13 bytes (before padding) instead of the usual 32 for
+/// std::map, and there is no separate malloc header since nodes come from a
+/// Pool. For 8 byte keys and values a node is 32 bytes.
+///
+/// The pool is owned by the map unless one is given to share between maps,
+/// and is allocated when the first entry is inserted. An owned pool reserves
+/// a 64KB slab (Pool::cSlabSize) on the first insert, so many small maps
+/// should share one Pool. Entries do not move, so pointers returned by
+/// find() stay valid until the entry is erased. Lookup,
+/// insertion and erasure take O(log n) time. The height of an AVL tree is at
+/// most about 1.44 log2(n), which bounds the recursion depth.
+template <typename Key, typename Value, typename Compare = std::less<Key>>
+class CompactMap
+{
+public:
+
+    /// key type
+    using KeyType = Key;
+
+    /// mapped type
+    using ValueType = Value;
+
+    /// entry type
+    using EntryType = CompactEntry<Key,Value>;
+
+private:
+
+    /// tree node
+    struct _Node
+    {
+        EntryType entry;
+        SixBytePointer<_Node> left;
+        SixBytePointer<_Node> right;
+
+        /// height of this subtree (1 for a leaf)
+        uchar_t height;
+    };
+
+    static_assert(alignof(_Node) <= Pool::cAlign);
+
+public:
+
+    /// bytes per node (before rounding to a Pool size class)
+    static constexpr usize_t cNodeSize = sizeof(_Node);
+
+private:
+
+    /// pool for nodes (nullptr until needed if not shared)
+    Pool *_pool;
+
+    /// whether _pool was allocated by this map
+    bool _ownsPool;
+
+    /// root of the tree
+    _Node *_root;
+
+    /// number of entries
+    usize_t _size;
+
+    /// key comparison
+    [[no_unique_address]] Compare _less;
+
+    [[nodiscard]] static inline uchar_t _height(_Node * const t) noexcept
+    {
+        return t ? t->height : 0;
+    }
+
+    static inline void _update(_Node * const t) noexcept
+    {
+        const uchar_t l = _height(t->left);
+        const uchar_t r = _height(t->right);
+        t->height = static_cast<uchar_t>((l > r ? l : r) + 1);
+    }
+
+    [[nodiscard]] static inline _Node* _rotateLeft(_Node * const t) noexcept
+    {
+        _Node *r = t->right;
+        t->right = r->left;
+        r->left = t;
+        _update(t);
+        _update(r);
+        return r;
+    }
+
+    [[nodiscard]] static inline _Node* _rotateRight(_Node * const t) noexcept
+    {
+        _Node *l = t->left;
+        t->left = l->right;
+        l->right = t;
+        _update(t);
+        _update(l);
+        return l;
+    }
+
+    /// restore the AVL property at t after one child changed height by 1
+    [[nodiscard]] static inline _Node* _balance(_Node * const t) noexcept
+    {
+        _update(t);
+        const int diff = _height(t->left) - _height(t->right);
+        if (diff > 1)
+        {
+            _Node *l = t->left;
+            if (_height(l->left) < _height(l->right))
+                t->left = _rotateLeft(l);
+            return _rotateRight(t);
+        }
+        if (diff < -1)
+        {
+            _Node *r = t->right;
+            if (_height(r->right) < _height(r->left))
+                t->right = _rotateRight(r);
+            return _rotateLeft(t);
+        }
+        return t;
+    }
+
+    /// allocate and construct a leaf
+    template <typename ...Args>
+    [[nodiscard]] inline _Node* _newNode(const Key &key, Args&& ...args)
+    {
+        if (!_pool)
+        {
+            _pool = new Pool();
+            _ownsPool = true;
+        }
+        void *mem = _pool->allocate(sizeof(_Node));
+        try
+        {
+            return new (mem) _Node{EntryType{key,
+                Value(std::forward<Args>(args)...)},nullptr,nullptr,1};
+        }
+        catch (...)
+        {
+            _pool->deallocate(mem);
+            throw;
+        }
+    }
+
+    inline void _freeNode(_Node * const t) noexcept
+    {
+        t->~_Node();
+        _pool->deallocate(t);
+    }
+
+    /// free a subtree
+    inline void _freeTree(_Node * const t) noexcept
+    {
+        if (!t)
+            return;
+        _freeTree(t->left);
+        _freeTree(t->right);
+        _freeNode(t);
+    }
+
+    /// insert into a subtree
+    /// \param found set to the node with key
+    /// \param inserted set to true if a node was added
+    /// \return new root of the subtree
+    template <typename ...Args>
+    [[nodiscard]] inline _Node* _insert(_Node * const t, const Key &key,
+        _Node *&found, bool &inserted, Args&& ...args)
+    {
+        if (!t)
+        {
+            found = _newNode(key,std::forward<Args>(args)...);
+            inserted = true;
+            return found;
+        }
+        if (_less(key,t->entry.key))
+            t->left = _insert(t->left,key,found,inserted,
+                std::forward<Args>(args)...);
+        else if (_less(t->entry.key,key))
+            t->right = _insert(t->right,key,found,inserted,
+                std::forward<Args>(args)...);
+        else
+        {
+            found = t;
+            return t;
+        }
+        return inserted ? _balance(t) : t;
+    }
+
+    /// detach the smallest node of a nonempty subtree
+    /// \param min set to the detached node
+    /// \return new root of the subtree
+    [[nodiscard]] static inline _Node* _removeMin(_Node * const t,
+        _Node *&min) noexcept
+    {
+        if (!t->left)
+        {
+            min = t;
+            return t->right;
+        }
+        t->left = _removeMin(t->left,min);
+        return _balance(t);
+    }
+
+    /// erase from a subtree
+    /// \param erased set to true if a node was removed
+    /// \return new root of the subtree
+    [[nodiscard]] inline _Node* _erase(_Node * const t, const Key &key,
+        bool &erased)
+    {
+        if (!t)
+            return nullptr;
+        if (_less(key,t->entry.key))
+            t->left = _erase(t->left,key,erased);
+        else if (_less(t->entry.key,key))
+            t->right = _erase(t->right,key,erased);
+        else
+        {
+            erased = true;
+            _Node *l = t->left;
+            _Node *r = t->right;
+            _freeNode(t);
+            if (!r)
+                return l;
+            _Node *min;
+            r = _removeMin(r,min);
+            min->left = l;
+            min->right = r;
+            return _balance(min);
+        }
+        return erased ? _balance(t) : t;
+    }
+
+    /// node with key or nullptr
+    [[nodiscard]] inline _Node* _find(const Key &key) const
+    {
+        _Node *t = _root;
+        while (t)
+        {
+            if (_less(key,t->entry.key))
+                t = t->left;
+            else if (_less(t->entry.key,key))
+                t = t->right;
+            else
+                return t;
+        }
+        return nullptr;
+    }
+
+    /// first node not less than key or nullptr
+    [[nodiscard]] inline _Node* _lowerBound(const Key &key) const
+    {
+        _Node *t = _root;
+        _Node *ret = nullptr;
+        while (t)
+        {
+            if (_less(t->entry.key,key))
+                t = t->right;
+            else
+            {
+                ret = t;
+                t = t->left;
+            }
+        }
+        return ret;
+    }
+
+    /// node with the smallest key or nullptr
+    [[nodiscard]] inline _Node* _front() const noexcept
+    {
+        _Node *t = _root;
+        if (t)
+            while (t->left)
+                t = t->left;
+        return t;
+    }
+
+    /// node with the largest key or nullptr
+    [[nodiscard]] inline _Node* _back() const noexcept
+    {
+        _Node *t = _root;
+        if (t)
+            while (t->right)
+                t = t->right;
+        return t;
+    }
+
+    template <typename Func>
+    static inline void _forEach(_Node * const t, Func &func)
+    {
+        if (!t)
+            return;
+        _forEach(t->left,func);
+        func(t->entry);
+        _forEach(t->right,func);
+    }
+
+    /// free all nodes (skipping the walk if the pool goes away anyway)
+    inline void _clear() noexcept
+    {
+        if (_ownsPool && std::is_trivially_destructible_v<EntryType>)
+        {
+            delete _pool;
+            _pool = nullptr;
+            _ownsPool = false;
+        }
+        else
+            _freeTree(_root);
+        _root = nullptr;
+        _size = 0;
+    }
+
+public:
+
+    /// \brief initialize as an empty map with its own pool
+    /// \note the pool allocates a 64KB slab when the first entry is inserted
+    [[nodiscard]] inline CompactMap() noexcept
+        : _pool(nullptr), _ownsPool(false), _root(nullptr), _size(0) {}
+
+    /// \brief initialize as an empty map using a shared pool
+    /// \param pool pool for nodes (must outlive the map)
+    [[nodiscard]] inline explicit CompactMap(Pool &pool) noexcept
+        : _pool(&pool), _ownsPool(false), _root(nullptr), _size(0) {}
+
+    /// \brief destructor
+    inline ~CompactMap()
+    {
+        _clear();
+        if (_ownsPool)
+            delete _pool;
+    }
+
+    CompactMap(const CompactMap&) = delete;
+    CompactMap& operator=(const CompactMap&) = delete;
+
+    /// \brief move constructor
+    /// \param other another CompactMap (empty afterward)
+    [[nodiscard]] inline CompactMap(CompactMap &&other) noexcept
+        : _pool(other._pool), _ownsPool(other._ownsPool), _root(other._root),
+          _size(other._size), _less(other._less)
+    {
+        // an owned pool moves here, a shared pool stays with the other map
+        if (_ownsPool)
+            other._pool = nullptr;
+        other._ownsPool = false;
+        other._root = nullptr;
+        other._size = 0;
+    }
+
+    /// \brief move assignment
+    /// \param other another CompactMap
+    /// \return reference to *this
+    inline CompactMap& operator=(CompactMap &&other) noexcept
+    {
+        swap(_pool,other._pool);
+        swap(_ownsPool,other._ownsPool);
+        swap(_root,other._root);
+        swap(_size,other._size);
+        std::swap(_less,other._less);
+        return *this;
+    }
+
+    /// \brief number of entries
+    [[nodiscard]] inline usize_t size() const noexcept
+    {
+        return _size;
+    }
+
+    /// \brief is the map empty
+    [[nodiscard]] inline bool empty() const noexcept
+    {
+        return _size == 0;
+    }
+
+    /// \brief height of the tree (0 if empty)
+    [[nodiscard]] inline usize_t height() const noexcept
+    {
+        return _height(_root);
+    }
+
+    /// \brief pool for nodes (nullptr if none is allocated yet)
+    [[nodiscard]] inline Pool* pool() const noexcept
+    {
+        return _pool;
+    }
+
+    /// \brief find an entry
+    /// \param key the key
+    /// \return the entry or nullptr if the key is not in the map
+    [[nodiscard]] inline EntryType* find(const Key &key)
+    {
+        _Node *t = _find(key);
+        return t ? &t->entry : nullptr;
+    }
+
+    /// \brief find an entry
+    /// \param key the key
+    /// \return the entry or nullptr if the key is not in the map
+    [[nodiscard]] inline const EntryType* find(const Key &key) const
+    {
+        const _Node *t = _find(key);
+        return t ? &t->entry : nullptr;
+    }
+
+    /// \brief is a key in the map
+    [[nodiscard]] inline bool contains(const Key &key) const
+    {
+        return _find(key) != nullptr;
+    }
+
+    /// \brief first entry with a key not less than a given key
+    /// \param key the key
+    /// \return the entry or nullptr if all keys are less
+    [[nodiscard]] inline EntryType* lowerBound(const Key &key)
+    {
+        _Node *t = _lowerBound(key);
+        return t ? &t->entry : nullptr;
+    }
+
+    /// \brief first entry with a key not less than a given key
+    /// \param key the key
+    /// \return the entry or nullptr if all keys are less
+    [[nodiscard]] inline const EntryType* lowerBound(const Key &key) const
+    {
+        const _Node *t = _lowerBound(key);
+        return t ? &t->entry : nullptr;
+    }
+
+    /// \brief entry with the smallest key (nullptr if empty)
+    [[nodiscard]] inline EntryType* front() noexcept
+    {
+        _Node *t = _front();
+        return t ? &t->entry : nullptr;
+    }
+
+    /// \brief entry with the smallest key (nullptr if empty)
+    [[nodiscard]] inline const EntryType* front() const noexcept
+    {
+        const _Node *t = _front();
+        return t ? &t->entry : nullptr;
+    }
+
+    /// \brief entry with the largest key (nullptr if empty)
+    [[nodiscard]] inline EntryType* back() noexcept
+    {
+        _Node *t = _back();
+        return t ? &t->entry : nullptr;
+    }
+
+    /// \brief entry with the largest key (nullptr if empty)
+    [[nodiscard]] inline const EntryType* back() const noexcept
+    {
+        const _Node *t = _back();
+        return t ? &t->entry : nullptr;
+    }
+
+    /// \brief insert an entry if the key is not in the map
+    /// \param key the key
+    /// \param value the value
+    /// \return true if inserted, false if the key was already in the map
+    /// (the value is not changed)
+    inline bool insert(const Key &key, const Value &value)
+    {
+        _Node *found;
+        bool inserted = false;
+        _root = _insert(_root,key,found,inserted,value);
+        _size += inserted;
+        return inserted;
+    }
+
+    /// \brief access a value, inserting a value initialized one if needed
+    /// \param key the key
+    /// \return reference to the value
+    inline Value& operator[](const Key &key)
+    {
+        _Node *found;
+        bool inserted = false;
+        _root = _insert(_root,key,found,inserted);
+        _size += inserted;
+        return found->entry.value;
+    }
+
+    /// \brief remove an entry
+    /// \param key the key
+    /// \return true if an entry was removed
+    inline bool erase(const Key &key)
+    {
+        bool erased = false;
+        _root = _erase(_root,key,erased);
+        _size -= erased;
+        return erased;
+    }
+
+    /// \brief remove all entries
+    inline void clear() noexcept
+    {
+        _clear();
+    }
+
+    /// \brief call a function on every entry in key order
+    /// \param func callable taking EntryType&
+    template <typename Func>
+    inline void forEach(Func &&func)
+    {
+        _forEach(_root,func);
+    }
+
+    /// \brief call a function on every entry in key order
+    /// \param func callable taking const EntryType&
+    template <typename Func>
+    inline void forEach(Func &&func) const
+    {
+        auto constFunc = [&func](const EntryType &e) { func(e); };
+        _forEach(_root,constFunc);
+    }
+};
+
+} // namespace tkoz::stl
@@ -0,0 +1,473 @@
+///
+/// ordered map (skip list) with 6 byte links and pooled nodes
+///
+
+#pragma once
+
+#include <tkoz/stl/Allocator.hpp>
+#include <tkoz/stl/CompactMap.hpp>
+#include <tkoz/stl/SixBytePointer.hpp>
+#include <tkoz/stl/Types.hpp>
+#include <tkoz/stl/Utils.hpp>
+
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace tkoz::stl
+{
+
+/// \brief ordered map for many small entries as a skip list
+/// \tparam Key key type
+/// \tparam Value mapped type
+/// \tparam Compare strict weak ordering of keys
+///
+/// Each node has a random height (each level with probability 1/4, so 1.33
+/// links on average) and a SixBytePointer to the next node at every level.
+/// The height is stored next to the first link, in the bytes that an 8 byte
+/// link would use, and the other links follow the node. Nodes are allocated
+/// with their exact size from a Pool, so for 8 byte keys and values most
+/// nodes are 24 or 30 bytes (32 byte size class).
+///
+/// Compared to CompactMap, insertion and erasure do not rebalance and
+/// iteration in order follows the level 0 links, but lookups visit more
+/// nodes. The pool is owned by the list unless one is given to share between
+/// lists, and is allocated when the first entry is inserted. An owned pool
+/// reserves a 64KB slab (Pool::cSlabSize) for each node size class used, so
+/// many small lists should share one Pool. Entries do not move, so pointers
+/// returned by find() stay valid until the entry is erased.
+template <typename Key, typename Value, typename Compare = std::less<Key>>
+class CompactSkipList
+{
+public:
+
+    /// key type
+    using KeyType = Key;
+
+    /// mapped type
+    using ValueType = Value;
+
+    /// entry type
+    using EntryType = CompactEntry<Key,Value>;
+
+    /// largest node height (enough for 4^cMaxHeight entries)
+    static constexpr usize_t cMaxHeight = 24;
+
+private:
+
+    /// list node (links 1 and above follow in the same allocation)
+    struct _Node
+    {
+        EntryType entry;
+
+        /// number of links
+        ushort_t height;
+
+        /// link at level 0
+        SixBytePointer<_Node> next[1];
+    };
+
+    using _Link = SixBytePointer<_Node>;
+
+    static_assert(alignof(_Node) <= Pool::cAlign);
+
+    /// pool for nodes (nullptr until needed if not shared)
+    Pool *_pool;
+
+    /// whether _pool was allocated by this list
+    bool _ownsPool;
+
+    /// links from before the first node
+    _Link _head[cMaxHeight];
+
+    /// number of levels in use
+    usize_t _height;
+
+    /// number of entries
+    usize_t _size;
+
+    /// state for node heights
+    uint64_t _rng;
+
+    /// key comparison
+    [[no_unique_address]] Compare _less;
+
+    /// links of a node (level i is at index i)
+    [[nodiscard]] static inline _Link* _links(_Node * const node) noexcept
+    {
+        return node->next;
+    }
+
+    /// bytes for a node with some height
+    [[nodiscard]] static inline constexpr usize_t _nodeBytes(
+        const usize_t height) noexcept
+    {
+        return sizeof(_Node) + (height - 1) * sizeof(_Link);
+    }
+
+    [[nodiscard]] inline usize_t _randomHeight() noexcept
+    {
+        // xorshift64, then 2 bits per level
+        _rng ^= _rng << 13;
+        _rng ^= _rng >> 7;
+        _rng ^= _rng << 17;
+        const usize_t h = static_cast<usize_t>(
+            __builtin_ctzll(_rng | (1ull << 62))) / 2 + 1;
+        return h < cMaxHeight ? h : cMaxHeight;
+    }
+
+    /// allocate and construct a node (links are not initialized)
+    template <typename ...Args>
+    [[nodiscard]] inline _Node* _newNode(const usize_t height,
+        const Key &key, Args&& ...args)
+    {
+        if (!_pool)
+        {
+            _pool = new Pool();
+            _ownsPool = true;
+        }
+        void *mem = _pool->allocate(_nodeBytes(height));
+        try
+        {
+            _Node *node = new (mem) _Node{EntryType{key,
+                Value(std::forward<Args>(args)...)},
+                static_cast<ushort_t>(height),{}};
+            for (usize_t i = 1; i < height; ++i)
+                new (_links(node) + i) _Link();
+            return node;
+        }
+        catch (...)
+        {
+            _pool->deallocate(mem);
+            throw;
+        }
+    }
+
+    inline void _freeNode(_Node * const node) noexcept
+    {
+        node->~_Node();
+        _pool->deallocate(node);
+    }
+
+    /// find the last link before key at each level
+    /// \param prev set to the link arrays (node links or _head) for levels
+    /// below _height
+    /// \return first node not less than key or nullptr
+    [[nodiscard]] inline _Node* _findPrev(const Key &key, _Link **prev)
+    {
+        _Link *links = _head;
+        _Node *next = nullptr;
+        for (usize_t i = _height; i--;)
+        {
+            while ((next = links[i]) && _less(next->entry.key,key))
+                links = _links(next);
+            prev[i] = links;
+        }
+        return next;
+    }
+
+    /// first node not less than key or nullptr
+    [[nodiscard]] inline _Node* _lowerBound(const Key &key) const
+    {
+        const _Link *links = _head;
+        _Node *next = nullptr;
+        for (usize_t i = _height; i--;)
+            while ((next = links[i]) && _less(next->entry.key,key))
+                links = _links(next);
+        return next;
+    }
+
+    /// node with the largest key or nullptr
+    [[nodiscard]] inline _Node* _back() const noexcept
+    {
+        const _Link *links = _head;
+        _Node *last = nullptr;
+        for (usize_t i = _height; i--;)
+            while (_Node *next = links[i])
+            {
+                last = next;
+                links = _links(next);
+            }
+        return last;
+    }
+
+    /// node with key or nullptr
+    [[nodiscard]] inline _Node* _find(const Key &key) const
+    {
+        _Node *node = _lowerBound(key);
+        return node && !_less(key,node->entry.key) ? node : nullptr;
+    }
+
+    /// insert if the key is not in the list
+    /// \param inserted set to true if a node was added
+    /// \return the node with key
+    template <typename ...Args>
+    [[nodiscard]] inline _Node* _insert(const Key &key, bool &inserted,
+        Args&& ...args)
+    {
+        _Link *prev[cMaxHeight];
+        _Node *node = _findPrev(key,prev);
+        if (node && !_less(key,node->entry.key))
+            return node;
+        const usize_t height = _randomHeight();
+        node = _newNode(height,key,std::forward<Args>(args)...);
+        for (; _height < height; ++_height)
+            prev[_height] = _head;
+        _Link *links = _links(node);
+        for (usize_t i = 0; i < height; ++i)
+        {
+            links[i] = prev[i][i];
+            prev[i][i] = node;
+        }
+        ++_size;
+        inserted = true;
+        return node;
+    }
+
+    /// free all nodes (skipping the walk if the pool goes away anyway)
+    inline void _clear() noexcept
+    {
+        if (_ownsPool && std::is_trivially_destructible_v<EntryType>)
+        {
+            delete _pool;
+            _pool = nullptr;
+            _ownsPool = false;
+        }
+        else
+        {
+            _Node *node = _head[0];
+            while (node)
+            {
+                _Node *next = _links(node)[0];
+                _freeNode(node);
+                node = next;
+            }
+        }
+        for (_Link &link : _head)
+            link = nullptr;
+        _height = 0;
+        _size = 0;
+    }
+
+public:
+
+    /// \brief initialize as an empty list with its own pool
+    /// \note the pool allocates a 64KB slab when the first entry is inserted
+    [[nodiscard]] inline CompactSkipList() noexcept
+        : _pool(nullptr), _ownsPool(false), _head{}, _height(0), _size(0),
+          _rng(0x9E3779B97F4A7C15ull) {}
+
+    /// \brief initialize as an empty list using a shared pool
+    /// \param pool pool for nodes (must outlive the list)
+    [[nodiscard]] inline explicit CompactSkipList(Pool &pool) noexcept
+        : _pool(&pool), _ownsPool(false), _head{}, _height(0), _size(0),
+          _rng(0x9E3779B97F4A7C15ull ^ reinterpret_cast<uintptr_t>(this)) {}
+
+    /// \brief destructor
+    inline ~CompactSkipList()
+    {
+        _clear();
+        if (_ownsPool)
+            delete _pool;
+    }
+
+    CompactSkipList(const CompactSkipList&) = delete;
+    CompactSkipList& operator=(const CompactSkipList&) = delete;
+
+    /// \brief move constructor
+    /// \param other another CompactSkipList (empty afterward)
+    [[nodiscard]] inline CompactSkipList(CompactSkipList &&other) noexcept
+        : _pool(other._pool), _ownsPool(other._ownsPool),
+          _height(other._height), _size(other._size), _rng(other._rng),
+          _less(other._less)
+    {
+        // an owned pool moves here, a shared pool stays with the other list
+        for (usize_t i = 0; i < cMaxHeight; ++i)
+        {
+            _head[i] = other._head[i];
+            other._head[i] = nullptr;
+        }
+        if (_ownsPool)
+            other._pool = nullptr;
+        other._ownsPool = false;
+        other._height = 0;
+        other._size = 0;
+    }
+
+    /// \brief move assignment
+    /// \param other another CompactSkipList
+    /// \return reference to *this
+    inline CompactSkipList& operator=(CompactSkipList &&other) noexcept
+    {
+        swap(_pool,other._pool);
+        swap(_ownsPool,other._ownsPool);
+        for (usize_t i = 0; i < cMaxHeight; ++i)
+            swap(_head[i],other._head[i]);
+        swap(_height,other._height);
+        swap(_size,other._size);
+        swap(_rng,other._rng);
+        std::swap(_less,other._less);
+        return *this;
+    }
+
+    /// \brief number of entries
+    [[nodiscard]] inline usize_t size() const noexcept
+    {
+        return _size;
+    }
+
+    /// \brief is the list empty
+    [[nodiscard]] inline bool empty() const noexcept
+    {
+        return _size == 0;
+    }
+
+    /// \brief number of levels in use
+    [[nodiscard]] inline usize_t height() const noexcept
+    {
+        return _height;
+    }
+
+    /// \brief pool for nodes (nullptr if none is allocated yet)
+    [[nodiscard]] inline Pool* pool() const noexcept
+    {
+        return _pool;
+    }
+
+    /// \brief find an entry
+    /// \param key the key
+    /// \return the entry or nullptr if the key is not in the list
+    [[nodiscard]] inline EntryType* find(const Key &key)
+    {
+        _Node *node = _find(key);
+        return node ? &node->entry : nullptr;
+    }
+
+    /// \brief find an entry
+    /// \param key the key
+    /// \return the entry or nullptr if the key is not in the list
+    [[nodiscard]] inline const EntryType* find(const Key &key) const
+    {
+        const _Node *node = _find(key);
+        return node ? &node->entry : nullptr;
+    }
+
+    /// \brief is a key in the list
+    [[nodiscard]] inline bool contains(const Key &key) const
+    {
+        return _find(key) != nullptr;
+    }
+
+    /// \brief first entry with a key not less than a given key
+    /// \param key the key
+    /// \return the entry or nullptr if all keys are less
+    [[nodiscard]] inline EntryType* lowerBound(const Key &key)
+    {
+        _Node *node = _lowerBound(key);
+        return node ? &node->entry : nullptr;
+    }
+
+    /// \brief first entry with a key not less than a given key
+    /// \param key the key
+    /// \return the entry or nullptr if all keys are less
+    [[nodiscard]] inline const EntryType* lowerBound(const Key &key) const
+    {
+        const _Node *node = _lowerBound(key);
+        return node ? &node->entry : nullptr;
+    }
+
+    /// \brief entry with the smallest key (nullptr if empty)
+    [[nodiscard]] inline EntryType* front() noexcept
+    {
+        _Node *node = _head[0];
+        return node ? &node->entry : nullptr;
+    }
+
+    /// \brief entry with the smallest key (nullptr if empty)
+    [[nodiscard]] inline const EntryType* front() const noexcept
+    {
+        _Node *node = _head[0];
+        return node ? &node->entry : nullptr;
+    }
+
+    /// \brief entry with the largest key (nullptr if empty)
+    [[nodiscard]] inline EntryType* back() noexcept
+    {
+        _Node *node = _back();
+        return node ? &node->entry : nullptr;
+    }
+
+    /// \brief entry with the largest key (nullptr if empty)
+    [[nodiscard]] inline const EntryType* back() const noexcept
+    {
+        const _Node *node = _back();
+        return node ? &node->entry : nullptr;
+    }
+
+    /// \brief insert an entry if the key is not in the list
+    /// \param key the key
+    /// \param value the value
+    /// \return true if inserted, false if the key was already in the list
+    /// (the value is not changed)
+    inline bool insert(const Key &key, const Value &value)
+    {
+        bool inserted = false;
+        (void)_insert(key,inserted,value);
+        return inserted;
+    }
+
+    /// \brief access a value, inserting a value initialized one if needed
+    /// \param key the key
+    /// \return reference to the value
+    inline Value& operator[](const Key &key)
+    {
+        bool inserted = false;
+        return _insert(key,inserted)->entry.value;
+    }
+
+    /// \brief remove an entry
+    /// \param key the key
+    /// \return true if an entry was removed
+    inline bool erase(const Key &key)
+    {
+        _Link *prev[cMaxHeight];
+        _Node *node = _findPrev(key,prev);
+        if (!node || _less(key,node->entry.key))
+            return false;
+        _Link *links = _links(node);
+        for (usize_t i = 0; i < node->height; ++i)
+            prev[i][i] = links[i];
+        while (_height && !_head[_height-1])
+            --_height;
+        _freeNode(node);
+        --_size;
+        return true;
+    }
+
+    /// \brief remove all entries
+    inline void clear() noexcept
+    {
+        _clear();
+    }
+
+    /// \brief call a function on every entry in key order
+    /// \param func callable taking EntryType&
+    template <typename Func>
+    inline void forEach(Func &&func)
+    {
+        for (_Node *node = _head[0]; node; node = _links(node)[0])
+            func(node->entry);
+    }
+
+    /// \brief call a function on every entry in key order
+    /// \param func callable taking const EntryType&
+    template <typename Func>
+    inline void forEach(Func &&func) const
+    {
+        for (_Node *node = _head[0]; node; node = _links(node)[0])
+            func(std::as_const(node->entry));
+    }
+};
+
+} // namespace tkoz::stl
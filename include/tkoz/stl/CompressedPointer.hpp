@@ -0,0 +1,402 @@
+///
+/// pointers stored as 32, 40, or 48 bit offsets from a base address
+///
+
+#pragma once
+
+#include <tkoz/stl/Concepts.hpp>
+#include <tkoz/stl/Meta.hpp>
+#include <tkoz/stl/Types.hpp>
+#include <tkoz/stl/Utils.hpp>
+
+#include <cstddef>
+#include <new>
+
+#include <sys/mman.h>
+
+namespace tkoz::stl
+{
+
+/// \brief bump allocator within one reserved range of addresses
+///
+/// The constructor reserves a contiguous range of virtual addresses and every
+/// allocation comes from that range, so all pointers from this arena are
+/// within capacity() bytes of base(). This is the guarantee CompressedPointer
+/// needs: with a capacity of at most 2^32 bytes, every object fits a 4 byte
+/// offset. Physical memory is only used for pages that are touched, so a
+/// large range can be reserved up front.
+///
+/// The first bytes of the range are never handed out, so an offset of 0 never
+/// refers to an allocation. Like Arena, individual allocations are not freed,
+/// and reset() frees everything together. This class is not thread safe.
+class RegionArena
+{
+private:
+
+    /// start of the reserved range
+    uchar_t *_base;
+
+    /// size of the reserved range
+    usize_t _size;
+
+    /// offset of the next free byte
+    usize_t _cur;
+
+    /// bytes handed out by allocate()
+    usize_t _used;
+
+public:
+
+    /// bytes at the start of the range that are never allocated
+    static constexpr usize_t cReservedStart = alignof(std::max_align_t);
+
+    /// \brief reserve a range of addresses
+    /// \param bytes size of the range (rounded up to whole pages by the OS)
+    /// \throw std::bad_alloc if the range cannot be reserved
+    [[nodiscard]] inline explicit RegionArena(const usize_t bytes)
+        : _size(bytes), _cur(cReservedStart), _used(0)
+    {
+        void *p = ::mmap(nullptr,bytes,PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,-1,0);
+        if (p == MAP_FAILED)
+            throw std::bad_alloc();
+        _base = static_cast<uchar_t*>(p);
+    }
+
+    /// \brief release the range
+    inline ~RegionArena()
+    {
+        if (_base)
+            ::munmap(_base,_size);
+    }
+
+    RegionArena(const RegionArena&) = delete;
+    RegionArena& operator=(const RegionArena&) = delete;
+
+    /// \brief move constructor
+    /// \param other another RegionArena (without a range afterward)
+    [[nodiscard]] inline RegionArena(RegionArena &&other) noexcept
+        : _base(other._base), _size(other._size), _cur(other._cur),
+          _used(other._used)
+    {
+        other._base = nullptr;
+        other._size = other._cur = other._used = 0;
+    }
+
+    /// \brief move assignment
+    /// \param other another RegionArena
+    /// \return reference to *this
+    inline RegionArena& operator=(RegionArena &&other) noexcept
+    {
+        swap(_base,other._base);
+        swap(_size,other._size);
+        swap(_cur,other._cur);
+        swap(_used,other._used);
+        return *this;
+    }
+
+    /// \brief allocate memory
+    /// \param bytes number of bytes
+    /// \param align alignment (power of 2)
+    /// \return pointer to the memory (valid until reset or destruction)
+    /// \throw std::bad_alloc if the range is full
+    [[nodiscard]] inline void* allocate(const usize_t bytes,
+        const usize_t align = alignof(std::max_align_t))
+    {
+        const usize_t p = (_cur + align - 1) & ~(align - 1);
+        if (p > _size || bytes > _size - p) [[unlikely]]
+            throw std::bad_alloc();
+        _cur = p + bytes;
+        _used += bytes;
+        return _base + p;
+    }
+
+    /// \brief free all allocations
+    ///
+    /// The addresses stay reserved and the physical pages are returned to
+    /// the OS (they read as zero when touched again).
+    inline void reset() noexcept
+    {
+        if (_base && _cur > cReservedStart)
+            ::madvise(_base,_cur,MADV_DONTNEED);
+        _cur = cReservedStart;
+        _used = 0;
+    }
+
+    /// \brief start of the reserved range
+    [[nodiscard]] inline uchar_t* base() const noexcept
+    {
+        return _base;
+    }
+
+    /// \brief size of the reserved range in bytes
+    [[nodiscard]] inline usize_t capacity() const noexcept
+    {
+        return _size;
+    }
+
+    /// \brief total bytes handed out since the last reset
+    [[nodiscard]] inline usize_t bytesUsed() const noexcept
+    {
+        return _used;
+    }
+
+    /// \brief is an address within the reserved range
+    [[nodiscard]] inline bool contains(const void * const ptr) const noexcept
+    {
+        const uchar_t *p = static_cast<const uchar_t*>(ptr);
+        return _base && p >= _base && p < _base + _size;
+    }
+};
+
+/// \brief allocator handle for a RegionArena
+/// \tparam Type type of array elements (should be trivially destructible)
+///
+/// deallocate() does nothing, memory is freed when the arena is reset or
+/// destroyed. The arena must outlive everything allocated from it.
+template <typename Type>
+class RegionAllocator
+{
+private:
+
+    template <typename>
+    friend class RegionAllocator;
+
+    /// arena providing memory
+    RegionArena *_arena;
+
+public:
+
+    /// \brief allocate from an arena
+    /// \param arena the arena
+    [[nodiscard]] inline RegionAllocator(RegionArena &arena) noexcept
+        : _arena(&arena) {}
+
+    /// \brief rebind from another element type
+    template <typename OtherType>
+    [[nodiscard]] inline explicit RegionAllocator(
+        const RegionAllocator<OtherType> &other) noexcept
+        : _arena(other._arena) {}
+
+    /// \brief allocate an array (elements are not constructed)
+    /// \param n number of elements
+    /// \return pointer to the array
+    [[nodiscard]] inline Type* allocate(const usize_t n) const
+    {
+        return static_cast<Type*>(
+            _arena->allocate(n * sizeof(Type),alignof(Type)));
+    }
+
+    /// \brief does nothing (memory is freed with the arena)
+    inline void deallocate(Type * const) const noexcept {}
+
+    /// \brief the arena used for allocation
+    [[nodiscard]] inline RegionArena& arena() const noexcept
+    {
+        return *_arena;
+    }
+
+    /// \brief allocators are equal if they use the same arena
+    [[nodiscard]] friend inline bool operator==(
+        const RegionAllocator &left, const RegionAllocator &right) noexcept
+    {
+        return left._arena == right._arena;
+    }
+};
+
+/// \brief base address for a family of CompressedPointers
+/// \tparam Tag any type, to have independent bases for different families
+///
+/// All CompressedPointers with the same Tag decode relative to this address.
+/// It should be set once, before any pointer is created, usually to the base
+/// of a RegionArena. Changing it invalidates all existing pointers.
+template <typename Tag = void>
+class CompressedBase
+{
+private:
+
+    /// the base address
+    static inline uchar_t *sBase = nullptr;
+
+public:
+
+    /// \brief set the base address
+    /// \param base address that offsets are relative to
+    static inline void set(const void * const base) noexcept
+    {
+        sBase = static_cast<uchar_t*>(const_cast<void*>(base));
+    }
+
+    /// \brief set the base address to the start of a RegionArena
+    /// \param arena the arena (pointers must be to its allocations)
+    static inline void set(const RegionArena &arena) noexcept
+    {
+        sBase = arena.base();
+    }
+
+    /// \brief the base address
+    [[nodiscard]] static inline uchar_t* get() noexcept
+    {
+        return sBase;
+    }
+};
+
+/// \brief pointer stored as an offset from a base address
+/// \tparam Type the type pointed to
+/// \tparam bits offset size (32, 40, or 48)
+/// \tparam Tag selects the CompressedBase
+///
+/// SixBytePointer saves 2 bytes by assuming 48 bit addresses. When objects
+/// live in one RegionArena, their offsets from its base are much smaller, so a
+/// 32 bit CompressedPointer takes half the space of Type* (up to 4 GiB of
+/// objects), and 40 bits (5 bytes) allow 1 TiB. The object has alignment 4 for
+/// 32 bits, 1 for 40 bits and 2 for 48 bits, so it adds no padding to the
+/// structs that contain it.
+///
+/// An offset of 0 is the null pointer (RegionArena never allocates at its
+/// base). Decoding adds the base to the offset, with a conditional move for
+/// null. Pointers must be within 2^bits bytes after the base, which is not
+/// checked (see fits()). This class only stores a pointer, it does not manage
+/// memory, and it does not enforce const correctness.
+template <typename Type, usize_t bits = 32, typename Tag = void>
+class CompressedPointer
+{
+public:
+
+    static_assert(bits == 32 || bits == 40 || bits == 48,
+        "compressed pointers must have 32, 40, or 48 bits");
+
+    /// number of bytes stored
+    static constexpr usize_t cBytes = bits / 8;
+
+    /// largest offset that can be stored
+    static constexpr uint64_t cMaxOffset = (1ull << bits) - 1;
+
+    /// base address provider
+    using BaseType = CompressedBase<Tag>;
+
+private:
+
+    /// storage element (sized for natural alignment within cBytes)
+    using _UnitType = meta::Conditional<bits == 32,uint32_t,
+        meta::Conditional<bits == 48,ushort_t,uchar_t>>;
+
+    /// offset from the base address (little endian units)
+    _UnitType _off[cBytes / sizeof(_UnitType)];
+
+    /// store an offset
+    inline void _setOffset(const uint64_t off) noexcept
+    {
+        __builtin_memcpy(_off,&off,cBytes);
+    }
+
+    /// offset of a pointer (null is 0)
+    [[nodiscard]] static inline uint64_t _offsetOf(
+        const Type * const ptr) noexcept
+    {
+        const uintptr_t p = reinterpret_cast<uintptr_t>(ptr);
+        const uintptr_t b = reinterpret_cast<uintptr_t>(BaseType::get());
+        return ptr ? p - b : 0;
+    }
+
+public:
+
+    /// \brief initialize as null pointer
+    [[nodiscard]] inline CompressedPointer() noexcept: _off{} {}
+
+    /// \brief initialize from a pointer (allowed to be null)
+    /// \param ptr the pointer to store (must satisfy fits())
+    [[nodiscard]] inline CompressedPointer(Type * const ptr) noexcept
+    {
+        _setOffset(_offsetOf(ptr));
+    }
+
+    /// \brief can a pointer be stored
+    /// \param ptr the pointer
+    /// \return true if ptr is null or within 2^bits bytes after the base
+    [[nodiscard]] static inline bool fits(const Type * const ptr) noexcept
+    {
+        const uchar_t *p = reinterpret_cast<const uchar_t*>(ptr);
+        const uchar_t *b = BaseType::get();
+        return !ptr || (p > b && static_cast<uint64_t>(p - b) <= cMaxOffset);
+    }
+
+    /// \brief the stored offset from the base (0 for null)
+    [[nodiscard]] inline uint64_t offset() const noexcept
+    {
+        uint64_t off = 0;
+        __builtin_memcpy(&off,_off,cBytes);
+        return off;
+    }
+
+    /// \brief create from an offset
+    /// \param off offset from the base (0 for null, at most cMaxOffset)
+    /// \return pointer with that offset
+    [[nodiscard]] static inline CompressedPointer fromOffset(
+        const uint64_t off) noexcept
+    {
+        CompressedPointer ret;
+        ret._setOffset(off);
+        return ret;
+    }
+
+    /// \brief get the pointer
+    /// \return a full 8 byte dereferenceable pointer (if not null)
+    [[nodiscard]] inline Type* ptr() const noexcept
+    {
+        const uint64_t off = offset();
+        return off ? reinterpret_cast<Type*>(BaseType::get() + off) : nullptr;
+    }
+
+    /// \brief dereference the represented pointer (no null check)
+    /// \note not available for void pointer
+    [[nodiscard]] inline auto& operator*() const noexcept
+        requires (!meta::isVoid<Type>)
+    {
+        return *ptr();
+    }
+
+    /// \brief access member of the represented pointer (no null check)
+    /// \note not available for void pointer
+    [[nodiscard]] inline Type* operator->() const noexcept
+        requires (!meta::isVoid<Type>)
+    {
+        return ptr();
+    }
+
+    /// \brief boolean equivalent (is the pointer non null)
+    [[nodiscard]] inline explicit operator bool() const noexcept
+    {
+        return offset() != 0;
+    }
+
+    /// \brief convert to the full pointer
+    [[nodiscard]] inline operator Type*() const noexcept
+    {
+        return ptr();
+    }
+
+    /// \brief compare pointer equality (compares offsets)
+    [[nodiscard]] friend inline bool operator==(
+        const CompressedPointer left, const CompressedPointer right) noexcept
+    {
+        return left.offset() == right.offset();
+    }
+
+    /// \brief compare pointer equality
+    template <concepts::isSameIgnoreCV<Type> TypeCV>
+    [[nodiscard]] friend inline bool operator==(
+        const CompressedPointer left, TypeCV * const right) noexcept
+    {
+        return left.ptr() == right;
+    }
+
+    /// \brief compare pointers 3 way (null is less than other pointers)
+    [[nodiscard]] friend inline auto operator<=>(
+        const CompressedPointer left, const CompressedPointer right) noexcept
+    {
+        return left.offset() <=> right.offset();
+    }
+};
+
+} // namespace tkoz::stl
@@ -152,4 +152,13 @@ public:
     CastError(const char * const msg): RuntimeError(msg) {}
 };
 
+/// operating system input/output failed
+/// example: file cannot be opened or mapped
+class IOError : public RuntimeError
+{
+public:
+    IOError(): RuntimeError() {}
+    IOError(const char * const msg): RuntimeError(msg) {}
+};
+
 } // namespace tkoz::stl
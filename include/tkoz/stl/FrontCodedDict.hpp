@@ -0,0 +1,507 @@
+///
+/// immutable sorted string dictionary with front coding
+///
+
+#pragma once
+
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/CStringSimd.hpp>
+#include <tkoz/stl/CStringView.hpp>
+#include <tkoz/stl/Exceptions.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+namespace tkoz::stl
+{
+
+namespace _detail
+{
+
+/// append an unsigned integer with 7 bits per byte (high bit continues)
+inline void _putVarint(std::vector<uchar_t> &out, usize_t n)
+{
+    while (n >= 0x80)
+    {
+        out.push_back(static_cast<uchar_t>(n | 0x80));
+        n >>= 7;
+    }
+    out.push_back(static_cast<uchar_t>(n));
+}
+
+/// read an integer written by _putVarint() and advance the pointer
+[[nodiscard]] inline usize_t _getVarint(const uchar_t *&p) noexcept
+{
+    usize_t ret = 0;
+    uint_t shift = 0;
+    while (*p & 0x80)
+    {
+        ret |= static_cast<usize_t>(*p++ & 0x7f) << shift;
+        shift += 7;
+    }
+    return ret | (static_cast<usize_t>(*p++) << shift);
+}
+
+} // namespace _detail
+
+/// \brief immutable sorted set of strings stored with front coding
+/// \tparam CharType character type (byte sized)
+/// \tparam bucketSize strings per bucket (larger is smaller but slower)
+///
+/// Strings are split into buckets of consecutive strings. The first string
+/// of each bucket is stored in full and each other one as the length of the
+/// prefix shared with the previous string and the remaining characters, with
+/// lengths as variable length integers. All buckets are in one byte array
+/// with one offset per bucket, so a set of many similar strings takes a small
+/// part of the memory of separately allocated CString objects.
+///
+/// Lookup binary searches the first strings of the buckets, then scans one
+/// bucket using the shared prefix lengths to skip most comparisons, so it is
+/// O(log n + bucketSize) without decoding strings. Strings are ordered the
+/// same way as CString comparison (see CString::ptrCmp3way()), and must not
+/// contain null characters.
+template <typename _CharType, usize_t _bucketSize = 16>
+class FrontCodedDict
+{
+public:
+
+    /// character type
+    using CharType = _CharType;
+
+    /// string view type
+    using ViewType = CStringView<CharType>;
+
+    /// strings per bucket
+    static constexpr usize_t bucketSize = _bucketSize;
+
+    /// rank returned when a string is not found
+    static constexpr usize_t npos = static_cast<usize_t>(-1);
+
+    static_assert(simd::isByteChar<CharType>,
+        "FrontCodedDict requires byte sized characters");
+    static_assert(bucketSize > 0);
+
+private:
+
+    /// encoded buckets
+    std::vector<uchar_t> _data;
+
+    /// offset of each bucket in _data
+    std::vector<usize_t> _buckets;
+
+    /// number of strings
+    usize_t _size;
+
+    /// length of the longest string
+    usize_t _maxLen;
+
+    [[nodiscard]] static inline const CharType* _chars(const uchar_t * const p)
+        noexcept
+    {
+        return reinterpret_cast<const CharType*>(p);
+    }
+
+    /// \brief compare a string with a key from a position both share
+    /// \param sfx characters of the string from start
+    /// \param sfxLen number of characters in sfx
+    /// \param key the key
+    /// \param start number of leading characters known to be equal
+    /// \param prefix if true, compare only the first key.len() characters
+    /// \param m set to the index where the comparison was decided
+    /// \return negative, zero, or positive as the string is less, equal, or
+    /// greater than the key (as null-terminated strings)
+    [[nodiscard]] static inline int _cmpFrom(const CharType * const sfx,
+        const usize_t sfxLen, const ViewType key, const usize_t start,
+        const bool prefix, usize_t &m) noexcept
+    {
+        const usize_t rest = key.len() - start;
+        const usize_t n = sfxLen < rest ? sfxLen : rest;
+        const usize_t j = n ? simd::memMismatch(sfx,key.ptr() + start,n) : 0;
+        m = start + j;
+        if (prefix && j == rest)
+            return 0;
+        const CharType a = j < sfxLen ? sfx[j] : CharType(0);
+        const CharType b = j < rest ? key[start + j] : CharType(0);
+        return a < b ? -1 : (b < a ? 1 : 0);
+    }
+
+    /// \brief compare the first string of a bucket with a key
+    [[nodiscard]] inline int _cmpHeader(const usize_t bucket,
+        const ViewType key, const bool prefix, usize_t &m,
+        const uchar_t *&p) const noexcept
+    {
+        p = _data.data() + _buckets[bucket];
+        const usize_t len = _detail::_getVarint(p);
+        const int c = _cmpFrom(_chars(p),len,key,0,prefix,m);
+        p += len;
+        return c;
+    }
+
+    /// \brief rank of the first string comparing at least (or greater than)
+    /// a key
+    /// \param key the key
+    /// \param prefix compare only the first key.len() characters of strings
+    /// \param upper find the first greater string instead
+    /// \param exact set to whether the string at the rank compares equal
+    [[nodiscard]] inline usize_t _bound(const ViewType key, const bool prefix,
+        const bool upper, bool &exact) const noexcept
+    {
+        exact = false;
+        usize_t m;
+        const uchar_t *p;
+        // first bucket whose first string satisfies the condition
+        usize_t lo = 0, hi = _buckets.size();
+        while (lo < hi)
+        {
+            const usize_t mid = lo + (hi - lo) / 2;
+            const int c = _cmpHeader(mid,key,prefix,m,p);
+            if (upper ? c > 0 : c >= 0)
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        if (lo > 0)
+        {
+            // scan the previous bucket (its first string is before the key)
+            const usize_t bucket = lo - 1;
+            const usize_t first = bucket * bucketSize;
+            const usize_t end = first + bucketSize < _size
+                ? first + bucketSize : _size;
+            int c = _cmpHeader(bucket,key,prefix,m,p);
+            for (usize_t rank = first + 1; rank < end; ++rank)
+            {
+                const usize_t lcp = _detail::_getVarint(p);
+                const usize_t sfxLen = _detail::_getVarint(p);
+                if (lcp < m)
+                {
+                    // differs where the previous string matched the key and
+                    // strings increase, so it is greater than the key
+                    return rank;
+                }
+                if (lcp == m)
+                    c = _cmpFrom(_chars(p),sfxLen,key,m,prefix,m);
+                // if lcp > m the comparison is decided at the same index
+                p += sfxLen;
+                if (upper ? c > 0 : c >= 0)
+                {
+                    exact = !c;
+                    return rank;
+                }
+            }
+        }
+        const usize_t rank = lo * bucketSize;
+        if (lo < _buckets.size())
+            exact = !_cmpHeader(lo,key,prefix,m,p);
+        return rank < _size ? rank : _size;
+    }
+
+    /// \brief decode the string after a position into a buffer
+    /// \param p position of an encoded string (advanced past it)
+    /// \param first whether it is the first string of its bucket
+    /// \param buf buffer holding the previous string (replaced by this one)
+    static inline void _decode(const uchar_t *&p, const bool first,
+        std::vector<CharType> &buf)
+    {
+        const usize_t lcp = first ? 0 : _detail::_getVarint(p);
+        const usize_t sfxLen = _detail::_getVarint(p);
+        buf.resize(lcp + sfxLen + 1);
+        if (sfxLen)
+            simd::copyChars(buf.data() + lcp,_chars(p),sfxLen);
+        buf[lcp + sfxLen] = CharType(0);
+        p += sfxLen;
+    }
+
+public:
+
+    /// \brief forward iterator over the strings in order
+    ///
+    /// Each string is decoded into a buffer owned by the iterator, so the
+    /// view from dereferencing is valid until the iterator is advanced or
+    /// destroyed.
+    class Iterator
+    {
+    public:
+
+        using iterator_concept = std::forward_iterator_tag;
+        using iterator_category = std::input_iterator_tag;
+        using value_type = ViewType;
+        using difference_type = std::ptrdiff_t;
+        using reference = ViewType;
+
+    private:
+
+        friend class FrontCodedDict;
+
+        /// the dictionary
+        const FrontCodedDict *_dict;
+
+        /// rank of the current string
+        usize_t _rank;
+
+        /// position of the next encoded string
+        const uchar_t *_next;
+
+        /// current string (null-terminated)
+        std::vector<CharType> _buf;
+
+        /// position at a rank without decoding (only for comparing)
+        [[nodiscard]] inline Iterator(const FrontCodedDict * const dict,
+            const usize_t rank, bool) noexcept
+            : _dict(dict), _rank(rank), _next(nullptr) {}
+
+        [[nodiscard]] inline Iterator(const FrontCodedDict * const dict,
+            const usize_t rank): _dict(dict), _rank(rank), _next(nullptr)
+        {
+            if (rank >= dict->_size)
+            {
+                _rank = dict->_size;
+                return;
+            }
+            // decode from the start of the bucket
+            const usize_t bucket = rank / bucketSize;
+            _next = dict->_data.data() + dict->_buckets[bucket];
+            for (usize_t r = bucket * bucketSize; r <= rank; ++r)
+                _decode(_next,r == bucket * bucketSize,_buf);
+        }
+
+    public:
+
+        /// \brief singular iterator
+        [[nodiscard]] inline Iterator() noexcept
+            : _dict(nullptr), _rank(0), _next(nullptr) {}
+
+        /// \brief the current string
+        [[nodiscard]] inline ViewType operator*() const noexcept
+        {
+            return ViewType(_buf.data(),_buf.size() - 1);
+        }
+
+        /// \brief rank of the current string
+        [[nodiscard]] inline usize_t rank() const noexcept
+        {
+            return _rank;
+        }
+
+        inline Iterator& operator++()
+        {
+            if (++_rank < _dict->_size)
+                _decode(_next,_rank % bucketSize == 0,_buf);
+            return *this;
+        }
+
+        inline Iterator operator++(int)
+        {
+            Iterator ret = *this;
+            ++*this;
+            return ret;
+        }
+
+        /// \brief compare ranks (iterators of the same dictionary)
+        [[nodiscard]] friend inline bool operator==(
+            const Iterator &left, const Iterator &right) noexcept
+        {
+            return left._rank == right._rank;
+        }
+    };
+
+    /// \brief strings with ranks in an interval (see prefixScan())
+    class Range
+    {
+    private:
+
+        friend class FrontCodedDict;
+
+        const FrontCodedDict *_dict;
+        usize_t _first;
+        usize_t _last;
+
+        [[nodiscard]] inline Range(const FrontCodedDict * const dict,
+            const usize_t first, const usize_t last) noexcept
+            : _dict(dict), _first(first), _last(last) {}
+
+    public:
+
+        [[nodiscard]] inline Iterator begin() const
+        {
+            return _first < _last ? Iterator(_dict,_first)
+                : Iterator(_dict,_last,true);
+        }
+
+        [[nodiscard]] inline Iterator end() const noexcept
+        {
+            return Iterator(_dict,_last,true);
+        }
+
+        /// \brief rank of the first string
+        [[nodiscard]] inline usize_t first() const noexcept
+        {
+            return _first;
+        }
+
+        /// \brief number of strings
+        [[nodiscard]] inline usize_t size() const noexcept
+        {
+            return _last - _first;
+        }
+
+        [[nodiscard]] inline bool empty() const noexcept
+        {
+            return _first == _last;
+        }
+    };
+
+    /// \brief initialize an empty dictionary
+    [[nodiscard]] inline FrontCodedDict() noexcept: _size(0), _maxLen(0) {}
+
+    /// \brief build from sorted strings
+    /// \param strs range of strings (CString, CStringView, C strings, ...)
+    /// sorted as CString, without null characters
+    /// \throw ArgumentError if strs is not sorted
+    ///
+    /// Repeated strings are stored once.
+    template <std::ranges::input_range RangeType>
+        requires std::convertible_to<
+            std::ranges::range_reference_t<const RangeType>,ViewType>
+    [[nodiscard]] inline explicit FrontCodedDict(const RangeType &strs)
+        : _size(0), _maxLen(0)
+    {
+        std::vector<CharType> prev;
+        for (auto &&s : strs)
+        {
+            const ViewType str = s;
+            usize_t m = 0;
+            if (_size)
+            {
+                const int c = _cmpFrom(prev.data(),prev.size(),str,0,false,m);
+                if (c > 0)
+                    throw ArgumentError("strings are not sorted");
+                if (c == 0)
+                    continue;
+            }
+            // m is the shared prefix length (index of the first difference)
+            if (_size % bucketSize == 0)
+            {
+                _buckets.push_back(_data.size());
+                m = 0;
+            }
+            else
+                _detail::_putVarint(_data,m);
+            _detail::_putVarint(_data,str.len() - m);
+            const usize_t at = _data.size();
+            _data.resize(at + str.len() - m);
+            if (str.len() > m)
+                simd::copyChars(reinterpret_cast<CharType*>(_data.data() + at),
+                    str.ptr() + m,str.len() - m);
+            prev.assign(str.ptr(),str.ptr() + str.len());
+            if (str.len() > _maxLen)
+                _maxLen = str.len();
+            ++_size;
+        }
+        _data.shrink_to_fit();
+        _buckets.shrink_to_fit();
+    }
+
+    /// \brief number of strings
+    [[nodiscard]] inline usize_t size() const noexcept
+    {
+        return _size;
+    }
+
+    /// \brief are there no strings
+    [[nodiscard]] inline bool empty() const noexcept
+    {
+        return !_size;
+    }
+
+    /// \brief length of the longest string
+    [[nodiscard]] inline usize_t maxLen() const noexcept
+    {
+        return _maxLen;
+    }
+
+    /// \brief bytes used by the dictionary
+    [[nodiscard]] inline usize_t memoryUsage() const noexcept
+    {
+        return sizeof(*this) + _data.capacity()
+            + _buckets.capacity() * sizeof(usize_t);
+    }
+
+    /// \brief rank of a string
+    /// \param key the string
+    /// \return index of key in sorted order, or npos if it is absent
+    [[nodiscard]] inline usize_t find(const ViewType key) const noexcept
+    {
+        bool exact;
+        const usize_t rank = _bound(key,false,false,exact);
+        return exact ? rank : npos;
+    }
+
+    /// \brief is a string present
+    [[nodiscard]] inline bool contains(const ViewType key) const noexcept
+    {
+        return find(key) != npos;
+    }
+
+    /// \brief number of strings less than a key (rank of the first string
+    /// at least the key)
+    [[nodiscard]] inline usize_t lowerBound(const ViewType key) const noexcept
+    {
+        bool exact;
+        return _bound(key,false,false,exact);
+    }
+
+    /// \brief the string with a rank
+    /// \param rank index in sorted order
+    /// \return a copy of the string
+    /// \throw IndexError if rank is out of bounds
+    [[nodiscard]] inline CString<CharType> at(const usize_t rank) const
+    {
+        if (rank >= _size)
+            throw IndexError("rank out of bounds");
+        const Iterator it(this,rank);
+        return CString<CharType>((*it).ptr(),(*it).len());
+    }
+
+    /// \brief the string with a rank (see at())
+    [[nodiscard]] inline CString<CharType> operator[](const usize_t rank)
+        const
+    {
+        return at(rank);
+    }
+
+    /// \brief iterator to the first string
+    [[nodiscard]] inline Iterator begin() const
+    {
+        return Iterator(this,0);
+    }
+
+    /// \brief end iterator
+    [[nodiscard]] inline Iterator end() const noexcept
+    {
+        return Iterator(this,_size,true);
+    }
+
+    /// \brief iterator to a rank (end iterator if out of bounds)
+    [[nodiscard]] inline Iterator iteratorAt(const usize_t rank) const
+    {
+        return Iterator(this,rank);
+    }
+
+    /// \brief strings starting with a prefix, in order
+    /// \param prefix the prefix (the empty prefix gives all strings)
+    /// \return range of the strings (with their ranks)
+    [[nodiscard]] inline Range prefixScan(const ViewType prefix) const
+        noexcept
+    {
+        bool exact;
+        const usize_t first = _bound(prefix,true,false,exact);
+        const usize_t last = _bound(prefix,true,true,exact);
+        return Range(this,first,last);
+    }
+};
+
+} // namespace tkoz::stl
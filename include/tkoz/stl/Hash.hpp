@@ -0,0 +1,694 @@
+///
+/// fast non-cryptographic hashing of byte arrays and C strings
+///
+
+#pragma once
+
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/CStringSimd.hpp>
+#include <tkoz/stl/Simd.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <cstddef>
+#include <functional>
+
+#if __x86_64__
+#include <immintrin.h>
+#endif
+
+namespace tkoz::stl
+{
+
+namespace _detail
+{
+
+//
+// The hash follows the structure of XXH3 (with its own secret, so values are
+// not compatible). Short inputs are mixed directly. Long inputs are processed
+// in 64 byte stripes by 8 independent 64 bit accumulators which vectorize
+// well, scrambled after every block of 16 stripes, and the last 64 bytes are
+// always accumulated as a final stripe. Multi-byte reads are little endian.
+//
+
+inline constexpr uint64_t _cHashPrime32_1 = 0x9E3779B1ull;
+inline constexpr uint64_t _cHashPrime32_2 = 0x85EBCA77ull;
+inline constexpr uint64_t _cHashPrime32_3 = 0xC2B2AE3Dull;
+inline constexpr uint64_t _cHashPrime64_1 = 0x9E3779B185EBCA87ull;
+inline constexpr uint64_t _cHashPrime64_2 = 0xC2B2AE3D27D4EB4Full;
+inline constexpr uint64_t _cHashPrime64_3 = 0x165667B19E3779F9ull;
+inline constexpr uint64_t _cHashPrime64_4 = 0x85EBCA77C2B2AE63ull;
+inline constexpr uint64_t _cHashPrime64_5 = 0x27D4EB2F165667C5ull;
+
+/// bytes per stripe
+inline constexpr usize_t _cHashStripe = 64;
+
+/// stripes per block (accumulators are scrambled after each block)
+inline constexpr usize_t _cHashBlockStripes = 16;
+
+/// longest input using the mid length mixing
+inline constexpr usize_t _cHashMidMax = 128;
+
+/// secret word offset of the scramble key
+inline constexpr usize_t _cHashScrambleKey = 16;
+
+/// secret word offset of the last stripe key
+inline constexpr usize_t _cHashLastKey = 11;
+
+/// pseudorandom words for mixing input
+struct _HashSecret
+{
+    uint64_t w[24];
+};
+
+[[nodiscard]] inline constexpr _HashSecret _makeHashSecret() noexcept
+{
+    // splitmix64 sequence
+    _HashSecret ret{};
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    for (uint64_t &w : ret.w)
+    {
+        x += 0x9E3779B97F4A7C15ull;
+        uint64_t z = x;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        w = z ^ (z >> 31);
+    }
+    return ret;
+}
+
+inline constexpr _HashSecret _cHashSecret = _makeHashSecret();
+
+[[nodiscard]] inline uint64_t _read64(const uchar_t * const p) noexcept
+{
+    uint64_t ret;
+    __builtin_memcpy(&ret,p,sizeof(ret));
+    return ret;
+}
+
+[[nodiscard]] inline uint64_t _read32(const uchar_t * const p) noexcept
+{
+    uint32_t ret;
+    __builtin_memcpy(&ret,p,sizeof(ret));
+    return ret;
+}
+
+[[nodiscard]] inline constexpr uint64_t _rotl64(
+    const uint64_t x, const int r) noexcept
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+/// 128 bit product with the high and low halves combined
+[[nodiscard]] inline uint64_t _mulFold64(
+    const uint64_t a, const uint64_t b) noexcept
+{
+    __extension__ using u128 = unsigned __int128;
+    const u128 p = static_cast<u128>(a) * b;
+    return static_cast<uint64_t>(p) ^ static_cast<uint64_t>(p >> 64);
+}
+
+[[nodiscard]] inline uint64_t _avalanche(uint64_t h) noexcept
+{
+    h ^= h >> 37;
+    h *= 0x165667919E3779F9ull;
+    return h ^ (h >> 32);
+}
+
+[[nodiscard]] inline uint64_t _rrmxmx(uint64_t h, const usize_t len) noexcept
+{
+    h ^= _rotl64(h,49) ^ _rotl64(h,24);
+    h *= 0x9FB21C651E98DF25ull;
+    h ^= (h >> 35) + len;
+    h *= 0x9FB21C651E98DF25ull;
+    return h ^ (h >> 28);
+}
+
+/// mix 16 bytes of input with 2 secret words
+[[nodiscard]] inline uint64_t _mix16(const uchar_t * const p,
+    const usize_t key, const uint64_t seed) noexcept
+{
+    const uint64_t * const s = _cHashSecret.w + key;
+    return _mulFold64(_read64(p) ^ (s[0] + seed),
+        _read64(p + 8) ^ (s[1] - seed));
+}
+
+/// hash of 0 to 16 bytes
+[[nodiscard]] inline uint64_t _hashShort(const uchar_t * const p,
+    const usize_t len, const uint64_t seed) noexcept
+{
+    const uint64_t * const s = _cHashSecret.w;
+    if (len > 8)
+    {
+        const uint64_t lo = _read64(p) ^ (s[3] + seed);
+        const uint64_t hi = _read64(p + len - 8) ^ (s[4] - seed);
+        return _avalanche(len + __builtin_bswap64(lo) + hi
+            + _mulFold64(lo,hi));
+    }
+    if (len >= 4)
+    {
+        const uint64_t v = _read32(p) + (_read32(p + len - 4) << 32);
+        return _rrmxmx(v ^ ((s[1] ^ s[2]) + seed),len);
+    }
+    if (len)
+    {
+        const uint64_t v = (static_cast<uint64_t>(p[0]) << 16)
+            | (static_cast<uint64_t>(p[len >> 1]) << 24)
+            | p[len - 1] | (static_cast<uint64_t>(len) << 8);
+        return _avalanche(v ^ (s[0] + seed));
+    }
+    return _avalanche(seed ^ s[5]);
+}
+
+/// hash of 17 to 128 bytes (pairs of 16 bytes from each end)
+[[nodiscard]] inline uint64_t _hashMid(const uchar_t * const p,
+    const usize_t len, const uint64_t seed) noexcept
+{
+    uint64_t acc = len * _cHashPrime64_1 + seed;
+    if (len > 32)
+    {
+        if (len > 64)
+        {
+            if (len > 96)
+            {
+                acc += _mix16(p + 48,12,seed);
+                acc += _mix16(p + len - 64,14,seed);
+            }
+            acc += _mix16(p + 32,8,seed);
+            acc += _mix16(p + len - 48,10,seed);
+        }
+        acc += _mix16(p + 16,4,seed);
+        acc += _mix16(p + len - 32,6,seed);
+    }
+    acc += _mix16(p,0,seed);
+    acc += _mix16(p + len - 16,2,seed);
+    return _avalanche(acc);
+}
+
+/// accumulate one stripe with 8 secret words starting at key
+inline void _hashStripeScalar(uint64_t * const acc, const uchar_t * const p,
+    const usize_t key) noexcept
+{
+    const uint64_t * const s = _cHashSecret.w + key;
+    for (usize_t i = 0; i < 8; ++i)
+    {
+        const uint64_t v = _read64(p + 8 * i);
+        const uint64_t k = v ^ s[i];
+        acc[i ^ 1] += v;
+        acc[i] += (k & 0xFFFFFFFFull) * (k >> 32);
+    }
+}
+
+inline void _hashScrambleScalar(uint64_t * const acc) noexcept
+{
+    const uint64_t * const s = _cHashSecret.w + _cHashScrambleKey;
+    for (usize_t i = 0; i < 8; ++i)
+    {
+        uint64_t a = acc[i];
+        a ^= a >> 47;
+        a ^= s[i];
+        acc[i] = a * _cHashPrime32_1;
+    }
+}
+
+// accumulate n stripes, the first having index first in the whole input
+inline void _hashStripesScalar(uint64_t * const acc, const uchar_t *p,
+    const usize_t n, const usize_t first) noexcept
+{
+    for (usize_t i = first; i < first + n; ++i, p += _cHashStripe)
+    {
+        _hashStripeScalar(acc,p,i % _cHashBlockStripes);
+        if ((i + 1) % _cHashBlockStripes == 0)
+            _hashScrambleScalar(acc);
+    }
+}
+
+#if __x86_64__
+
+[[gnu::target("avx2")]]
+inline void _hashStripesAvx2(uint64_t * const acc, const uchar_t *p,
+    const usize_t n, const usize_t first) noexcept
+{
+    __m256i a[2];
+    a[0] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc));
+    a[1] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + 4));
+    const __m256i prime = _mm256_set1_epi64x(_cHashPrime32_1);
+    for (usize_t i = first; i < first + n; ++i, p += _cHashStripe)
+    {
+        const uint64_t * const s = _cHashSecret.w + i % _cHashBlockStripes;
+        for (usize_t h = 0; h < 2; ++h)
+        {
+            const __m256i d = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(p + 32 * h));
+            const __m256i k = _mm256_xor_si256(d,_mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(s + 4 * h)));
+            // 32x32 bit product of the halves of each key mixed word
+            const __m256i prod = _mm256_mul_epu32(k,_mm256_srli_epi64(k,32));
+            // input words go to the neighboring accumulator
+            const __m256i swap = _mm256_shuffle_epi32(d,_MM_SHUFFLE(1,0,3,2));
+            a[h] = _mm256_add_epi64(a[h],_mm256_add_epi64(prod,swap));
+        }
+        if ((i + 1) % _cHashBlockStripes == 0)
+        {
+            const uint64_t * const t = _cHashSecret.w + _cHashScrambleKey;
+            for (usize_t h = 0; h < 2; ++h)
+            {
+                __m256i x = _mm256_xor_si256(a[h],_mm256_srli_epi64(a[h],47));
+                x = _mm256_xor_si256(x,_mm256_loadu_si256(
+                    reinterpret_cast<const __m256i*>(t + 4 * h)));
+                // 64 bit by 32 bit multiply
+                const __m256i lo = _mm256_mul_epu32(x,prime);
+                const __m256i hi = _mm256_mul_epu32(
+                    _mm256_srli_epi64(x,32),prime);
+                a[h] = _mm256_add_epi64(lo,_mm256_slli_epi64(hi,32));
+            }
+        }
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc),a[0]);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + 4),a[1]);
+}
+
+#endif // __x86_64__
+
+using _HashStripesFn = void (*)(uint64_t*, const uchar_t*, usize_t, usize_t)
+    noexcept;
+
+[[nodiscard]] inline _HashStripesFn _selectHashStripes(
+    const simd::SimdLevel level) noexcept
+{
+#if __x86_64__
+    if (level >= simd::cSimdAvx2)
+        return _hashStripesAvx2;
+#endif
+    (void) level;
+    return _hashStripesScalar;
+}
+
+// kernel for the best supported level, selected on first use
+inline void _hashStripesDispatch(uint64_t * const acc, const uchar_t * const p,
+    const usize_t n, const usize_t first) noexcept
+{
+    static const _HashStripesFn sFn = _selectHashStripes(simd::simdLevel());
+    sFn(acc,p,n,first);
+}
+
+inline void _hashInitAcc(uint64_t * const acc, const uint64_t seed) noexcept
+{
+    acc[0] = _cHashPrime32_3 + seed;
+    acc[1] = _cHashPrime64_1 - seed;
+    acc[2] = _cHashPrime64_2 + seed;
+    acc[3] = _cHashPrime64_3 - seed;
+    acc[4] = _cHashPrime64_4 + seed;
+    acc[5] = _cHashPrime32_2 - seed;
+    acc[6] = _cHashPrime64_5 + seed;
+    acc[7] = _cHashPrime32_1 - seed;
+}
+
+/// final hash of the accumulators (after the last stripe)
+[[nodiscard]] inline uint64_t _hashMerge(const uint64_t * const acc,
+    const usize_t len) noexcept
+{
+    const uint64_t * const s = _cHashSecret.w;
+    uint64_t ret = len * _cHashPrime64_1;
+    for (usize_t i = 0; i < 8; i += 2)
+        ret += _mulFold64(acc[i] ^ s[i + 1],acc[i + 1] ^ s[i + 2]);
+    return _avalanche(ret);
+}
+
+/// hash of more than 128 bytes
+[[nodiscard]] inline uint64_t _hashLong(const uchar_t * const p,
+    const usize_t len, const uint64_t seed, const _HashStripesFn fn) noexcept
+{
+    alignas(32) uint64_t acc[8];
+    _hashInitAcc(acc,seed);
+    // all full stripes before the last byte, then the last 64 bytes
+    fn(acc,p,(len - 1) / _cHashStripe,0);
+    _hashStripeScalar(acc,p + len - _cHashStripe,_cHashLastKey);
+    return _hashMerge(acc,len);
+}
+
+[[nodiscard]] inline uint64_t _hashBytes(const uchar_t * const p,
+    const usize_t len, const uint64_t seed, const _HashStripesFn fn) noexcept
+{
+    if (len <= 16)
+        return _hashShort(p,len,seed);
+    if (len <= _cHashMidMax)
+        return _hashMid(p,len,seed);
+    return _hashLong(p,len,seed,fn);
+}
+
+} // namespace _detail
+
+/// \brief hash an array of bytes
+/// \param data pointer to the bytes (may be null if bytes is 0)
+/// \param bytes number of bytes
+/// \param seed seed value (different seeds give unrelated hash functions)
+/// \return 64 bit hash value
+///
+/// This is a fast non-cryptographic hash in the style of XXH3 (the values are
+/// not the same as XXH3). Inputs longer than 128 bytes are processed with the
+/// best vector instructions available at runtime, giving the same result on
+/// every processor.
+[[nodiscard]] inline uint64_t hashBytes(const void * const data,
+    const usize_t bytes, const uint64_t seed = 0) noexcept
+{
+    return _detail::_hashBytes(static_cast<const uchar_t*>(data),bytes,seed,
+        _detail::_hashStripesDispatch);
+}
+
+/// \brief hash an array of bytes using a specific SIMD level
+/// \param data pointer to the bytes (may be null if bytes is 0)
+/// \param bytes number of bytes
+/// \param seed seed value
+/// \param level SIMD level to use (limited to what the processor supports)
+/// \return 64 bit hash value (same as the other overload)
+[[nodiscard]] inline uint64_t hashBytes(const void * const data,
+    const usize_t bytes, const uint64_t seed,
+    const simd::SimdLevel level) noexcept
+{
+    return _detail::_hashBytes(static_cast<const uchar_t*>(data),bytes,seed,
+        _detail::_selectHashStripes(simd::clampSimdLevel(level)));
+}
+
+/// \brief hash an array of characters
+/// \tparam CharType character type
+/// \param ptr pointer to the characters
+/// \param len number of characters
+/// \param seed seed value
+/// \return 64 bit hash value
+template <typename CharType>
+[[nodiscard]] inline uint64_t hashChars(const CharType * const ptr,
+    const usize_t len, const uint64_t seed = 0) noexcept
+{
+    return hashBytes(ptr,len * sizeof(CharType),seed);
+}
+
+/// \brief hash a null-terminated string
+/// \tparam CharType character type
+/// \param ptr the string (null is hashed like the empty string)
+/// \param seed seed value
+/// \return 64 bit hash value (equal to hashChars() with the string length)
+template <typename CharType>
+[[nodiscard]] inline uint64_t hashCString(const CharType * const ptr,
+    const uint64_t seed = 0) noexcept
+{
+    return hashChars(ptr,ptr ? simd::strLen(ptr) : 0,seed);
+}
+
+/// \brief incremental hash of data given in pieces
+///
+/// The digest of all data passed to update() is equal to hashBytes() of the
+/// data concatenated, so strings can be hashed across concatenations without
+/// building the concatenated string. Input is collected in a buffer and
+/// consumed in stripes once more input follows a full buffer, so the
+/// lengths of the pieces do not matter.
+class Hasher
+{
+public:
+
+    /// size of the input buffer (multiple of the stripe size)
+    static constexpr usize_t cBufferSize = 4 * _detail::_cHashStripe;
+
+private:
+
+    /// accumulators for the consumed input
+    alignas(32) uint64_t _acc[8];
+
+    /// input not yet consumed
+    uchar_t _buf[cBufferSize];
+
+    /// last stripe of the consumed input (for short final buffers)
+    uchar_t _last[_detail::_cHashStripe];
+
+    /// number of bytes in _buf
+    usize_t _bufLen;
+
+    /// number of bytes consumed (multiple of the stripe size)
+    usize_t _consumed;
+
+    /// the seed
+    uint64_t _seed;
+
+    /// consume a full buffer
+    inline void _consumeBuffer() noexcept
+    {
+        _detail::_hashStripesDispatch(_acc,_buf,
+            cBufferSize / _detail::_cHashStripe,
+            _consumed / _detail::_cHashStripe);
+        __builtin_memcpy(_last,_buf + cBufferSize - _detail::_cHashStripe,
+            _detail::_cHashStripe);
+        _consumed += cBufferSize;
+        _bufLen = 0;
+    }
+
+public:
+
+    /// \brief initialize with no data
+    /// \param seed seed value
+    [[nodiscard]] inline explicit Hasher(const uint64_t seed = 0) noexcept
+    {
+        reset(seed);
+    }
+
+    /// \brief discard all data
+    /// \param seed seed value
+    inline void reset(const uint64_t seed = 0) noexcept
+    {
+        _detail::_hashInitAcc(_acc,seed);
+        _bufLen = 0;
+        _consumed = 0;
+        _seed = seed;
+    }
+
+    /// \brief add bytes
+    /// \param data pointer to the bytes (may be null if bytes is 0)
+    /// \param bytes number of bytes
+    /// \return reference to *this
+    inline Hasher& update(const void * const data, usize_t bytes) noexcept
+    {
+        const uchar_t *p = static_cast<const uchar_t*>(data);
+        while (bytes)
+        {
+            if (_bufLen == cBufferSize)
+                _consumeBuffer();
+            // consume whole buffers directly from the input while more
+            // input follows them
+            if (!_bufLen && bytes > cBufferSize)
+            {
+                const usize_t stripes = (bytes - 1) / _detail::_cHashStripe;
+                const usize_t n = stripes * _detail::_cHashStripe;
+                _detail::_hashStripesDispatch(_acc,p,stripes,
+                    _consumed / _detail::_cHashStripe);
+                __builtin_memcpy(_last,p + n - _detail::_cHashStripe,
+                    _detail::_cHashStripe);
+                _consumed += n;
+                p += n;
+                bytes -= n;
+            }
+            const usize_t take = bytes < cBufferSize - _bufLen
+                ? bytes : cBufferSize - _bufLen;
+            __builtin_memcpy(_buf + _bufLen,p,take);
+            _bufLen += take;
+            p += take;
+            bytes -= take;
+        }
+        return *this;
+    }
+
+    /// \brief add characters
+    /// \param ptr pointer to the characters
+    /// \param len number of characters
+    /// \return reference to *this
+    template <typename CharType>
+    inline Hasher& update(const CharType * const ptr, const usize_t len)
+        noexcept
+    {
+        return update(static_cast<const void*>(ptr),len * sizeof(CharType));
+    }
+
+    /// \brief add a null-terminated string (excluding the terminator)
+    /// \param ptr the string (null adds nothing)
+    /// \return reference to *this
+    template <typename CharType>
+    inline Hasher& update(const CharType * const ptr) noexcept
+    {
+        if (!ptr)
+            return *this;
+        return update(ptr,simd::strLen(ptr));
+    }
+
+    /// \brief add a CString (excluding the terminator)
+    template <typename CharType, bool allowNull, typename AllocType>
+    inline Hasher& update(const CString<CharType,allowNull,AllocType> &str)
+        noexcept
+    {
+        return update(str.ptr());
+    }
+
+    /// \brief total number of bytes added
+    [[nodiscard]] inline usize_t len() const noexcept
+    {
+        return _consumed + _bufLen;
+    }
+
+    /// \brief hash of all data added (more data can be added afterward)
+    /// \return same value as hashBytes() of all the data with the seed
+    [[nodiscard]] inline uint64_t digest() const noexcept
+    {
+        if (!_consumed)
+            return _detail::_hashBytes(_buf,_bufLen,_seed,
+                _detail::_hashStripesDispatch);
+        alignas(32) uint64_t acc[8];
+        for (usize_t i = 0; i < 8; ++i)
+            acc[i] = _acc[i];
+        // _bufLen is at least 1 when input was consumed
+        _detail::_hashStripesDispatch(acc,_buf,
+            (_bufLen - 1) / _detail::_cHashStripe,
+            _consumed / _detail::_cHashStripe);
+        if (_bufLen >= _detail::_cHashStripe)
+            _detail::_hashStripeScalar(acc,
+                _buf + _bufLen - _detail::_cHashStripe,_detail::_cHashLastKey);
+        else
+        {
+            // last 64 bytes span the consumed and buffered input
+            uchar_t last[_detail::_cHashStripe];
+            const usize_t prev = _detail::_cHashStripe - _bufLen;
+            __builtin_memcpy(last,_last + _bufLen,prev);
+            __builtin_memcpy(last + prev,_buf,_bufLen);
+            _detail::_hashStripeScalar(acc,last,_detail::_cHashLastKey);
+        }
+        return _detail::_hashMerge(acc,len());
+    }
+};
+
+/// \brief hash an array of characters ignoring ASCII case
+/// \tparam CharType character type
+/// \param ptr pointer to the characters
+/// \param len number of characters
+/// \param seed seed value
+/// \return hashChars() of the characters with A-Z mapped to a-z
+///
+/// The characters are lowered with simd::memToLowerCase() into a stack buffer
+/// and hashed from there (streamed with a Hasher for long input), so the
+/// input is not copied to the heap.
+template <typename CharType>
+[[nodiscard]] inline uint64_t hashCharsIgnoreCase(const CharType * const ptr,
+    const usize_t len, const uint64_t seed = 0) noexcept
+{
+    constexpr usize_t cChunk = Hasher::cBufferSize / sizeof(CharType);
+    CharType buf[cChunk];
+    if (len <= cChunk)
+    {
+        simd::memToLowerCase(buf,ptr,len);
+        return hashChars(buf,len,seed);
+    }
+    Hasher hasher(seed);
+    for (usize_t i = 0; i < len; i += cChunk)
+    {
+        const usize_t n = len - i < cChunk ? len - i : cChunk;
+        simd::memToLowerCase(buf,ptr+i,n);
+        hasher.update(buf,n);
+    }
+    return hasher.digest();
+}
+
+/// \brief hash a null-terminated string ignoring ASCII case
+/// \tparam CharType character type
+/// \param ptr the string (null is hashed like the empty string)
+/// \param seed seed value
+/// \return 64 bit hash value (equal to hashCharsIgnoreCase() with the string
+/// length)
+template <typename CharType>
+[[nodiscard]] inline uint64_t hashCStringIgnoreCase(
+    const CharType * const ptr, const uint64_t seed = 0) noexcept
+{
+    return hashCharsIgnoreCase(ptr,ptr ? simd::strLen(ptr) : 0,seed);
+}
+
+/// \brief hash function object for C strings and CStrings
+/// \tparam CharType character type
+///
+/// This is transparent, so hash containers keyed by CString can be searched
+/// with a C string without constructing a CString.
+template <typename CharType>
+struct CStringHash
+{
+    using is_transparent = void;
+
+    [[nodiscard]] inline std::size_t operator()(
+        const CharType * const ptr) const noexcept
+    {
+        return static_cast<std::size_t>(hashCString(ptr));
+    }
+
+    template <bool allowNull, typename AllocType>
+    [[nodiscard]] inline std::size_t operator()(
+        const CString<CharType,allowNull,AllocType> &str) const noexcept
+    {
+        return static_cast<std::size_t>(hashCString(str.ptr()));
+    }
+};
+
+/// \brief hash function object for C strings and CStrings ignoring ASCII
+/// case (use with CStringEqualIgnoreCase)
+/// \tparam CharType character type
+template <typename CharType>
+struct CStringHashIgnoreCase
+{
+    using is_transparent = void;
+
+    [[nodiscard]] inline std::size_t operator()(
+        const CharType * const ptr) const noexcept
+    {
+        return static_cast<std::size_t>(hashCStringIgnoreCase(ptr));
+    }
+
+    template <bool allowNull, typename AllocType>
+    [[nodiscard]] inline std::size_t operator()(
+        const CString<CharType,allowNull,AllocType> &str) const noexcept
+    {
+        return static_cast<std::size_t>(hashCStringIgnoreCase(str.ptr()));
+    }
+};
+
+/// \brief equality function object for C strings and CStrings ignoring
+/// ASCII case (see CString::ptrCmpEqIgnoreCase())
+/// \tparam CharType character type
+template <typename CharType>
+class CStringEqualIgnoreCase
+{
+private:
+
+    /// characters of a C string
+    [[nodiscard]] static inline const CharType* _ptrOf(
+        const CharType * const ptr) noexcept
+    {
+        return ptr;
+    }
+
+    /// characters of a CString
+    template <bool allowNull, typename AllocType>
+    [[nodiscard]] static inline const CharType* _ptrOf(
+        const CString<CharType,allowNull,AllocType> &str) noexcept
+    {
+        return str.ptr();
+    }
+
+public:
+
+    using is_transparent = void;
+
+    template <typename Type1, typename Type2>
+    [[nodiscard]] inline bool operator()(
+        const Type1 &left, const Type2 &right) const noexcept
+    {
+        return CString<CharType>::ptrCmpEqIgnoreCase(
+            _ptrOf(left),_ptrOf(right));
+    }
+};
+
+} // namespace tkoz::stl
+
+/// \brief hash of a CString (null hashes like the empty string)
+template <typename CharType, bool allowNull, typename AllocType>
+struct std::hash<tkoz::stl::CString<CharType,allowNull,AllocType>>
+    : tkoz::stl::CStringHash<CharType> {};
@@ -0,0 +1,433 @@
+///
+/// interned C strings (each distinct value stored once)
+///
+
+#pragma once
+
+#include <tkoz/stl/Allocator.hpp>
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/CStringSimd.hpp>
+#include <tkoz/stl/Hash.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <compare>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+
+namespace tkoz::stl
+{
+
+template <typename CharType>
+class InternPool;
+
+namespace _detail
+{
+
+/// \brief stored interned value, followed by the null-terminated characters
+struct _InternEntry
+{
+    /// hash of the characters
+    uint64_t hash;
+
+    /// number of characters (excludes null terminator)
+    usize_t len;
+};
+
+} // namespace _detail
+
+/// \brief handle to a string stored in an InternPool
+/// \tparam CharType character type
+///
+/// Equal strings interned in the same pool have the same handle, so equality
+/// and hashing are constant time pointer and stored value operations. The
+/// length is also stored. Handles are small, trivially copyable, and valid
+/// as long as the pool exists. Comparing handles from different pools is not
+/// meaningful (except for ordering, which compares the characters). A default
+/// constructed handle is null.
+template <typename _CharType = char>
+class InternedCString
+{
+public:
+
+    /// character type
+    using CharType = _CharType;
+
+private:
+
+    friend class InternPool<CharType>;
+
+    /// the stored entry or nullptr
+    const _detail::_InternEntry *_entry;
+
+    [[nodiscard]] inline explicit InternedCString(
+        const _detail::_InternEntry * const entry) noexcept
+        : _entry(entry) {}
+
+public:
+
+    /// \brief initialize as null
+    [[nodiscard]] inline InternedCString() noexcept: _entry(nullptr) {}
+
+    /// \brief pointer to the null-terminated value
+    /// \return C string pointer (nullptr if null)
+    [[nodiscard]] inline const CharType* ptr() const noexcept
+    {
+        return _entry ? reinterpret_cast<const CharType*>(_entry + 1)
+            : nullptr;
+    }
+
+    /// \brief length of the string (constant time)
+    /// \return number of characters (0 if null)
+    [[nodiscard]] inline usize_t len() const noexcept
+    {
+        return _entry ? _entry->len : 0;
+    }
+
+    /// \brief length of the string (constant time)
+    /// \return number of characters (0 if null)
+    [[nodiscard]] inline usize_t size() const noexcept
+    {
+        return len();
+    }
+
+    /// \brief hash of the value (constant time, stored with the string)
+    /// \return hash value (0 if null)
+    [[nodiscard]] inline uint64_t hash() const noexcept
+    {
+        return _entry ? _entry->hash : 0;
+    }
+
+    /// \brief is the handle null
+    [[nodiscard]] inline bool isNull() const noexcept
+    {
+        return !_entry;
+    }
+
+    /// \brief true if non null and non empty
+    [[nodiscard]] inline explicit operator bool() const noexcept
+    {
+        return _entry && _entry->len;
+    }
+
+    /// \brief allocate a copy of the value
+    /// \return CString with the same value (null if this is null)
+    template <typename StringType = CString<CharType>>
+    [[nodiscard]] inline StringType toCString() const
+    {
+        return StringType(ptr());
+    }
+
+    /// \brief (const) access to a character
+    /// \param i the index (valid range is [0,len()])
+    [[nodiscard]] inline const CharType& operator[](
+        const usize_t i) const noexcept
+    {
+        return ptr()[i];
+    }
+
+    /// \brief compare equality (constant time, same pool only)
+    [[nodiscard]] friend inline bool operator==(
+        const InternedCString left, const InternedCString right) noexcept
+    {
+        return left._entry == right._entry;
+    }
+
+    /// \brief compare equality with a C string (linear time)
+    [[nodiscard]] friend inline bool operator==(
+        const InternedCString left, const CharType * const right) noexcept
+    {
+        return CString<CharType>::ptrCmpEq(left.ptr(),right);
+    }
+
+    /// \brief compare the characters (3 way, null is lowest)
+    [[nodiscard]] friend inline auto operator<=>(
+        const InternedCString left, const InternedCString right) noexcept
+    {
+        if (left._entry == right._entry)
+            return 0 <=> 0;
+        return CString<CharType>::ptrCmp3way(left.ptr(),right.ptr());
+    }
+};
+
+/// \brief memory and lookup statistics of an InternPool
+struct InternStats
+{
+    /// number of intern() calls
+    usize_t lookups;
+
+    /// number of intern() calls finding an existing string
+    usize_t hits;
+
+    /// number of distinct strings stored
+    usize_t strings;
+
+    /// bytes of characters stored (including null terminators)
+    usize_t bytesStored;
+
+    /// bytes allocated for string storage and hash tables
+    usize_t bytesReserved;
+
+    /// \brief fraction of lookups finding an existing string
+    [[nodiscard]] inline double hitRate() const noexcept
+    {
+        return lookups ? static_cast<double>(hits) / lookups : 0.0;
+    }
+};
+
+/// \brief pool storing each distinct string once
+/// \tparam CharType character type
+///
+/// Strings are copied into arena storage the first time they are interned and
+/// never freed until the pool is destroyed. The table is split into shards,
+/// each with its own mutex, arena, and open addressing hash table, selected by
+/// the high bits of the hash. This makes interning thread safe while threads
+/// working on different strings rarely wait on each other.
+template <typename _CharType = char>
+class InternPool
+{
+public:
+
+    /// character type
+    using CharType = _CharType;
+
+    /// handle type returned by intern()
+    using HandleType = InternedCString<CharType>;
+
+    /// number of shards (power of 2)
+    static constexpr usize_t cShards = 64;
+
+    /// initial hash table capacity of each shard (power of 2)
+    static constexpr usize_t cInitialCapacity = 16;
+
+private:
+
+    using _Entry = _detail::_InternEntry;
+
+    static_assert(sizeof(_Entry) % alignof(CharType) == 0);
+
+    /// one lock, arena, and hash table
+    struct alignas(64) _Shard
+    {
+        /// guards everything in the shard
+        std::mutex mutex;
+
+        /// storage for entries
+        Arena arena{16 * 1024};
+
+        /// open addressing table (linear probing, nullptr is empty)
+        const _Entry **table = nullptr;
+
+        /// table size (power of 2)
+        usize_t cap = 0;
+
+        /// number of entries
+        usize_t count = 0;
+
+        /// number of lookups
+        usize_t lookups = 0;
+
+        /// number of lookups finding an existing entry
+        usize_t hits = 0;
+
+        /// characters stored (including null terminators)
+        usize_t chars = 0;
+
+        inline ~_Shard()
+        {
+            delete[] table;
+        }
+    };
+
+    /// the shards (each on its own cache lines)
+    _Shard _shards[cShards];
+
+    /// shard for a hash value
+    [[nodiscard]] inline _Shard& _shardFor(const uint64_t hash) noexcept
+    {
+        return _shards[hash >> (64 - __builtin_ctzll(cShards))];
+    }
+
+    /// table slot with the value or the empty slot to insert it
+    [[nodiscard]] static inline usize_t _probe(const _Shard &shard,
+        const uint64_t hash, const CharType * const ptr, const usize_t len)
+        noexcept
+    {
+        const usize_t mask = shard.cap - 1;
+        usize_t i = static_cast<usize_t>(hash) & mask;
+        while (const _Entry *e = shard.table[i])
+        {
+            if (e->hash == hash && e->len == len
+                && !__builtin_memcmp(e + 1,ptr,len * sizeof(CharType)))
+                break;
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    /// double the table size (or allocate the initial table)
+    static inline void _growTable(_Shard &shard)
+    {
+        const usize_t cap = shard.cap ? 2 * shard.cap : cInitialCapacity;
+        const _Entry **table = new const _Entry*[cap]();
+        for (usize_t i = 0; i < shard.cap; ++i)
+        {
+            const _Entry *e = shard.table[i];
+            if (!e)
+                continue;
+            usize_t j = static_cast<usize_t>(e->hash) & (cap - 1);
+            while (table[j])
+                j = (j + 1) & (cap - 1);
+            table[j] = e;
+        }
+        delete[] shard.table;
+        shard.table = table;
+        shard.cap = cap;
+    }
+
+public:
+
+    /// \brief initialize an empty pool
+    [[nodiscard]] inline InternPool() = default;
+
+    InternPool(const InternPool&) = delete;
+    InternPool& operator=(const InternPool&) = delete;
+
+    /// \brief hash function used for interned strings
+    /// \param ptr pointer to the characters
+    /// \param len number of characters
+    [[nodiscard]] static inline uint64_t hash(
+        const CharType * const ptr, const usize_t len) noexcept
+    {
+        return hashChars(ptr,len);
+    }
+
+    /// \brief get the handle for a string, storing it if it is new
+    /// \param ptr pointer to len characters (no null characters)
+    /// \param len number of characters
+    /// \return handle (equal for equal strings)
+    [[nodiscard]] inline HandleType intern(
+        const CharType * const ptr, const usize_t len)
+    {
+        const uint64_t h = hash(ptr,len);
+        _Shard &shard = _shardFor(h);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        ++shard.lookups;
+        usize_t i = 0;
+        if (shard.cap)
+        {
+            i = _probe(shard,h,ptr,len);
+            if (shard.table[i])
+            {
+                ++shard.hits;
+                return HandleType(shard.table[i]);
+            }
+        }
+        // keep load factor at most 1/2 (only when inserting)
+        if (2 * (shard.count + 1) > shard.cap)
+        {
+            _growTable(shard);
+            i = _probe(shard,h,ptr,len);
+        }
+        void *mem = shard.arena.allocate(
+            sizeof(_Entry) + (len + 1) * sizeof(CharType),alignof(_Entry));
+        _Entry *e = static_cast<_Entry*>(mem);
+        e->hash = h;
+        e->len = len;
+        CharType *chars = reinterpret_cast<CharType*>(e + 1);
+        simd::copyChars(chars,ptr,len);
+        chars[len] = static_cast<CharType>(0);
+        shard.table[i] = e;
+        ++shard.count;
+        shard.chars += len + 1;
+        return HandleType(e);
+    }
+
+    /// \brief get the handle for a C string, storing it if it is new
+    /// \param ptr null-terminated string (nullptr gives the null handle)
+    /// \return handle (equal for equal strings)
+    [[nodiscard]] inline HandleType intern(const CharType * const ptr)
+    {
+        if (!ptr)
+            return HandleType();
+        return intern(ptr,simd::strLen(ptr));
+    }
+
+    /// \brief get the handle for a CString, storing it if it is new
+    /// \param str the string (null gives the null handle)
+    /// \return handle (equal for equal strings)
+    template <bool allowNull, typename AllocType>
+    [[nodiscard]] inline HandleType intern(
+        const CString<CharType,allowNull,AllocType> &str)
+    {
+        return intern(str.ptr());
+    }
+
+    /// \brief find a string without storing it
+    /// \param ptr pointer to len characters
+    /// \param len number of characters
+    /// \return handle, or the null handle if the string was never interned
+    [[nodiscard]] inline HandleType find(
+        const CharType * const ptr, const usize_t len)
+    {
+        const uint64_t h = hash(ptr,len);
+        _Shard &shard = _shardFor(h);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (!shard.cap)
+            return HandleType();
+        return HandleType(shard.table[_probe(shard,h,ptr,len)]);
+    }
+
+    /// \brief find a C string without storing it
+    /// \param ptr null-terminated string
+    /// \return handle, or the null handle if the string was never interned
+    [[nodiscard]] inline HandleType find(const CharType * const ptr)
+    {
+        if (!ptr)
+            return HandleType();
+        return find(ptr,simd::strLen(ptr));
+    }
+
+    /// \brief number of distinct strings stored
+    [[nodiscard]] inline usize_t size()
+    {
+        usize_t ret = 0;
+        for (_Shard &shard : _shards)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            ret += shard.count;
+        }
+        return ret;
+    }
+
+    /// \brief memory and hit rate statistics
+    /// \return totals over all shards
+    [[nodiscard]] inline InternStats stats()
+    {
+        InternStats ret{};
+        for (_Shard &shard : _shards)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            ret.lookups += shard.lookups;
+            ret.hits += shard.hits;
+            ret.strings += shard.count;
+            ret.bytesStored += shard.chars * sizeof(CharType);
+            ret.bytesReserved += shard.arena.bytesReserved()
+                + shard.cap * sizeof(const _Entry*);
+        }
+        return ret;
+    }
+};
+
+} // namespace tkoz::stl
+
+/// \brief hash of an interned string (the stored hash)
+template <typename CharType>
+struct std::hash<tkoz::stl::InternedCString<CharType>>
+{
+    [[nodiscard]] inline std::size_t operator()(
+        const tkoz::stl::InternedCString<CharType> str) const noexcept
+    {
+        return static_cast<std::size_t>(str.hash());
+    }
+};
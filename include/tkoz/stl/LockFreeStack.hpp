@@ -0,0 +1,255 @@
+///
+/// lock free stack and free list using AtomicSixBytePointer
+///
+
+#pragma once
+
+#include <tkoz/stl/AtomicSixBytePointer.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <atomic>
+#include <new>
+#include <utility>
+
+namespace tkoz::stl
+{
+
+namespace _detail
+{
+
+/// node for the lock free structures (storage first so a Type* converts)
+template <typename Type>
+struct _LockFreeNode
+{
+    /// space for one object
+    alignas(Type) uchar_t storage[sizeof(Type)];
+
+    /// next node in the stack (atomic since a stale pop may read it)
+    std::atomic<_LockFreeNode*> next;
+};
+
+/// push a chain of linked nodes first..last onto a stack
+template <typename Node>
+inline void _lfPush(AtomicSixBytePointer<Node> &top, Node * const first,
+    Node * const last) noexcept
+{
+    typename AtomicSixBytePointer<Node>::ValueType old =
+        top.load(std::memory_order_relaxed);
+    do
+        last->next.store(old.ptr(),std::memory_order_relaxed);
+    while (!top.compareExchangeWeak(old,first,std::memory_order_release,
+        std::memory_order_relaxed));
+}
+
+/// pop a node from a stack (nullptr if empty)
+///
+/// Reading next from a node that another thread already popped is safe since
+/// nodes are not freed while the structure exists, and the counter makes the
+/// compare and swap fail if the top changed in between.
+template <typename Node>
+[[nodiscard]] inline Node* _lfPop(AtomicSixBytePointer<Node> &top) noexcept
+{
+    typename AtomicSixBytePointer<Node>::ValueType old =
+        top.load(std::memory_order_acquire);
+    while (old.ptr() && !top.compareExchangeWeak(old,
+        old.ptr()->next.load(std::memory_order_relaxed),
+        std::memory_order_acquire,std::memory_order_acquire));
+    return old.ptr();
+}
+
+} // namespace _detail
+
+/// \brief lock free free list of fixed size blocks
+/// \tparam Type type of the objects that blocks are used for
+///
+/// allocate() and deallocate() may be called from any number of threads.
+/// Free blocks are kept in a Treiber stack whose top is an
+/// AtomicSixBytePointer, so both are one compare and swap in the common case.
+/// When there are no free blocks, a chunk of blocks is allocated with new and
+/// pushed to the free stack together. Memory is only returned to the system
+/// by the destructor.
+///
+/// Each block has sizeof(Type) bytes aligned for Type, followed by a link.
+/// The first block of each chunk links the chunks instead. Objects are not
+/// constructed or destroyed, like an allocator.
+template <typename Type>
+class LockFreeFreeList
+{
+private:
+
+    using _Node = _detail::_LockFreeNode<Type>;
+
+    /// free blocks
+    AtomicSixBytePointer<_Node> _free;
+
+    /// allocated chunks (only pushed until destruction)
+    AtomicSixBytePointer<_Node> _chunks;
+
+    /// blocks per chunk (including the chunk link)
+    usize_t _chunkSize;
+
+    /// number of usable blocks allocated
+    std::atomic<usize_t> _capacity;
+
+    /// allocate a chunk and push all but one of its blocks
+    /// \return the remaining block
+    [[nodiscard]] inline _Node* _refill()
+    {
+        _Node *chunk = new _Node[_chunkSize];
+        _detail::_lfPush(_chunks,chunk,chunk);
+        for (usize_t i = 2; i + 1 < _chunkSize; ++i)
+            chunk[i].next.store(chunk + i + 1,std::memory_order_relaxed);
+        if (_chunkSize > 2)
+            _detail::_lfPush(_free,chunk + 2,chunk + _chunkSize - 1);
+        _capacity.fetch_add(_chunkSize - 1,std::memory_order_relaxed);
+        return chunk + 1;
+    }
+
+public:
+
+    /// \brief construct without allocating
+    /// \param chunkSize blocks allocated together when none are free (at
+    /// least 1)
+    [[nodiscard]] inline explicit LockFreeFreeList(
+        const usize_t chunkSize = 64) noexcept
+        : _chunkSize((chunkSize ? chunkSize : 1) + 1), _capacity(0) {}
+
+    /// \brief free all memory (blocks must no longer be used)
+    inline ~LockFreeFreeList()
+    {
+        _Node *chunk = _chunks.load(std::memory_order_acquire).ptr();
+        while (chunk)
+        {
+            _Node *next = chunk->next.load(std::memory_order_relaxed);
+            delete[] chunk;
+            chunk = next;
+        }
+    }
+
+    LockFreeFreeList(const LockFreeFreeList&) = delete;
+    LockFreeFreeList& operator=(const LockFreeFreeList&) = delete;
+
+    /// \brief get a block
+    /// \return uninitialized memory for one Type
+    /// \throw std::bad_alloc if a new chunk cannot be allocated
+    [[nodiscard]] inline Type* allocate()
+    {
+        _Node *node = _detail::_lfPop(_free);
+        if (!node) [[unlikely]]
+            node = _refill();
+        return reinterpret_cast<Type*>(node);
+    }
+
+    /// \brief return a block
+    /// \param ptr block from allocate() (any object in it is destroyed)
+    inline void deallocate(Type * const ptr) noexcept
+    {
+        _Node *node = reinterpret_cast<_Node*>(ptr);
+        _detail::_lfPush(_free,node,node);
+    }
+
+    /// \brief number of blocks allocated from the system
+    [[nodiscard]] inline usize_t capacity() const noexcept
+    {
+        return _capacity.load(std::memory_order_relaxed);
+    }
+};
+
+/// \brief lock free stack (Treiber stack)
+/// \tparam Type element type (move assignment should not throw)
+///
+/// push() and tryPop() may be called from any number of threads. The top is
+/// an AtomicSixBytePointer so the compare and swap in tryPop() fails if the
+/// top was popped and pushed again in between (ABA). Nodes come from a
+/// LockFreeFreeList and are recycled, so steady state use does not call new.
+template <typename Type>
+class TreiberStack
+{
+private:
+
+    using _Node = _detail::_LockFreeNode<Type>;
+
+    /// top of the stack
+    AtomicSixBytePointer<_Node> _top;
+
+    /// memory for nodes
+    LockFreeFreeList<Type> _nodes;
+
+public:
+
+    /// \brief construct an empty stack
+    /// \param chunkSize nodes allocated together when none are free
+    [[nodiscard]] inline explicit TreiberStack(
+        const usize_t chunkSize = 64) noexcept: _nodes(chunkSize) {}
+
+    /// \brief destroy remaining elements
+    inline ~TreiberStack()
+    {
+        _Node *node = _top.load(std::memory_order_acquire).ptr();
+        while (node)
+        {
+            reinterpret_cast<Type*>(node)->~Type();
+            node = node->next.load(std::memory_order_relaxed);
+        }
+    }
+
+    TreiberStack(const TreiberStack&) = delete;
+    TreiberStack& operator=(const TreiberStack&) = delete;
+
+    /// \brief construct an element on top of the stack
+    /// \param args constructor arguments
+    /// \throw std::bad_alloc or exceptions from the constructor
+    template <typename ...Args>
+    inline void emplace(Args&& ...args)
+    {
+        Type *ptr = _nodes.allocate();
+        try
+        {
+            new (ptr) Type(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            _nodes.deallocate(ptr);
+            throw;
+        }
+        _Node *node = reinterpret_cast<_Node*>(ptr);
+        _detail::_lfPush(_top,node,node);
+    }
+
+    /// \brief push an element
+    /// \param value the element
+    inline void push(const Type &value)
+    {
+        emplace(value);
+    }
+
+    /// \brief push an element
+    /// \param value the element
+    inline void push(Type &&value)
+    {
+        emplace(std::move(value));
+    }
+
+    /// \brief remove the top element
+    /// \param value assigned the element if there is one
+    /// \return true if an element was removed, false if the stack was empty
+    inline bool tryPop(Type &value) noexcept
+    {
+        _Node *node = _detail::_lfPop(_top);
+        if (!node)
+            return false;
+        Type *ptr = reinterpret_cast<Type*>(node);
+        value = std::move(*ptr);
+        ptr->~Type();
+        _nodes.deallocate(ptr);
+        return true;
+    }
+
+    /// \brief is the stack empty (may be outdated when it returns)
+    [[nodiscard]] inline bool empty() const noexcept
+    {
+        return !_top.load(std::memory_order_acquire).ptr();
+    }
+};
+
+} // namespace tkoz::stl
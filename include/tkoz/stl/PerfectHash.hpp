@@ -0,0 +1,348 @@
+///
+/// compile time perfect hash tables for fixed sets of string keys
+///
+
+#pragma once
+
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/CStringSimd.hpp>
+#include <tkoz/stl/CStringView.hpp>
+#include <tkoz/stl/Exceptions.hpp>
+#include <tkoz/stl/Meta.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <iterator>
+
+namespace tkoz::stl
+{
+
+namespace _detail
+{
+
+/// final mix of a 64 bit hash (MurmurHash3 fmix64)
+[[nodiscard]] inline constexpr uint64_t _phMix(uint64_t h) noexcept
+{
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+/// string hash used by PerfectHash (same result at compile and run time)
+template <typename CharType>
+[[nodiscard]] inline constexpr uint64_t _phHash(const CharType * const ptr,
+    const usize_t len, const uint64_t seed) noexcept
+{
+    uint64_t h = seed ^ (len * 0x9E3779B97F4A7C15ull);
+    for (usize_t i = 0; i < len; ++i)
+        h = (std::rotl(h,5) ^ static_cast<uint64_t>(ptr[i]))
+            * 0x517CC1B727220A95ull;
+    return _phMix(h);
+}
+
+/// length of a C string during constant evaluation
+template <typename CharType>
+[[nodiscard]] inline constexpr usize_t _phLen(const CharType *ptr) noexcept
+{
+    usize_t l = 0;
+    while (ptr[l])
+        ++l;
+    return l;
+}
+
+/// characters needed to store all keys with null terminators
+template <typename CharType>
+[[nodiscard]] inline constexpr usize_t _phTotalChars(
+    const CharType * const * const keys, const usize_t count) noexcept
+{
+    usize_t ret = 0;
+    for (usize_t i = 0; i < count; ++i)
+        ret += _phLen(keys[i]) + 1;
+    return ret;
+}
+
+} // namespace _detail
+
+/// \brief collision free hash table for a fixed set of string keys
+/// \tparam CharType character type
+/// \tparam count number of keys
+/// \tparam totalChars characters in all keys including null terminators
+///
+/// Construct with makePerfectHash() during compile time. Lookup finds the
+/// index of a key in the array it was built from, or npos, by hashing the
+/// string once, reading a displacement and a slot, and comparing against the
+/// single candidate key, so there is no probing and only the final compare
+/// branches on the data. This replaces a chain of CString::ptrCmpEq() calls
+/// when dispatching on a known set of names.
+///
+/// The keys are copied into the object, so a constexpr table has no pointers
+/// to relocate and is placed entirely in read only data.
+///
+/// The table is built with hash and displace: keys are grouped into buckets
+/// by their hash and, largest bucket first, each bucket gets the smallest
+/// displacement moving all of its keys into free slots. There are about 1.5
+/// to 3 slots per key and 4 slots per bucket. If some keys cannot be placed,
+/// another hash seed is tried.
+template <typename _CharType, usize_t _count, usize_t _totalChars>
+class PerfectHash
+{
+public:
+
+    /// character type
+    using CharType = _CharType;
+
+    /// number of keys
+    static constexpr usize_t cCount = _count;
+
+    /// number of slots (power of 2)
+    static constexpr usize_t cSlots = std::bit_ceil(cCount + cCount / 2);
+
+    /// number of displacement buckets (power of 2)
+    static constexpr usize_t cBuckets = cSlots < 4 ? 1 : cSlots / 4;
+
+    /// index value meaning not found
+    static constexpr usize_t npos = static_cast<usize_t>(-1);
+
+    static_assert(cCount > 0, "perfect hash table requires at least 1 key");
+
+private:
+
+    /// key index type stored in slots
+    using _IndexType = meta::Conditional<(cCount <= 0xFFFF),uint16_t,uint32_t>;
+
+    /// displacement attempts before trying another seed
+    static constexpr uint32_t _cMaxDisplace = 1u << 16;
+
+    /// seed for the string hash
+    uint64_t _seed = 0;
+
+    /// displacement for each bucket
+    uint32_t _disp[cBuckets] = {};
+
+    /// key index for each slot (unused slots have index 0)
+    _IndexType _slots[cSlots] = {};
+
+    /// start of each key in _chars (and the end of all keys)
+    uint32_t _offsets[cCount+1] = {};
+
+    /// all keys with null terminators
+    CharType _chars[_totalChars] = {};
+
+    /// bucket of a hash
+    [[nodiscard]] static inline constexpr usize_t _bucketOf(
+        const uint64_t h) noexcept
+    {
+        return static_cast<usize_t>(h >> 32) & (cBuckets - 1);
+    }
+
+    /// slot of a hash with a displacement
+    [[nodiscard]] static inline constexpr usize_t _slotOf(
+        const uint64_t h, const uint32_t d) noexcept
+    {
+        return static_cast<usize_t>(_detail::_phMix(h ^ d)) & (cSlots - 1);
+    }
+
+    /// try to place all keys using a seed
+    /// \return false if the seed does not work
+    consteval bool _build(const uint64_t seed)
+    {
+        // discard what a failed seed placed
+        for (uint32_t &d : _disp)
+            d = 0;
+        for (_IndexType &slot : _slots)
+            slot = 0;
+        std::array<uint64_t,cCount> hashes{};
+        for (usize_t i = 0; i < cCount; ++i)
+            hashes[i] = _detail::_phHash(_chars + _offsets[i],
+                _offsets[i+1] - _offsets[i] - 1,seed);
+        // group keys by bucket, largest buckets first
+        std::array<usize_t,cBuckets> sizes{};
+        for (usize_t i = 0; i < cCount; ++i)
+            ++sizes[_bucketOf(hashes[i])];
+        std::array<usize_t,cCount> order{};
+        for (usize_t i = 0; i < cCount; ++i)
+            order[i] = i;
+        std::sort(order.begin(),order.end(),[&](usize_t a, usize_t b)
+        {
+            const usize_t ba = _bucketOf(hashes[a]);
+            const usize_t bb = _bucketOf(hashes[b]);
+            return sizes[ba] != sizes[bb] ? sizes[ba] > sizes[bb] : ba < bb;
+        });
+        std::array<bool,cSlots> used{};
+        std::array<usize_t,cSlots> placed{};
+        for (usize_t i = 0; i < cCount;)
+        {
+            const usize_t bucket = _bucketOf(hashes[order[i]]);
+            const usize_t end = i + sizes[bucket];
+            for (uint32_t d = 0;; ++d)
+            {
+                if (d == _cMaxDisplace)
+                    return false;
+                usize_t j = i;
+                for (; j < end; ++j)
+                {
+                    const usize_t slot = _slotOf(hashes[order[j]],d);
+                    if (used[slot])
+                        break;
+                    used[slot] = true;
+                    placed[j - i] = slot;
+                }
+                if (j == end)
+                {
+                    _disp[bucket] = d;
+                    for (usize_t k = i; k < end; ++k)
+                        _slots[placed[k - i]] =
+                            static_cast<_IndexType>(order[k]);
+                    break;
+                }
+                // undo partial placement
+                for (usize_t k = i; k < j; ++k)
+                    used[placed[k - i]] = false;
+            }
+            i = end;
+        }
+        _seed = seed;
+        return true;
+    }
+
+    /// compare key i with a string
+    [[nodiscard]] inline constexpr bool _keyEq(const usize_t i,
+        const CharType * const ptr, const usize_t len) const noexcept
+    {
+        const CharType *key = _chars + _offsets[i];
+        const usize_t keyLen = _offsets[i+1] - _offsets[i] - 1;
+        if consteval
+        {
+            if (keyLen != len)
+                return false;
+            for (usize_t j = 0; j < len; ++j)
+                if (key[j] != ptr[j])
+                    return false;
+            return true;
+        }
+        else
+        {
+            return simd::memCmpEq(key,keyLen,ptr,len);
+        }
+    }
+
+    /// index of the only key that a string can be
+    [[nodiscard]] inline constexpr usize_t _candidate(
+        const CharType * const ptr, const usize_t len) const noexcept
+    {
+        const uint64_t h = _detail::_phHash(ptr,len,_seed);
+        return _slots[_slotOf(h,_disp[_bucketOf(h)])];
+    }
+
+public:
+
+    /// \brief build the table (see makePerfectHash())
+    /// \param keys array of cCount distinct null-terminated keys
+    /// \throw ArgumentError (at compile time) if a key is repeated
+    consteval explicit PerfectHash(const CharType * const * const keys)
+    {
+        usize_t off = 0;
+        for (usize_t i = 0; i < cCount; ++i)
+        {
+            _offsets[i] = static_cast<uint32_t>(off);
+            const usize_t l = _detail::_phLen(keys[i]);
+            for (usize_t j = 0; j <= l; ++j)
+                _chars[off+j] = keys[i][j];
+            off += l + 1;
+        }
+        _offsets[cCount] = static_cast<uint32_t>(off);
+        for (usize_t i = 0; i < cCount; ++i)
+            for (usize_t j = 0; j < i; ++j)
+                if (_keyEq(j,_chars + _offsets[i],
+                        _offsets[i+1] - _offsets[i] - 1))
+                    throw ArgumentError("perfect hash keys must be distinct");
+        uint64_t seed = 0;
+        while (!_build(seed))
+            ++seed;
+    }
+
+    /// \brief number of keys
+    [[nodiscard]] inline constexpr usize_t size() const noexcept
+    {
+        return cCount;
+    }
+
+    /// \brief key by index
+    /// \param i index in the array the table was built from (< size())
+    /// \return view of the key (also null-terminated)
+    [[nodiscard]] inline constexpr CStringView<CharType> key(
+        const usize_t i) const noexcept
+    {
+        return CStringView<CharType>(_chars + _offsets[i],
+            _offsets[i+1] - _offsets[i] - 1);
+    }
+
+    /// \brief find a key
+    /// \param ptr pointer to len characters (may be nullptr if len is 0)
+    /// \param len number of characters
+    /// \return index of the key or npos if it is not a key
+    [[nodiscard]] inline constexpr usize_t find(const CharType * const ptr,
+        const usize_t len) const noexcept
+    {
+        const usize_t i = _candidate(ptr,len);
+        return _keyEq(i,ptr,len) ? i : npos;
+    }
+
+    /// \brief find a key
+    /// \param str view of the string (CString, SmallCString, ...)
+    /// \return index of the key or npos if it is not a key
+    [[nodiscard]] inline constexpr usize_t find(
+        const CStringView<CharType> str) const noexcept
+    {
+        return find(str.ptr(),str.len());
+    }
+
+    /// \brief find a key
+    /// \param ptr null-terminated C string (not null)
+    /// \return index of the key or npos if it is not a key
+    [[nodiscard]] inline usize_t find(const CharType * const ptr) const noexcept
+    {
+        // compare up to the terminators since a length compare followed by
+        // memcmp of the key length reads past a shorter literal on a path
+        // that gcc -O1 does not prove unreachable (-Wstringop-overread)
+        const usize_t i = _candidate(ptr,CString<CharType,false>::ptrLen(ptr));
+        return simd::strCmpEq(_chars + _offsets[i],ptr) ? i : npos;
+    }
+
+    /// \brief is a string one of the keys
+    /// \param str view of the string
+    /// \return true if it is a key
+    [[nodiscard]] inline constexpr bool contains(
+        const CStringView<CharType> str) const noexcept
+    {
+        return find(str) != npos;
+    }
+};
+
+/// \brief build a perfect hash table at compile time
+/// \tparam keys constexpr array (or std::array) of distinct null-terminated
+/// keys
+/// \return PerfectHash mapping each key to its index in keys
+///
+/// For example:
+///     static constexpr const char *cmds[] = {"get","set","del"};
+///     static constexpr auto cmdTable = makePerfectHash<cmds>();
+///     switch (cmdTable.find(name)) { case 0: ... }
+/// Repeated keys are a compile error.
+template <const auto &keys>
+[[nodiscard]] consteval auto makePerfectHash()
+{
+    using CharType = meta::RemoveCV<meta::RemovePointer<
+        meta::RemoveCVRef<decltype(keys[0])>>>;
+    constexpr usize_t count = std::size(keys);
+    constexpr usize_t totalChars =
+        _detail::_phTotalChars<CharType>(std::data(keys),count);
+    return PerfectHash<CharType,count,totalChars>(std::data(keys));
+}
+
+} // namespace tkoz::stl
@@ -0,0 +1,1313 @@
+///
+/// adaptive radix tree (ordered map with string keys)
+///
+
+#pragma once
+
+#include <tkoz/stl/CStringSimd.hpp>
+#include <tkoz/stl/CStringView.hpp>
+#include <tkoz/stl/Exceptions.hpp>
+#include <tkoz/stl/Types.hpp>
+#include <tkoz/stl/Utils.hpp>
+
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if __x86_64__
+#include <immintrin.h>
+#endif
+
+namespace tkoz::stl
+{
+
+/// \brief ordered map from strings to values (adaptive radix tree)
+/// \tparam ValueType mapped type
+/// \tparam CharType key character type (byte sized)
+///
+/// This is a trie branching on one byte per level, where each inner node has
+/// one of 4 sizes (4, 16, 48, or 256 children) chosen by how many children it
+/// has, so sparse nodes stay small and dense nodes are direct lookups. Runs of
+/// bytes with a single child are stored in the node (path compression), up to
+/// 8 bytes inline, with longer ones verified against the key in the leaf.
+/// Node16 is searched with SSE2 compares of all 16 keys at once.
+///
+/// Keys are strings without null characters (inserting one throws
+/// ArgumentError), and a key is stored with its null terminator so no key is
+/// a prefix of another. Keys are copied into leaves with their values.
+/// Iteration visits keys in the same order as CString comparison of
+/// null-terminated strings (see CString::ptrCmp3way()).
+template <typename _ValueType, typename _CharType = char>
+class RadixTree
+{
+public:
+
+    /// mapped type
+    using ValueType = _ValueType;
+
+    /// key character type
+    using CharType = _CharType;
+
+    /// key type for lookups
+    using KeyType = CStringView<CharType>;
+
+    static_assert(simd::isByteChar<CharType>,
+        "RadixTree requires byte sized characters");
+
+    /// maximum path compression bytes stored in a node
+    static constexpr usize_t cMaxPrefix = 8;
+
+    /// \brief stored key and value (leaf of the tree)
+    class Entry
+    {
+    private:
+
+        friend class RadixTree;
+
+        /// the mapped value
+        ValueType _value;
+
+        /// key length (the null-terminated key follows this object)
+        usize_t _len;
+
+        template <typename ...Args>
+        [[nodiscard]] inline Entry(const usize_t len, Args&&... args)
+            : _value(fwdRef<Args>(args)...), _len(len) {}
+
+    public:
+
+        Entry(const Entry&) = delete;
+        Entry& operator=(const Entry&) = delete;
+
+        /// \brief the key (null-terminated)
+        [[nodiscard]] inline KeyType key() const noexcept
+        {
+            return KeyType(reinterpret_cast<const CharType*>(this + 1),_len);
+        }
+
+        /// \brief the mapped value
+        [[nodiscard]] inline ValueType& value() noexcept
+        {
+            return _value;
+        }
+
+        /// \brief the mapped value
+        [[nodiscard]] inline const ValueType& value() const noexcept
+        {
+            return _value;
+        }
+    };
+
+    static_assert(sizeof(Entry) % alignof(CharType) == 0);
+
+private:
+
+    /// node or tagged leaf pointer (leaf if the low bit is set)
+    using _Ptr = void*;
+
+    enum _NodeType : uint8_t { _cNode4, _cNode16, _cNode48, _cNode256 };
+
+    /// common node header
+    struct _Node
+    {
+        /// size class
+        _NodeType type;
+
+        /// number of children
+        uint16_t count;
+
+        /// length of the compressed path
+        uint32_t prefixLen;
+
+        /// first bytes of the compressed path
+        uchar_t prefix[cMaxPrefix];
+    };
+
+    struct _Node4 : _Node
+    {
+        uchar_t keys[4];
+        _Ptr children[4];
+    };
+
+    struct _Node16 : _Node
+    {
+        alignas(16) uchar_t keys[16];
+        _Ptr children[16];
+    };
+
+    struct _Node48 : _Node
+    {
+        /// 1 + index into children for each byte (0 if absent)
+        uchar_t index[256];
+        _Ptr children[48];
+    };
+
+    struct _Node256 : _Node
+    {
+        _Ptr children[256];
+    };
+
+    /// root node or leaf
+    _Ptr _root;
+
+    /// number of keys
+    usize_t _size;
+
+    /// bytes allocated for nodes and leaves
+    usize_t _bytes;
+
+    //
+    // keys and leaves
+    //
+
+    /// byte of a character (unsigned order matches CharType order)
+    [[nodiscard]] static inline uchar_t _byte(const CharType c) noexcept
+    {
+        constexpr uchar_t flip = std::is_signed_v<CharType> ? 0x80 : 0;
+        return static_cast<uchar_t>(static_cast<uchar_t>(c) ^ flip);
+    }
+
+    /// byte at index i of a key (i at most the length, the terminator)
+    [[nodiscard]] static inline uchar_t _keyByte(
+        const KeyType key, const usize_t i) noexcept
+    {
+        return i < key.len() ? _byte(key[i]) : _byte(CharType(0));
+    }
+
+    [[nodiscard]] static inline bool _isLeaf(const _Ptr p) noexcept
+    {
+        return reinterpret_cast<uintptr_t>(p) & 1;
+    }
+
+    [[nodiscard]] static inline Entry* _leaf(const _Ptr p) noexcept
+    {
+        return reinterpret_cast<Entry*>(reinterpret_cast<uintptr_t>(p) - 1);
+    }
+
+    [[nodiscard]] static inline _Ptr _tag(Entry * const e) noexcept
+    {
+        return reinterpret_cast<_Ptr>(reinterpret_cast<uintptr_t>(e) + 1);
+    }
+
+    [[nodiscard]] static inline _Node* _node(const _Ptr p) noexcept
+    {
+        return static_cast<_Node*>(p);
+    }
+
+    [[nodiscard]] static inline usize_t _leafBytes(const usize_t len) noexcept
+    {
+        return sizeof(Entry) + (len + 1) * sizeof(CharType);
+    }
+
+    template <typename ...Args>
+    [[nodiscard]] inline _Ptr _newLeaf(const KeyType key, Args&&... args)
+    {
+        const usize_t bytes = _leafBytes(key.len());
+        void *mem = ::operator new(bytes,std::align_val_t(alignof(Entry)));
+        Entry *e;
+        try
+        {
+            e = new (mem) Entry(key.len(),fwdRef<Args>(args)...);
+        }
+        catch (...)
+        {
+            ::operator delete(mem,std::align_val_t(alignof(Entry)));
+            throw;
+        }
+        CharType *chars = reinterpret_cast<CharType*>(e + 1);
+        if (key.len())
+            simd::copyChars(chars,key.ptr(),key.len());
+        chars[key.len()] = CharType(0);
+        _bytes += bytes;
+        return _tag(e);
+    }
+
+    inline void _freeLeaf(Entry * const e) noexcept
+    {
+        _bytes -= _leafBytes(e->_len);
+        e->~Entry();
+        ::operator delete(static_cast<void*>(e),
+            std::align_val_t(alignof(Entry)));
+    }
+
+    /// does a leaf have a key
+    [[nodiscard]] static inline bool _leafMatches(
+        const Entry * const e, const KeyType key) noexcept
+    {
+        return e->key() == key;
+    }
+
+    //
+    // nodes
+    //
+
+    template <typename NodeType>
+    [[nodiscard]] inline NodeType* _newNode(const _NodeType type)
+    {
+        NodeType *n = new NodeType();
+        n->type = type;
+        _bytes += sizeof(NodeType);
+        return n;
+    }
+
+    inline void _freeNode(_Node * const n) noexcept
+    {
+        switch (n->type)
+        {
+        case _cNode4:
+            _bytes -= sizeof(_Node4);
+            delete static_cast<_Node4*>(n);
+            break;
+        case _cNode16:
+            _bytes -= sizeof(_Node16);
+            delete static_cast<_Node16*>(n);
+            break;
+        case _cNode48:
+            _bytes -= sizeof(_Node48);
+            delete static_cast<_Node48*>(n);
+            break;
+        case _cNode256:
+            _bytes -= sizeof(_Node256);
+            delete static_cast<_Node256*>(n);
+            break;
+        }
+    }
+
+    /// copy the header (type excluded) of a node being replaced
+    static inline void _copyHeader(_Node * const dst, const _Node * const src)
+        noexcept
+    {
+        dst->count = src->count;
+        dst->prefixLen = src->prefixLen;
+        for (usize_t i = 0; i < cMaxPrefix; ++i)
+            dst->prefix[i] = src->prefix[i];
+    }
+
+    /// index of a byte in a Node16 (or 16 if absent)
+    [[nodiscard]] static inline usize_t _find16(
+        const _Node16 * const n, const uchar_t b) noexcept
+    {
+#if __x86_64__
+        const __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(b)),
+            _mm_load_si128(reinterpret_cast<const __m128i*>(n->keys)));
+        const uint_t mask = static_cast<uint_t>(_mm_movemask_epi8(cmp))
+            & ((1u << n->count) - 1);
+        return mask ? static_cast<usize_t>(__builtin_ctz(mask)) : 16;
+#else
+        for (usize_t i = 0; i < n->count; ++i)
+            if (n->keys[i] == b)
+                return i;
+        return 16;
+#endif
+    }
+
+    /// number of keys in a Node16 less than a byte (insert position)
+    [[nodiscard]] static inline usize_t _lowerBound16(
+        const _Node16 * const n, const uchar_t b) noexcept
+    {
+#if __x86_64__
+        // signed compare after flipping the high bit is an unsigned compare
+        const __m128i flip = _mm_set1_epi8(static_cast<char>(0x80));
+        const __m128i keys = _mm_xor_si128(flip,
+            _mm_load_si128(reinterpret_cast<const __m128i*>(n->keys)));
+        const __m128i lt = _mm_cmplt_epi8(keys,
+            _mm_xor_si128(flip,_mm_set1_epi8(static_cast<char>(b))));
+        const uint_t mask = static_cast<uint_t>(_mm_movemask_epi8(lt))
+            & ((1u << n->count) - 1);
+        return static_cast<usize_t>(__builtin_popcount(mask));
+#else
+        usize_t i = 0;
+        while (i < n->count && n->keys[i] < b)
+            ++i;
+        return i;
+#endif
+    }
+
+    /// pointer to the child slot for a byte (nullptr if absent)
+    [[nodiscard]] static inline _Ptr* _findChild(
+        _Node * const n, const uchar_t b) noexcept
+    {
+        switch (n->type)
+        {
+        case _cNode4:
+        {
+            _Node4 *n4 = static_cast<_Node4*>(n);
+            for (usize_t i = 0; i < n4->count; ++i)
+                if (n4->keys[i] == b)
+                    return &n4->children[i];
+            return nullptr;
+        }
+        case _cNode16:
+        {
+            _Node16 *n16 = static_cast<_Node16*>(n);
+            const usize_t i = _find16(n16,b);
+            return i < 16 ? &n16->children[i] : nullptr;
+        }
+        case _cNode48:
+        {
+            _Node48 *n48 = static_cast<_Node48*>(n);
+            return n48->index[b] ? &n48->children[n48->index[b] - 1]
+                : nullptr;
+        }
+        default:
+        {
+            _Node256 *n256 = static_cast<_Node256*>(n);
+            return n256->children[b] ? &n256->children[b] : nullptr;
+        }
+        }
+    }
+
+    /// first child with a byte at least from (nullptr if none)
+    [[nodiscard]] static inline _Ptr _nextChild(const _Node * const n,
+        const uint_t from, uchar_t &b) noexcept
+    {
+        switch (n->type)
+        {
+        case _cNode4:
+        {
+            const _Node4 *n4 = static_cast<const _Node4*>(n);
+            for (usize_t i = 0; i < n4->count; ++i)
+                if (n4->keys[i] >= from)
+                {
+                    b = n4->keys[i];
+                    return n4->children[i];
+                }
+            return nullptr;
+        }
+        case _cNode16:
+        {
+            const _Node16 *n16 = static_cast<const _Node16*>(n);
+            for (usize_t i = 0; i < n16->count; ++i)
+                if (n16->keys[i] >= from)
+                {
+                    b = n16->keys[i];
+                    return n16->children[i];
+                }
+            return nullptr;
+        }
+        case _cNode48:
+        {
+            const _Node48 *n48 = static_cast<const _Node48*>(n);
+            for (uint_t i = from; i < 256; ++i)
+                if (n48->index[i])
+                {
+                    b = static_cast<uchar_t>(i);
+                    return n48->children[n48->index[i] - 1];
+                }
+            return nullptr;
+        }
+        default:
+        {
+            const _Node256 *n256 = static_cast<const _Node256*>(n);
+            for (uint_t i = from; i < 256; ++i)
+                if (n256->children[i])
+                {
+                    b = static_cast<uchar_t>(i);
+                    return n256->children[i];
+                }
+            return nullptr;
+        }
+        }
+    }
+
+    /// leaf with the smallest key below a node
+    [[nodiscard]] static inline Entry* _minimum(_Ptr p) noexcept
+    {
+        uchar_t b;
+        while (!_isLeaf(p))
+            p = _nextChild(_node(p),0,b);
+        return _leaf(p);
+    }
+
+    /// add a child to a Node4 with room (keeps keys sorted)
+    static inline void _addChild4(_Node4 * const n, const uchar_t b,
+        const _Ptr child) noexcept
+    {
+        usize_t i = 0;
+        while (i < n->count && n->keys[i] < b)
+            ++i;
+        for (usize_t j = n->count; j > i; --j)
+        {
+            n->keys[j] = n->keys[j-1];
+            n->children[j] = n->children[j-1];
+        }
+        n->keys[i] = b;
+        n->children[i] = child;
+        ++n->count;
+    }
+
+    /// add a child to a node with room (keeps keys sorted)
+    static inline void _addChildNoGrow(_Node * const n, const uchar_t b,
+        const _Ptr child) noexcept
+    {
+        switch (n->type)
+        {
+        case _cNode4:
+            _addChild4(static_cast<_Node4*>(n),b,child);
+            return;
+        case _cNode16:
+        {
+            _Node16 *n16 = static_cast<_Node16*>(n);
+            const usize_t i = _lowerBound16(n16,b);
+            for (usize_t j = n16->count; j > i; --j)
+            {
+                n16->keys[j] = n16->keys[j-1];
+                n16->children[j] = n16->children[j-1];
+            }
+            n16->keys[i] = b;
+            n16->children[i] = child;
+            break;
+        }
+        case _cNode48:
+        {
+            _Node48 *n48 = static_cast<_Node48*>(n);
+            usize_t i = 0;
+            while (n48->children[i])
+                ++i;
+            n48->children[i] = child;
+            n48->index[b] = static_cast<uchar_t>(i + 1);
+            break;
+        }
+        default:
+            static_cast<_Node256*>(n)->children[b] = child;
+            break;
+        }
+        ++n->count;
+    }
+
+    /// add a child, replacing the node with a larger one if it is full
+    inline void _addChild(_Ptr &ref, const uchar_t b, const _Ptr child)
+    {
+        _Node *n = _node(ref);
+        switch (n->type)
+        {
+        case _cNode4:
+            if (n->count == 4)
+            {
+                _Node4 *n4 = static_cast<_Node4*>(n);
+                _Node16 *g = _newNode<_Node16>(_cNode16);
+                _copyHeader(g,n4);
+                for (usize_t i = 0; i < 4; ++i)
+                {
+                    g->keys[i] = n4->keys[i];
+                    g->children[i] = n4->children[i];
+                }
+                _freeNode(n4);
+                ref = n = g;
+            }
+            break;
+        case _cNode16:
+            if (n->count == 16)
+            {
+                _Node16 *n16 = static_cast<_Node16*>(n);
+                _Node48 *g = _newNode<_Node48>(_cNode48);
+                _copyHeader(g,n16);
+                for (usize_t i = 0; i < 16; ++i)
+                {
+                    g->children[i] = n16->children[i];
+                    g->index[n16->keys[i]] = static_cast<uchar_t>(i + 1);
+                }
+                _freeNode(n16);
+                ref = n = g;
+            }
+            break;
+        case _cNode48:
+            if (n->count == 48)
+            {
+                _Node48 *n48 = static_cast<_Node48*>(n);
+                _Node256 *g = _newNode<_Node256>(_cNode256);
+                _copyHeader(g,n48);
+                for (usize_t i = 0; i < 256; ++i)
+                    if (n48->index[i])
+                        g->children[i] = n48->children[n48->index[i] - 1];
+                _freeNode(n48);
+                ref = n = g;
+            }
+            break;
+        default:
+            break;
+        }
+        _addChildNoGrow(n,b,child);
+    }
+
+    /// remove a child, replacing the node with a smaller one if it is sparse
+    inline void _removeChild(_Ptr &ref, const uchar_t b) noexcept
+    {
+        _Node *n = _node(ref);
+        switch (n->type)
+        {
+        case _cNode4:
+        {
+            _Node4 *n4 = static_cast<_Node4*>(n);
+            usize_t i = 0;
+            while (n4->keys[i] != b)
+                ++i;
+            for (; i + 1 < n4->count; ++i)
+            {
+                n4->keys[i] = n4->keys[i+1];
+                n4->children[i] = n4->children[i+1];
+            }
+            if (--n4->count == 1)
+                _collapse(ref);
+            break;
+        }
+        case _cNode16:
+        {
+            _Node16 *n16 = static_cast<_Node16*>(n);
+            usize_t i = _find16(n16,b);
+            for (; i + 1 < n16->count; ++i)
+            {
+                n16->keys[i] = n16->keys[i+1];
+                n16->children[i] = n16->children[i+1];
+            }
+            if (--n16->count == 3)
+            {
+                _Node4 *s = _newNodeNoThrow<_Node4>(_cNode4);
+                if (!s)
+                    break;
+                _copyHeader(s,n16);
+                for (usize_t j = 0; j < 3; ++j)
+                {
+                    s->keys[j] = n16->keys[j];
+                    s->children[j] = n16->children[j];
+                }
+                _freeNode(n16);
+                ref = s;
+            }
+            break;
+        }
+        case _cNode48:
+        {
+            _Node48 *n48 = static_cast<_Node48*>(n);
+            n48->children[n48->index[b] - 1] = nullptr;
+            n48->index[b] = 0;
+            if (--n48->count == 12)
+            {
+                _Node16 *s = _newNodeNoThrow<_Node16>(_cNode16);
+                if (!s)
+                    break;
+                _copyHeader(s,n48);
+                usize_t j = 0;
+                for (usize_t k = 0; k < 256; ++k)
+                    if (n48->index[k])
+                    {
+                        s->keys[j] = static_cast<uchar_t>(k);
+                        s->children[j++] = n48->children[n48->index[k] - 1];
+                    }
+                _freeNode(n48);
+                ref = s;
+            }
+            break;
+        }
+        default:
+        {
+            _Node256 *n256 = static_cast<_Node256*>(n);
+            n256->children[b] = nullptr;
+            if (--n256->count == 37)
+            {
+                _Node48 *s = _newNodeNoThrow<_Node48>(_cNode48);
+                if (!s)
+                    break;
+                _copyHeader(s,n256);
+                usize_t j = 0;
+                for (usize_t k = 0; k < 256; ++k)
+                    if (n256->children[k])
+                    {
+                        s->children[j] = n256->children[k];
+                        s->index[k] = static_cast<uchar_t>(++j);
+                    }
+                _freeNode(n256);
+                ref = s;
+            }
+            break;
+        }
+        }
+    }
+
+    /// node allocation for shrinking (keeps the larger node on failure)
+    template <typename NodeType>
+    [[nodiscard]] inline NodeType* _newNodeNoThrow(const _NodeType type)
+        noexcept
+    {
+        NodeType *n = new (std::nothrow) NodeType();
+        if (n)
+        {
+            n->type = type;
+            _bytes += sizeof(NodeType);
+        }
+        return n;
+    }
+
+    /// replace a Node4 having 1 child by the child (joining the paths)
+    inline void _collapse(_Ptr &ref) noexcept
+    {
+        _Node4 *n = static_cast<_Node4*>(_node(ref));
+        const _Ptr child = n->children[0];
+        if (!_isLeaf(child))
+        {
+            _Node *c = _node(child);
+            uchar_t prefix[cMaxPrefix];
+            usize_t len = 0;
+            for (; len < n->prefixLen && len < cMaxPrefix; ++len)
+                prefix[len] = n->prefix[len];
+            if (len < cMaxPrefix)
+                prefix[len++] = n->keys[0];
+            for (usize_t i = 0; i < c->prefixLen && len < cMaxPrefix; ++i)
+                prefix[len++] = c->prefix[i];
+            for (usize_t i = 0; i < len; ++i)
+                c->prefix[i] = prefix[i];
+            c->prefixLen += n->prefixLen + 1;
+        }
+        _freeNode(n);
+        ref = child;
+    }
+
+    /// number of compressed path bytes matching a key from depth (the
+    /// stored bytes and the rest from a leaf when the path is longer)
+    [[nodiscard]] static inline usize_t _prefixMismatch(const _Node * const n,
+        const KeyType key, const usize_t depth) noexcept
+    {
+        usize_t i = 0;
+        const usize_t stored = n->prefixLen < cMaxPrefix
+            ? n->prefixLen : cMaxPrefix;
+        for (; i < stored; ++i)
+            if (n->prefix[i] != _keyByte(key,depth + i)
+                    || depth + i == key.len())
+                return i;
+        if (n->prefixLen > cMaxPrefix)
+        {
+            const KeyType leafKey = _minimum(const_cast<_Node*>(n))->key();
+            for (; i < n->prefixLen; ++i)
+                if (_keyByte(leafKey,depth + i) != _keyByte(key,depth + i)
+                        || depth + i == key.len())
+                    return i;
+        }
+        return i;
+    }
+
+    /// find the leaf slot for a key
+    [[nodiscard]] inline Entry* _find(const KeyType key) const noexcept
+    {
+        _Ptr p = _root;
+        usize_t depth = 0;
+        while (p)
+        {
+            if (_isLeaf(p))
+            {
+                Entry *e = _leaf(p);
+                return _leafMatches(e,key) ? e : nullptr;
+            }
+            _Node *n = _node(p);
+            if (n->prefixLen)
+            {
+                // only the stored bytes, the leaf is compared at the end
+                const usize_t stored = n->prefixLen < cMaxPrefix
+                    ? n->prefixLen : cMaxPrefix;
+                for (usize_t i = 0; i < stored; ++i)
+                    if (depth + i > key.len()
+                            || n->prefix[i] != _keyByte(key,depth + i))
+                        return nullptr;
+                depth += n->prefixLen;
+            }
+            if (depth > key.len())
+                return nullptr;
+            _Ptr *c = _findChild(n,_keyByte(key,depth));
+            if (!c)
+                return nullptr;
+            p = *c;
+            ++depth;
+        }
+        return nullptr;
+    }
+
+    /// insert a key if absent
+    /// \return the leaf and whether it was inserted
+    template <typename ...Args>
+    inline std::pair<Entry*,bool> _insert(const KeyType key, Args&&... args)
+    {
+        // a null character would match the terminator of a shorter key
+        if (simd::memChr(key.ptr(),key.len(),CharType(0)) != key.len())
+            throw ArgumentError("RadixTree key contains a null character");
+        _Ptr *ref = &_root;
+        usize_t depth = 0;
+        for (;;)
+        {
+            const _Ptr p = *ref;
+            if (!p)
+            {
+                *ref = _newLeaf(key,fwdRef<Args>(args)...);
+                ++_size;
+                return {_leaf(*ref),true};
+            }
+            if (_isLeaf(p))
+            {
+                Entry *e = _leaf(p);
+                const KeyType other = e->key();
+                if (other == key)
+                    return {e,false};
+                // both keys end with a unique terminator so they differ
+                usize_t l = 0;
+                while (_keyByte(other,depth + l) == _keyByte(key,depth + l))
+                    ++l;
+                const _Ptr leaf = _newLeaf(key,fwdRef<Args>(args)...);
+                _Node4 *n;
+                try
+                {
+                    n = _newNode<_Node4>(_cNode4);
+                }
+                catch (...)
+                {
+                    _freeLeaf(_leaf(leaf));
+                    throw;
+                }
+                n->prefixLen = static_cast<uint32_t>(l);
+                for (usize_t i = 0; i < l && i < cMaxPrefix; ++i)
+                    n->prefix[i] = _keyByte(key,depth + i);
+                _addChild4(n,_keyByte(other,depth + l),p);
+                _addChild4(n,_keyByte(key,depth + l),leaf);
+                *ref = n;
+                ++_size;
+                return {_leaf(leaf),true};
+            }
+            _Node *n = _node(p);
+            if (n->prefixLen)
+            {
+                const usize_t m = _prefixMismatch(n,key,depth);
+                if (m < n->prefixLen)
+                {
+                    // split the path: new node with the common part
+                    const _Ptr leaf = _newLeaf(key,fwdRef<Args>(args)...);
+                    _Node4 *s;
+                    try
+                    {
+                        s = _newNode<_Node4>(_cNode4);
+                    }
+                    catch (...)
+                    {
+                        _freeLeaf(_leaf(leaf));
+                        throw;
+                    }
+                    s->prefixLen = static_cast<uint32_t>(m);
+                    for (usize_t i = 0; i < m && i < cMaxPrefix; ++i)
+                        s->prefix[i] = n->prefix[i];
+                    uchar_t nb;
+                    if (n->prefixLen <= cMaxPrefix)
+                    {
+                        nb = n->prefix[m];
+                        n->prefixLen -= static_cast<uint32_t>(m + 1);
+                        for (usize_t i = 0; i < n->prefixLen; ++i)
+                            n->prefix[i] = n->prefix[m + 1 + i];
+                    }
+                    else
+                    {
+                        // stored bytes may be too short, use a leaf
+                        const KeyType leafKey = _minimum(n)->key();
+                        nb = _keyByte(leafKey,depth + m);
+                        n->prefixLen -= static_cast<uint32_t>(m + 1);
+                        for (usize_t i = 0; i < n->prefixLen
+                                && i < cMaxPrefix; ++i)
+                            n->prefix[i] = _keyByte(leafKey,depth + m + 1 + i);
+                    }
+                    _addChild4(s,nb,n);
+                    _addChild4(s,_keyByte(key,depth + m),leaf);
+                    *ref = s;
+                    ++_size;
+                    return {_leaf(leaf),true};
+                }
+                depth += n->prefixLen;
+            }
+            const uchar_t b = _keyByte(key,depth);
+            _Ptr *c = _findChild(n,b);
+            if (c)
+            {
+                ref = c;
+                ++depth;
+                continue;
+            }
+            const _Ptr leaf = _newLeaf(key,fwdRef<Args>(args)...);
+            try
+            {
+                _addChild(*ref,b,leaf);
+            }
+            catch (...)
+            {
+                _freeLeaf(_leaf(leaf));
+                throw;
+            }
+            ++_size;
+            return {_leaf(leaf),true};
+        }
+    }
+
+    static_assert(cMaxPrefix >= sizeof(_Node*));
+
+    /// free a leaf now or link an inner node to a list of nodes to free
+    /// (the link is stored in the prefix bytes, which are no longer needed)
+    inline void _destroyPush(const _Ptr p, _Node *&list) noexcept
+    {
+        if (_isLeaf(p))
+        {
+            _freeLeaf(_leaf(p));
+            return;
+        }
+        _Node *n = _node(p);
+        __builtin_memcpy(n->prefix,&list,sizeof(list));
+        list = n;
+    }
+
+    /// free all nodes and leaves (without allocating or recursing)
+    inline void _destroy() noexcept
+    {
+        if (!_root)
+            return;
+        _Node *list = nullptr;
+        _destroyPush(_root,list);
+        while (list)
+        {
+            _Node *n = list;
+            __builtin_memcpy(&list,n->prefix,sizeof(list));
+            uchar_t b = 0;
+            for (_Ptr c = _nextChild(n,0,b); c; c = b < 255
+                    ? _nextChild(n,b + 1u,b) : nullptr)
+                _destroyPush(c,list);
+            _freeNode(n);
+        }
+        _root = nullptr;
+        _size = 0;
+    }
+
+    /// node containing exactly the keys starting with a prefix
+    [[nodiscard]] inline _Ptr _seekPrefix(const KeyType prefix) const noexcept
+    {
+        _Ptr p = _root;
+        usize_t depth = 0;
+        while (p)
+        {
+            if (_isLeaf(p))
+                return _leaf(p)->key().startsWith(prefix) ? p : nullptr;
+            _Node *n = _node(p);
+            const KeyType leafKey = n->prefixLen > cMaxPrefix
+                ? _minimum(n)->key() : KeyType();
+            for (usize_t i = 0; i < n->prefixLen
+                    && depth + i < prefix.len(); ++i)
+            {
+                const uchar_t b = i < cMaxPrefix ? n->prefix[i]
+                    : _keyByte(leafKey,depth + i);
+                if (b != _byte(prefix[depth + i]))
+                    return nullptr;
+            }
+            if (depth + n->prefixLen >= prefix.len())
+                return p;
+            depth += n->prefixLen;
+            _Ptr *c = _findChild(n,_byte(prefix[depth]));
+            if (!c)
+                return nullptr;
+            p = *c;
+            ++depth;
+        }
+        return nullptr;
+    }
+
+    /// inner node on the path of an iterator and the byte of the child taken
+    struct _IterFrame
+    {
+        const _Node *node;
+        uchar_t byte;
+    };
+
+    /// \brief forward iterator over entries in key order
+    /// \tparam isConst whether entries are accessed as const
+    ///
+    /// This keeps the path from the starting node to the current leaf, so
+    /// copying an iterator allocates. Inserting or erasing keys invalidates
+    /// iterators.
+    template <bool isConst>
+    class _IteratorImpl
+    {
+    public:
+
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Entry;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<isConst,const Entry*,Entry*>;
+        using reference = std::conditional_t<isConst,const Entry&,Entry&>;
+
+    private:
+
+        friend class RadixTree;
+
+        template <bool>
+        friend class _IteratorImpl;
+
+        /// inner nodes on the path and the byte of the child taken
+        std::vector<_IterFrame> _stack;
+
+        /// current leaf (nullptr at the end)
+        Entry *_entry;
+
+        /// go to the smallest leaf below p
+        inline void _descend(_Ptr p)
+        {
+            while (!_isLeaf(p))
+            {
+                uchar_t b = 0;
+                const _Node *n = _node(p);
+                p = _nextChild(n,0,b);
+                _stack.push_back({n,b});
+            }
+            _entry = _leaf(p);
+        }
+
+        [[nodiscard]] inline explicit _IteratorImpl(const _Ptr start)
+            : _entry(nullptr)
+        {
+            if (start)
+                _descend(start);
+        }
+
+    public:
+
+        /// \brief end iterator
+        [[nodiscard]] inline _IteratorImpl() noexcept: _entry(nullptr) {}
+
+        /// \brief const iterator from a non const iterator
+        template <bool otherConst>
+            requires (isConst && !otherConst)
+        [[nodiscard]] inline _IteratorImpl(
+            const _IteratorImpl<otherConst> &other)
+            : _stack(other._stack), _entry(other._entry) {}
+
+        [[nodiscard]] inline reference operator*() const noexcept
+        {
+            return *_entry;
+        }
+
+        [[nodiscard]] inline pointer operator->() const noexcept
+        {
+            return _entry;
+        }
+
+        inline _IteratorImpl& operator++()
+        {
+            while (!_stack.empty())
+            {
+                _IterFrame &f = _stack.back();
+                uchar_t b = 0;
+                const _Ptr c = f.byte < 255
+                    ? _nextChild(f.node,f.byte + 1u,b) : nullptr;
+                if (c)
+                {
+                    f.byte = b;
+                    _descend(c);
+                    return *this;
+                }
+                _stack.pop_back();
+            }
+            _entry = nullptr;
+            return *this;
+        }
+
+        inline _IteratorImpl operator++(int)
+        {
+            _IteratorImpl ret = *this;
+            ++*this;
+            return ret;
+        }
+
+        /// \brief compare the current entries
+        [[nodiscard]] friend inline bool operator==(
+            const _IteratorImpl &left, const _IteratorImpl &right) noexcept
+        {
+            return left._entry == right._entry;
+        }
+    };
+
+    /// \brief entries with keys starting with a prefix (see prefixScan())
+    /// \tparam isConst whether entries are accessed as const
+    template <bool isConst>
+    class _PrefixRangeImpl
+    {
+    private:
+
+        friend class RadixTree;
+
+        /// node containing the entries
+        _Ptr _start;
+
+        [[nodiscard]] inline explicit _PrefixRangeImpl(
+            const _Ptr start) noexcept
+            : _start(start) {}
+
+    public:
+
+        [[nodiscard]] inline _IteratorImpl<isConst> begin() const
+        {
+            return _IteratorImpl<isConst>(_start);
+        }
+
+        [[nodiscard]] inline _IteratorImpl<isConst> end() const noexcept
+        {
+            return _IteratorImpl<isConst>();
+        }
+
+        /// \brief are there no entries
+        [[nodiscard]] inline bool empty() const noexcept
+        {
+            return !_start;
+        }
+    };
+
+public:
+
+    /// iterator with mutable access to values
+    using Iterator = _IteratorImpl<false>;
+
+    /// iterator with const access to entries
+    using ConstIterator = _IteratorImpl<true>;
+
+    /// range of entries with mutable access to values
+    using PrefixRange = _PrefixRangeImpl<false>;
+
+    /// range of entries with const access to entries
+    using ConstPrefixRange = _PrefixRangeImpl<true>;
+
+    /// \brief initialize an empty tree
+    [[nodiscard]] inline RadixTree() noexcept
+        : _root(nullptr), _size(0), _bytes(0) {}
+
+    RadixTree(const RadixTree&) = delete;
+    RadixTree& operator=(const RadixTree&) = delete;
+
+    /// \brief take the entries of another tree
+    [[nodiscard]] inline RadixTree(RadixTree &&other) noexcept
+        : _root(other._root), _size(other._size), _bytes(other._bytes)
+    {
+        other._root = nullptr;
+        other._size = 0;
+        other._bytes = 0;
+    }
+
+    /// \brief take the entries of another tree
+    inline RadixTree& operator=(RadixTree &&other) noexcept
+    {
+        if (this != &other)
+        {
+            _destroy();
+            swap(_root,other._root);
+            swap(_size,other._size);
+            swap(_bytes,other._bytes);
+        }
+        return *this;
+    }
+
+    inline ~RadixTree()
+    {
+        _destroy();
+    }
+
+    /// \brief number of keys
+    [[nodiscard]] inline usize_t size() const noexcept
+    {
+        return _size;
+    }
+
+    /// \brief are there no keys
+    [[nodiscard]] inline bool empty() const noexcept
+    {
+        return !_size;
+    }
+
+    /// \brief bytes allocated for nodes and entries (including keys)
+    [[nodiscard]] inline usize_t memoryUsage() const noexcept
+    {
+        return sizeof(*this) + _bytes;
+    }
+
+    /// \brief remove all keys
+    inline void clear() noexcept
+    {
+        _destroy();
+    }
+
+    /// \brief find the value for a key
+    /// \param key the key (C string, CString, CStringView, ...)
+    /// \return pointer to the value or nullptr if the key is absent
+    [[nodiscard]] inline ValueType* find(const KeyType key) noexcept
+    {
+        Entry *e = _find(key);
+        return e ? &e->_value : nullptr;
+    }
+
+    /// \brief find the value for a key
+    [[nodiscard]] inline const ValueType* find(const KeyType key)
+        const noexcept
+    {
+        const Entry *e = _find(key);
+        return e ? &e->_value : nullptr;
+    }
+
+    /// \brief is a key present
+    [[nodiscard]] inline bool contains(const KeyType key) const noexcept
+    {
+        return _find(key);
+    }
+
+    /// \brief insert a key if absent, constructing the value in place
+    /// \param key the key (no null characters)
+    /// \param args value constructor arguments (unused if the key exists)
+    /// \return the value for the key and whether it was inserted
+    /// \throw ArgumentError if the key contains a null character
+    template <typename ...Args>
+    inline std::pair<ValueType*,bool> emplace(const KeyType key,
+        Args&&... args)
+    {
+        const auto [e,inserted] = _insert(key,fwdRef<Args>(args)...);
+        return {&e->_value,inserted};
+    }
+
+    /// \brief insert a key if absent
+    /// \param key the key (no null characters)
+    /// \param value the value (unused if the key exists)
+    /// \return the value for the key and whether it was inserted
+    /// \throw ArgumentError if the key contains a null character
+    inline std::pair<ValueType*,bool> insert(const KeyType key,
+        const ValueType &value)
+    {
+        return emplace(key,value);
+    }
+
+    /// \brief insert a key or replace its value
+    /// \param key the key (no null characters)
+    /// \param value the new value
+    /// \return true if the key was inserted, false if it was replaced
+    /// \throw ArgumentError if the key contains a null character
+    template <typename ArgType>
+    inline bool insertOrAssign(const KeyType key, ArgType &&value)
+    {
+        const auto [e,inserted] = _insert(key,fwdRef<ArgType>(value));
+        if (!inserted)
+            e->_value = fwdRef<ArgType>(value);
+        return inserted;
+    }
+
+    /// \brief value for a key, inserting a default constructed one if absent
+    /// \throw ArgumentError if the key contains a null character
+    inline ValueType& operator[](const KeyType key)
+    {
+        return _insert(key).first->_value;
+    }
+
+    /// \brief remove a key
+    /// \param key the key
+    /// \return true if the key was removed, false if it was absent
+    inline bool erase(const KeyType key) noexcept
+    {
+        _Ptr *ref = &_root;
+        _Ptr *parentRef = nullptr;
+        uchar_t parentByte = 0;
+        usize_t depth = 0;
+        while (*ref)
+        {
+            if (_isLeaf(*ref))
+            {
+                Entry *e = _leaf(*ref);
+                if (!_leafMatches(e,key))
+                    return false;
+                if (parentRef)
+                    _removeChild(*parentRef,parentByte);
+                else
+                    _root = nullptr;
+                _freeLeaf(e);
+                --_size;
+                return true;
+            }
+            _Node *n = _node(*ref);
+            const usize_t stored = n->prefixLen < cMaxPrefix
+                ? n->prefixLen : cMaxPrefix;
+            for (usize_t i = 0; i < stored; ++i)
+                if (depth + i > key.len()
+                        || n->prefix[i] != _keyByte(key,depth + i))
+                    return false;
+            depth += n->prefixLen;
+            if (depth > key.len())
+                return false;
+            parentRef = ref;
+            parentByte = _keyByte(key,depth);
+            ref = _findChild(n,parentByte);
+            if (!ref)
+                return false;
+            ++depth;
+        }
+        return false;
+    }
+
+    /// \brief iterator to the smallest key
+    [[nodiscard]] inline Iterator begin()
+    {
+        return Iterator(_root);
+    }
+
+    /// \brief iterator to the smallest key
+    [[nodiscard]] inline ConstIterator begin() const
+    {
+        return ConstIterator(_root);
+    }
+
+    /// \brief end iterator
+    [[nodiscard]] inline Iterator end() noexcept
+    {
+        return Iterator();
+    }
+
+    /// \brief end iterator
+    [[nodiscard]] inline ConstIterator end() const noexcept
+    {
+        return ConstIterator();
+    }
+
+    /// \brief entries whose keys start with a prefix, in key order
+    /// \param prefix the prefix (the empty prefix gives all entries)
+    /// \return range of the entries (valid until the tree is modified)
+    [[nodiscard]] inline PrefixRange prefixScan(const KeyType prefix) noexcept
+    {
+        return PrefixRange(_seekPrefix(prefix));
+    }
+
+    /// \brief entries whose keys start with a prefix, in key order
+    /// \param prefix the prefix (the empty prefix gives all entries)
+    /// \return range of the entries (valid until the tree is modified)
+    [[nodiscard]] inline ConstPrefixRange prefixScan(
+        const KeyType prefix) const noexcept
+    {
+        return ConstPrefixRange(_seekPrefix(prefix));
+    }
+
+    /// \brief number of inner nodes of each size (4, 16, 48, 256)
+    /// \param counts array of 4 counts to set
+    inline void nodeCounts(usize_t (&counts)[4]) const
+    {
+        for (usize_t &c : counts)
+            c = 0;
+        if (!_root)
+            return;
+        std::vector<_Ptr> stack{_root};
+        while (!stack.empty())
+        {
+            const _Ptr p = stack.back();
+            stack.pop_back();
+            if (_isLeaf(p))
+                continue;
+            const _Node *n = _node(p);
+            ++counts[n->type];
+            uchar_t b = 0;
+            for (_Ptr c = _nextChild(n,0,b); c; c = b < 255
+                    ? _nextChild(n,b + 1u,b) : nullptr)
+                stack.push_back(c);
+        }
+    }
+};
+
+} // namespace tkoz::stl
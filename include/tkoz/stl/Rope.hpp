@@ -0,0 +1,622 @@
+///
+/// rope (balanced tree of string chunks) for large edited strings
+///
+
+#pragma once
+
+#include <tkoz/stl/Allocator.hpp>
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/CStringSimd.hpp>
+#include <tkoz/stl/CStringView.hpp>
+#include <tkoz/stl/Exceptions.hpp>
+#include <tkoz/stl/Types.hpp>
+#include <tkoz/stl/Utils.hpp>
+
+#include <memory>
+#include <new>
+
+namespace tkoz::stl
+{
+
+/// \brief string stored as a balanced tree of chunks
+/// \tparam CharType character type
+///
+/// The characters are split into CString chunks of at most cMaxChunk
+/// characters, stored in order in an implicit treap (a binary search tree
+/// keyed by position with random heap priorities), so insert, erase, and
+/// concatenation take expected logarithmic time in the number of chunks plus
+/// the length of the inserted text, instead of copying the whole string.
+/// Small insertions are copied into an existing chunk when it has room so
+/// the tree does not fill with tiny chunks.
+///
+/// Nodes and chunk characters are allocated from a Pool, which is
+/// Pool::threadLocal() unless one is given. A rope keeps that pool alive, so
+/// it may outlive the thread (such as a static rope), but it must not be
+/// used at the same time as the creating thread uses the pool. Ropes using the
+/// same pool are concatenated without copying. ptr() flattens the rope into a
+/// contiguous CString, which is cached until the rope is modified.
+/// Null characters must not be inserted.
+template <typename _CharType = char>
+class Rope
+{
+public:
+
+    /// character type
+    using CharType = _CharType;
+
+    /// view type for inserted text
+    using ViewType = CStringView<CharType>;
+
+    /// flattened string type (allocated from the pool of the rope)
+    using StringType = CString<CharType,true,PoolAllocator<CharType>>;
+
+    /// index value meaning until the end
+    static constexpr usize_t npos = static_cast<usize_t>(-1);
+
+    /// largest number of characters in a chunk
+    static constexpr usize_t cMaxChunk = 1024;
+
+private:
+
+    /// chunk storage
+    using _ChunkType = CString<CharType,false,PoolAllocator<CharType>>;
+
+    /// tree node with one chunk
+    struct _Node
+    {
+        _Node *left;
+        _Node *right;
+
+        /// total characters in this subtree
+        usize_t size;
+
+        /// characters in this chunk
+        usize_t len;
+
+        /// heap priority (larger is closer to the root)
+        uint32_t priority;
+
+        /// the characters
+        _ChunkType chunk;
+    };
+
+    /// pool for nodes, chunks, and flattened strings
+    Pool *_pool;
+
+    /// keeps Pool::threadLocal() alive (null if the pool was given)
+    std::shared_ptr<Pool> _sharedPool;
+
+    /// root of the tree
+    _Node *_root;
+
+    /// state for node priorities
+    uint64_t _rng;
+
+    /// flattened value (valid if _flatValid)
+    mutable StringType _flat;
+
+    /// is _flat equal to the current value
+    mutable bool _flatValid;
+
+    [[nodiscard]] static inline usize_t _size(const _Node * const t) noexcept
+    {
+        return t ? t->size : 0;
+    }
+
+    static inline void _update(_Node * const t) noexcept
+    {
+        t->size = _size(t->left) + t->len + _size(t->right);
+    }
+
+    [[nodiscard]] inline uint32_t _nextPriority() noexcept
+    {
+        // xorshift64
+        _rng ^= _rng << 13;
+        _rng ^= _rng >> 7;
+        _rng ^= _rng << 17;
+        return static_cast<uint32_t>(_rng >> 32);
+    }
+
+    /// allocate a node holding a copy of len characters
+    [[nodiscard]] inline _Node* _newNode(
+        const CharType * const ptr, const usize_t len)
+    {
+        void *mem = _pool->allocate(sizeof(_Node));
+        try
+        {
+            return new (mem) _Node{nullptr,nullptr,len,len,_nextPriority(),
+                _ChunkType(ptr,len,PoolAllocator<CharType>(*_pool))};
+        }
+        catch (...)
+        {
+            _pool->deallocate(mem);
+            throw;
+        }
+    }
+
+    /// free a subtree
+    inline void _freeTree(_Node * const t) noexcept
+    {
+        if (!t)
+            return;
+        _freeTree(t->left);
+        _freeTree(t->right);
+        t->~_Node();
+        _pool->deallocate(t);
+    }
+
+    /// join 2 trees (all of a before all of b)
+    [[nodiscard]] static inline _Node* _merge(_Node * const a, _Node * const b)
+        noexcept
+    {
+        if (!a)
+            return b;
+        if (!b)
+            return a;
+        if (a->priority > b->priority)
+        {
+            a->right = _merge(a->right,b);
+            _update(a);
+            return a;
+        }
+        b->left = _merge(a,b->left);
+        _update(b);
+        return b;
+    }
+
+    /// split a tree into the first pos characters and the rest
+    /// (a chunk containing position pos is split in 2)
+    inline void _split(_Node * const t, const usize_t pos,
+        _Node *&a, _Node *&b)
+    {
+        if (!t)
+        {
+            a = b = nullptr;
+            return;
+        }
+        const usize_t lsize = _size(t->left);
+        if (pos <= lsize)
+        {
+            _split(t->left,pos,a,t->left);
+            _update(t);
+            b = t;
+        }
+        else if (pos >= lsize + t->len)
+        {
+            _split(t->right,pos - lsize - t->len,t->right,b);
+            _update(t);
+            a = t;
+        }
+        else
+        {
+            // the chunk is split, its right part becomes a new node
+            const usize_t k = pos - lsize;
+            _Node *node = _newNode(t->chunk.ptr() + k,t->len - k);
+            t->chunk = _ChunkType(t->chunk.ptr(),k,
+                PoolAllocator<CharType>(*_pool));
+            t->len = k;
+            _Node *right = t->right;
+            t->right = nullptr;
+            _update(t);
+            a = t;
+            b = _merge(node,right);
+        }
+    }
+
+    /// build a tree from text split into chunks
+    [[nodiscard]] inline _Node* _build(const ViewType text)
+    {
+        _Node *ret = nullptr;
+        for (usize_t i = 0; i < text.len(); i += cMaxChunk)
+        {
+            const usize_t n = text.len() - i < cMaxChunk
+                ? text.len() - i : cMaxChunk;
+            ret = _merge(ret,_newNode(text.ptr() + i,n));
+        }
+        return ret;
+    }
+
+    /// insert into the chunk containing (or ending at) pos if it has room
+    /// \return true if inserted (subtree sizes are updated)
+    inline bool _insertInChunk(_Node * const t, const usize_t pos,
+        const ViewType text)
+    {
+        if (!t)
+            return false;
+        const usize_t lsize = _size(t->left);
+        bool ret;
+        if (pos < lsize)
+            ret = _insertInChunk(t->left,pos,text);
+        else if (pos > lsize + t->len)
+            ret = _insertInChunk(t->right,pos - lsize - t->len,text);
+        else if (t->len + text.len() > cMaxChunk)
+            return false;
+        else
+        {
+            const usize_t k = pos - lsize;
+            const usize_t n = t->len + text.len();
+            PoolAllocator<CharType> alloc(*_pool);
+            CharType *chars = alloc.allocate(n + 1);
+            simd::copyChars(chars,t->chunk.ptr(),k);
+            simd::copyChars(chars + k,text.ptr(),text.len());
+            simd::copyChars(chars + k + text.len(),t->chunk.ptr() + k,
+                t->len - k);
+            chars[n] = static_cast<CharType>(0);
+            t->chunk = _ChunkType::ptrWrap(chars,alloc);
+            t->len = n;
+            ret = true;
+        }
+        if (ret)
+            _update(t);
+        return ret;
+    }
+
+    /// character at an index of a subtree
+    [[nodiscard]] static inline CharType _charAt(const _Node *t, usize_t i)
+        noexcept
+    {
+        for (;;)
+        {
+            const usize_t lsize = _size(t->left);
+            if (i < lsize)
+                t = t->left;
+            else if (i < lsize + t->len)
+                return t->chunk[i - lsize];
+            else
+            {
+                i -= lsize + t->len;
+                t = t->right;
+            }
+        }
+    }
+
+    /// copy the characters in [pos,pos+count) of a subtree to dst
+    static inline void _copyRange(const _Node * const t, usize_t pos,
+        usize_t count, CharType *dst) noexcept
+    {
+        if (!t || !count)
+            return;
+        const usize_t lsize = _size(t->left);
+        if (pos < lsize)
+        {
+            const usize_t n = lsize - pos < count ? lsize - pos : count;
+            _copyRange(t->left,pos,n,dst);
+            dst += n;
+            count -= n;
+            pos = lsize;
+        }
+        if (!count)
+            return;
+        if (pos < lsize + t->len)
+        {
+            const usize_t k = pos - lsize;
+            const usize_t n = t->len - k < count ? t->len - k : count;
+            simd::copyChars(dst,t->chunk.ptr() + k,n);
+            dst += n;
+            count -= n;
+            pos = lsize + t->len;
+        }
+        _copyRange(t->right,pos - lsize - t->len,count,dst);
+    }
+
+    /// call fn with a view of each chunk in order
+    template <typename Func>
+    static inline void _forEach(const _Node * const t, Func &fn)
+    {
+        if (!t)
+            return;
+        _forEach(t->left,fn);
+        fn(ViewType(t->chunk.ptr(),t->len));
+        _forEach(t->right,fn);
+    }
+
+    /// number of nodes in a subtree
+    [[nodiscard]] static inline usize_t _count(const _Node * const t) noexcept
+    {
+        return t ? 1 + _count(t->left) + _count(t->right) : 0;
+    }
+
+    /// mark the flattened value as outdated
+    inline void _modified() noexcept
+    {
+        if (_flatValid)
+        {
+            _flat = StringType(PoolAllocator<CharType>(*_pool));
+            _flatValid = false;
+        }
+    }
+
+    /// initialize as the empty string owning a reference to a pool
+    [[nodiscard]] inline explicit Rope(
+        const std::shared_ptr<Pool> &sharedPool) noexcept
+        : Rope(*sharedPool)
+    {
+        _sharedPool = sharedPool;
+    }
+
+public:
+
+    /// \brief initialize as the empty string using Pool::threadLocal()
+    [[nodiscard]] inline Rope(): Rope(Pool::threadLocal()) {}
+
+    /// \brief initialize as the empty string using a shared pool
+    /// \param pool pool for nodes and chunks (must outlive the rope)
+    [[nodiscard]] inline explicit Rope(Pool &pool) noexcept
+        : _pool(&pool), _sharedPool(), _root(nullptr),
+          _rng(0x9E3779B97F4A7C15ull ^ reinterpret_cast<uintptr_t>(this)),
+          _flat(PoolAllocator<CharType>(pool)), _flatValid(false) {}
+
+    /// \brief initialize with a copy of some text
+    /// \param text the initial value
+    [[nodiscard]] inline explicit Rope(const ViewType text): Rope()
+    {
+        _root = _build(text);
+    }
+
+    /// \brief initialize with a copy of some text using a shared pool
+    /// \param text the initial value
+    /// \param pool pool for nodes and chunks (must outlive the rope)
+    [[nodiscard]] inline Rope(const ViewType text, Pool &pool): Rope(pool)
+    {
+        _root = _build(text);
+    }
+
+    /// \brief destructor
+    inline ~Rope()
+    {
+        _freeTree(_root);
+    }
+
+    /// \brief copy constructor (uses the same pool)
+    /// \param other another Rope
+    [[nodiscard]] inline Rope(const Rope &other)
+        : _pool(other._pool), _sharedPool(other._sharedPool), _root(nullptr),
+          _rng(other._rng), _flat(PoolAllocator<CharType>(*_pool)),
+          _flatValid(false)
+    {
+        other.forEachChunk([this](const ViewType chunk)
+        {
+            _root = _merge(_root,_newNode(chunk.ptr(),chunk.len()));
+        });
+    }
+
+    /// \brief copy assignment
+    /// \param other another Rope
+    /// \return reference to *this
+    inline Rope& operator=(const Rope &other)
+    {
+        Rope tmp(other);
+        *this = static_cast<Rope&&>(tmp);
+        return *this;
+    }
+
+    /// \brief move constructor
+    /// \param other another Rope (empty afterward)
+    [[nodiscard]] inline Rope(Rope &&other) noexcept
+        : _pool(other._pool), _sharedPool(other._sharedPool),
+          _root(other._root), _rng(other._rng),
+          _flat(static_cast<StringType&&>(other._flat)),
+          _flatValid(other._flatValid)
+    {
+        // the other rope keeps using the same pool
+        other._root = nullptr;
+        other._flatValid = false;
+    }
+
+    /// \brief move assignment
+    /// \param other another Rope
+    /// \return reference to *this
+    inline Rope& operator=(Rope &&other) noexcept
+    {
+        swap(_pool,other._pool);
+        std::swap(_sharedPool,other._sharedPool);
+        swap(_root,other._root);
+        swap(_rng,other._rng);
+        swap(_flat,other._flat);
+        swap(_flatValid,other._flatValid);
+        return *this;
+    }
+
+    /// \brief number of characters (constant time)
+    [[nodiscard]] inline usize_t len() const noexcept
+    {
+        return _size(_root);
+    }
+
+    /// \brief number of characters (constant time)
+    [[nodiscard]] inline usize_t size() const noexcept
+    {
+        return _size(_root);
+    }
+
+    /// \brief is the length 0
+    [[nodiscard]] inline bool empty() const noexcept
+    {
+        return !_root;
+    }
+
+    /// \brief number of chunks (linear time)
+    [[nodiscard]] inline usize_t chunkCount() const noexcept
+    {
+        return _count(_root);
+    }
+
+    /// \brief character at an index (logarithmic time)
+    /// \param i the index (valid range is [0,len()), undefined otherwise)
+    [[nodiscard]] inline CharType operator[](const usize_t i) const noexcept
+    {
+        return _charAt(_root,i);
+    }
+
+    /// \brief character at an index with bounds checking
+    /// \throw IndexError if i is not less than len()
+    [[nodiscard]] inline CharType at(const usize_t i) const
+    {
+        if (i >= len())
+            throw IndexError("index too large");
+        return _charAt(_root,i);
+    }
+
+    /// \brief insert text
+    /// \param pos index to insert at (at most len())
+    /// \param text the text
+    /// \return reference to *this
+    /// \throw IndexError if pos is greater than len()
+    inline Rope& insert(const usize_t pos, const ViewType text)
+    {
+        if (pos > len())
+            throw IndexError("insert position out of range");
+        if (text.empty())
+            return *this;
+        _modified();
+        if (_insertInChunk(_root,pos,text))
+            return *this;
+        _Node *mid = _build(text);
+        _Node *a, *b;
+        _split(_root,pos,a,b);
+        _root = _merge(_merge(a,mid),b);
+        return *this;
+    }
+
+    /// \brief remove characters
+    /// \param pos index of the first character to remove (at most len())
+    /// \param count number of characters (limited to the end)
+    /// \return reference to *this
+    /// \throw IndexError if pos is greater than len()
+    inline Rope& erase(const usize_t pos, usize_t count = npos)
+    {
+        const usize_t l = len();
+        if (pos > l)
+            throw IndexError("erase position out of range");
+        if (count > l - pos)
+            count = l - pos;
+        if (!count)
+            return *this;
+        _modified();
+        _Node *a, *b, *c;
+        _split(_root,pos,a,b);
+        _split(b,count,b,c);
+        _freeTree(b);
+        _root = _merge(a,c);
+        return *this;
+    }
+
+    /// \brief add text to the end
+    inline Rope& append(const ViewType text)
+    {
+        return insert(len(),text);
+    }
+
+    /// \brief add text to the beginning
+    inline Rope& prepend(const ViewType text)
+    {
+        return insert(0,text);
+    }
+
+    /// \brief add text to the end
+    inline Rope& operator+=(const ViewType text)
+    {
+        return insert(len(),text);
+    }
+
+    /// \brief move another rope to the end
+    /// \param other another rope (empty afterward)
+    /// \return reference to *this
+    ///
+    /// This takes logarithmic time if both ropes use the same pool (such as
+    /// Pool::threadLocal()), otherwise the chunks of other are copied.
+    inline Rope& operator+=(Rope &&other)
+    {
+        if (!other._root)
+            return *this;
+        _modified();
+        if (other._pool == _pool)
+        {
+            _root = _merge(_root,other._root);
+            other._root = nullptr;
+            other._modified();
+            return *this;
+        }
+        other.forEachChunk([this](const ViewType chunk)
+        {
+            _root = _merge(_root,_newNode(chunk.ptr(),chunk.len()));
+        });
+        other.clear();
+        return *this;
+    }
+
+    /// \brief remove all characters
+    inline void clear() noexcept
+    {
+        _modified();
+        _freeTree(_root);
+        _root = nullptr;
+    }
+
+    /// \brief copy a range into a CString
+    /// \param pos first index (at most len())
+    /// \param count number of characters (limited to the end)
+    /// \return the characters (allocated from the pool of the rope)
+    /// \throw IndexError if pos is greater than len()
+    [[nodiscard]] inline StringType substr(
+        const usize_t pos, usize_t count = npos) const
+    {
+        const usize_t l = len();
+        if (pos > l)
+            throw IndexError("substring start out of range");
+        if (count > l - pos)
+            count = l - pos;
+        PoolAllocator<CharType> alloc(*_pool);
+        CharType *chars = alloc.allocate(count + 1);
+        _copyRange(_root,pos,count,chars);
+        chars[count] = static_cast<CharType>(0);
+        return StringType::ptrWrap(chars,alloc);
+    }
+
+    /// \brief copy all characters into a CString
+    [[nodiscard]] inline StringType toCString() const
+    {
+        return substr(0);
+    }
+
+    /// \brief contiguous null-terminated value
+    /// \return pointer valid until the rope is modified or destroyed
+    ///
+    /// The rope is flattened on the first call after a modification, later
+    /// calls return the cached value.
+    [[nodiscard]] inline const CharType* ptr() const
+    {
+        if (!_flatValid)
+        {
+            _flat = toCString();
+            _flatValid = true;
+        }
+        return _flat.ptr();
+    }
+
+    /// \brief call a function with a view of each chunk in order
+    /// \param fn function taking a CStringView
+    template <typename Func>
+    inline void forEachChunk(Func fn) const
+    {
+        _forEach(_root,fn);
+    }
+
+    /// \brief compare the characters with a view
+    [[nodiscard]] friend inline bool operator==(
+        const Rope &left, const ViewType right) noexcept
+    {
+        if (left.len() != right.len())
+            return false;
+        usize_t pos = 0;
+        bool ret = true;
+        left.forEachChunk([&](const ViewType chunk)
+        {
+            ret = ret && chunk == right.substr(pos,chunk.len());
+            pos += chunk.len();
+        });
+        return ret;
+    }
+};
+
+} // namespace tkoz::stl
@@ -0,0 +1,523 @@
+///
+/// reference counted C string with copy on write
+///
+
+#pragma once
+
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/CStringSimd.hpp>
+#include <tkoz/stl/Concepts.hpp>
+#include <tkoz/stl/Exceptions.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <atomic>
+#include <new>
+#include <utility>
+
+namespace tkoz::stl
+{
+
+/// \brief reference count updated with atomic operations
+///
+/// Copies of a string may be created and destroyed on different threads, like
+/// std::shared_ptr. Increments are relaxed and the final decrement
+/// synchronizes with all earlier ones before the memory is freed.
+struct AtomicRefCount
+{
+    /// counter type stored with the string
+    using CountType = std::atomic<usize_t>;
+
+    /// \brief add a reference
+    static inline void increment(CountType &count) noexcept
+    {
+        count.fetch_add(1,std::memory_order_relaxed);
+    }
+
+    /// \brief remove a reference
+    /// \return true if it was the last reference
+    [[nodiscard]] static inline bool decrement(CountType &count) noexcept
+    {
+        return count.fetch_sub(1,std::memory_order_acq_rel) == 1;
+    }
+
+    /// \brief current number of references
+    [[nodiscard]] static inline usize_t load(const CountType &count) noexcept
+    {
+        return count.load(std::memory_order_acquire);
+    }
+};
+
+/// \brief reference count updated with plain integer operations
+///
+/// Cheaper than AtomicRefCount but all copies of a string must be used by a
+/// single thread at a time.
+struct PlainRefCount
+{
+    /// counter type stored with the string
+    using CountType = usize_t;
+
+    /// \brief add a reference
+    static inline void increment(CountType &count) noexcept
+    {
+        ++count;
+    }
+
+    /// \brief remove a reference
+    /// \return true if it was the last reference
+    [[nodiscard]] static inline bool decrement(CountType &count) noexcept
+    {
+        return --count == 0;
+    }
+
+    /// \brief current number of references
+    [[nodiscard]] static inline usize_t load(const CountType &count) noexcept
+    {
+        return count;
+    }
+};
+
+namespace concepts
+{
+
+/// \brief type is a reference count policy (like AtomicRefCount)
+template <typename PolicyType>
+concept isRefCountPolicy = requires (
+    typename PolicyType::CountType &count, const PolicyType::CountType &c)
+{
+    { PolicyType::increment(count) } noexcept;
+    { PolicyType::decrement(count) } noexcept -> isSame<bool>;
+    { PolicyType::load(c) } noexcept -> isSame<usize_t>;
+};
+
+} // namespace concepts
+
+/// \brief immutable by default C string shared between copies
+/// \tparam CharType character type
+/// \tparam allowNull whether to allow a null C string
+/// \tparam RefCount reference count policy (AtomicRefCount or PlainRefCount)
+///
+/// This is a sibling of CString with the same null-terminated contract. The
+/// characters are stored in one allocation after a small header with the
+/// reference count and the length, so len() is constant time. Copying only
+/// increments the reference count, which suits strings copied into several
+/// caches and never modified.
+///
+/// Const access never copies. Non const ptr(), operator[] and at() first make
+/// this string the only owner of its characters (copy on write), so changes
+/// are never visible through other copies. A pointer or reference obtained
+/// this way must not be used to modify the string after it is copied again.
+/// Behavior is undefined if a null character is inserted anywhere other than
+/// at the end or if the null terminator is changed.
+template <typename _CharType = char, bool _allowNull = true,
+    typename _RefCount = AtomicRefCount>
+    requires concepts::isRefCountPolicy<_RefCount>
+class SharedCString
+{
+public:
+
+    /// character type
+    using CharType = _CharType;
+
+    /// is null pointer allowed
+    static constexpr bool allowNull = _allowNull;
+
+    /// reference count policy
+    using RefCount = _RefCount;
+
+private:
+
+    /// CString functions that do not check for null
+    using _CStrNoNull = CString<CharType,false>;
+
+    /// allocation header, followed by the characters
+    struct _Header
+    {
+        RefCount::CountType refs;
+        usize_t len;
+    };
+
+    static_assert(sizeof(_Header) % alignof(CharType) == 0);
+
+    /// pointer to the shared header or nullptr for the null string
+    _Header *_head;
+
+    /// characters stored after a header
+    [[nodiscard]] static inline CharType* _chars(_Header * const h) noexcept
+    {
+        return reinterpret_cast<CharType*>(h + 1);
+    }
+
+    /// allocate a header with a single reference for a string of length l
+    /// (does not write the characters or null terminator)
+    [[nodiscard]] static inline _Header* _allocate(const usize_t l)
+    {
+        void *mem = ::operator new(sizeof(_Header) + (l+1) * sizeof(CharType));
+        return new (mem) _Header{1,l};
+    }
+
+    /// allocate a header and copy l characters
+    [[nodiscard]] static inline _Header* _allocateCopy(
+        const CharType * const ptr, const usize_t l)
+    {
+        _Header *h = _allocate(l);
+        CharType *p = _chars(h);
+        simd::copyChars(p,ptr,l);
+        p[l] = static_cast<CharType>(0);
+        return h;
+    }
+
+    /// drop this reference, freeing the memory if it was the last one
+    inline void _release() noexcept
+    {
+        if (_head && RefCount::decrement(_head->refs))
+        {
+            _head->~_Header();
+            ::operator delete(_head);
+        }
+    }
+
+    /// copy the characters if they are shared
+    inline void _unshare()
+    {
+        if (!_head || RefCount::load(_head->refs) == 1)
+            return;
+        _Header *h = _allocateCopy(_chars(_head),_head->len);
+        _release();
+        _head = h;
+    }
+
+public:
+
+    /// \brief initialize as null string
+    [[nodiscard]] inline SharedCString() noexcept: _head(nullptr) {}
+
+    /// \brief initialize from a C string
+    /// \param ptr a null-terminated C string, or nullptr
+    [[nodiscard]] inline SharedCString(const CharType * const ptr)
+    {
+        if constexpr (allowNull)
+        {
+            if (!ptr)
+            {
+                _head = nullptr;
+                return;
+            }
+        }
+        _head = _allocateCopy(ptr,_CStrNoNull::ptrLen(ptr));
+    }
+
+    /// \brief initialize from a pointer with a known length
+    /// \param ptr pointer to at least len characters (not null)
+    /// \param len number of characters to copy
+    ///
+    /// The characters must not contain a null character.
+    [[nodiscard]] inline SharedCString(
+        const CharType * const ptr, const usize_t len)
+        : _head(_allocateCopy(ptr,len)) {}
+
+    /// \brief initialize with a repeated character
+    /// \param count string length
+    /// \param value character value
+    ///
+    /// Character value must be nonzero.
+    [[nodiscard]] inline SharedCString(
+        const usize_t count, const CharType value): _head(_allocate(count))
+    {
+        CharType *p = _chars(_head);
+        for (usize_t i = 0; i < count; ++i)
+            p[i] = value;
+        p[count] = static_cast<CharType>(0);
+    }
+
+    /// \brief initialize from a CString
+    /// \param str a CString with the same character type
+    template <bool otherAllowNull, typename AllocType>
+    [[nodiscard]] inline explicit SharedCString(
+        const CString<CharType,otherAllowNull,AllocType> &str)
+        : SharedCString(str.ptr()) {}
+
+    /// \brief destructor
+    inline ~SharedCString()
+    {
+        _release();
+    }
+
+    /// \brief copy constructor (shares the characters)
+    /// \param other another SharedCString
+    [[nodiscard]] inline SharedCString(const SharedCString &other) noexcept
+        : _head(other._head)
+    {
+        if (_head)
+            RefCount::increment(_head->refs);
+    }
+
+    /// \brief copy assignment (shares the characters)
+    /// \param other another SharedCString
+    /// \return reference to *this
+    inline SharedCString& operator=(const SharedCString &other) noexcept
+    {
+        if (_head != other._head)
+        {
+            if (other._head)
+                RefCount::increment(other._head->refs);
+            _release();
+            _head = other._head;
+        }
+        return *this;
+    }
+
+    /// \brief move constructor
+    /// \param other another SharedCString
+    [[nodiscard]] inline SharedCString(SharedCString &&other) noexcept
+        : _head(other._head)
+    {
+        other._head = nullptr;
+    }
+
+    /// \brief move assignment
+    /// \param other another SharedCString
+    /// \return reference to *this
+    inline SharedCString& operator=(SharedCString &&other) noexcept
+    {
+        swap(_head,other._head);
+        return *this;
+    }
+
+    /// \brief length of the string (excludes null terminator) (constant time)
+    /// \return string length
+    [[nodiscard]] inline usize_t len() const noexcept
+    {
+        if constexpr (allowNull)
+            return _head ? _head->len : 0;
+        else
+            return _head->len;
+    }
+
+    /// \brief length of the string (excludes null terminator) (constant time)
+    /// \return string length
+    [[nodiscard]] inline usize_t size() const noexcept
+    {
+        return len();
+    }
+
+    /// \brief const pointer to the string value (never copies)
+    /// \return const C string pointer
+    [[nodiscard]] inline const CharType* ptr() const noexcept
+    {
+        if constexpr (allowNull)
+            return _head ? _chars(_head) : nullptr;
+        else
+            return _chars(_head);
+    }
+
+    /// \brief non const pointer to the string value
+    /// \return non const C string pointer
+    /// \throw std::bad_alloc if the characters must be copied
+    ///
+    /// The characters are copied first if they are shared with another string.
+    [[nodiscard]] inline CharType* ptr()
+    {
+        _unshare();
+        return const_cast<CharType*>(std::as_const(*this).ptr());
+    }
+
+    /// \brief number of strings sharing the characters
+    /// \return reference count (0 for the null string)
+    ///
+    /// With AtomicRefCount the value may be outdated as soon as it is read.
+    [[nodiscard]] inline usize_t useCount() const noexcept
+    {
+        return _head ? RefCount::load(_head->refs) : 0;
+    }
+
+    /// \brief is this the only string with these characters
+    /// \return true if modifying will not copy
+    [[nodiscard]] inline bool isUnique() const noexcept
+    {
+        return useCount() <= 1;
+    }
+
+    /// \brief copy the characters now if they are shared
+    /// \return reference to *this
+    inline SharedCString& makeUnique()
+    {
+        _unshare();
+        return *this;
+    }
+
+    /// \brief true if non null and non empty
+    /// \return boolean representation of the string (true if positive length)
+    [[nodiscard]] inline operator bool() const noexcept
+    {
+        return len() > 0;
+    }
+
+    /// \brief is string null (not the same as the empty string)
+    /// \return true if the string stored is nullptr
+    /// \note this function should be avoided if allowNull == false
+    [[nodiscard]] inline bool isNull() const noexcept
+    {
+        if constexpr (allowNull)
+            return !_head;
+        else
+            return false;
+    }
+
+    /// \brief copy to a CString
+    /// \return CString with the same value
+    [[nodiscard]] inline CString<CharType,allowNull> toCString() const
+    {
+        if constexpr (allowNull)
+        {
+            if (!_head)
+                return CString<CharType,allowNull>();
+        }
+        return CString<CharType,allowNull>(_chars(_head),_head->len);
+    }
+
+    /// \brief compare equality
+    /// \param left a SharedCString
+    /// \param right a SharedCString
+    /// \return true if both strings are equal
+    ///
+    /// Copies of the same string compare equal without reading characters and
+    /// strings of different lengths are rejected without reading characters.
+    [[nodiscard]] friend inline bool operator==(
+        const SharedCString &left, const SharedCString &right) noexcept
+    {
+        if (left._head == right._head)
+            return true;
+        if constexpr (allowNull)
+        {
+            if (!left._head || !right._head)
+                return false;
+        }
+        return simd::memCmpEq(_chars(left._head),left._head->len,
+            _chars(right._head),right._head->len);
+    }
+
+    /// \brief compare equality
+    /// \param left a pointer
+    /// \param right a SharedCString
+    /// \return true if both strings are equal
+    [[nodiscard]] friend inline bool operator==(
+        const CharType * const left, const SharedCString &right) noexcept
+    {
+        return CString<CharType,allowNull>::ptrCmpEq(left,right.ptr());
+    }
+
+    /// \brief compare equality
+    /// \param left a SharedCString
+    /// \param right a pointer
+    /// \return true if both strings are equal
+    [[nodiscard]] friend inline bool operator==(
+        const SharedCString &left, const CharType * const right) noexcept
+    {
+        return CString<CharType,allowNull>::ptrCmpEq(left.ptr(),right);
+    }
+
+    /// \brief compare 3 way
+    /// \param left a SharedCString
+    /// \param right a SharedCString
+    /// \return 3 way compare result of both strings
+    [[nodiscard]] friend inline auto operator<=>(
+        const SharedCString &left, const SharedCString &right) noexcept
+    {
+        return CString<CharType,allowNull>::ptrCmp3way(left.ptr(),right.ptr());
+    }
+
+    /// \brief compare 3 way
+    /// \param left a pointer
+    /// \param right a SharedCString
+    /// \return 3 way compare result of both strings
+    [[nodiscard]] friend inline auto operator<=>(
+        const CharType * const left, const SharedCString &right) noexcept
+    {
+        return CString<CharType,allowNull>::ptrCmp3way(left,right.ptr());
+    }
+
+    /// \brief compare 3 way
+    /// \param left a SharedCString
+    /// \param right a pointer
+    /// \return 3 way compare result of both strings
+    [[nodiscard]] friend inline auto operator<=>(
+        const SharedCString &left, const CharType * const right) noexcept
+    {
+        return CString<CharType,allowNull>::ptrCmp3way(left.ptr(),right);
+    }
+
+    /// \brief (non const) access to a character
+    /// \param i the index
+    /// \return reference to ith character
+    ///
+    /// Behavior is undefined if i is ouf of bounds or string is null.
+    /// The valid range is [0,len()] (which includes the null terminator).
+    /// The characters are copied first if they are shared.
+    [[nodiscard]] inline CharType& operator[](usize_t i)
+    {
+        return ptr()[i];
+    }
+
+    [[nodiscard]] inline const CharType& operator[](usize_t i) const noexcept
+    {
+        return ptr()[i];
+    }
+
+    /// \brief (non const) access to a character
+    /// \tparam IndexType type of index (bool or integer primitive)
+    /// \param i the index
+    /// \return reference to character at that index
+    /// \throw NullError if the string value is nullptr
+    /// \throw IndexError if the index is out of bounds
+    ///
+    /// Same as CString::at() except bounds are checked in constant time. The
+    /// characters are copied first if they are shared.
+    template <concepts::isPrimitiveIntegerOrBool IndexType>
+    [[nodiscard]] inline CharType& at(IndexType i)
+    {
+        const CharType *p = std::as_const(*this).ptr();
+        const usize_t j = static_cast<usize_t>(&std::as_const(*this).at(i) - p);
+        return ptr()[j];
+    }
+
+    /// \brief const access to a character
+    /// \return const reference to character at that index
+    /// \throw NullError or IndexError
+    ///
+    /// See non const version for details.
+    template <concepts::isPrimitiveIntegerOrBool IndexType>
+    [[nodiscard]] inline const CharType& at(IndexType i) const
+    {
+        if constexpr (allowNull)
+        {
+            if (!_head)
+                throw NullError("string pointer is null");
+        }
+        const usize_t l = _head->len;
+        const CharType *p = _chars(_head);
+        if constexpr (concepts::isBool<IndexType>)
+        {
+            if (i && !l)
+                throw IndexError("index too large");
+            return p[i];
+        }
+        else
+        {
+            if constexpr (concepts::isPrimitiveSignedInteger<IndexType>)
+            {
+                const ssize_t j = static_cast<ssize_t>(i);
+                if (j < 0)
+                {
+                    if (j < -static_cast<ssize_t>(l))
+                        throw IndexError("index too small");
+                    return p[l + static_cast<usize_t>(j)];
+                }
+            }
+            if (static_cast<usize_t>(i) > l)
+                throw IndexError("index too large");
+            return p[static_cast<usize_t>(i)];
+        }
+    }
+};
+
+} // namespace tkoz::stl
@@ -0,0 +1,76 @@
+///
+/// runtime detection of SIMD instruction set support
+///
+
+#pragma once
+
+#include <tkoz/stl/Types.hpp>
+
+namespace tkoz::stl::simd
+{
+
+/// \brief SIMD instruction set levels used by vectorized kernels
+///
+/// Levels are ordered so a higher level implies support for the lower ones.
+/// SSE2 is the baseline on x86_64. Other architectures only use scalar code.
+enum SimdLevel: int
+{
+    cSimdScalar = 0, ///< no vector instructions
+    cSimdSse2 = 1,   ///< 16 byte vectors (x86_64 baseline)
+    cSimdAvx2 = 2,   ///< 32 byte vectors
+    cSimdAvx512 = 3  ///< 64 byte vectors (requires AVX-512 F and BW)
+};
+
+/// size (in bytes) of a memory page, vector loads never cross this boundary
+static constexpr usize_t cPageSize = 4096;
+
+namespace _detail
+{
+
+// query the processor (done once, see simdLevel())
+inline SimdLevel _detectSimdLevel() noexcept
+{
+#if __x86_64__
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+        return cSimdAvx512;
+    if (__builtin_cpu_supports("avx2"))
+        return cSimdAvx2;
+    return cSimdSse2;
+#else
+    return cSimdScalar;
+#endif
+}
+
+} // namespace _detail
+
+/// \brief highest SIMD level supported by the running processor
+/// \return detected SIMD level (cached after the first call)
+[[nodiscard]] inline SimdLevel simdLevel() noexcept
+{
+    static const SimdLevel sLevel = _detail::_detectSimdLevel();
+    return sLevel;
+}
+
+/// \brief limit a requested SIMD level to what the processor supports
+/// \param level requested level
+/// \return the lower of level and simdLevel()
+[[nodiscard]] inline SimdLevel clampSimdLevel(const SimdLevel level) noexcept
+{
+    const SimdLevel max = simdLevel();
+    return level < max ? level : max;
+}
+
+/// \brief can a load of size bytes at ptr cross into the next page
+/// \param ptr address to load from
+/// \param size number of bytes loaded
+/// \return true if the load would touch 2 pages
+[[nodiscard]] inline bool crossesPage(
+    const void * const ptr, const usize_t size) noexcept
+{
+    const uintptr_t offset =
+        reinterpret_cast<uintptr_t>(ptr) & (cPageSize - 1);
+    return offset > cPageSize - size;
+}
+
+} // namespace tkoz::stl::simd
@@ -108,7 +108,7 @@ public:
     /// \brief boolean equivalent (is the pointer non null)
     [[nodiscard]] inline operator bool() const noexcept
     {
-        return _ptr[0] && _ptr[1] && _ptr[2];
+        return _ptr[0] || _ptr[1] || _ptr[2];
     }
 
     /// \brief convert to another pointer (implicit if matching type)
@@ -0,0 +1,656 @@
+///
+/// dynamic array of packed 6 byte pointers
+///
+
+#pragma once
+
+#include <tkoz/stl/Allocator.hpp>
+#include <tkoz/stl/Concepts.hpp>
+#include <tkoz/stl/Exceptions.hpp>
+#include <tkoz/stl/Simd.hpp>
+#include <tkoz/stl/SixBytePointer.hpp>
+#include <tkoz/stl/Types.hpp>
+#include <tkoz/stl/Utils.hpp>
+
+#include <initializer_list>
+
+#if __x86_64__
+#include <immintrin.h>
+#endif
+
+namespace tkoz::stl
+{
+
+namespace _detail
+{
+
+//
+// scalar code
+//
+
+/// low 48 bits of a pointer
+static constexpr uint64_t _cSixByteMask = 0xFFFFFFFFFFFFull;
+
+/// read 6 bytes as the low bits of an integer
+[[nodiscard]] inline uint64_t _loadSixBytes(const uchar_t * const p) noexcept
+{
+    uint32_t lo;
+    ushort_t hi;
+    __builtin_memcpy(&lo,p,4);
+    __builtin_memcpy(&hi,p+4,2);
+    return lo | (static_cast<uint64_t>(hi) << 32);
+}
+
+/// decode n packed 6 byte pointers to 8 byte pointers
+inline void _decodeSixBytesScalar(const void * const src, const usize_t n,
+    void * const dst) noexcept
+{
+    const uchar_t *s = static_cast<const uchar_t*>(src);
+    uchar_t *d = static_cast<uchar_t*>(dst);
+    usize_t i = 0;
+    // 8 byte loads while the 2 extra bytes belong to the next pointer
+    for (; i + 1 < n; ++i)
+    {
+        uint64_t v;
+        __builtin_memcpy(&v,s + 6*i,8);
+        v &= _cSixByteMask;
+        __builtin_memcpy(d + 8*i,&v,8);
+    }
+    for (; i < n; ++i)
+    {
+        const uint64_t v = _loadSixBytes(s + 6*i);
+        __builtin_memcpy(d + 8*i,&v,8);
+    }
+}
+
+/// encode n 8 byte pointers (high 16 bits zero) as packed 6 byte pointers
+inline void _encodeSixBytesScalar(const void * const src, const usize_t n,
+    void * const dst) noexcept
+{
+    const uchar_t *s = static_cast<const uchar_t*>(src);
+    uchar_t *d = static_cast<uchar_t*>(dst);
+    for (usize_t i = 0; i < n; ++i)
+        __builtin_memcpy(d + 6*i,s + 8*i,6);
+}
+
+#if __x86_64__
+
+//
+// x86 code
+//
+// 2 pointers occupy 12 bytes, which is 3 dwords, so a dword permutation moves
+// each pair of pointers into its own 128 bit lane, then a byte shuffle within
+// the lanes inserts (or removes) the zero high bytes. Masked loads and stores
+// never access memory past the packed pointers.
+//
+
+[[gnu::target("avx2")]]
+inline void _decodeSixBytesAvx2(const void * const src, const usize_t n,
+    void * const dst) noexcept
+{
+    const uchar_t *s = static_cast<const uchar_t*>(src);
+    uchar_t *d = static_cast<uchar_t*>(dst);
+    const __m256i perm = _mm256_setr_epi32(0,1,2,0,3,4,5,0);
+    const __m256i shuf = _mm256_setr_epi8(0,1,2,3,4,5,-1,-1,
+        6,7,8,9,10,11,-1,-1,0,1,2,3,4,5,-1,-1,6,7,8,9,10,11,-1,-1);
+    const __m256i mask = _mm256_setr_epi32(-1,-1,-1,-1,-1,-1,0,0);
+    usize_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i v = _mm256_maskload_epi32(
+            reinterpret_cast<const int*>(s + 6*i),mask);
+        v = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(v,perm),shuf);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + 8*i),v);
+    }
+    _decodeSixBytesScalar(s + 6*i,n - i,d + 8*i);
+}
+
+[[gnu::target("avx2")]]
+inline void _encodeSixBytesAvx2(const void * const src, const usize_t n,
+    void * const dst) noexcept
+{
+    const uchar_t *s = static_cast<const uchar_t*>(src);
+    uchar_t *d = static_cast<uchar_t*>(dst);
+    const __m256i shuf = _mm256_setr_epi8(0,1,2,3,4,5,8,9,10,11,12,13,
+        -1,-1,-1,-1,0,1,2,3,4,5,8,9,10,11,12,13,-1,-1,-1,-1);
+    const __m256i perm = _mm256_setr_epi32(0,1,2,4,5,6,0,0);
+    const __m256i mask = _mm256_setr_epi32(-1,-1,-1,-1,-1,-1,0,0);
+    usize_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i v = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(s + 8*i));
+        v = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(v,shuf),perm);
+        _mm256_maskstore_epi32(reinterpret_cast<int*>(d + 6*i),mask,v);
+    }
+    _encodeSixBytesScalar(s + 8*i,n - i,d + 6*i);
+}
+
+[[gnu::target("avx512f,avx512bw")]]
+inline void _decodeSixBytesAvx512(const void * const src, const usize_t n,
+    void * const dst) noexcept
+{
+    const uchar_t *s = static_cast<const uchar_t*>(src);
+    uchar_t *d = static_cast<uchar_t*>(dst);
+    const __m512i perm = _mm512_setr_epi32(0,1,2,0,3,4,5,0,
+        6,7,8,0,9,10,11,0);
+    // bytes 0-5,z,z,6-11,z,z in each lane
+    const __m512i shuf = _mm512_setr4_epi32(0x03020100,
+        static_cast<int>(0xFFFF0504u),0x09080706,static_cast<int>(0xFFFF0B0Au));
+    usize_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m512i v = _mm512_maskz_loadu_epi32(0x0FFF,s + 6*i);
+        v = _mm512_shuffle_epi8(_mm512_maskz_permutexvar_epi32(0xFFFF,perm,v),
+            shuf);
+        _mm512_storeu_si512(d + 8*i,v);
+    }
+    _decodeSixBytesAvx2(s + 6*i,n - i,d + 8*i);
+}
+
+[[gnu::target("avx512f,avx512bw")]]
+inline void _encodeSixBytesAvx512(const void * const src, const usize_t n,
+    void * const dst) noexcept
+{
+    const uchar_t *s = static_cast<const uchar_t*>(src);
+    uchar_t *d = static_cast<uchar_t*>(dst);
+    // bytes 0-5,8-13,z,z,z,z in each lane
+    const __m512i shuf = _mm512_setr4_epi32(0x03020100,0x09080504,0x0D0C0B0A,
+        -1);
+    const __m512i perm = _mm512_setr_epi32(0,1,2,4,5,6,8,9,
+        10,12,13,14,0,0,0,0);
+    usize_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        __m512i v = _mm512_loadu_si512(s + 8*i);
+        v = _mm512_maskz_permutexvar_epi32(0xFFFF,perm,
+            _mm512_shuffle_epi8(v,shuf));
+        _mm512_mask_storeu_epi32(d + 6*i,0x0FFF,v);
+    }
+    _encodeSixBytesAvx2(s + 8*i,n - i,d + 6*i);
+}
+
+#endif // __x86_64__
+
+//
+// selection of a kernel for a SIMD level
+//
+
+using _SixBytesFn = void (*)(const void*, usize_t, void*) noexcept;
+
+[[nodiscard]] inline _SixBytesFn _selectDecodeSixBytes(
+    const simd::SimdLevel level) noexcept
+{
+    switch (level)
+    {
+#if __x86_64__
+    case simd::cSimdAvx512:
+        return _decodeSixBytesAvx512;
+    case simd::cSimdAvx2:
+        return _decodeSixBytesAvx2;
+#endif
+    default:
+        return _decodeSixBytesScalar;
+    }
+}
+
+[[nodiscard]] inline _SixBytesFn _selectEncodeSixBytes(
+    const simd::SimdLevel level) noexcept
+{
+    switch (level)
+    {
+#if __x86_64__
+    case simd::cSimdAvx512:
+        return _encodeSixBytesAvx512;
+    case simd::cSimdAvx2:
+        return _encodeSixBytesAvx2;
+#endif
+    default:
+        return _encodeSixBytesScalar;
+    }
+}
+
+// kernels for the best supported level, selected on first use
+inline void _decodeSixBytesDispatch(const void * const src, const usize_t n,
+    void * const dst) noexcept
+{
+    static const _SixBytesFn sFn = _selectDecodeSixBytes(simd::simdLevel());
+    sFn(src,n,dst);
+}
+
+inline void _encodeSixBytesDispatch(const void * const src, const usize_t n,
+    void * const dst) noexcept
+{
+    static const _SixBytesFn sFn = _selectEncodeSixBytes(simd::simdLevel());
+    sFn(src,n,dst);
+}
+
+} // namespace _detail
+
+/// \brief convert packed 6 byte pointers to full pointers
+/// \param src array of n SixBytePointers
+/// \param n number of pointers
+/// \param dst array for n pointers (must not overlap src)
+///
+/// With AVX2 (AVX-512), 4 (8) pointers are decoded by each instruction.
+template <typename Type>
+inline void decodeSixBytePointers(const SixBytePointer<Type> * const src,
+    const usize_t n, Type ** const dst) noexcept
+{
+    _detail::_decodeSixBytesDispatch(src,n,dst);
+}
+
+/// \brief decodeSixBytePointers() using a specific SIMD level
+/// \param level SIMD level to use (limited to what the processor supports)
+template <typename Type>
+inline void decodeSixBytePointers(const SixBytePointer<Type> * const src,
+    const usize_t n, Type ** const dst, const simd::SimdLevel level) noexcept
+{
+    _detail::_selectDecodeSixBytes(simd::clampSimdLevel(level))(src,n,dst);
+}
+
+/// \brief convert full pointers to packed 6 byte pointers
+/// \param src array of n pointers (high 16 bits must be zero)
+/// \param n number of pointers
+/// \param dst array for n SixBytePointers (must not overlap src)
+template <typename Type>
+inline void encodeSixBytePointers(Type * const * const src, const usize_t n,
+    SixBytePointer<Type> * const dst) noexcept
+{
+    _detail::_encodeSixBytesDispatch(src,n,dst);
+}
+
+/// \brief encodeSixBytePointers() using a specific SIMD level
+/// \param level SIMD level to use (limited to what the processor supports)
+template <typename Type>
+inline void encodeSixBytePointers(Type * const * const src, const usize_t n,
+    SixBytePointer<Type> * const dst, const simd::SimdLevel level) noexcept
+{
+    _detail::_selectEncodeSixBytes(simd::clampSimdLevel(level))(src,n,dst);
+}
+
+/// \brief dynamic array of pointers stored in 6 bytes each
+/// \tparam Type the type pointed to
+/// \tparam AllocType allocator for the elements (see Allocator.hpp)
+///
+/// Elements are SixBytePointers stored contiguously with no padding, so the
+/// array takes 25% less memory than an array of Type*. Single elements are
+/// accessed like a std::vector, and decode() converts ranges to Type* with
+/// vector instructions. forEach() visits the pointers in blocks, prefetching
+/// the objects of the next block while the current one is processed, which
+/// hides cache misses when each pointer is dereferenced.
+///
+/// The capacity grows geometrically. This class only stores pointers, it does
+/// not manage the memory pointed to.
+template <typename _Type,
+    typename _AllocType = NewAllocator<SixBytePointer<_Type>>>
+    requires concepts::isAllocator<_AllocType,SixBytePointer<_Type>>
+class SixBytePointerArray
+{
+public:
+
+    /// type pointed to
+    using Type = _Type;
+
+    /// element type
+    using ElementType = SixBytePointer<Type>;
+
+    /// allocator type
+    using AllocType = _AllocType;
+
+    /// smallest capacity allocated
+    static constexpr usize_t cMinCapacity = 16;
+
+    /// pointers decoded at once by forEach()
+    static constexpr usize_t cBlockSize = 16;
+
+private:
+
+    /// elements or nullptr if nothing is allocated
+    ElementType *_ptr;
+
+    /// number of elements
+    usize_t _size;
+
+    /// allocated number of elements
+    usize_t _cap;
+
+    /// allocator for _ptr
+    [[no_unique_address]] AllocType _alloc;
+
+    /// replace the storage with exactly cap elements
+    inline void _realloc(const usize_t cap)
+    {
+        ElementType *ptr = _alloc.allocate(cap);
+        if (_size)
+            __builtin_memcpy(ptr,_ptr,_size * sizeof(ElementType));
+        _alloc.deallocate(_ptr);
+        _ptr = ptr;
+        _cap = cap;
+    }
+
+    /// ensure capacity for extra more elements
+    inline void _grow(const usize_t extra)
+    {
+        const usize_t need = _size + extra;
+        if (need <= _cap) [[likely]]
+            return;
+        usize_t cap = _cap < cMinCapacity ? cMinCapacity : _cap;
+        while (cap < need)
+            cap *= 2;
+        _realloc(cap);
+    }
+
+    /// swap with other
+    inline void _swapWith(SixBytePointerArray &other) noexcept
+    {
+        swap(_ptr,other._ptr);
+        swap(_size,other._size);
+        swap(_cap,other._cap);
+        swap(_alloc,other._alloc);
+    }
+
+public:
+
+    /// \brief initialize as empty (does not allocate)
+    [[nodiscard]] inline SixBytePointerArray() noexcept
+        : _ptr(nullptr), _size(0), _cap(0), _alloc() {}
+
+    /// \brief initialize as empty (does not allocate)
+    /// \param alloc allocator to use
+    [[nodiscard]] inline explicit SixBytePointerArray(
+        const AllocType &alloc) noexcept
+        : _ptr(nullptr), _size(0), _cap(0), _alloc(alloc) {}
+
+    /// \brief initialize with null pointers
+    /// \param size number of elements
+    /// \param alloc allocator to use
+    [[nodiscard]] inline explicit SixBytePointerArray(const usize_t size,
+        const AllocType &alloc = AllocType())
+        : SixBytePointerArray(alloc)
+    {
+        resize(size);
+    }
+
+    /// \brief initialize from pointers
+    /// \param ptrs the pointers (high 16 bits must be zero)
+    /// \param alloc allocator to use
+    [[nodiscard]] inline SixBytePointerArray(
+        const std::initializer_list<Type*> ptrs,
+        const AllocType &alloc = AllocType())
+        : SixBytePointerArray(alloc)
+    {
+        append(ptrs.begin(),ptrs.size());
+    }
+
+    /// \brief destructor
+    inline ~SixBytePointerArray()
+    {
+        _alloc.deallocate(_ptr);
+    }
+
+    /// \brief copy constructor
+    /// \param other another array (its allocator is copied)
+    [[nodiscard]] inline SixBytePointerArray(const SixBytePointerArray &other)
+        : SixBytePointerArray(other._alloc)
+    {
+        if (other._size)
+        {
+            _realloc(other._size);
+            __builtin_memcpy(_ptr,other._ptr,other._size * sizeof(ElementType));
+            _size = other._size;
+        }
+    }
+
+    /// \brief copy assignment
+    /// \param other another array
+    /// \return reference to *this
+    inline SixBytePointerArray& operator=(const SixBytePointerArray &other)
+    {
+        SixBytePointerArray tmp(other);
+        _swapWith(tmp);
+        return *this;
+    }
+
+    /// \brief move constructor
+    /// \param other another array (left empty)
+    [[nodiscard]] inline SixBytePointerArray(
+        SixBytePointerArray &&other) noexcept
+        : _ptr(other._ptr), _size(other._size), _cap(other._cap),
+        _alloc(other._alloc)
+    {
+        other._ptr = nullptr;
+        other._size = 0;
+        other._cap = 0;
+    }
+
+    /// \brief move assignment
+    /// \param other another array
+    /// \return reference to *this
+    inline SixBytePointerArray& operator=(SixBytePointerArray &&other) noexcept
+    {
+        _swapWith(other);
+        return *this;
+    }
+
+    /// \brief number of elements
+    [[nodiscard]] inline usize_t size() const noexcept
+    {
+        return _size;
+    }
+
+    /// \brief is the array empty
+    [[nodiscard]] inline bool empty() const noexcept
+    {
+        return !_size;
+    }
+
+    /// \brief number of elements that fit without reallocating
+    [[nodiscard]] inline usize_t capacity() const noexcept
+    {
+        return _cap;
+    }
+
+    /// \brief bytes of memory allocated for elements
+    [[nodiscard]] inline usize_t bytes() const noexcept
+    {
+        return _cap * sizeof(ElementType);
+    }
+
+    /// \brief allocator used by this array
+    [[nodiscard]] inline AllocType allocator() const noexcept
+    {
+        return _alloc;
+    }
+
+    /// \brief ensure space for a total number of elements
+    /// \param capacity elements to reserve
+    inline void reserve(const usize_t capacity)
+    {
+        if (capacity > _cap)
+            _realloc(capacity);
+    }
+
+    /// \brief change the number of elements
+    /// \param size new size (added elements are null pointers)
+    inline void resize(const usize_t size)
+    {
+        if (size > _size)
+        {
+            _grow(size - _size);
+            for (usize_t i = _size; i < size; ++i)
+                _ptr[i] = ElementType();
+        }
+        _size = size;
+    }
+
+    /// \brief remove all elements (keeps the allocated capacity)
+    inline void clear() noexcept
+    {
+        _size = 0;
+    }
+
+    /// \brief reduce the capacity to the size
+    inline void shrinkToFit()
+    {
+        if (_cap == _size)
+            return;
+        if (_size)
+            _realloc(_size);
+        else
+        {
+            _alloc.deallocate(_ptr);
+            _ptr = nullptr;
+            _cap = 0;
+        }
+    }
+
+    /// \brief add a pointer to the end
+    /// \param ptr the pointer (high 16 bits must be zero)
+    inline void pushBack(Type * const ptr)
+    {
+        _grow(1);
+        _ptr[_size++] = ElementType(ptr);
+    }
+
+    /// \brief remove the last element (array must not be empty)
+    inline void popBack() noexcept
+    {
+        --_size;
+    }
+
+    /// \brief add pointers to the end
+    /// \param ptrs array of count pointers (high 16 bits must be zero)
+    /// \param count number of pointers
+    inline void append(Type * const * const ptrs, const usize_t count)
+    {
+        _grow(count);
+        encodeSixBytePointers(ptrs,count,_ptr + _size);
+        _size += count;
+    }
+
+    /// \brief element access (no bounds check)
+    /// \param i the index
+    /// \return reference to the stored SixBytePointer
+    [[nodiscard]] inline ElementType& operator[](const usize_t i) noexcept
+    {
+        return _ptr[i];
+    }
+
+    [[nodiscard]] inline const ElementType& operator[](
+        const usize_t i) const noexcept
+    {
+        return _ptr[i];
+    }
+
+    /// \brief element access
+    /// \param i the index
+    /// \return reference to the stored SixBytePointer
+    /// \throw IndexError if the index is out of bounds
+    [[nodiscard]] inline ElementType& at(const usize_t i)
+    {
+        if (i >= _size)
+            throw IndexError("index too large");
+        return _ptr[i];
+    }
+
+    [[nodiscard]] inline const ElementType& at(const usize_t i) const
+    {
+        return const_cast<SixBytePointerArray*>(this)->at(i);
+    }
+
+    /// \brief pointer at an index (no bounds check)
+    /// \param i the index
+    /// \return the decoded pointer
+    [[nodiscard]] inline Type* get(const usize_t i) const noexcept
+    {
+        return _ptr[i].ptr();
+    }
+
+    /// \brief replace the pointer at an index (no bounds check)
+    /// \param i the index
+    /// \param ptr the pointer (high 16 bits must be zero)
+    inline void set(const usize_t i, Type * const ptr) noexcept
+    {
+        _ptr[i] = ElementType(ptr);
+    }
+
+    /// \brief decode a range of pointers
+    /// \param first index of the first element
+    /// \param count number of elements (first + count <= size())
+    /// \param dst array for count pointers
+    inline void decode(const usize_t first, const usize_t count,
+        Type ** const dst) const noexcept
+    {
+        decodeSixBytePointers(_ptr + first,count,dst);
+    }
+
+    /// \brief call a function with each pointer in order
+    /// \param func called as func(Type*)
+    /// \param prefetch whether to prefetch the objects pointed to
+    ///
+    /// Pointers are decoded cBlockSize at a time. With prefetch, the pointers
+    /// in the next block are prefetched before the current block is visited,
+    /// which overlaps the cache misses of dereferencing them. Null pointers
+    /// are prefetched too since a prefetch does not fault, avoiding a branch.
+    template <typename FuncType>
+    inline void forEach(FuncType &&func, const bool prefetch = true) const
+    {
+        Type *blocks[2][cBlockSize];
+        usize_t cur = 0;
+        if (_size)
+            decode(0,_size < cBlockSize ? _size : cBlockSize,blocks[0]);
+        for (usize_t i = 0; i < _size; i += cBlockSize)
+        {
+            const usize_t n = _size - i < cBlockSize ? _size - i : cBlockSize;
+            const usize_t next = i + cBlockSize;
+            if (next < _size)
+            {
+                const usize_t m = _size - next < cBlockSize
+                    ? _size - next : cBlockSize;
+                decode(next,m,blocks[cur^1]);
+                if (prefetch)
+                    for (usize_t j = 0; j < m; ++j)
+                        __builtin_prefetch(blocks[cur^1][j]);
+            }
+            for (usize_t j = 0; j < n; ++j)
+                func(blocks[cur][j]);
+            cur ^= 1;
+        }
+    }
+
+    /// \brief pointer to the elements
+    [[nodiscard]] inline ElementType* data() noexcept
+    {
+        return _ptr;
+    }
+
+    [[nodiscard]] inline const ElementType* data() const noexcept
+    {
+        return _ptr;
+    }
+
+    /// \brief iterator to the first element (elements convert to Type*)
+    [[nodiscard]] inline ElementType* begin() noexcept
+    {
+        return _ptr;
+    }
+
+    [[nodiscard]] inline const ElementType* begin() const noexcept
+    {
+        return _ptr;
+    }
+
+    /// \brief iterator past the last element
+    [[nodiscard]] inline ElementType* end() noexcept
+    {
+        return _ptr + _size;
+    }
+
+    [[nodiscard]] inline const ElementType* end() const noexcept
+    {
+        return _ptr + _size;
+    }
+};
+
+} // namespace tkoz::stl
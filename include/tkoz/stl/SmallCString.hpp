@@ -0,0 +1,547 @@
+///
+/// C string wrapper with small string optimization and cached length
+///
+
+#pragma once
+
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/Concepts.hpp>
+#include <tkoz/stl/Exceptions.hpp>
+#include <tkoz/stl/Types.hpp>
+#include <tkoz/stl/Utils.hpp>
+
+namespace tkoz::stl
+{
+
+/// \brief extended C string with inline storage for short values
+/// \tparam CharType character type
+/// \tparam allowNull whether to allow a null C string
+/// \tparam inlineCapacity characters stored inline (including null terminator)
+///
+/// This is a sibling of CString with the same null-terminated contract. The
+/// length is stored so len() is constant time, and strings shorter than
+/// inlineCapacity (so the null terminator also fits) are stored inside the
+/// object without dynamic memory allocation. Longer strings are allocated with
+/// new[] like CString. The default capacity reuses the space of 2 pointers, so
+/// for char, strings up to 15 characters do not allocate.
+///
+/// A null string (if allowed) is different from the empty string and has
+/// length 0. Behavior is undefined if a null character is inserted anywhere
+/// other than at the end or if the null terminator is changed, since the
+/// stored length would no longer match.
+template <typename _CharType = char, bool _allowNull = true,
+    usize_t _inlineCapacity = (2 * sizeof(void*)) / sizeof(_CharType)>
+class SmallCString
+{
+public:
+
+    /// character type
+    using CharType = _CharType;
+
+    /// is null pointer allowed
+    static constexpr bool allowNull = _allowNull;
+
+    /// characters stored inline (including null terminator)
+    static constexpr usize_t cInlineCapacity = _inlineCapacity;
+
+    static_assert(cInlineCapacity > 0,
+        "inline capacity must fit at least the null terminator");
+
+private:
+
+    /// CString with matching parameters for the static C string functions
+    using _CStr = CString<CharType,allowNull>;
+
+    /// CString functions that do not check for null
+    using _CStrNoNull = CString<CharType,false>;
+
+    /// length value representing the null string
+    static constexpr usize_t _cNullLen = static_cast<usize_t>(-1);
+
+    /// string length (excludes null terminator) or _cNullLen
+    usize_t _len;
+
+    /// heap pointer if length >= cInlineCapacity, otherwise inline storage
+    union
+    {
+        CharType *_heap;
+        CharType _buf[cInlineCapacity];
+    };
+
+    /// is the string value stored inside the object
+    [[nodiscard]] inline bool _isInline() const noexcept
+    {
+        return _len < cInlineCapacity;
+    }
+
+    /// set to the null string
+    inline void _setNull() noexcept
+    {
+        _len = _cNullLen;
+        _heap = nullptr;
+    }
+
+    /// prepare storage for a string of length l and return pointer to it
+    /// (does not write the null terminator)
+    ///
+    /// Always inlined so the heap branch is never split into a function that
+    /// identical code folding shares between inline capacities, where gcc
+    /// would see a heap store through the wrong class size (-Warray-bounds).
+    [[gnu::always_inline]] inline CharType* _alloc(const usize_t l)
+    {
+        if (l < cInlineCapacity)
+        {
+            _len = l;
+            return _buf;
+        }
+        _heap = new CharType[l+1];
+        _len = l;
+        return _heap;
+    }
+
+    /// initialize from a pointer with known length (not null)
+    inline void _initFrom(const CharType * const ptr, const usize_t l)
+    {
+        CharType *p = _alloc(l);
+        for (usize_t i = 0; i < l; ++i)
+            p[i] = ptr[i];
+        p[l] = static_cast<CharType>(0);
+    }
+
+    /// free heap memory if it is used
+    inline void _free() noexcept
+    {
+        if (!_isInline())
+            delete[] _heap;
+    }
+
+    /// copy value from other
+    inline void _copyFrom(const SmallCString &other)
+    {
+        if constexpr (allowNull)
+        {
+            if (other._len == _cNullLen)
+            {
+                _setNull();
+                return;
+            }
+        }
+        _initFrom(other.ptr(),other._len);
+    }
+
+    /// take value from other, leaving it null
+    inline void _moveFrom(SmallCString &other) noexcept
+    {
+        _len = other._len;
+        if (_isInline())
+        {
+            for (usize_t i = 0; i <= _len; ++i)
+                _buf[i] = other._buf[i];
+        }
+        else
+            _heap = other._heap;
+        other._setNull();
+    }
+
+public:
+
+    /// \brief initialize as null string
+    [[nodiscard]] inline SmallCString() noexcept
+    {
+        _setNull();
+    }
+
+    /// \brief initialize from a C string
+    /// \param ptr a null-terminated C string, or nullptr
+    [[nodiscard]] inline SmallCString(const CharType * const ptr)
+    {
+        if constexpr (allowNull)
+        {
+            if (!ptr)
+            {
+                _setNull();
+                return;
+            }
+        }
+        _initFrom(ptr,_CStrNoNull::ptrLen(ptr));
+    }
+
+    /// \brief initialize from a pointer with a known length
+    /// \param ptr pointer to at least len characters (not null)
+    /// \param len number of characters to copy
+    ///
+    /// The characters must not contain a null character.
+    [[nodiscard]] inline SmallCString(
+        const CharType * const ptr, const usize_t len)
+    {
+        _initFrom(ptr,len);
+    }
+
+    /// \brief initialize with a repeated character
+    /// \param count string length
+    /// \param value character value
+    ///
+    /// Character value must be nonzero.
+    [[nodiscard]] inline SmallCString(
+        const usize_t count, const CharType value)
+    {
+        CharType *p = _alloc(count);
+        for (usize_t i = 0; i < count; ++i)
+            p[i] = value;
+        p[count] = static_cast<CharType>(0);
+    }
+
+    /// \brief initialize from a CString
+    /// \param str a CString with the same character type
+    template <bool otherAllowNull>
+    [[nodiscard]] inline explicit SmallCString(
+        const CString<CharType,otherAllowNull> &str)
+        : SmallCString(str.ptr()) {}
+
+    /// \brief destructor
+    inline ~SmallCString()
+    {
+        _free();
+    }
+
+    /// \brief copy constructor
+    /// \param other another SmallCString
+    [[nodiscard]] inline SmallCString(const SmallCString &other)
+    {
+        _copyFrom(other);
+    }
+
+    /// \brief copy assignment
+    /// \param other another SmallCString
+    /// \return reference to *this
+    inline SmallCString& operator=(const SmallCString &other)
+    {
+        if (this != &other)
+        {
+            SmallCString tmp(other);
+            _free();
+            _moveFrom(tmp);
+        }
+        return *this;
+    }
+
+    /// \brief move constructor
+    /// \param other another SmallCString
+    [[nodiscard]] inline SmallCString(SmallCString &&other) noexcept
+    {
+        _moveFrom(other);
+    }
+
+    /// \brief move assignment
+    /// \param other another SmallCString
+    /// \return reference to *this
+    inline SmallCString& operator=(SmallCString &&other) noexcept
+    {
+        if (this != &other)
+        {
+            _free();
+            _moveFrom(other);
+        }
+        return *this;
+    }
+
+    /// \brief length of the string (excludes null terminator) (constant time)
+    /// \return string length
+    [[nodiscard]] inline usize_t len() const noexcept
+    {
+        if constexpr (allowNull)
+            return _len == _cNullLen ? 0 : _len;
+        else
+            return _len;
+    }
+
+    /// \brief length of the string (excludes null terminator) (constant time)
+    /// \return string length
+    [[nodiscard]] inline usize_t size() const noexcept
+    {
+        return len();
+    }
+
+    /// \brief const pointer to the string value
+    /// \return const C string pointer
+    [[nodiscard]] inline const CharType* ptr() const noexcept
+    {
+        return _isInline() ? _buf : _heap;
+    }
+
+    /// \brief non const pointer to the string value
+    /// \return non const C string pointer
+    [[nodiscard]] inline CharType* ptr() noexcept
+    {
+        return _isInline() ? _buf : _heap;
+    }
+
+    /// \brief is the string stored without dynamic memory allocation
+    /// \return true if the value is stored inline (or is null)
+    [[nodiscard]] inline bool isInline() const noexcept
+    {
+        return _isInline() || _len == _cNullLen;
+    }
+
+    /// \brief true if non null and non empty
+    /// \return boolean representation of the string (true if positive length)
+    [[nodiscard]] inline operator bool() const noexcept
+    {
+        return len() > 0;
+    }
+
+    /// \brief is string null (not the same as the empty string)
+    /// \return true if the string stored is nullptr
+    /// \note this function should be avoided if allowNull == false
+    [[nodiscard]] inline bool isNull() const noexcept
+    {
+        if constexpr (allowNull)
+            return _len == _cNullLen;
+        else
+            return false;
+    }
+
+    /// \brief copy to a CString
+    /// \return CString with the same value
+    [[nodiscard]] inline CString<CharType,allowNull> toCString() const
+    {
+        return CString<CharType,allowNull>(ptr());
+    }
+
+    /// \brief compare equality
+    /// \param left a SmallCString
+    /// \param right a SmallCString
+    /// \return true if both strings are equal
+    ///
+    /// Strings of different lengths are rejected without reading characters.
+    [[nodiscard]] friend inline bool operator==(
+        const SmallCString &left, const SmallCString &right) noexcept
+    {
+        if (left._len != right._len)
+            return false;
+        if constexpr (allowNull)
+        {
+            if (left._len == _cNullLen)
+                return true;
+        }
+        const CharType *l = left.ptr();
+        const CharType *r = right.ptr();
+        for (usize_t i = 0; i < left._len; ++i)
+            if (l[i] != r[i])
+                return false;
+        return true;
+    }
+
+    /// \brief compare equality
+    /// \param left a pointer
+    /// \param right a SmallCString
+    /// \return true if both strings are equal
+    [[nodiscard]] friend inline bool operator==(
+        const CharType * const left, const SmallCString &right) noexcept
+    {
+        return _CStr::ptrCmpEq(left,right.ptr());
+    }
+
+    /// \brief compare equality
+    /// \param left a SmallCString
+    /// \param right a pointer
+    /// \return true if both strings are equal
+    [[nodiscard]] friend inline bool operator==(
+        const SmallCString &left, const CharType * const right) noexcept
+    {
+        return _CStr::ptrCmpEq(left.ptr(),right);
+    }
+
+    /// \brief compare 3 way
+    /// \param left a SmallCString
+    /// \param right a SmallCString
+    /// \return 3 way compare result of both strings
+    [[nodiscard]] friend inline auto operator<=>(
+        const SmallCString &left, const SmallCString &right) noexcept
+    {
+        return _CStr::ptrCmp3way(left.ptr(),right.ptr());
+    }
+
+    /// \brief compare 3 way
+    /// \param left a pointer
+    /// \param right a SmallCString
+    /// \return 3 way compare result of both strings
+    [[nodiscard]] friend inline auto operator<=>(
+        const CharType * const left, const SmallCString &right) noexcept
+    {
+        return _CStr::ptrCmp3way(left,right.ptr());
+    }
+
+    /// \brief compare 3 way
+    /// \param left a SmallCString
+    /// \param right a pointer
+    /// \return 3 way compare result of both strings
+    [[nodiscard]] friend inline auto operator<=>(
+        const SmallCString &left, const CharType * const right) noexcept
+    {
+        return _CStr::ptrCmp3way(left.ptr(),right);
+    }
+
+    /// \brief concatenate 2 strings (both of this class)
+    ///
+    /// The result is null only if both strings are null.
+    [[nodiscard]] friend inline SmallCString operator+(
+        const SmallCString &left, const SmallCString &right)
+    {
+        SmallCString ret(left);
+        ret += right;
+        return ret;
+    }
+
+    /// \brief concatenate 2 strings (c string on left)
+    [[nodiscard]] friend inline SmallCString operator+(
+        const CharType * const left, const SmallCString &right)
+    {
+        SmallCString ret(left);
+        ret += right;
+        return ret;
+    }
+
+    /// \brief concatenate 2 strings (c string on right)
+    [[nodiscard]] friend inline SmallCString operator+(
+        const SmallCString &left, const CharType * const right)
+    {
+        SmallCString ret(left);
+        ret += right;
+        return ret;
+    }
+
+    /// \brief concatenate another string to the end
+    /// \param other pointer to the string and its length
+    /// \param l2 length of other
+    /// \return reference to *this
+    ///
+    /// Memory is only allocated if the result does not fit inline.
+    inline SmallCString& append(const CharType * const other, const usize_t l2)
+    {
+        if constexpr (allowNull)
+        {
+            if (_len == _cNullLen)
+            {
+                if (!other)
+                    return *this;
+                _initFrom(other,l2);
+                return *this;
+            }
+            if (!other)
+                return *this;
+        }
+        const usize_t l1 = _len;
+        const usize_t l = l1 + l2;
+        if (l < cInlineCapacity)
+        {
+            for (usize_t i = 0; i < l2; ++i)
+                _buf[l1+i] = other[i];
+            _buf[l] = static_cast<CharType>(0);
+            _len = l;
+            return *this;
+        }
+        CharType *p = new CharType[l+1];
+        const CharType *old = ptr();
+        for (usize_t i = 0; i < l1; ++i)
+            p[i] = old[i];
+        for (usize_t i = 0; i < l2; ++i)
+            p[l1+i] = other[i];
+        p[l] = static_cast<CharType>(0);
+        _free();
+        _heap = p;
+        _len = l;
+        return *this;
+    }
+
+    /// \brief concatenate another string to the end
+    inline SmallCString& operator+=(const CharType * const other)
+    {
+        if constexpr (allowNull)
+        {
+            if (!other)
+                return *this;
+        }
+        return append(other,_CStrNoNull::ptrLen(other));
+    }
+
+    /// \brief concatenate another string to the end
+    inline SmallCString& operator+=(const SmallCString &other)
+    {
+        if constexpr (allowNull)
+        {
+            if (other._len == _cNullLen)
+                return *this;
+        }
+        return append(other.ptr(),other._len);
+    }
+
+    /// \brief (non const) access to a character
+    /// \param i the index
+    /// \return reference to ith character
+    ///
+    /// Behavior is undefined if i is ouf of bounds or string is null.
+    /// The valid range is [0,len()] (which includes the null terminator).
+    [[nodiscard]] inline CharType& operator[](usize_t i) noexcept
+    {
+        return ptr()[i];
+    }
+
+    [[nodiscard]] inline const CharType& operator[](usize_t i) const noexcept
+    {
+        return ptr()[i];
+    }
+
+    /// \brief (non const) access to a character
+    /// \tparam IndexType type of index (bool or integer primitive)
+    /// \param i the index
+    /// \return reference to character at that index
+    /// \throw NullError if the string value is nullptr
+    /// \throw IndexError if the index is out of bounds
+    ///
+    /// Same as CString::at() except bounds are checked in constant time.
+    template <concepts::isPrimitiveIntegerOrBool IndexType>
+    [[nodiscard]] inline CharType& at(IndexType i)
+    {
+        if constexpr (allowNull)
+        {
+            if (_len == _cNullLen)
+                throw NullError("string pointer is null");
+        }
+        if constexpr (concepts::isBool<IndexType>)
+        {
+            if (i && !_len)
+                throw IndexError("index too large");
+            return ptr()[i];
+        }
+        else
+        {
+            if constexpr (concepts::isPrimitiveSignedInteger<IndexType>)
+            {
+                const ssize_t j = static_cast<ssize_t>(i);
+                if (j < 0)
+                {
+                    if (j < -static_cast<ssize_t>(_len))
+                        throw IndexError("index too small");
+                    return ptr()[_len + static_cast<usize_t>(j)];
+                }
+            }
+            if (static_cast<usize_t>(i) > _len)
+                throw IndexError("index too large");
+            return ptr()[static_cast<usize_t>(i)];
+        }
+    }
+
+    /// \brief const access to a character
+    /// \return character by value
+    /// \throw NullError or IndexError
+    ///
+    /// See non const version for details.
+    template <concepts::isPrimitiveIntegerOrBool IndexType>
+    [[nodiscard]] inline const CharType& at(IndexType i) const
+    {
+        return const_cast<SmallCString*>(this)->at(i);
+    }
+};
+
+} // namespace tkoz::stl
@@ -0,0 +1,329 @@
+///
+/// multiple pattern string search (Aho-Corasick automaton)
+///
+
+#pragma once
+
+#include <tkoz/stl/CStringSimd.hpp>
+#include <tkoz/stl/CStringView.hpp>
+#include <tkoz/stl/Exceptions.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <initializer_list>
+#include <type_traits>
+#include <vector>
+
+namespace tkoz::stl
+{
+
+/// \brief occurrence of a pattern found by AhoCorasick
+struct SearchMatch
+{
+    /// index of the pattern (order given to the constructor)
+    usize_t pattern;
+
+    /// index of the first character of the occurrence
+    usize_t pos;
+
+    /// length of the occurrence (length of the pattern)
+    usize_t len;
+
+    [[nodiscard]] friend inline bool operator==(
+        const SearchMatch&, const SearchMatch&) noexcept = default;
+
+    /// \brief swap (exact match so std::sort does not find std::swap and
+    /// tkoz::stl::swap ambiguous)
+    friend inline constexpr void swap(SearchMatch &a, SearchMatch &b) noexcept
+    {
+        const SearchMatch t = a;
+        a = b;
+        b = t;
+    }
+};
+
+/// \brief matcher finding occurrences of many patterns in one pass
+/// \tparam CharType character type (byte sized)
+///
+/// The patterns are compiled once into a deterministic automaton, which is
+/// then reused for any number of inputs. Each input character costs one table
+/// lookup regardless of the number of patterns, plus the work of reporting
+/// the matches. Bytes not occurring in any pattern share one alphabet class,
+/// so each state stores only (distinct pattern bytes + 1) transitions.
+///
+/// All occurrences are reported, including overlapping ones, in order of their
+/// end position (longer patterns first when several end at the same position).
+/// The matcher is immutable after construction and safe to use from multiple
+/// threads at once.
+template <typename _CharType = char>
+class AhoCorasick
+{
+public:
+
+    /// character type
+    using CharType = _CharType;
+
+    /// input view type
+    using ViewType = CStringView<CharType>;
+
+    static_assert(simd::isByteChar<CharType>,
+        "AhoCorasick requires byte sized characters");
+
+    /// index value meaning none
+    static constexpr usize_t npos = static_cast<usize_t>(-1);
+
+private:
+
+    /// missing state or pattern
+    static constexpr uint32_t _cNone = static_cast<uint32_t>(-1);
+
+    /// alphabet class of each byte value (0 for bytes in no pattern)
+    uint16_t _classOf[256];
+
+    /// number of alphabet classes (row length of _delta)
+    usize_t _classes;
+
+    /// transition table (state * _classes + class -> state)
+    std::vector<uint32_t> _delta;
+
+    /// first pattern ending at each state (others follow _nextPattern)
+    std::vector<uint32_t> _out;
+
+    /// nearest proper suffix state with an output
+    std::vector<uint32_t> _dict;
+
+    /// first state to report from each state (itself or _dict)
+    std::vector<uint32_t> _report;
+
+    /// next pattern with the same value (duplicate patterns)
+    std::vector<uint32_t> _nextPattern;
+
+    /// length of each pattern
+    std::vector<usize_t> _patternLen;
+
+    /// add a state with no transitions
+    inline uint32_t _newState()
+    {
+        const uint32_t s = static_cast<uint32_t>(_out.size());
+        _delta.resize(_delta.size() + _classes,_cNone);
+        _out.push_back(_cNone);
+        _dict.push_back(_cNone);
+        return s;
+    }
+
+    /// build the automaton
+    inline void _build(const ViewType * const patterns, const usize_t count)
+    {
+        for (uint16_t &c : _classOf)
+            c = 0;
+        for (usize_t p = 0; p < count; ++p)
+        {
+            if (patterns[p].empty())
+                throw ArgumentError("empty pattern");
+            for (const CharType c : patterns[p])
+                _classOf[static_cast<uchar_t>(c)] = 1;
+        }
+        _classes = 1;
+        for (uint16_t &c : _classOf)
+            if (c)
+                c = static_cast<uint16_t>(_classes++);
+        // trie of the patterns
+        _newState();
+        _nextPattern.assign(count,_cNone);
+        _patternLen.resize(count);
+        for (usize_t p = 0; p < count; ++p)
+        {
+            uint32_t s = 0;
+            for (const CharType c : patterns[p])
+            {
+                const usize_t i = s * _classes
+                    + _classOf[static_cast<uchar_t>(c)];
+                if (_delta[i] == _cNone)
+                {
+                    const uint32_t t = _newState();
+                    _delta[i] = t;
+                }
+                s = _delta[i];
+            }
+            _nextPattern[p] = _out[s];
+            _out[s] = static_cast<uint32_t>(p);
+            _patternLen[p] = patterns[p].len();
+        }
+        // breadth first over the trie, filling missing transitions from the
+        // failure state (whose row is already complete since it is shallower)
+        std::vector<uint32_t> fail(_out.size(),0);
+        std::vector<uint32_t> queue;
+        queue.reserve(_out.size());
+        for (usize_t c = 0; c < _classes; ++c)
+        {
+            uint32_t &t = _delta[c];
+            if (t == _cNone)
+                t = 0;
+            else
+                queue.push_back(t);
+        }
+        for (usize_t q = 0; q < queue.size(); ++q)
+        {
+            const uint32_t s = queue[q];
+            const uint32_t *failRow = _delta.data() + fail[s] * _classes;
+            for (usize_t c = 0; c < _classes; ++c)
+            {
+                uint32_t &t = _delta[s * _classes + c];
+                if (t == _cNone)
+                    t = failRow[c];
+                else
+                {
+                    const uint32_t f = failRow[c];
+                    fail[t] = f;
+                    _dict[t] = _out[f] != _cNone ? f : _dict[f];
+                    queue.push_back(t);
+                }
+            }
+        }
+        _report.resize(_out.size());
+        for (usize_t s = 0; s < _out.size(); ++s)
+            _report[s] = _out[s] != _cNone
+                ? static_cast<uint32_t>(s) : _dict[s];
+    }
+
+public:
+
+    /// \brief compile patterns into an automaton
+    /// \param patterns array of patterns (copied, may be freed afterward)
+    /// \param count number of patterns
+    /// \throw ArgumentError if a pattern is empty
+    [[nodiscard]] inline AhoCorasick(
+        const ViewType * const patterns, const usize_t count)
+    {
+        _build(patterns,count);
+    }
+
+    /// \brief compile patterns into an automaton
+    /// \param patterns the patterns (copied, may be freed afterward)
+    /// \throw ArgumentError if a pattern is empty
+    [[nodiscard]] inline AhoCorasick(std::initializer_list<ViewType> patterns)
+    {
+        _build(patterns.begin(),patterns.size());
+    }
+
+    /// \brief compile patterns into an automaton
+    /// \param patterns the patterns (copied, may be freed afterward)
+    /// \throw ArgumentError if a pattern is empty
+    [[nodiscard]] inline explicit AhoCorasick(
+        const std::vector<ViewType> &patterns)
+    {
+        _build(patterns.data(),patterns.size());
+    }
+
+    /// \brief number of patterns
+    [[nodiscard]] inline usize_t patternCount() const noexcept
+    {
+        return _patternLen.size();
+    }
+
+    /// \brief number of automaton states
+    [[nodiscard]] inline usize_t stateCount() const noexcept
+    {
+        return _out.size();
+    }
+
+    /// \brief number of alphabet classes (transitions per state)
+    [[nodiscard]] inline usize_t classCount() const noexcept
+    {
+        return _classes;
+    }
+
+    /// \brief bytes used by the automaton tables
+    [[nodiscard]] inline usize_t memoryUsage() const noexcept
+    {
+        return sizeof(*this) + sizeof(uint32_t) * (_delta.size() + _out.size()
+            + _dict.size() + _report.size() + _nextPattern.size())
+            + sizeof(usize_t) * _patternLen.size();
+    }
+
+    /// \brief call a function for each occurrence of each pattern
+    /// \param text input to search
+    /// \param func called with a SearchMatch for each occurrence, and if it
+    /// returns bool, returning false stops the search
+    /// \return false if func stopped the search, true otherwise
+    template <typename FuncType>
+    inline bool forEachMatch(const ViewType text, FuncType &&func) const
+    {
+        const uint32_t *delta = _delta.data();
+        const uint32_t *report = _report.data();
+        const usize_t classes = _classes;
+        const CharType *ptr = text.ptr();
+        uint32_t s = 0;
+        for (usize_t i = 0; i < text.len(); ++i)
+        {
+            s = delta[s * classes + _classOf[static_cast<uchar_t>(ptr[i])]];
+            for (uint32_t t = report[s]; t != _cNone; t = _dict[t])
+                for (uint32_t p = _out[t]; p != _cNone; p = _nextPattern[p])
+                {
+                    const usize_t len = _patternLen[p];
+                    const SearchMatch m{p,i + 1 - len,len};
+                    using ResultType =
+                        std::invoke_result_t<FuncType&,const SearchMatch&>;
+                    if constexpr (std::is_same_v<ResultType,bool>)
+                    {
+                        if (!func(m))
+                            return false;
+                    }
+                    else
+                        func(m);
+                }
+        }
+        return true;
+    }
+
+    /// \brief all occurrences of all patterns
+    /// \param text input to search
+    /// \return matches in order of end position
+    [[nodiscard]] inline std::vector<SearchMatch> findAll(
+        const ViewType text) const
+    {
+        std::vector<SearchMatch> ret;
+        forEachMatch(text,[&ret](const SearchMatch &m) { ret.push_back(m); });
+        return ret;
+    }
+
+    /// \brief first occurrence (smallest end position) of any pattern
+    /// \param text input to search
+    /// \return the match, or pattern == npos if there is none
+    [[nodiscard]] inline SearchMatch findFirst(const ViewType text) const
+    {
+        SearchMatch ret{npos,npos,0};
+        forEachMatch(text,[&ret](const SearchMatch &m)
+        {
+            ret = m;
+            return false;
+        });
+        return ret;
+    }
+
+    /// \brief does any pattern occur
+    /// \param text input to search
+    [[nodiscard]] inline bool containsAny(const ViewType text) const
+    {
+        const uint32_t *delta = _delta.data();
+        const CharType *ptr = text.ptr();
+        uint32_t s = 0;
+        for (usize_t i = 0; i < text.len(); ++i)
+        {
+            s = delta[s * _classes + _classOf[static_cast<uchar_t>(ptr[i])]];
+            if (_report[s] != _cNone)
+                return true;
+        }
+        return false;
+    }
+
+    /// \brief total number of occurrences of all patterns
+    /// \param text input to search
+    [[nodiscard]] inline usize_t countMatches(const ViewType text) const
+    {
+        usize_t ret = 0;
+        forEachMatch(text,[&ret](const SearchMatch&) { ++ret; });
+        return ret;
+    }
+};
+
+} // namespace tkoz::stl
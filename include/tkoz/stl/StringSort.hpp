@@ -0,0 +1,589 @@
+///
+/// string sorting (MSD radix sort, multikey quicksort, parallel LCP merge)
+///
+
+#pragma once
+
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/CStringSimd.hpp>
+#include <tkoz/stl/CStringView.hpp>
+#include <tkoz/stl/Concepts.hpp>
+#include <tkoz/stl/Meta.hpp>
+#include <tkoz/stl/Types.hpp>
+#include <tkoz/stl/Utils.hpp>
+
+#include <compare>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace tkoz::stl
+{
+
+namespace _detail
+{
+
+/// \brief sort entry for CString arrays (sorted indirectly)
+template <typename CharType>
+struct _SortIndexed
+{
+    /// the string
+    const CharType *ptr;
+
+    /// index in the original array
+    usize_t idx;
+};
+
+/// \brief character key type for sorting (byte keys are radix sortable)
+template <typename CharType>
+using _SortKey = std::conditional_t<simd::isByteChar<CharType>,
+    uint16_t,int64_t>;
+
+/// \brief byte value mapped so unsigned order matches CharType order
+template <typename CharType>
+[[nodiscard]] inline constexpr uint16_t _sortByte(const CharType c) noexcept
+{
+    constexpr uchar_t flip = std::is_signed_v<CharType> ? 0x80 : 0;
+    return static_cast<uint16_t>(static_cast<uchar_t>(c) ^ flip);
+}
+
+/// \brief sort traits of null-terminated strings (pointers and CString)
+///
+/// Keys are the characters themselves so the order is that of
+/// CString::ptrCmp3way(). The null terminator ends a string. Null pointers
+/// are removed before sorting.
+template <typename _CharType, typename _ElemType>
+struct _SortNullTerm
+{
+    using CharType = _CharType;
+    using ElemType = _ElemType;
+    using KeyType = _SortKey<CharType>;
+
+    /// number of distinct keys (for radix sort)
+    static constexpr usize_t cKeys = 256;
+
+    /// key of the null terminator
+    static constexpr KeyType cEnd = simd::isByteChar<CharType>
+        ? _sortByte(CharType(0)) : 0;
+
+    [[nodiscard]] static inline const CharType* str(const ElemType &e) noexcept
+    {
+        if constexpr (std::is_pointer_v<ElemType>)
+            return e;
+        else
+            return e.ptr;
+    }
+
+    /// key at an index (at most the length)
+    [[nodiscard]] static inline KeyType key(
+        const ElemType &e, const usize_t depth) noexcept
+    {
+        if constexpr (simd::isByteChar<CharType>)
+            return _sortByte(str(e)[depth]);
+        else
+            return static_cast<KeyType>(str(e)[depth]);
+    }
+
+    /// compare strings with a common prefix of length depth
+    /// \param lcp set to the length of the common prefix
+    [[nodiscard]] static inline std::strong_ordering cmp(const ElemType &a,
+        const ElemType &b, const usize_t depth, usize_t &lcp) noexcept
+    {
+        const CharType *sa = str(a);
+        const CharType *sb = str(b);
+        lcp = depth + simd::strMismatch(sa + depth,sb + depth);
+        return sa[lcp] <=> sb[lcp];
+    }
+};
+
+/// \brief sort traits of strings with a known length (CStringView)
+///
+/// Keys are characters before the end and a lowest key after, so the order is
+/// that of CStringView (shorter strings first when one is a prefix).
+template <typename _CharType>
+struct _SortView
+{
+    using CharType = _CharType;
+    using ElemType = CStringView<CharType>;
+    using KeyType = _SortKey<CharType>;
+
+    static constexpr usize_t cKeys = 257;
+
+    static constexpr KeyType cEnd = simd::isByteChar<CharType>
+        ? 0 : std::numeric_limits<KeyType>::min();
+
+    [[nodiscard]] static inline KeyType key(
+        const ElemType &e, const usize_t depth) noexcept
+    {
+        if (depth >= e.len())
+            return cEnd;
+        if constexpr (simd::isByteChar<CharType>)
+            return static_cast<KeyType>(1 + _sortByte(e[depth]));
+        else
+            return static_cast<KeyType>(e[depth]);
+    }
+
+    [[nodiscard]] static inline std::strong_ordering cmp(const ElemType &a,
+        const ElemType &b, const usize_t depth, usize_t &lcp) noexcept
+    {
+        const usize_t n = a.len() < b.len() ? a.len() : b.len();
+        lcp = depth + simd::memMismatch(a.ptr() + depth,b.ptr() + depth,
+            n - depth);
+        return lcp < n ? a[lcp] <=> b[lcp] : a.len() <=> b.len();
+    }
+};
+
+/// depth of a part that needs no more sorting
+inline constexpr usize_t _cSortDone = static_cast<usize_t>(-1);
+
+/// below this size, use insertion sort
+inline constexpr usize_t _cSortInsertion = 16;
+
+/// below this size, radix sort uses multikey quicksort
+inline constexpr usize_t _cSortRadixMin = 64;
+
+/// \brief insertion sort of strings with a common prefix
+template <typename Traits>
+inline void _insertionSort(typename Traits::ElemType * const a,
+    const usize_t n, const usize_t depth) noexcept
+{
+    usize_t lcp;
+    for (usize_t i = 1; i < n; ++i)
+    {
+        const typename Traits::ElemType e = a[i];
+        usize_t j = i;
+        for (; j > 0 && Traits::cmp(e,a[j-1],depth,lcp) < 0; --j)
+            a[j] = a[j-1];
+        a[j] = e;
+    }
+}
+
+/// \brief multikey quicksort of strings with a common prefix
+///
+/// Partitions by the key at depth into less, equal, and greater parts. The
+/// 2 smaller parts are sorted recursively and the largest by continuing the
+/// loop, so the recursion depth is logarithmic.
+template <typename Traits>
+inline void _multikeyQuicksort(typename Traits::ElemType *a, usize_t n,
+    usize_t depth) noexcept
+{
+    using KeyType = typename Traits::KeyType;
+    while (n >= _cSortInsertion)
+    {
+        // median of 3 keys
+        KeyType k0 = Traits::key(a[0],depth);
+        KeyType k1 = Traits::key(a[n/2],depth);
+        KeyType k2 = Traits::key(a[n-1],depth);
+        if (k0 > k1)
+            swap(k0,k1);
+        if (k1 > k2)
+            k1 = k0 > k2 ? k0 : k2;
+        const KeyType pivot = k1;
+        usize_t lt = 0, i = 0, gt = n;
+        while (i < gt)
+        {
+            const KeyType k = Traits::key(a[i],depth);
+            if (k < pivot)
+                swap(a[lt++],a[i++]);
+            else if (k > pivot)
+                swap(a[i],a[--gt]);
+            else
+                ++i;
+        }
+        // parts: [0,lt) less, [lt,gt) equal, [gt,n) greater
+        struct Part { usize_t begin, n, depth; };
+        Part parts[3] =
+        {
+            {0,lt,depth},
+            {lt,gt - lt,pivot == Traits::cEnd ? _cSortDone : depth + 1},
+            {gt,n - gt,depth}
+        };
+        usize_t big = 0;
+        for (usize_t p = 1; p < 3; ++p)
+            if (parts[p].n > parts[big].n)
+                big = p;
+        for (usize_t p = 0; p < 3; ++p)
+            if (p != big && parts[p].n > 1 && parts[p].depth != _cSortDone)
+                _multikeyQuicksort<Traits>(a + parts[p].begin,parts[p].n,
+                    parts[p].depth);
+        if (parts[big].depth == _cSortDone)
+            return;
+        a += parts[big].begin;
+        n = parts[big].n;
+        depth = parts[big].depth;
+    }
+    _insertionSort<Traits>(a,n,depth);
+}
+
+/// \brief MSD radix sort (byte keys)
+///
+/// Buckets are processed from an explicit stack so long common prefixes do
+/// not cause deep recursion. Keys of each bucket are computed once into a
+/// buffer, then elements are distributed through a buffer of the same size.
+template <typename Traits>
+inline void _msdRadixSort(typename Traits::ElemType * const a,
+    const usize_t n)
+{
+    using ElemType = typename Traits::ElemType;
+    static_assert(simd::isByteChar<typename Traits::CharType>);
+    if (n < _cSortRadixMin)
+    {
+        _multikeyQuicksort<Traits>(a,n,0);
+        return;
+    }
+    struct Task { usize_t begin, n, depth; };
+    std::vector<Task> stack{{0,n,0}};
+    std::vector<ElemType> tmp(n);
+    std::vector<uint16_t> keys(n);
+    usize_t count[Traits::cKeys];
+    while (!stack.empty())
+    {
+        const Task t = stack.back();
+        stack.pop_back();
+        ElemType * const b = a + t.begin;
+        if (t.n < _cSortRadixMin)
+        {
+            _multikeyQuicksort<Traits>(b,t.n,t.depth);
+            continue;
+        }
+        for (usize_t &c : count)
+            c = 0;
+        for (usize_t i = 0; i < t.n; ++i)
+            ++count[keys[i] = Traits::key(b[i],t.depth)];
+        // all in one bucket, go to the next character
+        if (count[keys[0]] == t.n)
+        {
+            if (keys[0] != Traits::cEnd)
+                stack.push_back({t.begin,t.n,t.depth + 1});
+            continue;
+        }
+        usize_t start[Traits::cKeys];
+        usize_t sum = 0;
+        for (usize_t k = 0; k < Traits::cKeys; ++k)
+        {
+            start[k] = sum;
+            sum += count[k];
+        }
+        for (usize_t i = 0; i < t.n; ++i)
+            tmp[start[keys[i]]++] = b[i];
+        for (usize_t i = 0; i < t.n; ++i)
+            b[i] = tmp[i];
+        for (usize_t k = 0; k < Traits::cKeys; ++k)
+            if (count[k] > 1 && k != Traits::cEnd)
+                stack.push_back({t.begin + start[k] - count[k],count[k],
+                    t.depth + 1});
+    }
+}
+
+/// \brief best sequential sort for the character type
+template <typename Traits>
+inline void _stringSort(typename Traits::ElemType * const a, const usize_t n)
+{
+    if constexpr (simd::isByteChar<typename Traits::CharType>)
+        _msdRadixSort<Traits>(a,n);
+    else
+        _multikeyQuicksort<Traits>(a,n,0);
+}
+
+/// \brief merge 2 sorted runs using their longest common prefix arrays
+/// \param a1 first run (n1 elements, lcp1[i] = lcp of elements i-1 and i)
+/// \param a2 second run
+/// \param out destination for n1 + n2 elements
+/// \param lcpOut destination for the lcp array of the output
+///
+/// For the candidates from each run, the lcp with the last output element is
+/// known. If these differ, the candidate with the longer one is smaller and
+/// no characters are compared. Otherwise both are compared starting after the
+/// common prefix, so each character is compared at most once per merge.
+template <typename Traits>
+inline void _lcpMerge(
+    const typename Traits::ElemType * const a1, const usize_t * const lcp1,
+    const usize_t n1,
+    const typename Traits::ElemType * const a2, const usize_t * const lcp2,
+    const usize_t n2,
+    typename Traits::ElemType * const out, usize_t * const lcpOut) noexcept
+{
+    usize_t i = 0, j = 0, k = 0;
+    // lcp of the candidates with the last output
+    usize_t h1 = 0, h2 = 0;
+    while (i < n1 && j < n2)
+    {
+        bool first;
+        if (h1 != h2)
+            first = h1 > h2;
+        else
+        {
+            usize_t lcp;
+            first = Traits::cmp(a1[i],a2[j],h1,lcp) <= 0;
+            // the other candidate shares lcp with the one output
+            if (first)
+                h2 = lcp;
+            else
+                h1 = lcp;
+        }
+        if (first)
+        {
+            out[k] = a1[i];
+            lcpOut[k++] = h1;
+            if (++i < n1)
+                h1 = lcp1[i];
+        }
+        else
+        {
+            out[k] = a2[j];
+            lcpOut[k++] = h2;
+            if (++j < n2)
+                h2 = lcp2[j];
+        }
+    }
+    for (; i < n1; ++i, ++k)
+    {
+        out[k] = a1[i];
+        lcpOut[k] = h1;
+        h1 = i + 1 < n1 ? lcp1[i+1] : 0;
+    }
+    for (; j < n2; ++j, ++k)
+    {
+        out[k] = a2[j];
+        lcpOut[k] = h2;
+        h2 = j + 1 < n2 ? lcp2[j+1] : 0;
+    }
+}
+
+/// \brief sort in parallel: sort chunks in threads, then merge in rounds
+template <typename Traits>
+inline void _parallelStringSort(typename Traits::ElemType * const a,
+    const usize_t n, usize_t threads)
+{
+    using ElemType = typename Traits::ElemType;
+    if (!threads)
+        threads = std::thread::hardware_concurrency();
+    if (threads > n / _cSortRadixMin)
+        threads = n / _cSortRadixMin;
+    if (threads < 2)
+    {
+        _stringSort<Traits>(a,n);
+        return;
+    }
+    std::vector<usize_t> bounds(threads + 1);
+    for (usize_t t = 0; t <= threads; ++t)
+        bounds[t] = n * t / threads;
+    std::vector<usize_t> lcp(n);
+    {
+        std::vector<std::thread> workers;
+        for (usize_t t = 0; t < threads; ++t)
+            workers.emplace_back([a,&lcp,begin = bounds[t],end = bounds[t+1]]
+            {
+                _stringSort<Traits>(a + begin,end - begin);
+                lcp[begin] = 0;
+                usize_t l;
+                for (usize_t i = begin + 1; i < end; ++i)
+                {
+                    (void) Traits::cmp(a[i-1],a[i],0,l);
+                    lcp[i] = l;
+                }
+            });
+        for (std::thread &w : workers)
+            w.join();
+    }
+    // merge pairs of runs until one is left (ping pong between buffers)
+    std::vector<ElemType> tmp(n);
+    std::vector<usize_t> tmpLcp(n);
+    ElemType *src = a, *dst = tmp.data();
+    usize_t *srcLcp = lcp.data(), *dstLcp = tmpLcp.data();
+    while (bounds.size() > 2)
+    {
+        const usize_t runs = bounds.size() - 1;
+        std::vector<usize_t> next;
+        std::vector<std::thread> workers;
+        for (usize_t r = 0; r < runs; r += 2)
+        {
+            next.push_back(bounds[r]);
+            const usize_t b0 = bounds[r];
+            const usize_t b1 = bounds[r+1];
+            const usize_t b2 = r + 1 < runs ? bounds[r+2] : b1;
+            workers.emplace_back([=]
+            {
+                _lcpMerge<Traits>(src + b0,srcLcp + b0,b1 - b0,
+                    src + b1,srcLcp + b1,b2 - b1,dst + b0,dstLcp + b0);
+            });
+        }
+        next.push_back(n);
+        for (std::thread &w : workers)
+            w.join();
+        bounds.swap(next);
+        swap(src,dst);
+        swap(srcLcp,dstLcp);
+    }
+    if (src != a)
+        for (usize_t i = 0; i < n; ++i)
+            a[i] = src[i];
+}
+
+/// \brief is ElemType a pointer to characters
+template <typename ElemType>
+concept _isCharPtr = std::is_pointer_v<ElemType>
+    && !std::is_pointer_v<std::remove_pointer_t<ElemType>>;
+
+/// \brief is ElemType a CString
+template <typename ElemType>
+concept _isCString = requires (const ElemType &e)
+{
+    typename ElemType::AllocType;
+    { ElemType::allowNull } -> concepts::isSame<const bool&>;
+    { e.ptr() } -> concepts::isSame<const typename ElemType::CharType*>;
+};
+
+/// \brief sort an array with an algorithm taking (traits, array, size)
+///
+/// Pointer arrays are sorted directly after moving null pointers first.
+/// Views are sorted directly. CString arrays are sorted as (pointer, index)
+/// pairs, then the strings are permuted with swaps (no allocation).
+template <typename ElemType, typename SortFunc>
+inline void _sortStrings(ElemType * const a, usize_t n, SortFunc &&sortFunc)
+{
+    if constexpr (_isCharPtr<ElemType>)
+    {
+        using CharType = std::remove_cv_t<std::remove_pointer_t<ElemType>>;
+        using Traits = _SortNullTerm<CharType,ElemType>;
+        usize_t nulls = 0;
+        for (usize_t i = 0; i < n; ++i)
+            if (!a[i])
+                swap(a[i],a[nulls++]);
+        sortFunc.template operator()<Traits>(a + nulls,n - nulls);
+    }
+    else if constexpr (_isCString<ElemType>)
+    {
+        using CharType = typename ElemType::CharType;
+        using Entry = _SortIndexed<CharType>;
+        using Traits = _SortNullTerm<CharType,Entry>;
+        usize_t nulls = 0;
+        for (usize_t i = 0; i < n; ++i)
+            nulls += !a[i].ptr();
+        // null strings first (in their original order), then the others
+        std::vector<Entry> entries(n);
+        usize_t nullPos = 0;
+        usize_t strPos = nulls;
+        for (usize_t i = 0; i < n; ++i)
+        {
+            if (a[i].ptr())
+                entries[strPos++] = {a[i].ptr(),i};
+            else
+                entries[nullPos++] = {nullptr,i};
+        }
+        sortFunc.template operator()<Traits>(
+            entries.data() + nulls,n - nulls);
+        // result position j takes the string from index entries[j].idx
+        for (usize_t i = 0; i < n; ++i)
+        {
+            usize_t j = i;
+            for (;;)
+            {
+                const usize_t k = entries[j].idx;
+                entries[j].idx = j;
+                if (k == i)
+                    break;
+                swap(a[j],a[k]);
+                j = k;
+            }
+        }
+    }
+    else
+    {
+        using Traits = _SortView<typename ElemType::CharType>;
+        static_assert(meta::isSame<ElemType,typename Traits::ElemType>,
+            "unsupported string type");
+        sortFunc.template operator()<Traits>(a,n);
+    }
+}
+
+} // namespace _detail
+
+namespace concepts
+{
+
+/// \brief element types supported by the string sorts (C string pointers,
+/// CString, CStringView)
+template <typename ElemType>
+concept isSortableString = _detail::_isCharPtr<ElemType>
+    || _detail::_isCString<ElemType>
+    || isSame<ElemType,CStringView<typename ElemType::CharType>>;
+
+} // namespace concepts
+
+/// \brief sort strings with MSD radix sort
+/// \tparam ElemType C string pointer, CString, or CStringView (byte sized
+/// characters)
+/// \param strs array of strings
+/// \param n number of strings
+///
+/// The order is the same as operator<=> of the string type (null strings
+/// first). Each character is examined a constant number of times until the
+/// strings are distinguished, instead of once per comparison.
+template <concepts::isSortableString ElemType>
+inline void msdRadixSort(ElemType * const strs, const usize_t n)
+{
+    _detail::_sortStrings(strs,n,[]<typename Traits>(
+        typename Traits::ElemType *a, const usize_t m)
+    {
+        _detail::_msdRadixSort<Traits>(a,m);
+    });
+}
+
+/// \brief sort strings with multikey quicksort
+/// \tparam ElemType C string pointer, CString, or CStringView
+/// \param strs array of strings
+/// \param n number of strings
+///
+/// This is quicksort partitioning by one character at a time, which works
+/// for any character type and uses no extra memory for pointers and views.
+template <concepts::isSortableString ElemType>
+inline void multikeyQuicksort(ElemType * const strs, const usize_t n)
+{
+    _detail::_sortStrings(strs,n,[]<typename Traits>(
+        typename Traits::ElemType *a, const usize_t m)
+    {
+        _detail::_multikeyQuicksort<Traits>(a,m,0);
+    });
+}
+
+/// \brief sort strings with the best sequential algorithm
+/// \tparam ElemType C string pointer, CString, or CStringView
+/// \param strs array of strings
+/// \param n number of strings
+///
+/// This is msdRadixSort() for byte sized characters and multikeyQuicksort()
+/// otherwise.
+template <concepts::isSortableString ElemType>
+inline void stringSort(ElemType * const strs, const usize_t n)
+{
+    _detail::_sortStrings(strs,n,[]<typename Traits>(
+        typename Traits::ElemType *a, const usize_t m)
+    {
+        _detail::_stringSort<Traits>(a,m);
+    });
+}
+
+/// \brief sort strings using multiple threads
+/// \tparam ElemType C string pointer, CString, or CStringView
+/// \param strs array of strings
+/// \param n number of strings
+/// \param threads number of threads (0 for the hardware concurrency)
+///
+/// The array is split into a chunk for each thread, sorted with stringSort()
+/// along with the longest common prefix (LCP) of neighbors. Then pairs of
+/// runs are merged in parallel rounds using the LCPs to skip characters that
+/// are known to be equal.
+template <concepts::isSortableString ElemType>
+inline void parallelStringSort(ElemType * const strs, const usize_t n,
+    const usize_t threads = 0)
+{
+    _detail::_sortStrings(strs,n,[threads]<typename Traits>(
+        typename Traits::ElemType *a, const usize_t m)
+    {
+        _detail::_parallelStringSort<Traits>(a,m,threads);
+    });
+}
+
+} // namespace tkoz::stl
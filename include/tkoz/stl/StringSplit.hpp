@@ -0,0 +1,362 @@
+///
+/// lazy split and tokenize ranges yielding borrowed views
+///
+
+#pragma once
+
+#include <tkoz/stl/CStringSimd.hpp>
+#include <tkoz/stl/CStringView.hpp>
+#include <tkoz/stl/Exceptions.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <type_traits>
+
+namespace tkoz::stl
+{
+
+namespace _detail
+{
+
+/// \brief delimiter of a single character
+template <typename CharType>
+struct _SplitChar
+{
+    CharType delim;
+
+    /// index of the first delimiter in n characters (or n)
+    [[nodiscard]] inline usize_t find(
+        const CharType * const ptr, const usize_t n) const noexcept
+    {
+        return simd::memChr(ptr,n,delim);
+    }
+
+    /// delimiter length
+    [[nodiscard]] inline constexpr usize_t len() const noexcept
+    {
+        return 1;
+    }
+};
+
+/// \brief delimiter of a string of characters
+template <typename CharType>
+struct _SplitString
+{
+    CStringView<CharType> delim;
+
+    /// index of the first occurrence of delim in n characters (or n)
+    [[nodiscard]] inline usize_t find(
+        const CharType * const ptr, const usize_t n) const noexcept
+    {
+        const usize_t i = simd::memFind(ptr,n,delim.ptr(),delim.len());
+        return i == CStringView<CharType>::npos ? n : i;
+    }
+
+    /// delimiter length (length of delim)
+    [[nodiscard]] inline constexpr usize_t len() const noexcept
+    {
+        return delim.len();
+    }
+};
+
+/// \brief delimiter of any character in a set
+template <typename CharType>
+struct _SplitByteSet
+{
+    simd::ByteSet delim;
+
+    /// index of the first character in delim in n characters (or n)
+    [[nodiscard]] inline usize_t find(
+        const CharType * const ptr, const usize_t n) const noexcept
+    {
+        return simd::memFindAny(ptr,n,delim);
+    }
+
+    /// delimiter length (one character)
+    [[nodiscard]] inline constexpr usize_t len() const noexcept
+    {
+        return 1;
+    }
+};
+
+} // namespace _detail
+
+/// \brief range of the fields of a string separated by delimiters
+/// \tparam CharType character type
+/// \tparam DelimType delimiter search (see split() and tokenize())
+/// \tparam skipEmpty whether to skip empty fields
+///
+/// Fields are CStringView objects referring to the characters of the string,
+/// so nothing is allocated and the string must outlive the range and the
+/// fields. Each delimiter is found when the iterator advances, with a vector
+/// search over the rest of the string. Iterators refer to the range object,
+/// which must outlive them (as with range-for or a named range variable).
+template <typename _CharType, typename _DelimType, bool _skipEmpty>
+class SplitRange
+    : public std::ranges::view_interface<SplitRange<
+        _CharType,_DelimType,_skipEmpty>>
+{
+public:
+
+    /// character type
+    using CharType = _CharType;
+
+    /// field type
+    using ViewType = CStringView<CharType>;
+
+    /// delimiter search type
+    using DelimType = _DelimType;
+
+    /// whether empty fields are skipped
+    static constexpr bool skipEmpty = _skipEmpty;
+
+private:
+
+    /// string being split
+    ViewType _str;
+
+    /// delimiter search
+    DelimType _delim;
+
+public:
+
+    /// \brief forward iterator over the fields
+    class Iterator
+    {
+    public:
+
+        using iterator_concept = std::forward_iterator_tag;
+        using iterator_category = std::input_iterator_tag;
+        using value_type = ViewType;
+        using difference_type = std::ptrdiff_t;
+        using reference = ViewType;
+
+    private:
+
+        friend class SplitRange;
+
+        /// the range
+        const SplitRange *_range;
+
+        /// start index of the current field (npos at the end)
+        usize_t _pos;
+
+        /// length of the current field
+        usize_t _len;
+
+        /// start index of the next field (npos if current is the last)
+        usize_t _next;
+
+        /// find the field starting at index pos
+        inline void _scan(const usize_t pos) noexcept
+        {
+            const ViewType str = _range->_str;
+            _pos = pos;
+            _len = pos < str.len()
+                ? _range->_delim.find(str.ptr() + pos,str.len() - pos) : 0;
+            _next = pos + _len < str.len()
+                ? pos + _len + _range->_delim.len() : ViewType::npos;
+        }
+
+        /// skip empty fields if requested
+        inline void _skip() noexcept
+        {
+            if constexpr (skipEmpty)
+            {
+                while (!_len && _pos != ViewType::npos)
+                    _advance();
+            }
+        }
+
+        /// go to the next field (or the end)
+        inline void _advance() noexcept
+        {
+            if (_next == ViewType::npos)
+                _pos = ViewType::npos;
+            else
+                _scan(_next);
+        }
+
+        [[nodiscard]] inline Iterator(const SplitRange * const range,
+            const bool end) noexcept
+            : _range(range), _pos(ViewType::npos), _len(0),
+            _next(ViewType::npos)
+        {
+            if (!end)
+            {
+                _scan(0);
+                _skip();
+            }
+        }
+
+    public:
+
+        /// \brief singular iterator
+        [[nodiscard]] inline Iterator() noexcept
+            : _range(nullptr), _pos(ViewType::npos), _len(0),
+            _next(ViewType::npos) {}
+
+        /// \brief the current field
+        [[nodiscard]] inline ViewType operator*() const noexcept
+        {
+            return ViewType(_range->_str.ptr() + _pos,_len);
+        }
+
+        /// \brief index of the current field in the string
+        [[nodiscard]] inline usize_t pos() const noexcept
+        {
+            return _pos;
+        }
+
+        inline Iterator& operator++() noexcept
+        {
+            _advance();
+            _skip();
+            return *this;
+        }
+
+        inline Iterator operator++(int) noexcept
+        {
+            Iterator ret = *this;
+            ++*this;
+            return ret;
+        }
+
+        /// \brief compare positions (iterators of the same range)
+        [[nodiscard]] friend inline bool operator==(
+            const Iterator &left, const Iterator &right) noexcept
+        {
+            return left._pos == right._pos;
+        }
+    };
+
+    /// \brief initialize a range
+    /// \param str string to split
+    /// \param delim delimiter search
+    [[nodiscard]] inline SplitRange(const ViewType str, const DelimType &delim)
+        noexcept: _str(str), _delim(delim) {}
+
+    /// \brief iterator to the first field
+    [[nodiscard]] inline Iterator begin() const noexcept
+    {
+        return Iterator(this,false);
+    }
+
+    /// \brief iterator past the last field
+    [[nodiscard]] inline Iterator end() const noexcept
+    {
+        return Iterator(this,true);
+    }
+
+    /// \brief the string being split
+    [[nodiscard]] inline ViewType str() const noexcept
+    {
+        return _str;
+    }
+
+    /// \brief count the fields (linear time)
+    [[nodiscard]] inline usize_t count() const noexcept
+    {
+        usize_t ret = 0;
+        for (Iterator it = begin(); it != end(); ++it)
+            ++ret;
+        return ret;
+    }
+};
+
+/// \brief split at each occurrence of a character
+/// \param str string to split (must outlive the range)
+/// \param delim delimiter character
+/// \return range of all fields (n delimiters give n+1 fields, and the empty
+/// string gives 1 empty field)
+template <typename StringType,
+    typename CharType = typename StringType::CharType>
+    requires concepts::isStringLike<StringType,CharType>
+[[nodiscard]] inline auto split(const StringType &str,
+    const std::type_identity_t<CharType> delim) noexcept
+{
+    return SplitRange<CharType,_detail::_SplitChar<CharType>,false>(
+        str,{delim});
+}
+
+/// \brief split at each (non overlapping) occurrence of a string
+/// \param str string to split (must outlive the range)
+/// \param delim delimiter string (must outlive the range)
+/// \return range of all fields
+/// \throw ArgumentError if delim is empty
+template <typename StringType,
+    typename CharType = typename StringType::CharType>
+    requires concepts::isStringLike<StringType,CharType>
+[[nodiscard]] inline auto split(const StringType &str,
+    const std::type_identity_t<CStringView<CharType>> delim)
+{
+    if (delim.empty())
+        throw ArgumentError("empty delimiter");
+    return SplitRange<CharType,_detail::_SplitString<CharType>,false>(
+        str,{delim});
+}
+
+/// \brief split at each character in a set
+/// \param str string to split (must outlive the range)
+/// \param delims delimiter characters
+/// \return range of all fields
+template <typename StringType,
+    typename CharType = typename StringType::CharType>
+    requires concepts::isStringLike<StringType,CharType>
+        && simd::isByteChar<CharType>
+[[nodiscard]] inline auto split(const StringType &str,
+    const simd::ByteSet &delims) noexcept
+{
+    return SplitRange<CharType,_detail::_SplitByteSet<CharType>,false>(
+        str,{delims});
+}
+
+/// \brief split at each occurrence of a character, skipping empty fields
+/// \param str string to split (must outlive the range)
+/// \param delim delimiter character
+/// \return range of the non empty fields
+template <typename StringType,
+    typename CharType = typename StringType::CharType>
+    requires concepts::isStringLike<StringType,CharType>
+[[nodiscard]] inline auto tokenize(const StringType &str,
+    const std::type_identity_t<CharType> delim) noexcept
+{
+    return SplitRange<CharType,_detail::_SplitChar<CharType>,true>(
+        str,{delim});
+}
+
+/// \brief split at each occurrence of a string, skipping empty fields
+/// \param str string to split (must outlive the range)
+/// \param delim delimiter string (must outlive the range)
+/// \return range of the non empty fields
+/// \throw ArgumentError if delim is empty
+template <typename StringType,
+    typename CharType = typename StringType::CharType>
+    requires concepts::isStringLike<StringType,CharType>
+[[nodiscard]] inline auto tokenize(const StringType &str,
+    const std::type_identity_t<CStringView<CharType>> delim)
+{
+    if (delim.empty())
+        throw ArgumentError("empty delimiter");
+    return SplitRange<CharType,_detail::_SplitString<CharType>,true>(
+        str,{delim});
+}
+
+/// \brief split at each character in a set, skipping empty fields
+/// \param str string to split (must outlive the range)
+/// \param delims delimiter characters (such as simd::ByteSet::whitespace())
+/// \return range of the non empty fields
+template <typename StringType,
+    typename CharType = typename StringType::CharType>
+    requires concepts::isStringLike<StringType,CharType>
+        && simd::isByteChar<CharType>
+[[nodiscard]] inline auto tokenize(const StringType &str,
+    const simd::ByteSet &delims) noexcept
+{
+    return SplitRange<CharType,_detail::_SplitByteSet<CharType>,true>(
+        str,{delims});
+}
+
+} // namespace tkoz::stl
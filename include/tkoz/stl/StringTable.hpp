@@ -0,0 +1,484 @@
+///
+/// string table file format readable in place with mmap
+///
+
+#pragma once
+
+#include <tkoz/stl/CStringSimd.hpp>
+#include <tkoz/stl/CStringView.hpp>
+#include <tkoz/stl/Exceptions.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <cstddef>
+#include <cstdio>
+#include <iterator>
+#include <ranges>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tkoz::stl
+{
+
+namespace _detail
+{
+
+/// \brief string table file header (followed by offsets and characters)
+///
+/// Layout:
+/// - header (32 bytes)
+/// - count+1 offsets (uint64_t), the start of each string in characters
+///   with the last one being the total
+/// - characters of all strings, each followed by a null terminator
+///
+/// Integers use the byte order of the writer, which is checked by reading
+/// the byteOrder field.
+struct _StringTableHeader
+{
+    /// identifies the file format (cStringTableMagic)
+    char magic[8];
+
+    /// 0x01020304 in the byte order of the writer
+    uint32_t byteOrder;
+
+    /// sizeof(CharType) of the strings
+    uint32_t charSize;
+
+    /// number of strings
+    uint64_t count;
+
+    /// number of characters (including terminators)
+    uint64_t chars;
+};
+
+static_assert(sizeof(_StringTableHeader) == 32);
+
+inline constexpr char cStringTableMagic[8] = {'T','K','O','Z','S','T','B','1'};
+
+inline constexpr uint32_t cStringTableByteOrder = 0x01020304;
+
+} // namespace _detail
+
+/// \brief read only string table (a file mapped into memory or a buffer)
+/// \tparam CharType character type
+///
+/// Opening a table maps the file and checks the header and size, which is
+/// constant time, so strings are not copied or parsed. Each entry is a view
+/// of a null-terminated string in the mapped memory, usable as a C string or
+/// anywhere a CStringView is accepted, with the length from the offsets.
+/// Tables are written with encode() or write().
+template <typename _CharType>
+class StringTable
+{
+public:
+
+    /// character type
+    using CharType = _CharType;
+
+    /// string view type
+    using ViewType = CStringView<CharType>;
+
+private:
+
+    using _Header = _detail::_StringTableHeader;
+
+    /// start of the table
+    const uchar_t *_data;
+
+    /// size of the table in bytes
+    usize_t _bytes;
+
+    /// whether _data is a mapping to unmap
+    bool _mapped;
+
+    /// string offsets (count+1)
+    const uint64_t *_offsets;
+
+    /// string characters
+    const CharType *_chars;
+
+    /// number of strings
+    usize_t _size;
+
+    /// bytes before the characters of a table with count strings
+    [[nodiscard]] static inline constexpr usize_t _charsStart(
+        const usize_t count) noexcept
+    {
+        const usize_t end = sizeof(_Header) + (count + 1) * sizeof(uint64_t);
+        return (end + alignof(CharType) - 1) / alignof(CharType)
+            * alignof(CharType);
+    }
+
+    /// check the header and locate the arrays
+    inline void _load()
+    {
+        if (_bytes < sizeof(_Header))
+            throw FormatError("string table is too small");
+        const _Header *h = reinterpret_cast<const _Header*>(_data);
+        if (__builtin_memcmp(h->magic,_detail::cStringTableMagic,8))
+            throw FormatError("not a string table");
+        if (h->byteOrder != _detail::cStringTableByteOrder)
+            throw FormatError("string table has a different byte order");
+        if (h->charSize != sizeof(CharType))
+            throw FormatError("string table has a different character size");
+        // check sizes without overflow
+        const usize_t maxCount = (_bytes - sizeof(_Header)) / sizeof(uint64_t);
+        if (h->count >= maxCount)
+            throw FormatError("string table is truncated");
+        const usize_t start = _charsStart(h->count);
+        if (start > _bytes
+                || h->chars > (_bytes - start) / sizeof(CharType))
+            throw FormatError("string table is truncated");
+        _size = h->count;
+        _offsets = reinterpret_cast<const uint64_t*>(_data + sizeof(_Header));
+        _chars = reinterpret_cast<const CharType*>(_data + start);
+        if (_offsets[_size] != h->chars)
+            throw FormatError("string table is corrupt");
+    }
+
+    inline void _release() noexcept
+    {
+        if (_mapped)
+            ::munmap(const_cast<uchar_t*>(_data),_bytes);
+        _data = nullptr;
+        _bytes = 0;
+        _mapped = false;
+        _offsets = nullptr;
+        _chars = nullptr;
+        _size = 0;
+    }
+
+public:
+
+    /// \brief random access iterator over the strings
+    class Iterator
+    {
+    public:
+
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = ViewType;
+        using difference_type = std::ptrdiff_t;
+        using reference = ViewType;
+
+    private:
+
+        friend class StringTable;
+
+        const StringTable *_table;
+        usize_t _index;
+
+        [[nodiscard]] inline Iterator(const StringTable * const table,
+            const usize_t index) noexcept: _table(table), _index(index) {}
+
+    public:
+
+        [[nodiscard]] inline Iterator() noexcept
+            : _table(nullptr), _index(0) {}
+
+        [[nodiscard]] inline ViewType operator*() const noexcept
+        {
+            return (*_table)[_index];
+        }
+
+        [[nodiscard]] inline ViewType operator[](const difference_type n)
+            const noexcept
+        {
+            return (*_table)[_index + static_cast<usize_t>(n)];
+        }
+
+        inline Iterator& operator++() noexcept
+        {
+            ++_index;
+            return *this;
+        }
+
+        inline Iterator operator++(int) noexcept
+        {
+            Iterator ret = *this;
+            ++_index;
+            return ret;
+        }
+
+        inline Iterator& operator--() noexcept
+        {
+            --_index;
+            return *this;
+        }
+
+        inline Iterator operator--(int) noexcept
+        {
+            Iterator ret = *this;
+            --_index;
+            return ret;
+        }
+
+        inline Iterator& operator+=(const difference_type n) noexcept
+        {
+            _index += static_cast<usize_t>(n);
+            return *this;
+        }
+
+        inline Iterator& operator-=(const difference_type n) noexcept
+        {
+            _index -= static_cast<usize_t>(n);
+            return *this;
+        }
+
+        [[nodiscard]] friend inline Iterator operator+(Iterator it,
+            const difference_type n) noexcept
+        {
+            return it += n;
+        }
+
+        [[nodiscard]] friend inline Iterator operator+(
+            const difference_type n, Iterator it) noexcept
+        {
+            return it += n;
+        }
+
+        [[nodiscard]] friend inline Iterator operator-(Iterator it,
+            const difference_type n) noexcept
+        {
+            return it -= n;
+        }
+
+        [[nodiscard]] friend inline difference_type operator-(
+            const Iterator &left, const Iterator &right) noexcept
+        {
+            return static_cast<difference_type>(left._index - right._index);
+        }
+
+        [[nodiscard]] friend inline bool operator==(
+            const Iterator &left, const Iterator &right) noexcept
+        {
+            return left._index == right._index;
+        }
+
+        [[nodiscard]] friend inline auto operator<=>(
+            const Iterator &left, const Iterator &right) noexcept
+        {
+            return left._index <=> right._index;
+        }
+    };
+
+    /// \brief initialize an empty table
+    [[nodiscard]] inline StringTable() noexcept
+        : _data(nullptr), _bytes(0), _mapped(false), _offsets(nullptr),
+        _chars(nullptr), _size(0) {}
+
+    /// \brief map a table file read only
+    /// \param path file path
+    /// \throw IOError if the file cannot be opened or mapped
+    /// \throw FormatError if the file is not a table for CharType
+    [[nodiscard]] inline explicit StringTable(const char * const path)
+        : StringTable()
+    {
+        const int fd = ::open(path,O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            throw IOError("cannot open string table");
+        struct stat st;
+        if (::fstat(fd,&st) < 0)
+        {
+            ::close(fd);
+            throw IOError("cannot stat string table");
+        }
+        _bytes = static_cast<usize_t>(st.st_size);
+        if (_bytes)
+        {
+            void *p = ::mmap(nullptr,_bytes,PROT_READ,MAP_PRIVATE,fd,0);
+            if (p == MAP_FAILED)
+            {
+                ::close(fd);
+                throw IOError("cannot map string table");
+            }
+            _data = static_cast<const uchar_t*>(p);
+            _mapped = true;
+        }
+        // the mapping stays valid after closing
+        ::close(fd);
+        try
+        {
+            _load();
+        }
+        catch (...)
+        {
+            _release();
+            throw;
+        }
+    }
+
+    /// \brief use a table in memory (such as a buffer from encode())
+    /// \param data start of the table (aligned for uint64_t), which must
+    /// outlive this object
+    /// \param bytes size of the table
+    /// \throw FormatError if the data is not a table for CharType
+    [[nodiscard]] inline StringTable(const void * const data,
+        const usize_t bytes)
+        : _data(static_cast<const uchar_t*>(data)), _bytes(bytes),
+        _mapped(false), _offsets(nullptr), _chars(nullptr), _size(0)
+    {
+        _load();
+    }
+
+    StringTable(const StringTable&) = delete;
+    StringTable& operator=(const StringTable&) = delete;
+
+    [[nodiscard]] inline StringTable(StringTable &&other) noexcept
+        : _data(other._data), _bytes(other._bytes), _mapped(other._mapped),
+        _offsets(other._offsets), _chars(other._chars), _size(other._size)
+    {
+        other._mapped = false;
+        other._release();
+    }
+
+    inline StringTable& operator=(StringTable &&other) noexcept
+    {
+        if (this != &other)
+        {
+            _release();
+            _data = other._data;
+            _bytes = other._bytes;
+            _mapped = other._mapped;
+            _offsets = other._offsets;
+            _chars = other._chars;
+            _size = other._size;
+            other._mapped = false;
+            other._release();
+        }
+        return *this;
+    }
+
+    inline ~StringTable()
+    {
+        _release();
+    }
+
+    /// \brief number of strings
+    [[nodiscard]] inline usize_t size() const noexcept
+    {
+        return _size;
+    }
+
+    /// \brief are there no strings
+    [[nodiscard]] inline bool empty() const noexcept
+    {
+        return !_size;
+    }
+
+    /// \brief size of the table in bytes
+    [[nodiscard]] inline usize_t bytes() const noexcept
+    {
+        return _bytes;
+    }
+
+    /// \brief string at an index (no bounds check)
+    /// \return view of a null-terminated string in the table
+    [[nodiscard]] inline ViewType operator[](const usize_t i) const noexcept
+    {
+        return ViewType(_chars + _offsets[i],
+            static_cast<usize_t>(_offsets[i+1] - _offsets[i] - 1));
+    }
+
+    /// \brief string at an index
+    /// \throw IndexError if i is out of bounds
+    [[nodiscard]] inline ViewType at(const usize_t i) const
+    {
+        if (i >= _size)
+            throw IndexError("string table index out of bounds");
+        return (*this)[i];
+    }
+
+    [[nodiscard]] inline Iterator begin() const noexcept
+    {
+        return Iterator(this,0);
+    }
+
+    [[nodiscard]] inline Iterator end() const noexcept
+    {
+        return Iterator(this,_size);
+    }
+
+    /// \brief check every offset and terminator (linear time)
+    /// \throw FormatError if the table is corrupt
+    ///
+    /// Opening a table only checks the header, so this is for tables from
+    /// untrusted sources, after which indexing cannot go out of bounds.
+    inline void validate() const
+    {
+        for (usize_t i = 0; i < _size; ++i)
+            if (_offsets[i] >= _offsets[i+1]
+                    || _chars[_offsets[i+1] - 1] != CharType(0))
+                throw FormatError("string table is corrupt");
+    }
+
+    /// \brief encode strings as a table
+    /// \param strs range of strings (CString, CStringView, C strings, ...)
+    /// without null characters (read twice, so it must be multi pass)
+    /// \return the table as 64 bit words for alignment (the last one padded
+    /// with zeros), usable with StringTable(data(),size()*8)
+    template <std::ranges::forward_range RangeType>
+        requires std::convertible_to<
+            std::ranges::range_reference_t<const RangeType>,ViewType>
+    [[nodiscard]] static inline std::vector<uint64_t> encode(
+        const RangeType &strs)
+    {
+        std::vector<uint64_t> offsets{0};
+        for (auto &&s : strs)
+        {
+            const ViewType str = s;
+            offsets.push_back(offsets.back() + str.len() + 1);
+        }
+        const usize_t count = offsets.size() - 1;
+        const usize_t start = _charsStart(count);
+        const usize_t bytes = start + offsets.back() * sizeof(CharType);
+        // uint64_t elements for alignment
+        std::vector<uint64_t> ret((bytes + 7) / 8,0);
+        uchar_t *out = reinterpret_cast<uchar_t*>(ret.data());
+        _Header h;
+        __builtin_memcpy(h.magic,_detail::cStringTableMagic,8);
+        h.byteOrder = _detail::cStringTableByteOrder;
+        h.charSize = sizeof(CharType);
+        h.count = count;
+        h.chars = offsets.back();
+        __builtin_memcpy(out,&h,sizeof(h));
+        __builtin_memcpy(out + sizeof(h),offsets.data(),
+            offsets.size() * sizeof(uint64_t));
+        CharType *chars = reinterpret_cast<CharType*>(out + start);
+        usize_t i = 0;
+        for (auto &&s : strs)
+        {
+            const ViewType str = s;
+            if (str.len())
+                simd::copyChars(chars + offsets[i],str.ptr(),str.len());
+            ++i;
+        }
+        return ret;
+    }
+
+    /// \brief write strings to a table file
+    /// \param path file path (replaced if it exists)
+    /// \param strs range of strings without null characters
+    /// \throw IOError if the file cannot be written
+    template <std::ranges::forward_range RangeType>
+        requires std::convertible_to<
+            std::ranges::range_reference_t<const RangeType>,ViewType>
+    static inline void write(const char * const path, const RangeType &strs)
+    {
+        const std::vector<uint64_t> data = encode(strs);
+        const usize_t bytes = _charsStart(
+            reinterpret_cast<const _Header*>(data.data())->count)
+            + reinterpret_cast<const _Header*>(data.data())->chars
+            * sizeof(CharType);
+        std::FILE *f = std::fopen(path,"wb");
+        if (!f)
+            throw IOError("cannot create string table");
+        const bool ok = std::fwrite(data.data(),1,bytes,f) == bytes;
+        if (std::fclose(f) != 0 || !ok)
+            throw IOError("cannot write string table");
+    }
+};
+
+} // namespace tkoz::stl
@@ -0,0 +1,248 @@
+///
+/// pointer with tags stored in unused high and low bits
+///
+
+#pragma once
+
+#include <tkoz/stl/Concepts.hpp>
+#include <tkoz/stl/Meta.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <bit>
+
+namespace tkoz::stl
+{
+
+namespace _detail
+{
+
+/// low bits that are always zero in a pointer to Type
+template <typename Type>
+inline constexpr usize_t _tpAlignBits = 0;
+
+template <typename Type> requires (!meta::isVoid<Type>)
+inline constexpr usize_t _tpAlignBits<Type> =
+    static_cast<usize_t>(std::countr_zero(alignof(Type)));
+
+/// lowBits value meaning all bits guaranteed zero by alignof(Type)
+inline constexpr usize_t _tpAutoLowBits = static_cast<usize_t>(-1);
+
+} // namespace _detail
+
+/// \brief 8 byte pointer with a high tag and a low tag
+/// \tparam Type the type pointed to
+/// \tparam lowBits bits of the low tag (at most log2(alignof(Type)), all of
+/// them by default)
+/// \tparam addressBits virtual address bits (48, or 57 for LA57)
+///
+/// On x86_64, user space addresses are below 2^48 (4 level paging) or 2^57
+/// (5 level paging, LA57), so the bits above are zero, and a pointer to Type
+/// has its low log2(alignof(Type)) bits zero. This class stores a high tag of
+/// 64-addressBits bits (16, or 7 with LA57) and a low tag of lowBits bits in
+/// those positions, so a tag (such as a node type or a version counter) costs
+/// no extra memory. The layout of the 64 bit word is:
+///     [ high tag | address without low bits | low tag ]
+///
+/// Every accessor is a single mask or shift, there are no branches. The
+/// alignment is checked at compile time, so lowBits cannot exceed the bits
+/// guaranteed by alignof(Type). Tags wider than their field are truncated.
+/// Both the default low tag width and the check are evaluated when the masks
+/// are first used rather than when the class is instantiated, so Type may be
+/// incomplete there, as in a node linking to nodes of its own type.
+///
+/// Linux only returns addresses above 2^47 when mmap is given a hint address
+/// above it, so addressBits = 48 also works with LA57 unless the program asks
+/// for such memory. Use addressBits = 57 if it does. SixBytePointer relies on
+/// the same assumption as addressBits = 48.
+///
+/// This class only stores a pointer, it does not manage memory, and it does
+/// not enforce const correctness.
+template <typename Type, usize_t lowBits = _detail::_tpAutoLowBits,
+    usize_t addressBits = 48>
+class TaggedPointer
+{
+private:
+
+    /// low tag width (needs Type to be complete, so only called from the
+    /// initializer of cLowBits which is instantiated when first used)
+    [[nodiscard]] static consteval usize_t _lowBits() noexcept
+    {
+        constexpr usize_t alignBits = _detail::_tpAlignBits<Type>;
+        if constexpr (lowBits == _detail::_tpAutoLowBits)
+            return alignBits;
+        else
+        {
+            static_assert(lowBits <= alignBits, "low tag bits exceed those "
+                "guaranteed zero by alignof(Type)");
+            return lowBits;
+        }
+    }
+
+public:
+
+#if __x86_64__
+    static_assert(sizeof(Type*) == 8, "this class is only for x86_64 with "
+        "48 or 57 bit virtual addresses");
+#else
+    static_assert(sizeof(Type*) == 0, "this class is only for x86_64 with "
+        "48 or 57 bit virtual addresses");
+#endif
+    static_assert(addressBits == 48 || addressBits == 57,
+        "virtual addresses must have 48 or 57 bits");
+
+    /// number of bits in the high tag
+    static constexpr usize_t cHighBits = 64 - addressBits;
+
+    /// number of bits in the low tag
+    static constexpr usize_t cLowBits = _lowBits();
+
+    /// largest high tag
+    static constexpr uint64_t cMaxHighTag = (1ull << cHighBits) - 1;
+
+    /// largest low tag
+    static constexpr uint64_t cMaxLowTag = (1ull << cLowBits) - 1;
+
+    /// bits holding the address
+    static constexpr uint64_t cAddressMask =
+        ((1ull << addressBits) - 1) & ~cMaxLowTag;
+
+    /// type for the high tag
+    using HighTagType = meta::Conditional<(cHighBits > 8),ushort_t,uchar_t>;
+
+    /// type for the low tag
+    using LowTagType = uchar_t;
+
+private:
+
+    /// tags and address
+    uint64_t _bits;
+
+    /// combine the fields (each is masked)
+    [[nodiscard]] static inline uint64_t _pack(Type * const ptr,
+        const uint64_t high, const uint64_t low) noexcept
+    {
+        return (reinterpret_cast<uint64_t>(ptr) & cAddressMask)
+            | (high << addressBits) | (low & cMaxLowTag);
+    }
+
+public:
+
+    /// \brief initialize as null pointer with zero tags
+    [[nodiscard]] inline TaggedPointer() noexcept: _bits(0) {}
+
+    /// \brief initialize from a pointer with zero tags
+    /// \param ptr the pointer to store (must satisfy fits())
+    [[nodiscard]] inline TaggedPointer(Type * const ptr) noexcept
+        : _bits(_pack(ptr,0,0)) {}
+
+    /// \brief initialize from a pointer and tags
+    /// \param ptr the pointer to store (must satisfy fits())
+    /// \param high the high tag (truncated to cHighBits)
+    /// \param low the low tag (truncated to cLowBits)
+    [[nodiscard]] inline TaggedPointer(Type * const ptr,
+        const HighTagType high, const LowTagType low = 0) noexcept
+        : _bits(_pack(ptr,high,low)) {}
+
+    /// \brief create from the raw 64 bit representation
+    /// \param bits value previously returned by bits()
+    [[nodiscard]] static inline TaggedPointer fromBits(
+        const uint64_t bits) noexcept
+    {
+        TaggedPointer ret;
+        ret._bits = bits;
+        return ret;
+    }
+
+    /// \brief the raw 64 bit representation (for atomic operations)
+    [[nodiscard]] inline uint64_t bits() const noexcept
+    {
+        return _bits;
+    }
+
+    /// \brief can a pointer be stored without losing information
+    /// \param ptr the pointer
+    /// \return true if ptr is below 2^addressBits with zero low tag bits
+    [[nodiscard]] static inline bool fits(const Type * const ptr) noexcept
+    {
+        return (reinterpret_cast<uint64_t>(ptr) & ~cAddressMask) == 0;
+    }
+
+    /// \brief get the pointer (without tags)
+    /// \return a full 8 byte dereferenceable pointer (if not null)
+    [[nodiscard]] inline Type* ptr() const noexcept
+    {
+        return reinterpret_cast<Type*>(_bits & cAddressMask);
+    }
+
+    /// \brief the high tag
+    [[nodiscard]] inline HighTagType highTag() const noexcept
+    {
+        return static_cast<HighTagType>(_bits >> addressBits);
+    }
+
+    /// \brief the low tag
+    [[nodiscard]] inline LowTagType lowTag() const noexcept
+    {
+        return static_cast<LowTagType>(_bits & cMaxLowTag);
+    }
+
+    /// \brief replace the pointer, keeping the tags
+    /// \param ptr the pointer to store (must satisfy fits())
+    inline void setPtr(Type * const ptr) noexcept
+    {
+        _bits = (_bits & ~cAddressMask)
+            | (reinterpret_cast<uint64_t>(ptr) & cAddressMask);
+    }
+
+    /// \brief replace the high tag
+    /// \param high the high tag (truncated to cHighBits)
+    inline void setHighTag(const HighTagType high) noexcept
+    {
+        _bits = (_bits & ((1ull << addressBits) - 1))
+            | (static_cast<uint64_t>(high) << addressBits);
+    }
+
+    /// \brief replace the low tag
+    /// \param low the low tag (truncated to cLowBits)
+    inline void setLowTag(const LowTagType low) noexcept
+    {
+        _bits = (_bits & ~cMaxLowTag) | (low & cMaxLowTag);
+    }
+
+    /// \brief dereference the represented pointer (no null check)
+    /// \note not available for void pointer
+    [[nodiscard]] inline auto& operator*() const noexcept
+        requires (!meta::isVoid<Type>)
+    {
+        return *ptr();
+    }
+
+    /// \brief access member of the represented pointer (no null check)
+    /// \note not available for void pointer
+    [[nodiscard]] inline Type* operator->() const noexcept
+        requires (!meta::isVoid<Type>)
+    {
+        return ptr();
+    }
+
+    /// \brief boolean equivalent (is the pointer non null, ignoring tags)
+    [[nodiscard]] inline explicit operator bool() const noexcept
+    {
+        return (_bits & cAddressMask) != 0;
+    }
+
+    /// \brief convert to the pointer (without tags)
+    [[nodiscard]] inline explicit operator Type*() const noexcept
+    {
+        return ptr();
+    }
+
+    /// \brief compare pointers and tags for equality
+    [[nodiscard]] friend inline bool operator==(
+        const TaggedPointer left, const TaggedPointer right) noexcept
+    {
+        return left._bits == right._bits;
+    }
+};
+
+} // namespace tkoz::stl
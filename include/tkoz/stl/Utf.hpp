@@ -0,0 +1,839 @@
+///
+/// Unicode validation, counting, and transcoding (UTF-8, UTF-16, UTF-32)
+///
+
+#pragma once
+
+#include <tkoz/stl/Allocator.hpp>
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/CStringView.hpp>
+#include <tkoz/stl/Exceptions.hpp>
+#include <tkoz/stl/Simd.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#if __x86_64__
+#include <immintrin.h>
+#endif
+
+namespace tkoz::stl::utf
+{
+
+using simd::SimdLevel;
+
+namespace _detail
+{
+
+//
+// scalar code
+//
+
+/// length of the valid UTF-8 sequence at p[0..n) or 0 if it is invalid
+[[nodiscard]] inline usize_t _utf8SeqLen(const uchar_t * const p,
+    const usize_t n) noexcept
+{
+    const uchar_t b0 = p[0];
+    if (b0 < 0x80)
+        return 1;
+    auto isCont = [](const uchar_t b) { return (b & 0xC0) == 0x80; };
+    if (b0 < 0xC2)
+        return 0;
+    if (b0 < 0xE0)
+        return n >= 2 && isCont(p[1]) ? 2 : 0;
+    if (b0 < 0xF0)
+    {
+        if (n < 3 || !isCont(p[1]) || !isCont(p[2]))
+            return 0;
+        if (b0 == 0xE0 && p[1] < 0xA0) // overlong
+            return 0;
+        if (b0 == 0xED && p[1] >= 0xA0) // surrogate
+            return 0;
+        return 3;
+    }
+    if (b0 < 0xF5)
+    {
+        if (n < 4 || !isCont(p[1]) || !isCont(p[2]) || !isCont(p[3]))
+            return 0;
+        if (b0 == 0xF0 && p[1] < 0x90) // overlong
+            return 0;
+        if (b0 == 0xF4 && p[1] >= 0x90) // above U+10FFFF
+            return 0;
+        return 4;
+    }
+    return 0;
+}
+
+/// index of the first invalid UTF-8 sequence (or n), with 16 byte ASCII runs
+/// checked at once
+[[nodiscard]] inline usize_t _utf8ErrorScalar(const uchar_t * const p,
+    const usize_t n) noexcept
+{
+    usize_t i = 0;
+    while (i < n)
+    {
+        if (i + 16 <= n)
+        {
+            uint64_t a, b;
+            __builtin_memcpy(&a,p+i,8);
+            __builtin_memcpy(&b,p+i+8,8);
+            if (!((a | b) & 0x8080808080808080ull))
+            {
+                i += 16;
+                continue;
+            }
+        }
+        const usize_t l = _utf8SeqLen(p+i,n-i);
+        if (!l)
+            return i;
+        i += l;
+    }
+    return n;
+}
+
+[[nodiscard]] inline bool _validateUtf8Scalar(const uchar_t * const p,
+    const usize_t n) noexcept
+{
+    return _utf8ErrorScalar(p,n) == n;
+}
+
+/// count bytes that are not continuation bytes (10xxxxxx)
+[[nodiscard]] inline usize_t _countUtf8Scalar(const uchar_t * const p,
+    const usize_t n) noexcept
+{
+    usize_t ret = 0;
+    for (usize_t i = 0; i < n; ++i)
+        ret += static_cast<schar_t>(p[i]) > -65;
+    return ret;
+}
+
+/// decode the code point of a valid UTF-8 sequence and advance
+[[nodiscard]] inline char32_t _decodeUtf8(const uchar_t *&p) noexcept
+{
+    const uchar_t b0 = *p++;
+    if (b0 < 0x80)
+        return b0;
+    if (b0 < 0xE0)
+        return static_cast<char32_t>(((b0 & 0x1F) << 6) | (*p++ & 0x3F));
+    if (b0 < 0xF0)
+    {
+        const char32_t c = static_cast<char32_t>(((b0 & 0x0F) << 12)
+            | ((p[0] & 0x3F) << 6) | (p[1] & 0x3F));
+        p += 2;
+        return c;
+    }
+    const char32_t c = static_cast<char32_t>(((b0 & 0x07) << 18)
+        | ((p[0] & 0x3F) << 12) | ((p[1] & 0x3F) << 6) | (p[2] & 0x3F));
+    p += 3;
+    return c;
+}
+
+/// encode a code point as UTF-8 and advance
+inline void _encodeUtf8(const char32_t c, char8_t *&out) noexcept
+{
+    if (c < 0x80)
+        *out++ = static_cast<char8_t>(c);
+    else if (c < 0x800)
+    {
+        *out++ = static_cast<char8_t>(0xC0 | (c >> 6));
+        *out++ = static_cast<char8_t>(0x80 | (c & 0x3F));
+    }
+    else if (c < 0x10000)
+    {
+        *out++ = static_cast<char8_t>(0xE0 | (c >> 12));
+        *out++ = static_cast<char8_t>(0x80 | ((c >> 6) & 0x3F));
+        *out++ = static_cast<char8_t>(0x80 | (c & 0x3F));
+    }
+    else
+    {
+        *out++ = static_cast<char8_t>(0xF0 | (c >> 18));
+        *out++ = static_cast<char8_t>(0x80 | ((c >> 12) & 0x3F));
+        *out++ = static_cast<char8_t>(0x80 | ((c >> 6) & 0x3F));
+        *out++ = static_cast<char8_t>(0x80 | (c & 0x3F));
+    }
+}
+
+[[nodiscard]] inline constexpr bool _isHighSurrogate(const char32_t c) noexcept
+{
+    return c >= 0xD800 && c < 0xDC00;
+}
+
+[[nodiscard]] inline constexpr bool _isLowSurrogate(const char32_t c) noexcept
+{
+    return c >= 0xDC00 && c < 0xE000;
+}
+
+//
+// x86 kernels
+//
+
+#if __x86_64__
+
+// ASCII runs are skipped 16 bytes at a time, other characters are checked
+// one at a time
+inline bool _validateUtf8Sse2(const uchar_t * const p,
+    const usize_t n) noexcept
+{
+    usize_t i = 0;
+    while (i < n)
+    {
+        if (i + 16 <= n && !_mm_movemask_epi8(_mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(p+i))))
+        {
+            i += 16;
+            continue;
+        }
+        const usize_t l = _utf8SeqLen(p+i,n-i);
+        if (!l)
+            return false;
+        i += l;
+    }
+    return true;
+}
+
+inline usize_t _countUtf8Sse2(const uchar_t * const p,
+    const usize_t n) noexcept
+{
+    const __m128i cont = _mm_set1_epi8(-65);
+    usize_t ret = 0;
+    usize_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        const __m128i v = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(p+i));
+        ret += static_cast<usize_t>(__builtin_popcount(static_cast<uint_t>(
+            _mm_movemask_epi8(_mm_cmpgt_epi8(v,cont)))));
+    }
+    return ret + _countUtf8Scalar(p+i,n-i);
+}
+
+// Bits of the error classes in the lookup tables (Keiser and Lemire,
+// "Validating UTF-8 In Less Than One Instruction Per Byte"). Each byte is
+// classified by the high and low nibble of the previous byte and the high
+// nibble of itself, and the AND of the 3 lookups is nonzero for an error,
+// except that 2 continuation bytes are expected after 3 and 4 byte leads.
+inline constexpr char _cUtfTooShort = 1 << 0;
+inline constexpr char _cUtfTooLong = 1 << 1;
+inline constexpr char _cUtfOverlong3 = 1 << 2;
+inline constexpr char _cUtfTooLarge = 1 << 3;
+inline constexpr char _cUtfSurrogate = 1 << 4;
+inline constexpr char _cUtfOverlong2 = 1 << 5;
+inline constexpr char _cUtfTooLarge1000 = 1 << 6;
+inline constexpr char _cUtfOverlong4 = 1 << 6;
+inline constexpr char _cUtfTwoConts = static_cast<char>(1 << 7);
+inline constexpr char _cUtfCarry = _cUtfTooShort | _cUtfTooLong
+    | _cUtfTwoConts;
+
+/// state carried between 32 byte blocks
+struct _Utf8StateAvx2
+{
+    __m256i prev;
+    __m256i prevIncomplete;
+    __m256i error;
+};
+
+/// bytes of (prev,in) shifted so each byte of in lines up with the byte n
+/// positions earlier
+template <int n>
+[[gnu::target("avx2")]]
+inline __m256i _prevAvx2(const __m256i in, const __m256i prev) noexcept
+{
+    return _mm256_alignr_epi8(in,_mm256_permute2x128_si256(prev,in,0x21),
+        16 - n);
+}
+
+[[gnu::target("avx2")]]
+inline void _utf8BlockAvx2(const __m256i in, _Utf8StateAvx2 &s) noexcept
+{
+    if (!_mm256_movemask_epi8(in))
+    {
+        // ASCII is valid unless the previous block ended mid character
+        s.error = _mm256_or_si256(s.error,s.prevIncomplete);
+        s.prevIncomplete = _mm256_setzero_si256();
+        s.prev = in;
+        return;
+    }
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i byte1High = _mm256_setr_epi8(
+        _cUtfTooLong,_cUtfTooLong,_cUtfTooLong,_cUtfTooLong,
+        _cUtfTooLong,_cUtfTooLong,_cUtfTooLong,_cUtfTooLong,
+        _cUtfTwoConts,_cUtfTwoConts,_cUtfTwoConts,_cUtfTwoConts,
+        _cUtfTooShort | _cUtfOverlong2,
+        _cUtfTooShort,
+        _cUtfTooShort | _cUtfOverlong3 | _cUtfSurrogate,
+        _cUtfTooShort | _cUtfTooLarge | _cUtfTooLarge1000 | _cUtfOverlong4,
+        _cUtfTooLong,_cUtfTooLong,_cUtfTooLong,_cUtfTooLong,
+        _cUtfTooLong,_cUtfTooLong,_cUtfTooLong,_cUtfTooLong,
+        _cUtfTwoConts,_cUtfTwoConts,_cUtfTwoConts,_cUtfTwoConts,
+        _cUtfTooShort | _cUtfOverlong2,
+        _cUtfTooShort,
+        _cUtfTooShort | _cUtfOverlong3 | _cUtfSurrogate,
+        _cUtfTooShort | _cUtfTooLarge | _cUtfTooLarge1000 | _cUtfOverlong4);
+    constexpr char large = _cUtfCarry | _cUtfTooLarge | _cUtfTooLarge1000;
+    const __m256i byte1Low = _mm256_setr_epi8(
+        _cUtfCarry | _cUtfOverlong3 | _cUtfOverlong2 | _cUtfOverlong4,
+        _cUtfCarry | _cUtfOverlong2,
+        _cUtfCarry,_cUtfCarry,
+        _cUtfCarry | _cUtfTooLarge,
+        large,large,large,large,large,large,large,large,
+        large | _cUtfSurrogate,
+        large,large,
+        _cUtfCarry | _cUtfOverlong3 | _cUtfOverlong2 | _cUtfOverlong4,
+        _cUtfCarry | _cUtfOverlong2,
+        _cUtfCarry,_cUtfCarry,
+        _cUtfCarry | _cUtfTooLarge,
+        large,large,large,large,large,large,large,large,
+        large | _cUtfSurrogate,
+        large,large);
+    constexpr char cont80 = _cUtfTooLong | _cUtfOverlong2 | _cUtfTwoConts
+        | _cUtfOverlong3 | _cUtfTooLarge1000 | _cUtfOverlong4;
+    constexpr char cont90 = _cUtfTooLong | _cUtfOverlong2 | _cUtfTwoConts
+        | _cUtfOverlong3 | _cUtfTooLarge;
+    constexpr char contA0 = _cUtfTooLong | _cUtfOverlong2 | _cUtfTwoConts
+        | _cUtfSurrogate | _cUtfTooLarge;
+    const __m256i byte2High = _mm256_setr_epi8(
+        _cUtfTooShort,_cUtfTooShort,_cUtfTooShort,_cUtfTooShort,
+        _cUtfTooShort,_cUtfTooShort,_cUtfTooShort,_cUtfTooShort,
+        cont80,cont90,contA0,contA0,
+        _cUtfTooShort,_cUtfTooShort,_cUtfTooShort,_cUtfTooShort,
+        _cUtfTooShort,_cUtfTooShort,_cUtfTooShort,_cUtfTooShort,
+        _cUtfTooShort,_cUtfTooShort,_cUtfTooShort,_cUtfTooShort,
+        cont80,cont90,contA0,contA0,
+        _cUtfTooShort,_cUtfTooShort,_cUtfTooShort,_cUtfTooShort);
+    const __m256i prev1 = _prevAvx2<1>(in,s.prev);
+    const __m256i special = _mm256_and_si256(
+        _mm256_and_si256(
+            _mm256_shuffle_epi8(byte1High,
+                _mm256_and_si256(_mm256_srli_epi16(prev1,4),nibble)),
+            _mm256_shuffle_epi8(byte1Low,_mm256_and_si256(prev1,nibble))),
+        _mm256_shuffle_epi8(byte2High,
+            _mm256_and_si256(_mm256_srli_epi16(in,4),nibble)));
+    // 2nd and 3rd bytes after 3 and 4 byte leads must be continuations
+    const __m256i prev2 = _prevAvx2<2>(in,s.prev);
+    const __m256i prev3 = _prevAvx2<3>(in,s.prev);
+    const __m256i must23 = _mm256_or_si256(
+        _mm256_subs_epu8(prev2,_mm256_set1_epi8(static_cast<char>(0xE0-0x80))),
+        _mm256_subs_epu8(prev3,_mm256_set1_epi8(static_cast<char>(0xF0-0x80))));
+    const __m256i must23x80 = _mm256_and_si256(must23,
+        _mm256_set1_epi8(static_cast<char>(0x80)));
+    s.error = _mm256_or_si256(s.error,_mm256_xor_si256(must23x80,special));
+    // the last 3 bytes must not start sequences longer than what is left
+    const __m256i maxValue = _mm256_setr_epi8(
+        -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+        -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+        static_cast<char>(0xF0-1),static_cast<char>(0xE0-1),
+        static_cast<char>(0xC0-1));
+    s.prevIncomplete = _mm256_subs_epu8(in,maxValue);
+    s.prev = in;
+}
+
+[[gnu::target("avx2")]]
+inline bool _validateUtf8Avx2(const uchar_t * const p,
+    const usize_t n) noexcept
+{
+    _Utf8StateAvx2 s{_mm256_setzero_si256(),_mm256_setzero_si256(),
+        _mm256_setzero_si256()};
+    usize_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        _utf8BlockAvx2(_mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(p+i)),s);
+        // stop early on errors every 1KB
+        if (!(i & 1023) && !_mm256_testz_si256(s.error,s.error))
+            return false;
+    }
+    if (i < n)
+    {
+        // zero padding is ASCII
+        alignas(32) uchar_t buf[32] = {};
+        __builtin_memcpy(buf,p+i,n-i);
+        _utf8BlockAvx2(_mm256_load_si256(
+            reinterpret_cast<const __m256i*>(buf)),s);
+    }
+    s.error = _mm256_or_si256(s.error,s.prevIncomplete);
+    return _mm256_testz_si256(s.error,s.error);
+}
+
+[[gnu::target("avx2")]]
+inline usize_t _countUtf8Avx2(const uchar_t * const p,
+    const usize_t n) noexcept
+{
+    const __m256i cont = _mm256_set1_epi8(-65);
+    usize_t ret = 0;
+    usize_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        const __m256i v = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(p+i));
+        ret += static_cast<usize_t>(__builtin_popcount(static_cast<uint_t>(
+            _mm256_movemask_epi8(_mm256_cmpgt_epi8(v,cont)))));
+    }
+    return ret + _countUtf8Scalar(p+i,n-i);
+}
+
+#endif // __x86_64__
+
+//
+// selection of a kernel for a SIMD level
+//
+
+using _ValidateUtf8Fn = bool (*)(const uchar_t*, usize_t) noexcept;
+using _CountUtf8Fn = usize_t (*)(const uchar_t*, usize_t) noexcept;
+
+[[nodiscard]] inline _ValidateUtf8Fn _selectValidateUtf8(
+    const SimdLevel level) noexcept
+{
+    switch (level)
+    {
+#if __x86_64__
+    case simd::cSimdAvx512:
+    case simd::cSimdAvx2:
+        return _validateUtf8Avx2;
+    case simd::cSimdSse2:
+        return _validateUtf8Sse2;
+#endif
+    default:
+        return _validateUtf8Scalar;
+    }
+}
+
+[[nodiscard]] inline _CountUtf8Fn _selectCountUtf8(
+    const SimdLevel level) noexcept
+{
+    switch (level)
+    {
+#if __x86_64__
+    case simd::cSimdAvx512:
+    case simd::cSimdAvx2:
+        return _countUtf8Avx2;
+    case simd::cSimdSse2:
+        return _countUtf8Sse2;
+#endif
+    default:
+        return _countUtf8Scalar;
+    }
+}
+
+// kernels for the best supported level, selected on first use
+[[nodiscard]] inline bool _validateUtf8Dispatch(const uchar_t * const p,
+    const usize_t n) noexcept
+{
+    static const _ValidateUtf8Fn sFn = _selectValidateUtf8(simd::simdLevel());
+    return sFn(p,n);
+}
+
+[[nodiscard]] inline usize_t _countUtf8Dispatch(const uchar_t * const p,
+    const usize_t n) noexcept
+{
+    static const _CountUtf8Fn sFn = _selectCountUtf8(simd::simdLevel());
+    return sFn(p,n);
+}
+
+[[nodiscard]] inline const uchar_t* _bytes(const char8_t * const p) noexcept
+{
+    return reinterpret_cast<const uchar_t*>(p);
+}
+
+} // namespace _detail
+
+//
+// validation
+//
+
+/// \brief is an array valid UTF-8
+/// \param p array of n code units
+/// \param n number of code units
+/// \return true if p is a sequence of shortest form encodings of code points
+/// (not surrogates, at most U+10FFFF) with no truncated character at the end
+///
+/// With AVX2, 32 bytes are checked at once with table lookups of the byte
+/// nibbles (the algorithm used by simdjson and simdutf). With SSE2, runs of
+/// ASCII are skipped 16 bytes at a time.
+[[nodiscard]] inline bool validateUtf8(const char8_t * const p,
+    const usize_t n) noexcept
+{
+    return _detail::_validateUtf8Dispatch(_detail::_bytes(p),n);
+}
+
+/// \brief validateUtf8() using a specific SIMD level
+/// \param level SIMD level to use (limited to what the processor supports)
+[[nodiscard]] inline bool validateUtf8(const char8_t * const p,
+    const usize_t n, const SimdLevel level) noexcept
+{
+    return _detail::_selectValidateUtf8(simd::clampSimdLevel(level))(
+        _detail::_bytes(p),n);
+}
+
+/// \brief index of the first invalid UTF-8 sequence
+/// \param p array of n code units
+/// \param n number of code units
+/// \return index of the byte starting the first invalid or truncated
+/// sequence, or n if p is valid
+[[nodiscard]] inline usize_t utf8ErrorIndex(const char8_t * const p,
+    const usize_t n) noexcept
+{
+    return _detail::_utf8ErrorScalar(_detail::_bytes(p),n);
+}
+
+/// \brief is an array valid UTF-16
+/// \param p array of n code units
+/// \param n number of code units
+/// \return true if every surrogate is part of a high, low pair
+[[nodiscard]] inline bool validateUtf16(const char16_t * const p,
+    const usize_t n) noexcept
+{
+    usize_t i = 0;
+#if __x86_64__
+    // skip 8 code units at a time without surrogates
+    const __m128i mask = _mm_set1_epi16(static_cast<short>(0xF800));
+    const __m128i surrogate = _mm_set1_epi16(static_cast<short>(0xD800));
+#endif
+    while (i < n)
+    {
+#if __x86_64__
+        if (i + 8 <= n)
+        {
+            const __m128i v = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(p+i));
+            if (!_mm_movemask_epi8(_mm_cmpeq_epi16(
+                    _mm_and_si128(v,mask),surrogate)))
+            {
+                i += 8;
+                continue;
+            }
+        }
+#endif
+        const char32_t c = p[i];
+        if (_detail::_isHighSurrogate(c))
+        {
+            if (i + 1 == n || !_detail::_isLowSurrogate(p[i+1]))
+                return false;
+            i += 2;
+        }
+        else if (_detail::_isLowSurrogate(c))
+            return false;
+        else
+            ++i;
+    }
+    return true;
+}
+
+/// \brief is an array valid UTF-32
+/// \param p array of n code points
+/// \param n number of code points
+/// \return true if every code point is at most U+10FFFF and not a surrogate
+[[nodiscard]] inline bool validateUtf32(const char32_t * const p,
+    const usize_t n) noexcept
+{
+    bool ok = true;
+    for (usize_t i = 0; i < n; ++i)
+        ok &= p[i] < 0x110000 && (p[i] < 0xD800 || p[i] >= 0xE000);
+    return ok;
+}
+
+//
+// counting
+//
+
+/// \brief number of code points in valid UTF-8
+/// \param p array of n code units (valid UTF-8)
+/// \param n number of code units
+/// \return number of bytes that are not continuation bytes
+[[nodiscard]] inline usize_t countUtf8(const char8_t * const p,
+    const usize_t n) noexcept
+{
+    return _detail::_countUtf8Dispatch(_detail::_bytes(p),n);
+}
+
+/// \brief countUtf8() using a specific SIMD level
+/// \param level SIMD level to use (limited to what the processor supports)
+[[nodiscard]] inline usize_t countUtf8(const char8_t * const p,
+    const usize_t n, const SimdLevel level) noexcept
+{
+    return _detail::_selectCountUtf8(simd::clampSimdLevel(level))(
+        _detail::_bytes(p),n);
+}
+
+/// \brief number of code points in valid UTF-16
+[[nodiscard]] inline usize_t countUtf16(const char16_t * const p,
+    const usize_t n) noexcept
+{
+    usize_t ret = n;
+    for (usize_t i = 0; i < n; ++i)
+        ret -= _detail::_isLowSurrogate(p[i]);
+    return ret;
+}
+
+/// \brief number of UTF-16 code units to encode valid UTF-8
+[[nodiscard]] inline usize_t utf16LenOfUtf8(const char8_t * const p,
+    const usize_t n) noexcept
+{
+    // 4 byte sequences become surrogate pairs
+    usize_t ret = countUtf8(p,n);
+    for (usize_t i = 0; i < n; ++i)
+        ret += static_cast<uchar_t>(p[i]) >= 0xF0;
+    return ret;
+}
+
+/// \brief number of UTF-8 code units to encode valid UTF-16
+[[nodiscard]] inline usize_t utf8LenOfUtf16(const char16_t * const p,
+    const usize_t n) noexcept
+{
+    // surrogate pairs (4 bytes) count 2 for each unit
+    usize_t ret = 0;
+    for (usize_t i = 0; i < n; ++i)
+        ret += 1 + (p[i] >= 0x80) + (p[i] >= 0x800 && !(p[i] >= 0xD800
+            && p[i] < 0xE000));
+    return ret;
+}
+
+/// \brief number of UTF-8 code units to encode valid UTF-32
+[[nodiscard]] inline usize_t utf8LenOfUtf32(const char32_t * const p,
+    const usize_t n) noexcept
+{
+    usize_t ret = 0;
+    for (usize_t i = 0; i < n; ++i)
+        ret += 1 + (p[i] >= 0x80) + (p[i] >= 0x800) + (p[i] >= 0x10000);
+    return ret;
+}
+
+//
+// transcoding (input must be valid, output must have enough space)
+//
+
+/// \brief convert valid UTF-8 to UTF-16
+/// \param src array of n code units (valid UTF-8)
+/// \param n number of code units
+/// \param dst output with space for utf16LenOfUtf8(src,n) code units
+/// \return number of code units written
+inline usize_t utf8ToUtf16(const char8_t * const src, const usize_t n,
+    char16_t * const dst) noexcept
+{
+    const uchar_t *p = _detail::_bytes(src);
+    const uchar_t * const end = p + n;
+    char16_t *out = dst;
+    while (p < end)
+    {
+#if __x86_64__
+        // widen 16 ASCII bytes
+        if (end - p >= 16)
+        {
+            const __m128i v = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(p));
+            if (!_mm_movemask_epi8(v))
+            {
+                const __m128i zero = _mm_setzero_si128();
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                    _mm_unpacklo_epi8(v,zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out+8),
+                    _mm_unpackhi_epi8(v,zero));
+                p += 16;
+                out += 16;
+                continue;
+            }
+        }
+#endif
+        const char32_t c = _detail::_decodeUtf8(p);
+        if (c < 0x10000)
+            *out++ = static_cast<char16_t>(c);
+        else
+        {
+            *out++ = static_cast<char16_t>(0xD800 + ((c - 0x10000) >> 10));
+            *out++ = static_cast<char16_t>(0xDC00 + (c & 0x3FF));
+        }
+    }
+    return static_cast<usize_t>(out - dst);
+}
+
+/// \brief convert valid UTF-8 to UTF-32
+/// \param src array of n code units (valid UTF-8)
+/// \param n number of code units
+/// \param dst output with space for countUtf8(src,n) code points
+/// \return number of code points written
+inline usize_t utf8ToUtf32(const char8_t * const src, const usize_t n,
+    char32_t * const dst) noexcept
+{
+    const uchar_t *p = _detail::_bytes(src);
+    const uchar_t * const end = p + n;
+    char32_t *out = dst;
+    while (p < end)
+    {
+#if __x86_64__
+        if (end - p >= 16)
+        {
+            const __m128i v = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(p));
+            if (!_mm_movemask_epi8(v))
+            {
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i lo = _mm_unpacklo_epi8(v,zero);
+                const __m128i hi = _mm_unpackhi_epi8(v,zero);
+                __m128i *o = reinterpret_cast<__m128i*>(out);
+                _mm_storeu_si128(o,_mm_unpacklo_epi16(lo,zero));
+                _mm_storeu_si128(o+1,_mm_unpackhi_epi16(lo,zero));
+                _mm_storeu_si128(o+2,_mm_unpacklo_epi16(hi,zero));
+                _mm_storeu_si128(o+3,_mm_unpackhi_epi16(hi,zero));
+                p += 16;
+                out += 16;
+                continue;
+            }
+        }
+#endif
+        *out++ = _detail::_decodeUtf8(p);
+    }
+    return static_cast<usize_t>(out - dst);
+}
+
+/// \brief convert valid UTF-16 to UTF-8
+/// \param src array of n code units (valid UTF-16)
+/// \param n number of code units
+/// \param dst output with space for utf8LenOfUtf16(src,n) code units
+/// \return number of code units written
+inline usize_t utf16ToUtf8(const char16_t * const src, const usize_t n,
+    char8_t * const dst) noexcept
+{
+    char8_t *out = dst;
+    usize_t i = 0;
+#if __x86_64__
+    const __m128i ascii = _mm_set1_epi16(static_cast<short>(0xFF80));
+    const __m128i zero = _mm_setzero_si128();
+#endif
+    while (i < n)
+    {
+#if __x86_64__
+        // narrow 8 ASCII code units
+        if (i + 8 <= n)
+        {
+            const __m128i v = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(src+i));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v,ascii),
+                    zero)) == 0xFFFF)
+            {
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(out),
+                    _mm_packus_epi16(v,v));
+                i += 8;
+                out += 8;
+                continue;
+            }
+        }
+#endif
+        char32_t c = src[i++];
+        if (_detail::_isHighSurrogate(c))
+            c = 0x10000 + ((c - 0xD800) << 10) + (src[i++] - 0xDC00);
+        _detail::_encodeUtf8(c,out);
+    }
+    return static_cast<usize_t>(out - dst);
+}
+
+/// \brief convert valid UTF-32 to UTF-8
+/// \param src array of n code points (valid UTF-32)
+/// \param n number of code points
+/// \param dst output with space for utf8LenOfUtf32(src,n) code units
+/// \return number of code units written
+inline usize_t utf32ToUtf8(const char32_t * const src, const usize_t n,
+    char8_t * const dst) noexcept
+{
+    char8_t *out = dst;
+    usize_t i = 0;
+#if __x86_64__
+    const __m128i ascii = _mm_set1_epi32(static_cast<int>(0xFFFFFF80));
+    const __m128i zero = _mm_setzero_si128();
+#endif
+    while (i < n)
+    {
+#if __x86_64__
+        if (i + 8 <= n)
+        {
+            const __m128i a = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(src+i));
+            const __m128i b = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(src+i+4));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(
+                    _mm_or_si128(a,b),ascii),zero)) == 0xFFFF)
+            {
+                const __m128i w = _mm_packs_epi32(a,b);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(out),
+                    _mm_packus_epi16(w,w));
+                i += 8;
+                out += 8;
+                continue;
+            }
+        }
+#endif
+        _detail::_encodeUtf8(src[i++],out);
+    }
+    return static_cast<usize_t>(out - dst);
+}
+
+//
+// strings
+//
+
+namespace _detail
+{
+
+/// allocate an output string of a length and fill it
+template <typename CharType, typename FillFunc>
+[[nodiscard]] inline CString<CharType> _makeString(const usize_t len,
+    FillFunc fill)
+{
+    NewAllocator<CharType> alloc;
+    CharType *ptr = alloc.allocate(len + 1);
+    const usize_t written = fill(ptr);
+    ptr[written] = CharType(0);
+    return CString<CharType>::ptrWrap(ptr,alloc);
+}
+
+} // namespace _detail
+
+/// \brief convert UTF-8 to UTF-16
+/// \param str UTF-8 string (such as CString<char8_t>)
+/// \return the UTF-16 string
+/// \throw FormatError if str is not valid UTF-8
+[[nodiscard]] inline CString<char16_t> toUtf16(
+    const CStringView<char8_t> str)
+{
+    if (!validateUtf8(str.ptr(),str.len()))
+        throw FormatError("invalid UTF-8");
+    return _detail::_makeString<char16_t>(utf16LenOfUtf8(str.ptr(),str.len()),
+        [str](char16_t *dst) { return utf8ToUtf16(str.ptr(),str.len(),dst); });
+}
+
+/// \brief convert UTF-8 to UTF-32
+/// \param str UTF-8 string (such as CString<char8_t>)
+/// \return the UTF-32 string
+/// \throw FormatError if str is not valid UTF-8
+[[nodiscard]] inline CString<char32_t> toUtf32(
+    const CStringView<char8_t> str)
+{
+    if (!validateUtf8(str.ptr(),str.len()))
+        throw FormatError("invalid UTF-8");
+    return _detail::_makeString<char32_t>(countUtf8(str.ptr(),str.len()),
+        [str](char32_t *dst) { return utf8ToUtf32(str.ptr(),str.len(),dst); });
+}
+
+/// \brief convert UTF-16 to UTF-8
+/// \param str UTF-16 string (such as CString<char16_t>)
+/// \return the UTF-8 string
+/// \throw FormatError if str is not valid UTF-16
+[[nodiscard]] inline CString<char8_t> toUtf8(
+    const CStringView<char16_t> str)
+{
+    if (!validateUtf16(str.ptr(),str.len()))
+        throw FormatError("invalid UTF-16");
+    return _detail::_makeString<char8_t>(utf8LenOfUtf16(str.ptr(),str.len()),
+        [str](char8_t *dst) { return utf16ToUtf8(str.ptr(),str.len(),dst); });
+}
+
+/// \brief convert UTF-32 to UTF-8
+/// \param str UTF-32 string (such as CString<char32_t>)
+/// \return the UTF-8 string
+/// \throw FormatError if str is not valid UTF-32
+[[nodiscard]] inline CString<char8_t> toUtf8(
+    const CStringView<char32_t> str)
+{
+    if (!validateUtf32(str.ptr(),str.len()))
+        throw FormatError("invalid UTF-32");
+    return _detail::_makeString<char8_t>(utf8LenOfUtf32(str.ptr(),str.len()),
+        [str](char8_t *dst) { return utf32ToUtf8(str.ptr(),str.len(),dst); });
+}
+
+} // namespace tkoz::stl::utf
@@ -0,0 +1,200 @@
+///
+/// unit tests for tkoz::stl allocators (new, arena, pool)
+///
+
+#include <tkoz/Test.hpp>
+
+#include <tkoz/stl/Allocator.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <random>
+#include <thread>
+#include <vector>
+
+using tkoz::stl::Arena;
+using tkoz::stl::Pool;
+using tkoz::stl::usize_t;
+
+// instantiate template for accurate code coverage report
+template struct tkoz::stl::NewAllocator<char>;
+template class tkoz::stl::ArenaAllocator<char>;
+template class tkoz::stl::ArenaAllocator<long>;
+template class tkoz::stl::PoolAllocator<char>;
+template class tkoz::stl::PoolAllocator<long>;
+
+static_assert(tkoz::stl::concepts::isAllocator<
+    tkoz::stl::NewAllocator<char>,char>);
+static_assert(tkoz::stl::concepts::isAllocator<
+    tkoz::stl::ArenaAllocator<int>,int>);
+static_assert(tkoz::stl::concepts::isAllocator<
+    tkoz::stl::PoolAllocator<wchar_t>,wchar_t>);
+static_assert(!tkoz::stl::concepts::isAllocator<
+    tkoz::stl::PoolAllocator<wchar_t>,char>);
+
+TEST_RUNNER_MAIN
+
+TEST_CASE_CREATE(testNewAllocator)
+{
+    tkoz::stl::NewAllocator<int> alloc;
+    int *p = alloc.allocate(10);
+    for (int i = 0; i < 10; ++i)
+        p[i] = i;
+    TEST_ASSERT_EQ(p[9],9);
+    alloc.deallocate(p);
+    alloc.deallocate(nullptr);
+    TEST_ASSERT_TRUE(alloc == tkoz::stl::NewAllocator<int>());
+}
+
+TEST_CASE_CREATE(testArena)
+{
+    Arena arena(1024);
+    TEST_ASSERT_EQ(arena.bytesReserved(),0);
+    char *c = static_cast<char*>(arena.allocate(3,1));
+    char *d = static_cast<char*>(arena.allocate(5,1));
+    TEST_ASSERT_EQ(d,c+3);
+    void *e = arena.allocate(8,8);
+    TEST_ASSERT_EQ(reinterpret_cast<uintptr_t>(e) % 8,0);
+    TEST_ASSERT_EQ(arena.bytesUsed(),16);
+    TEST_ASSERT_EQ(arena.bytesReserved(),1024);
+    // large request gets its own block, the current block is still used
+    char *big = static_cast<char*>(arena.allocate(5000,1));
+    for (usize_t i = 0; i < 5000; ++i)
+        big[i] = 'x';
+    char *f = static_cast<char*>(arena.allocate(1,1));
+    TEST_ASSERT_EQ(f,static_cast<char*>(e)+8);
+    TEST_ASSERT_GT(arena.bytesReserved(),6024);
+    // fill several blocks
+    std::vector<char*> ptrs;
+    for (usize_t i = 0; i < 1000; ++i)
+    {
+        char *p = static_cast<char*>(arena.allocate(10,1));
+        for (usize_t j = 0; j < 10; ++j)
+            p[j] = static_cast<char>(i);
+        ptrs.push_back(p);
+    }
+    for (usize_t i = 0; i < 1000; ++i)
+        TEST_ASSERT_EQ(ptrs[i][9],static_cast<char>(i));
+    TEST_ASSERT_EQ(arena.bytesUsed(),16+5000+1+10000);
+    // one block is kept for reuse
+    arena.reset();
+    TEST_ASSERT_EQ(arena.bytesUsed(),0);
+    TEST_ASSERT_EQ(arena.bytesReserved(),1024);
+    TEST_ASSERT_NE(arena.allocate(100),nullptr);
+    TEST_ASSERT_EQ(arena.bytesReserved(),1024);
+    Arena other(std::move(arena));
+    TEST_ASSERT_EQ(arena.bytesReserved(),0);
+    TEST_ASSERT_EQ(other.bytesReserved(),1024);
+    TEST_ASSERT_EQ(other.bytesUsed(),100);
+}
+
+TEST_CASE_CREATE(testArenaAllocator)
+{
+    Arena arena;
+    tkoz::stl::ArenaAllocator<long> alloc(arena);
+    long *p = alloc.allocate(4);
+    TEST_ASSERT_EQ(reinterpret_cast<uintptr_t>(p) % alignof(long),0);
+    p[3] = 7;
+    alloc.deallocate(p);
+    TEST_ASSERT_EQ(arena.bytesUsed(),4*sizeof(long));
+    tkoz::stl::ArenaAllocator<char> alloc2(alloc);
+    TEST_ASSERT_EQ(&alloc2.arena(),&arena);
+    TEST_ASSERT_TRUE(alloc == tkoz::stl::ArenaAllocator<long>(arena));
+}
+
+TEST_CASE_CREATE(testPoolSizeClass)
+{
+    TEST_ASSERT_EQ(Pool::sizeClass(0),0);
+    TEST_ASSERT_EQ(Pool::sizeClass(1),0);
+    TEST_ASSERT_EQ(Pool::sizeClass(16),0);
+    TEST_ASSERT_EQ(Pool::sizeClass(17),1);
+    TEST_ASSERT_EQ(Pool::sizeClass(128),7);
+    TEST_ASSERT_EQ(Pool::sizeClass(129),8);
+    TEST_ASSERT_EQ(Pool::sizeClass(256),8);
+    TEST_ASSERT_EQ(Pool::sizeClass(257),9);
+    TEST_ASSERT_EQ(Pool::sizeClass(Pool::cMaxSmall),Pool::cNumClasses-1);
+    TEST_ASSERT_EQ(Pool::classSize(Pool::cNumClasses-1),Pool::cMaxSmall);
+    for (usize_t b = 1; b <= Pool::cMaxSmall; ++b)
+    {
+        const usize_t c = Pool::sizeClass(b);
+        TEST_ASSERT_GE(Pool::classSize(c),b);
+        if (c > 0)
+            TEST_ASSERT_LT(Pool::classSize(c-1),b);
+    }
+}
+
+TEST_CASE_CREATE(testPool)
+{
+    Pool pool;
+    void *a = pool.allocate(10);
+    void *b = pool.allocate(12);
+    TEST_ASSERT_EQ(reinterpret_cast<uintptr_t>(a) % Pool::cAlign,0);
+    TEST_ASSERT_EQ(static_cast<char*>(b),static_cast<char*>(a)+16);
+    TEST_ASSERT_EQ(pool.bytesInUse(),32);
+    TEST_ASSERT_EQ(pool.bytesReserved(),Pool::cSlabSize);
+    // freed memory is reused by the same size class
+    pool.deallocate(a);
+    TEST_ASSERT_EQ(pool.allocate(16),a);
+    pool.deallocate(nullptr);
+    // large allocations
+    char *big = static_cast<char*>(pool.allocate(100000));
+    big[99999] = 'x';
+    TEST_ASSERT_EQ(pool.bytesInUse(),32+100000);
+    pool.deallocate(big);
+    TEST_ASSERT_EQ(pool.bytesInUse(),32);
+    TEST_ASSERT_EQ(pool.bytesReserved(),Pool::cSlabSize);
+    pool.deallocate(a);
+    pool.deallocate(b);
+    TEST_ASSERT_EQ(pool.bytesInUse(),0);
+}
+
+TEST_CASE_CREATE(testPoolRandom)
+{
+    std::mt19937 rng(5);
+    Pool pool;
+    tkoz::stl::PoolAllocator<char> alloc(pool);
+    std::vector<std::pair<char*,usize_t>> live;
+    for (int step = 0; step < 50000; ++step)
+    {
+        if (live.empty() || rng() % 3)
+        {
+            const usize_t size = rng() % 8 ? rng() % 300 : rng() % 10000;
+            char *p = alloc.allocate(size + 1);
+            for (usize_t i = 0; i <= size; ++i)
+                p[i] = static_cast<char>(size);
+            live.push_back({p,size});
+        }
+        else
+        {
+            const usize_t i = rng() % live.size();
+            auto [p,size] = live[i];
+            for (usize_t j = 0; j <= size; ++j)
+                TEST_ASSERT_EQ(p[j],static_cast<char>(size));
+            alloc.deallocate(p);
+            live[i] = live.back();
+            live.pop_back();
+        }
+    }
+    for (auto [p,size] : live)
+        alloc.deallocate(p);
+    TEST_ASSERT_EQ(pool.bytesInUse(),0);
+}
+
+TEST_CASE_CREATE(testPoolThreadLocal)
+{
+    Pool &local = *Pool::threadLocal();
+    TEST_ASSERT_TRUE(&local == Pool::threadLocal().get());
+    void *p = local.allocate(24);
+    TEST_ASSERT_GE(local.bytesInUse(),32);
+    // each thread has its own pool
+    Pool *other = nullptr;
+    usize_t otherBytes = 1;
+    std::thread thread([&other, &otherBytes]()
+    {
+        other = Pool::threadLocal().get();
+        otherBytes = other->bytesInUse();
+    });
+    thread.join();
+    TEST_ASSERT_TRUE(other != &local);
+    TEST_ASSERT_EQ(otherBytes,0);
+    local.deallocate(p);
+}
@@ -0,0 +1,88 @@
+///
+/// unit tests for tkoz::stl::AtomicSixBytePointer
+///
+
+#include <tkoz/Test.hpp>
+
+#include <tkoz/stl/AtomicSixBytePointer.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <thread>
+#include <vector>
+
+namespace stl = tkoz::stl;
+using stl::usize_t;
+using Atomic = stl::AtomicSixBytePointer<int>;
+
+// instantiate template for accurate code coverage report
+template class stl::AtomicSixBytePointer<int>;
+
+static_assert(sizeof(Atomic) == 8);
+static_assert(Atomic::cIsAlwaysLockFree);
+
+TEST_RUNNER_MAIN
+
+TEST_CASE_CREATE(testCounter)
+{
+    int x[3];
+    Atomic a;
+    TEST_ASSERT_TRUE(a.load().ptr() == nullptr);
+    TEST_ASSERT_EQ(a.load().highTag(),0);
+    a.store(x);
+    TEST_ASSERT_TRUE(a.load().ptr() == x);
+    TEST_ASSERT_EQ(a.load().highTag(),1);
+    Atomic::ValueType old = a.exchange(x + 1);
+    TEST_ASSERT_TRUE(old.ptr() == x);
+    TEST_ASSERT_EQ(old.highTag(),1);
+    TEST_ASSERT_EQ(a.load().highTag(),2);
+    Atomic b(x + 2);
+    TEST_ASSERT_TRUE(b.load().ptr() == x + 2);
+    TEST_ASSERT_EQ(b.load().highTag(),0);
+    // counter wraps around
+    for (usize_t i = 0; i < 0x10000 - 2; ++i)
+        a.store(x + 1);
+    TEST_ASSERT_EQ(a.load().highTag(),0);
+    TEST_ASSERT_TRUE(a.load().ptr() == x + 1);
+}
+
+TEST_CASE_CREATE(testCompareExchange)
+{
+    int x[2];
+    Atomic a(x);
+    Atomic::ValueType expected = a.load();
+    TEST_ASSERT_TRUE(a.compareExchangeStrong(expected,x + 1));
+    TEST_ASSERT_TRUE(a.load().ptr() == x + 1);
+    TEST_ASSERT_EQ(a.load().highTag(),1);
+    // A to B to A is detected by the counter
+    expected = a.load();
+    a.store(x);
+    a.store(x + 1);
+    TEST_ASSERT_TRUE(a.load().ptr() == expected.ptr());
+    TEST_ASSERT_FALSE(a.compareExchangeStrong(expected,nullptr));
+    TEST_ASSERT_TRUE(expected == a.load());
+    TEST_ASSERT_EQ(expected.highTag(),3);
+    while (!a.compareExchangeWeak(expected,nullptr));
+    TEST_ASSERT_TRUE(a.load().ptr() == nullptr);
+    TEST_ASSERT_EQ(a.load().highTag(),4);
+}
+
+TEST_CASE_CREATE(testThreads)
+{
+    // every successful modification increments the counter exactly once
+    int x[2];
+    Atomic a(x);
+    std::vector<std::thread> threads;
+    for (usize_t t = 0; t < 4; ++t)
+        threads.emplace_back([&a, &x, t]()
+        {
+            for (usize_t i = 0; i < 5000; ++i)
+            {
+                Atomic::ValueType v = a.load(std::memory_order_relaxed);
+                while (!a.compareExchangeWeak(v,x + ((t + i) & 1),
+                    std::memory_order_relaxed,std::memory_order_relaxed));
+            }
+        });
+    for (std::thread &thread : threads)
+        thread.join();
+    TEST_ASSERT_EQ(a.load().highTag(),20000 & 0xFFFF);
+}
@@ -4,6 +4,7 @@
 
 #include <tkoz/Test.hpp>
 
+#include <tkoz/stl/Allocator.hpp>
 #include <tkoz/stl/CString.hpp>
 #include <tkoz/stl/Concepts.hpp>
 #include <tkoz/stl/Exceptions.hpp>
@@ -30,6 +31,9 @@ using IntStringNoNull = tkoz::stl::CString<int,false>;
 // default argument is char
 static_assert(tkoz::stl::meta::isSame<CString,tkoz::stl::CString<char,true>>);
 
+// default allocator is stateless and takes no space
+static_assert(sizeof(CString) == sizeof(char*));
+
 TEST_RUNNER_MAIN
 
 TEST_CASE_CREATE(testCtorDefault)
@@ -132,6 +136,37 @@ TEST_CASE_CREATE(testCtorRepchar)
     TEST_ASSERT_EQ(s3.ptr()[12],'\0');
 }
 
+TEST_CASE_CREATE(testCtorPtrLen)
+{
+    CString s1("Phenom II",6);
+    TEST_ASSERT_EQ(s1.len(),6);
+    TEST_ASSERT_EQ(s1,"Phenom");
+    CString s2("",0);
+    TEST_ASSERT_FALSE(s2.isNull());
+    TEST_ASSERT_EQ(s2,"");
+    const wchar_t w[3] = {L'a',L'b',L'c'};
+    WCString s3(w,3);
+    TEST_ASSERT_EQ(s3,L"abc");
+}
+
+TEST_CASE_CREATE(testFind)
+{
+    CString s1("mississippi");
+    TEST_ASSERT_EQ(s1.find("ssi"),2);
+    TEST_ASSERT_EQ(s1.find("ippi"),7);
+    TEST_ASSERT_EQ(s1.find("issp"),CString::npos);
+    TEST_ASSERT_EQ(s1.find(""),0);
+    TEST_ASSERT_EQ(s1.find(CString("pi")),9);
+    TEST_ASSERT_TRUE(s1.contains("sis"));
+    TEST_ASSERT_FALSE(s1.contains("mississippis"));
+    CString s2;
+    TEST_ASSERT_EQ(s2.find("a"),CString::npos);
+    TEST_ASSERT_EQ(s2.find(nullptr),0);
+    TEST_ASSERT_EQ(CString::ptrFind("abcabc","ca"),2);
+    WCString s3(L"wide string");
+    TEST_ASSERT_EQ(s3.find(L"str"),5);
+}
+
 TEST_CASE_CREATE(testCtorCopy)
 {
     CString s1;
@@ -784,6 +819,125 @@ TEST_CASE_CREATE(testOpAdd)
     }
 }
 
+TEST_CASE_CREATE(testOpAddChain)
+{
+    using tkoz::stl::meta::isSame;
+    using Concat2 = tkoz::stl::CStringConcat<CString,2>;
+    using Concat4 = tkoz::stl::CStringConcat<CString,4>;
+    CString a("log"), b(": "), c("request"), n;
+    static_assert(isSame<decltype(a + b),Concat2>);
+    static_assert(isSame<decltype(a + b + c + "!"),Concat4>);
+    static_assert(isSame<decltype("[" + a + b + c),Concat4>);
+    static_assert(isSame<decltype((a + b) + (c + a)),Concat4>);
+
+    CString s1 = a + b + c + " " + CString("done");
+    TEST_ASSERT_EQ(s1,"log: request done");
+    TEST_ASSERT_EQ(s1.len(),17);
+    CString s2 = "[" + a + "] " + c;
+    TEST_ASSERT_EQ(s2,"[log] request");
+    CString s3 = (a + b) + (c + a);
+    TEST_ASSERT_EQ(s3,"log: requestlog");
+    TEST_ASSERT_EQ((a + b + c).len(),12);
+    TEST_ASSERT_EQ((a + b + c).toCString(),"log: request");
+
+    // null operands are empty unless every operand is null
+    CString s4 = n + n + n;
+    TEST_ASSERT_TRUE(s4.isNull());
+    CString s5 = n + "" + n;
+    TEST_ASSERT_FALSE(s5.isNull());
+    TEST_ASSERT_EQ(s5,"");
+    CString s6 = n + a + nullptr + c;
+    TEST_ASSERT_EQ(s6,"logrequest");
+
+    // append a chain with a single allocation
+    CString s7;
+    s7 += a + b;
+    TEST_ASSERT_EQ(s7,"log: ");
+    s7 += c + "s" + n;
+    TEST_ASSERT_EQ(s7,"log: requests");
+    s7 += n + n;
+    TEST_ASSERT_EQ(s7,"log: requests");
+    CString s8;
+    s8 += n + n;
+    TEST_ASSERT_TRUE(s8.isNull());
+
+    // assigning a chain that refers to the assigned string
+    a = a + "/" + a;
+    TEST_ASSERT_EQ(a,"log/log");
+
+    const char *parts[] = {"x",nullptr,"yz",""};
+    char *p = CString::ptrConcatNew(parts);
+    TEST_ASSERT_TRUE(CString::ptrCmpEq(p,"xyz"));
+    delete[] p;
+    const char *nulls[] = {nullptr,nullptr};
+    TEST_ASSERT_EQ(CString::ptrConcatNew(nulls),nullptr);
+    const char *noNull[] = {"ab","","c"};
+    p = CStringNoNull::ptrConcatNew(noNull);
+    TEST_ASSERT_TRUE(CStringNoNull::ptrCmpEq(p,"abc"));
+    delete[] p;
+}
+
+TEST_CASE_CREATE(testAllocator)
+{
+    using ArenaString = tkoz::stl::CString<char,true,
+        tkoz::stl::ArenaAllocator<char>>;
+    using PoolString = tkoz::stl::CString<char,true,
+        tkoz::stl::PoolAllocator<char>>;
+    tkoz::stl::Arena arena;
+    tkoz::stl::Pool pool;
+    {
+        ArenaString s1("Ryzen",arena);
+        ArenaString s2(3,'9',arena);
+        TEST_ASSERT_EQ(s1,"Ryzen");
+        TEST_ASSERT_EQ(s2,"999");
+        TEST_ASSERT_EQ(arena.bytesUsed(),10);
+        s1 += " ";
+        s1 += s2;
+        TEST_ASSERT_EQ(s1,"Ryzen 999");
+        ArenaString s3 = (s1 + "0" + s2).toCString(arena);
+        TEST_ASSERT_EQ(s3,"Ryzen 9990999");
+        TEST_ASSERT_TRUE(s3.allocator() == s1.allocator());
+        ArenaString s4(s3);
+        TEST_ASSERT_EQ(s4,s3);
+        TEST_ASSERT_NE(s4.ptr(),s3.ptr());
+        ArenaString s5(arena);
+        TEST_ASSERT_TRUE(s5.isNull());
+        s5 += s1 + s2;
+        TEST_ASSERT_EQ(s5,"Ryzen 999999");
+        // the result uses the allocator of the left-most CString
+        ArenaString s6 = s1 + s2;
+        TEST_ASSERT_EQ(s6,"Ryzen 999999");
+        TEST_ASSERT_TRUE(s6.allocator() == s1.allocator());
+        ArenaString s7 = "[" + s2 + "] " + s1;
+        TEST_ASSERT_EQ(s7,"[999] Ryzen 999");
+        TEST_ASSERT_TRUE(s7.allocator() == s2.allocator());
+        TEST_ASSERT_EQ((s2 + s2).toCString(),"999999");
+        tkoz::stl::Arena other;
+        ArenaString t1("X3D ",other);
+        ArenaString t2 = t1 + s1;
+        TEST_ASSERT_EQ(t2,"X3D Ryzen 999");
+        TEST_ASSERT_TRUE(t2.allocator() == t1.allocator());
+        TEST_ASSERT_FALSE(t2.allocator() == s1.allocator());
+    }
+    // nothing is freed until reset
+    TEST_ASSERT_GE(arena.bytesUsed(),48);
+    arena.reset();
+    TEST_ASSERT_EQ(arena.bytesUsed(),0);
+    {
+        PoolString s1("EPYC",pool);
+        PoolString s2 = PoolString::ptrWrap(
+            PoolString::ptrConcatNew(s1.ptr()," 9654",pool),pool);
+        TEST_ASSERT_EQ(s2,"EPYC 9654");
+        s1 = s2;
+        TEST_ASSERT_EQ(s1,"EPYC 9654");
+        s2 += s1 + s1;
+        TEST_ASSERT_EQ(s2,"EPYC 9654EPYC 9654EPYC 9654");
+        TEST_ASSERT_GT(pool.bytesInUse(),0);
+    }
+    // all memory returned to the pool
+    TEST_ASSERT_EQ(pool.bytesInUse(),0);
+}
+
 TEST_CASE_CREATE(testOpAddEq)
 {
     for (auto [left,right,concat] : CONCAT_TEST_DATA)
@@ -1192,6 +1346,35 @@ TEST_CASE_CREATE(testAtOther)
     delete s3;
 }
 
+TEST_CASE_CREATE(testIgnoreCase)
+{
+    using CString = tkoz::stl::CString<char>;
+    TEST_ASSERT_TRUE(CString::ptrCmpEqIgnoreCase("X-Forwarded-For",
+        "x-forwarded-for"));
+    TEST_ASSERT_FALSE(CString::ptrCmpEqIgnoreCase("abc","abcd"));
+    TEST_ASSERT_TRUE(CString::ptrCmpEqIgnoreCase(nullptr,nullptr));
+    TEST_ASSERT_FALSE(CString::ptrCmpEqIgnoreCase("",nullptr));
+    TEST_ASSERT_LT(CString::ptrCmp3wayIgnoreCase("apple","BANANA"),0);
+    TEST_ASSERT_GT(CString::ptrCmp3wayIgnoreCase("b","A"),0);
+    TEST_ASSERT_EQ(CString::ptrCmp3wayIgnoreCase("Hello","hELLO"),0);
+    TEST_ASSERT_LT(CString::ptrCmp3wayIgnoreCase(nullptr,""),0);
+    CString s("Hello, World! 123");
+    const CString lower = s.lowerCase();
+    const CString upper = s.upperCase();
+    TEST_ASSERT_EQ(lower,"hello, world! 123");
+    TEST_ASSERT_EQ(upper,"HELLO, WORLD! 123");
+    TEST_ASSERT_EQ(s,"Hello, World! 123");
+    TEST_ASSERT_EQ(s.toUpperCase(),upper);
+    TEST_ASSERT_EQ(s.toLowerCase(),lower);
+    TEST_ASSERT_TRUE(CString().lowerCase().isNull());
+    CString null;
+    TEST_ASSERT_TRUE(null.toUpperCase().isNull());
+    tkoz::stl::CString<wchar_t,false> w(L"\u00c9T\u00c9");
+    TEST_ASSERT_TRUE(w.toLowerCase() == L"\u00c9t\u00c9");
+    tkoz::stl::CString<int> ints(3,'Q');
+    TEST_ASSERT_EQ(ints.lowerCase()[2],'q');
+}
+
 // TODO debug asserts inside CString.hpp for preconditions and invariants
 // precondition checks grouped by fast (<linear), medium(quasilinear), slow(>linear)
 // optional and handled with macros, require some symbol and make debug/assert/check headers
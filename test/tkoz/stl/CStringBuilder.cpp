@@ -0,0 +1,165 @@
+///
+/// unit tests for tkoz::stl::CStringBuilder (growable string buffer)
+///
+
+#include <tkoz/Test.hpp>
+
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/CStringBuilder.hpp>
+#include <tkoz/stl/Meta.hpp>
+#include <tkoz/stl/Utils.hpp>
+
+// instantiate template for accurate code coverage report
+template class tkoz::stl::CStringBuilder<char>;
+template class tkoz::stl::CStringBuilder<wchar_t>;
+template class tkoz::stl::CStringBuilder<char,false>;
+
+using Builder = tkoz::stl::CStringBuilder<char>;
+using BuilderNoNull = tkoz::stl::CStringBuilder<char,false>;
+using WBuilder = tkoz::stl::CStringBuilder<wchar_t>;
+using CString = tkoz::stl::CString<char>;
+using tkoz::stl::usize_t;
+
+static_assert(tkoz::stl::meta::isSame<Builder::StringType,CString>);
+static_assert(tkoz::stl::meta::isSame<BuilderNoNull::StringType,
+    tkoz::stl::CString<char,false>>);
+
+TEST_RUNNER_MAIN
+
+TEST_CASE_CREATE(testEmpty)
+{
+    Builder b1;
+    TEST_ASSERT_EQ(b1.len(),0);
+    TEST_ASSERT_EQ(b1.capacity(),0);
+    TEST_ASSERT_TRUE(CString::ptrCmpEq(b1.ptr(),""));
+    b1.append(nullptr);
+    b1.append("",0);
+    TEST_ASSERT_EQ(b1.capacity(),0);
+    CString s1 = b1.build();
+    TEST_ASSERT_FALSE(s1.isNull());
+    TEST_ASSERT_EQ(s1,"");
+
+    Builder b2(100);
+    TEST_ASSERT_EQ(b2.len(),0);
+    TEST_ASSERT_EQ(b2.capacity(),100);
+    TEST_ASSERT_TRUE(CString::ptrCmpEq(b2.ptr(),""));
+}
+
+TEST_CASE_CREATE(testAppend)
+{
+    Builder b1("Hello");
+    TEST_ASSERT_EQ(b1.len(),5);
+    b1 += ',';
+    b1 += " ";
+    b1 += CString("world");
+    b1.append(3,'!');
+    b1.append("??? ignored",0);
+    b1.append("? and more",1);
+    TEST_ASSERT_EQ(b1.len(),16);
+    TEST_ASSERT_TRUE(CString::ptrCmpEq(b1.ptr(),"Hello, world!!!?"));
+    TEST_ASSERT_EQ(b1[0],'H');
+    b1[0] = 'h';
+    TEST_ASSERT_EQ(b1[16],'\0');
+    b1 += b1;
+    TEST_ASSERT_TRUE(CString::ptrCmpEq(b1.ptr(),
+        "hello, world!!!?hello, world!!!?"));
+    // appending part of its own buffer
+    b1.append(b1.ptr()+7,5);
+    TEST_ASSERT_TRUE(CString::ptrCmpEq(b1.ptr(),
+        "hello, world!!!?hello, world!!!?world"));
+
+    b1.clear();
+    TEST_ASSERT_EQ(b1.len(),0);
+    TEST_ASSERT_GE(b1.capacity(),37);
+    TEST_ASSERT_TRUE(CString::ptrCmpEq(b1.ptr(),""));
+}
+
+TEST_CASE_CREATE(testGeometricGrowth)
+{
+    Builder b1;
+    usize_t reallocs = 0;
+    usize_t cap = b1.capacity();
+    CString expected(100000,'x');
+    for (int i = 0; i < 100000; ++i)
+    {
+        b1 += 'x';
+        if (b1.capacity() != cap)
+        {
+            ++reallocs;
+            cap = b1.capacity();
+        }
+    }
+    TEST_ASSERT_LE(reallocs,20);
+    TEST_ASSERT_EQ(b1.len(),100000);
+    TEST_ASSERT_TRUE(CString::ptrCmpEq(b1.ptr(),expected.ptr()));
+}
+
+TEST_CASE_CREATE(testBuild)
+{
+    Builder b1;
+    for (int i = 0; i < 10; ++i)
+        b1 += "ab";
+    const char *buf = b1.ptr();
+    CString s1 = b1.build();
+    // buffer handed off without a copy
+    TEST_ASSERT_EQ(s1.ptr(),buf);
+    TEST_ASSERT_EQ(s1,"abababababababababab");
+    TEST_ASSERT_EQ(b1.len(),0);
+    TEST_ASSERT_EQ(b1.capacity(),0);
+    b1 += "again";
+    TEST_ASSERT_EQ(b1.build(),"again");
+
+    // take the buffer of an existing CString
+    CString s2("taken");
+    const char *p2 = s2.ptr();
+    Builder b2(tkoz::stl::move(s2));
+    TEST_ASSERT_TRUE(s2.isNull());
+    TEST_ASSERT_EQ(b2.ptr(),p2);
+    TEST_ASSERT_EQ(b2.len(),5);
+    TEST_ASSERT_EQ(b2.capacity(),5);
+    b2 += " back";
+    TEST_ASSERT_EQ(b2.build(),"taken back");
+
+    Builder b3{CString()};
+    TEST_ASSERT_EQ(b3.len(),0);
+
+    BuilderNoNull b4("no null");
+    TEST_ASSERT_EQ(b4.build(),"no null");
+}
+
+TEST_CASE_CREATE(testCopyMove)
+{
+    Builder b1("copied value");
+    Builder b2(b1);
+    TEST_ASSERT_NE(b1.ptr(),b2.ptr());
+    TEST_ASSERT_TRUE(CString::ptrCmpEq(b1.ptr(),b2.ptr()));
+    Builder b3;
+    b3 = b1;
+    TEST_ASSERT_TRUE(CString::ptrCmpEq(b3.ptr(),"copied value"));
+    b3 = b3;
+    TEST_ASSERT_TRUE(CString::ptrCmpEq(b3.ptr(),"copied value"));
+    Builder b4(tkoz::stl::move(b3));
+    TEST_ASSERT_EQ(b3.len(),0);
+    TEST_ASSERT_TRUE(CString::ptrCmpEq(b4.ptr(),"copied value"));
+    Builder b5("other");
+    b5 = tkoz::stl::move(b4);
+    TEST_ASSERT_TRUE(CString::ptrCmpEq(b5.ptr(),"copied value"));
+}
+
+TEST_CASE_CREATE(testWide)
+{
+    WBuilder b1(L"wide");
+    b1 += L' ';
+    b1 += L"string";
+    TEST_ASSERT_EQ(b1.len(),11);
+    TEST_ASSERT_EQ(b1.build(),L"wide string");
+}
+
+TEST_CASE_CREATE(testRelease)
+{
+    CString s1("owned");
+    char *p = s1.release();
+    TEST_ASSERT_TRUE(s1.isNull());
+    TEST_ASSERT_TRUE(CString::ptrCmpEq(p,"owned"));
+    delete[] p;
+}
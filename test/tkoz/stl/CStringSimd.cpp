@@ -0,0 +1,388 @@
+///
+/// unit tests for vectorized C string kernels (compared to scalar loops)
+///
+
+#include <tkoz/Test.hpp>
+
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/CStringSimd.hpp>
+#include <tkoz/stl/Simd.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <compare>
+#include <random>
+#include <vector>
+
+#include <sys/mman.h>
+
+namespace simd = tkoz::stl::simd;
+using tkoz::stl::usize_t;
+
+static_assert(simd::isByteChar<char>);
+static_assert(simd::isByteChar<const unsigned char>);
+static_assert(simd::isByteChar<char8_t>);
+static_assert(!simd::isByteChar<wchar_t>);
+static_assert(!simd::isByteChar<int>);
+
+// all levels to compare, unsupported ones are clamped to the processor
+static const simd::SimdLevel LEVELS[] =
+{
+    simd::cSimdScalar,
+    simd::cSimdSse2,
+    simd::cSimdAvx2,
+    simd::cSimdAvx512
+};
+
+TEST_RUNNER_MAIN
+
+TEST_CASE_CREATE(testSimdLevel)
+{
+    const simd::SimdLevel level = simd::simdLevel();
+    TEST_INFO("detected SIMD level " << static_cast<int>(level));
+#if __x86_64__
+    TEST_ASSERT_GE(level,simd::cSimdSse2);
+#endif
+    TEST_ASSERT_EQ(simd::clampSimdLevel(simd::cSimdScalar),simd::cSimdScalar);
+    TEST_ASSERT_EQ(simd::clampSimdLevel(simd::cSimdAvx512),level);
+    TEST_ASSERT_EQ(level,simd::simdLevel());
+    TEST_ASSERT_FALSE(simd::crossesPage(reinterpret_cast<void*>(4096),64));
+    TEST_ASSERT_FALSE(simd::crossesPage(reinterpret_cast<void*>(4032),64));
+    TEST_ASSERT_TRUE(simd::crossesPage(reinterpret_cast<void*>(4033),64));
+}
+
+TEST_CASE_CREATE(testStrLen)
+{
+    std::mt19937 rng(1);
+    // 64 bytes of padding before and after so every start alignment is used
+    std::vector<char> buf(64 + 600 + 64);
+    for (usize_t len = 0; len <= 300; ++len)
+    {
+        for (usize_t offset = 0; offset < 64; ++offset)
+        {
+            char *s = buf.data() + offset;
+            for (usize_t i = 0; i < len; ++i)
+                s[i] = static_cast<char>(1 + rng() % 255);
+            s[len] = '\0';
+            for (simd::SimdLevel level : LEVELS)
+                TEST_ASSERT_EQ(simd::strLen(s,level),len);
+            TEST_ASSERT_EQ(simd::strLen(s),len);
+            TEST_ASSERT_EQ(tkoz::stl::CString<char>::ptrLen(s),len);
+        }
+    }
+}
+
+TEST_CASE_CREATE(testStrMismatch)
+{
+    std::mt19937 rng(2);
+    std::vector<char> buf1(64 + 300 + 64);
+    std::vector<char> buf2(64 + 300 + 64);
+    for (int trial = 0; trial < 20000; ++trial)
+    {
+        const usize_t len1 = rng() % 260;
+        const usize_t len2 = rng() % 2 ? len1 : rng() % 260;
+        char *s1 = buf1.data() + rng() % 64;
+        char *s2 = buf2.data() + rng() % 64;
+        // small alphabet so long common prefixes are likely
+        for (usize_t i = 0; i < len1; ++i)
+            s1[i] = static_cast<char>(rng() % 4 ? 'a' : 0x80 + rng() % 3);
+        s1[len1] = '\0';
+        for (usize_t i = 0; i < len2; ++i)
+            s2[i] = i < len1 && rng() % 300 ? s1[i] : static_cast<char>('b');
+        s2[len2] = '\0';
+        const usize_t expected = simd::_detail::_strMismatchScalar(s1,s2);
+        for (simd::SimdLevel level : LEVELS)
+            TEST_ASSERT_EQ(simd::strMismatch(s1,s2,level),expected);
+        TEST_ASSERT_EQ(simd::strMismatch(s1,s2),expected);
+        // signed char ordering must match the character comparison
+        const auto cmp = s1[expected] <=> s2[expected];
+        TEST_ASSERT_EQ(simd::strCmp3way(s1,s2),cmp);
+        TEST_ASSERT_EQ(simd::strCmpEq(s1,s2),cmp == 0);
+        TEST_ASSERT_EQ(tkoz::stl::CString<char>::ptrCmp3way(s1,s2),cmp);
+    }
+}
+
+// strings ending at the last byte of a page followed by an inaccessible page
+TEST_CASE_CREATE(testPageBoundary)
+{
+    const usize_t page = simd::cPageSize;
+    void *map = mmap(nullptr,2*page,PROT_READ|PROT_WRITE,
+        MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+    TEST_ASSERT_NE(map,MAP_FAILED);
+    TEST_ASSERT_EQ(mprotect(static_cast<char*>(map)+page,page,PROT_NONE),0);
+    char *end = static_cast<char*>(map) + page - 1;
+    *end = '\0';
+    char other[400];
+    for (usize_t len = 0; len < 300; ++len)
+    {
+        char *s = end - len;
+        s[0] = len ? 'x' : '\0';
+        for (usize_t i = 0; i <= len; ++i)
+            other[i] = s[i];
+        for (simd::SimdLevel level : LEVELS)
+        {
+            TEST_ASSERT_EQ(simd::strLen(s,level),len);
+            TEST_ASSERT_EQ(simd::strMismatch(s,other,level),len);
+            TEST_ASSERT_EQ(simd::strMismatch(other,s,level),len);
+            TEST_ASSERT_EQ(simd::strMismatch(s,s,level),len);
+            TEST_ASSERT_EQ(simd::strMismatchIgnoreCase(s,other,level),len);
+            TEST_ASSERT_EQ(simd::strMismatchIgnoreCase(other,s,level),len);
+        }
+    }
+    munmap(map,2*page);
+}
+
+// letters near the case boundaries and bytes mapping to letters with 0x20
+static char randomCaseChar(std::mt19937 &rng)
+{
+    static const char chars[] = "@AZ[`az{aAzZ_\x80\xc1\xe1\xfa";
+    return chars[rng() % (sizeof(chars) - 1)];
+}
+
+TEST_CASE_CREATE(testStrMismatchIgnoreCase)
+{
+    std::mt19937 rng(17);
+    std::vector<char> buf1(64 + 300 + 64);
+    std::vector<char> buf2(64 + 300 + 64);
+    for (int trial = 0; trial < 20000; ++trial)
+    {
+        const usize_t len1 = rng() % 260;
+        const usize_t len2 = rng() % 2 ? len1 : rng() % 260;
+        char *s1 = buf1.data() + rng() % 64;
+        char *s2 = buf2.data() + rng() % 64;
+        for (usize_t i = 0; i < len1; ++i)
+            s1[i] = randomCaseChar(rng);
+        s1[len1] = '\0';
+        // same letters with random case, and rarely a different character
+        for (usize_t i = 0; i < len2; ++i)
+        {
+            const char c = i < len1 ? s1[i] : randomCaseChar(rng);
+            s2[i] = rng() % 300 == 0 ? randomCaseChar(rng) : rng() % 2
+                ? simd::toUpperAscii(c) : simd::toLowerAscii(c);
+        }
+        s2[len2] = '\0';
+        const usize_t expected =
+            simd::_detail::_strMismatchIgnoreCaseScalar(s1,s2);
+        for (simd::SimdLevel level : LEVELS)
+            TEST_ASSERT_EQ(simd::strMismatchIgnoreCase(s1,s2,level),expected);
+        TEST_ASSERT_EQ(simd::strMismatchIgnoreCase(s1,s2),expected);
+        const auto cmp = simd::toLowerAscii(s1[expected])
+            <=> simd::toLowerAscii(s2[expected]);
+        TEST_ASSERT_EQ(simd::strCmp3wayIgnoreCase(s1,s2),cmp);
+        TEST_ASSERT_EQ(simd::strCmpEqIgnoreCase(s1,s2),cmp == 0);
+    }
+    TEST_ASSERT_TRUE(simd::strCmpEqIgnoreCase("Content-Length",
+        "content-length"));
+    TEST_ASSERT_FALSE(simd::strCmpEqIgnoreCase("[","{"));
+    TEST_ASSERT_EQ(simd::strCmp3wayIgnoreCase("B","a"),
+        std::strong_ordering::greater);
+    TEST_ASSERT_EQ(simd::strCmp3wayIgnoreCase("_","A"),
+        std::strong_ordering::less);
+}
+
+TEST_CASE_CREATE(testMemCase)
+{
+    std::mt19937 rng(18);
+    std::vector<char> src(300);
+    std::vector<char> lower(300);
+    std::vector<char> upper(300);
+    std::vector<char> dst(300);
+    for (usize_t n = 0; n <= 200; ++n)
+    {
+        for (usize_t i = 0; i < n; ++i)
+        {
+            src[i] = static_cast<char>(rng() % 2 ? rng()
+                : static_cast<unsigned>(randomCaseChar(rng)));
+            lower[i] = 'A' <= src[i] && src[i] <= 'Z'
+                ? static_cast<char>(src[i] + 32) : src[i];
+            upper[i] = 'a' <= src[i] && src[i] <= 'z'
+                ? static_cast<char>(src[i] - 32) : src[i];
+        }
+        for (simd::SimdLevel level : LEVELS)
+        {
+            // bytes after the range are not written
+            dst[n] = '#';
+            simd::memToLowerCase(dst.data(),src.data(),n,level);
+            TEST_ASSERT_EQ(simd::memMismatch(dst.data(),lower.data(),n),n);
+            TEST_ASSERT_EQ(dst[n],'#');
+            simd::memToUpperCase(dst.data(),src.data(),n,level);
+            TEST_ASSERT_EQ(simd::memMismatch(dst.data(),upper.data(),n),n);
+            // in place
+            simd::memToLowerCase(dst.data(),dst.data(),n,level);
+            TEST_ASSERT_EQ(simd::memMismatch(dst.data(),lower.data(),n),n);
+            TEST_ASSERT_EQ(dst[n],'#');
+        }
+        simd::memToUpperCase(dst.data(),src.data(),n);
+        TEST_ASSERT_EQ(simd::memMismatch(dst.data(),upper.data(),n),n);
+    }
+    wchar_t w[] = L"MiXeD \u00c9";
+    simd::memToLowerCase(w,w,7);
+    TEST_ASSERT_TRUE(simd::strCmpEq(static_cast<const wchar_t*>(w),
+        L"mixed \u00c9"));
+    TEST_ASSERT_EQ(simd::strMismatchIgnoreCase(L"abc",L"ABd"),2);
+    static_assert(simd::toLowerAscii(U'Q') == U'q');
+    static_assert(simd::toUpperAscii('@') == '@');
+}
+
+TEST_CASE_CREATE(testMemMismatch)
+{
+    std::mt19937 rng(3);
+    std::vector<char> buf1(64 + 300);
+    std::vector<char> buf2(64 + 300);
+    for (int trial = 0; trial < 20000; ++trial)
+    {
+        const usize_t n = rng() % 300;
+        char *s1 = buf1.data() + rng() % 64;
+        char *s2 = buf2.data() + rng() % 64;
+        // null characters are compared like others
+        for (usize_t i = 0; i < n; ++i)
+        {
+            s1[i] = static_cast<char>(rng() % 4 ? 0 : 0x80 + rng() % 3);
+            s2[i] = rng() % 200 ? s1[i] : static_cast<char>('b');
+        }
+        const usize_t expected = simd::_detail::_memMismatchScalar(s1,s2,n);
+        for (simd::SimdLevel level : LEVELS)
+            TEST_ASSERT_EQ(simd::memMismatch(s1,s2,n,level),expected);
+        TEST_ASSERT_EQ(simd::memMismatch(s1,s2,n),expected);
+        TEST_ASSERT_EQ(simd::memCmpEq(s1,n,s2,n),expected == n);
+        const auto cmp = expected < n ? s1[expected] <=> s2[expected]
+            : std::strong_ordering::equal;
+        TEST_ASSERT_EQ(simd::memCmp3way(s1,n,s2,n),cmp);
+    }
+    // lengths are compared after the common prefix
+    TEST_ASSERT_EQ(simd::memCmp3way("abc",2,"abc",3),std::strong_ordering::less);
+    TEST_ASSERT_EQ(simd::memCmp3way("abd",3,"abc",2),
+        std::strong_ordering::greater);
+    TEST_ASSERT_FALSE(simd::memCmpEq("abc",2,"abc",3));
+    TEST_ASSERT_TRUE(simd::memCmpEq<char>(nullptr,0,"",0));
+    const int w1[] = {1,-2,3};
+    const int w2[] = {1,-2,4};
+    TEST_ASSERT_EQ(simd::memMismatch(w1,w2,3),2);
+    TEST_ASSERT_EQ(simd::memCmp3way(w1,3,w2,3),std::strong_ordering::less);
+}
+
+TEST_CASE_CREATE(testMemFind)
+{
+    std::mt19937 rng(4);
+    std::vector<char> hay(500);
+    std::vector<char> needle(20);
+    for (int trial = 0; trial < 20000; ++trial)
+    {
+        // small alphabet so partial matches are common
+        const usize_t n = rng() % 500;
+        const usize_t m = rng() % 20;
+        const char *alpha = "ab\0\xff";
+        const usize_t needleAlpha = trial % 7 ? 2 : 4;
+        for (usize_t i = 0; i < n; ++i)
+            hay[i] = alpha[rng() % 4];
+        for (usize_t i = 0; i < m; ++i)
+            needle[i] = alpha[rng() % needleAlpha];
+        // sometimes copy the needle from near the end
+        if (m <= n && rng() % 2)
+            for (usize_t i = 0; i < m; ++i)
+                needle[i] = hay[n - m + i];
+        usize_t expected = static_cast<usize_t>(-1);
+        for (usize_t i = 0; i + m <= n; ++i)
+            if (!__builtin_memcmp(hay.data()+i,needle.data(),m))
+            {
+                expected = i;
+                break;
+            }
+        for (simd::SimdLevel level : LEVELS)
+            TEST_ASSERT_EQ(simd::memFind(hay.data(),n,needle.data(),m,level),
+                expected);
+        TEST_ASSERT_EQ(simd::memFind(hay.data(),n,needle.data(),m),expected);
+    }
+    TEST_ASSERT_EQ(simd::memFind("abc",3,"",0),0);
+    TEST_ASSERT_EQ(simd::memFind<char>(nullptr,0,nullptr,0),0);
+    TEST_ASSERT_EQ(simd::memFind("abc",3,"abcd",4),
+        static_cast<usize_t>(-1));
+    const int w[] = {1,2,3,2,3,4};
+    const int x[] = {3,4};
+    TEST_ASSERT_EQ(simd::memFind(w,6,x,2),4);
+    TEST_ASSERT_EQ(simd::memFind(w,6,x,1),2);
+}
+
+TEST_CASE_CREATE(testMemChr)
+{
+    std::mt19937 rng(7);
+    std::vector<char> buf(64 + 300);
+    for (int trial = 0; trial < 5000; ++trial)
+    {
+        const usize_t n = rng() % 300;
+        char *hay = buf.data() + rng() % 64;
+        for (usize_t i = 0; i < n; ++i)
+            hay[i] = static_cast<char>(rng() % 64 ? 'a' : 0x80 + rng() % 2);
+        const char c = static_cast<char>(0x80 + rng() % 2);
+        const usize_t expected = simd::_detail::_memChrScalar(hay,n,c);
+        for (simd::SimdLevel level : LEVELS)
+            TEST_ASSERT_EQ(simd::memChr(hay,n,c,level),expected);
+        TEST_ASSERT_EQ(simd::memChr(hay,n,c),expected);
+    }
+    const int w[] = {4,0,-1,0};
+    TEST_ASSERT_EQ(simd::memChr(w,4,0),1);
+    TEST_ASSERT_EQ(simd::memChr(w,4,5),4);
+}
+
+TEST_CASE_CREATE(testMemFindAny)
+{
+    std::mt19937 rng(6);
+    std::vector<unsigned char> buf(400);
+    for (int trial = 0; trial < 5000; ++trial)
+    {
+        // random sets including high bytes and null
+        simd::ByteSet set;
+        for (int i = 0, k = 1 + rng() % 6; i < k; ++i)
+            set.add(static_cast<unsigned char>(rng()));
+        const usize_t n = rng() % 400;
+        for (usize_t i = 0; i < n; ++i)
+            buf[i] = static_cast<unsigned char>(rng());
+        usize_t expected = n;
+        for (usize_t i = 0; i < n; ++i)
+            if (set.contains(buf[i]))
+            {
+                expected = i;
+                break;
+            }
+        for (simd::SimdLevel level : LEVELS)
+            TEST_ASSERT_EQ(simd::memFindAny(buf.data(),n,set,level),expected);
+        TEST_ASSERT_EQ(simd::memFindAny(buf.data(),n,set),expected);
+    }
+    const simd::ByteSet ws = simd::ByteSet::whitespace();
+    TEST_ASSERT_TRUE(ws.contains('\t'));
+    TEST_ASSERT_FALSE(ws.contains('x'));
+    TEST_ASSERT_FALSE(ws.contains(0));
+    const char *text = "abcdefghijklmnopqrstuvwxyz0123456789 ABC";
+    TEST_ASSERT_EQ(simd::memFindAny(text,40,ws),36);
+    TEST_ASSERT_EQ(simd::memFindAny(text,36,ws),36);
+    TEST_ASSERT_EQ(simd::memFindAny(text,40,simd::ByteSet("CB",2)),38);
+}
+
+TEST_CASE_CREATE(testStrCopy)
+{
+    char dst[100];
+    for (char &c : dst)
+        c = '#';
+    TEST_ASSERT_EQ(simd::strCopy("Aris",dst),4);
+    TEST_ASSERT_TRUE(tkoz::stl::CString<char>::ptrCmpEq(dst,"Aris"));
+    TEST_ASSERT_EQ(dst[5],'#');
+    TEST_ASSERT_EQ(simd::strCopy("",dst),0);
+    TEST_ASSERT_EQ(dst[0],'\0');
+    TEST_ASSERT_EQ(dst[1],'r');
+}
+
+TEST_CASE_CREATE(testNonByteChars)
+{
+    const int s1[] = {5,-3,7,0};
+    const int s2[] = {5,-3,8,0};
+    TEST_ASSERT_EQ(simd::strLen(s1),3);
+    TEST_ASSERT_EQ(simd::strLen(s1,simd::cSimdAvx512),3);
+    TEST_ASSERT_EQ(simd::strMismatch(s1,s2),2);
+    TEST_ASSERT_EQ(simd::strCmp3way(s1,s2),std::strong_ordering::less);
+    TEST_ASSERT_TRUE(simd::strCmpEq(s1,s1));
+    const wchar_t *w = L"wide string";
+    TEST_ASSERT_EQ(simd::strLen(w),11);
+    TEST_ASSERT_EQ(simd::strMismatch(w,L"wide strong"),8);
+    wchar_t wdst[20];
+    TEST_ASSERT_EQ(simd::strCopy(w,wdst),11);
+    TEST_ASSERT_TRUE(simd::strCmpEq(w,static_cast<const wchar_t*>(wdst)));
+}
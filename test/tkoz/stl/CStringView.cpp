@@ -0,0 +1,149 @@
+///
+/// unit tests for tkoz::stl::CStringView (non owning string with length)
+///
+
+#include <tkoz/Test.hpp>
+
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/CStringBuilder.hpp>
+#include <tkoz/stl/CStringView.hpp>
+#include <tkoz/stl/Exceptions.hpp>
+#include <tkoz/stl/SmallCString.hpp>
+
+#include <compare>
+
+// instantiate template for accurate code coverage report
+template class tkoz::stl::CStringView<char>;
+template class tkoz::stl::CStringView<wchar_t>;
+template class tkoz::stl::CStringView<int>;
+
+using View = tkoz::stl::CStringView<char>;
+using WView = tkoz::stl::CStringView<wchar_t>;
+using CString = tkoz::stl::CString<char>;
+using tkoz::stl::usize_t;
+using IE = tkoz::stl::IndexError;
+
+static_assert(sizeof(View) == 2 * sizeof(void*));
+
+TEST_RUNNER_MAIN
+
+TEST_CASE_CREATE(testCtor)
+{
+    View v1;
+    TEST_ASSERT_TRUE(v1.isNull());
+    TEST_ASSERT_TRUE(v1.empty());
+    TEST_ASSERT_EQ(v1.len(),0);
+    View v2("Barcelona");
+    TEST_ASSERT_EQ(v2.len(),9);
+    TEST_ASSERT_FALSE(v2.isNull());
+    TEST_ASSERT_TRUE(static_cast<bool>(v2));
+    View v3("Barcelona",3);
+    TEST_ASSERT_EQ(v3.len(),3);
+    TEST_ASSERT_EQ(v3,"Bar");
+    const CString s("Shanghai");
+    View v4(s);
+    TEST_ASSERT_EQ(v4.ptr(),s.ptr());
+    TEST_ASSERT_EQ(v4.len(),8);
+    const tkoz::stl::SmallCString<char> small("Istanbul");
+    View v5 = small;
+    TEST_ASSERT_EQ(v5.ptr(),small.ptr());
+    TEST_ASSERT_EQ(v5,"Istanbul");
+    tkoz::stl::CStringBuilder<char> b("Magny");
+    b += "-Cours";
+    TEST_ASSERT_EQ(View(b),"Magny-Cours");
+    View v6(static_cast<const char*>(nullptr));
+    TEST_ASSERT_TRUE(v6.isNull());
+    // null view is equal to the empty view
+    TEST_ASSERT_EQ(v6,"");
+}
+
+TEST_CASE_CREATE(testAccess)
+{
+    View v("Llano");
+    TEST_ASSERT_EQ(v[0],'L');
+    TEST_ASSERT_EQ(v.at(4),'o');
+    TEST_EXCEPTION(v.at(5),IE);
+    usize_t count = 0;
+    for (char c : v)
+        count += c == 'l' || c == 'L';
+    TEST_ASSERT_EQ(count,2);
+    TEST_ASSERT_EQ(v.end() - v.begin(),5);
+}
+
+TEST_CASE_CREATE(testSubstr)
+{
+    const char *text = "Bulldozer Piledriver Steamroller";
+    View v(text);
+    View s1 = v.substr(10,10);
+    TEST_ASSERT_EQ(s1,"Piledriver");
+    TEST_ASSERT_EQ(s1.ptr(),text+10);
+    TEST_ASSERT_EQ(v.substr(21),"Steamroller");
+    TEST_ASSERT_EQ(v.substr(32),"");
+    TEST_EXCEPTION(v.substr(33),IE);
+    TEST_ASSERT_EQ(v.prefix(9),"Bulldozer");
+    TEST_ASSERT_EQ(v.prefix(100),v);
+    TEST_ASSERT_EQ(v.suffix(6),"roller");
+    TEST_ASSERT_EQ(v.suffix(100),v);
+    View w = v;
+    w.removePrefix(10);
+    w.removeSuffix(12);
+    TEST_ASSERT_EQ(w,"Piledriver");
+    TEST_ASSERT_TRUE(v.startsWith("Bull"));
+    TEST_ASSERT_TRUE(v.startsWith(""));
+    TEST_ASSERT_FALSE(v.startsWith("Pile"));
+    TEST_ASSERT_TRUE(v.endsWith("roller"));
+    TEST_ASSERT_FALSE(w.endsWith("Steamroller"));
+    // substrings convert to null-terminated copies
+    CString c = s1.toCString();
+    TEST_ASSERT_EQ(c,"Piledriver");
+    TEST_ASSERT_TRUE(View().toCString().isNull());
+    TEST_ASSERT_FALSE(View("",0).toCString().isNull());
+}
+
+TEST_CASE_CREATE(testFind)
+{
+    // heap storage: for a view over a literal, gcc -O1 reports the pointer
+    // past the end in find("",12) even though it is never formed
+    const CString s("abracadabra");
+    View v(s);
+    TEST_ASSERT_EQ(v.find('a'),0);
+    TEST_ASSERT_EQ(v.find('a',1),3);
+    TEST_ASSERT_EQ(v.find('z'),View::npos);
+    TEST_ASSERT_EQ(v.find('a',11),View::npos);
+    TEST_ASSERT_EQ(v.rfind('b'),8);
+    TEST_ASSERT_EQ(v.rfind('z'),View::npos);
+    TEST_ASSERT_EQ(v.find("abra"),0);
+    TEST_ASSERT_EQ(v.find("abra",1),7);
+    TEST_ASSERT_EQ(v.find("cad"),4);
+    TEST_ASSERT_EQ(v.find("abrax"),View::npos);
+    TEST_ASSERT_EQ(v.find(""),0);
+    TEST_ASSERT_EQ(v.find("",11),11);
+    TEST_ASSERT_EQ(v.find("",12),View::npos);
+    TEST_ASSERT_TRUE(v.contains("dab"));
+    TEST_ASSERT_FALSE(v.contains("bad"));
+    // a match must not extend past the view
+    TEST_ASSERT_EQ(v.prefix(10).find("bra",8),View::npos);
+    WView w(L"wide wide");
+    TEST_ASSERT_EQ(w.find(L'd'),2);
+    TEST_ASSERT_EQ(w.find(L"ide",3),6);
+}
+
+TEST_CASE_CREATE(testCompare)
+{
+    const CString s("Kaveri");
+    View v1(s);
+    TEST_ASSERT_TRUE(v1 == "Kaveri");
+    TEST_ASSERT_TRUE(v1 == s);
+    TEST_ASSERT_TRUE(v1 != "Kaver");
+    TEST_ASSERT_TRUE(v1 != View("Kaveri",5));
+    TEST_ASSERT_TRUE(View("Kaveri",5) < v1);
+    TEST_ASSERT_TRUE(View("Kaz") > v1);
+    // same ordering as CString (signed characters)
+    const char hi[] = {static_cast<char>(0x80),'\0'};
+    TEST_ASSERT_EQ(View(hi) <=> View("a"),CString(hi) <=> CString("a"));
+    TEST_ASSERT_EQ(View() <=> View(""),std::strong_ordering::equal);
+    const int i1[] = {1,2,3,0};
+    const int i2[] = {1,2,-3,0};
+    TEST_ASSERT_TRUE(tkoz::stl::CStringView<int>(i2)
+        < tkoz::stl::CStringView<int>(i1));
+}
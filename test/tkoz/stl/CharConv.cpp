@@ -0,0 +1,195 @@
+///
+/// unit tests for tkoz::stl number formatting and parsing
+///
+
+#include <tkoz/Test.hpp>
+
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/CStringBuilder.hpp>
+#include <tkoz/stl/CharConv.hpp>
+#include <tkoz/stl/Exceptions.hpp>
+#include <tkoz/stl/ExplicitPrimitives.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+
+namespace stl = tkoz::stl;
+using stl::usize_t;
+using CString = stl::CString<char>;
+
+// instantiate template for accurate code coverage report
+template char* stl::toChars(char*, stl::sint32_t) noexcept;
+template stl::ParseResult stl::fromChars(const char*, const char*,
+    stl::uint64_t&) noexcept;
+
+// format with std::to_chars for comparison
+template <typename NumberType>
+static std::string stdFormat(const NumberType value)
+{
+    char buf[64];
+    return std::string(buf,std::to_chars(buf,buf + 64,value).ptr);
+}
+
+// random values with every digit count
+template <typename IntType>
+static IntType randomInt(std::mt19937_64 &rng)
+{
+    const auto bits = rng() % (8 * sizeof(IntType)) + 1;
+    const stl::uint64_t mask = bits == 64 ? ~0ull : (1ull << bits) - 1;
+    return static_cast<IntType>(rng() & mask);
+}
+
+template <typename IntType>
+static void checkInts(std::mt19937_64 &rng)
+{
+    using Limits = std::numeric_limits<IntType>;
+    char buf[stl::cMaxNumberChars<IntType>];
+    for (int trial = 0; trial < 20000; ++trial)
+    {
+        const IntType value = trial == 0 ? Limits::min() : trial == 1
+            ? Limits::max() : trial == 2 ? IntType(0) : randomInt<IntType>(rng);
+        char *end = stl::toChars(buf,value);
+        const std::string expected = stdFormat(value);
+        TEST_ASSERT_EQ(std::string(buf,end),expected);
+        IntType parsed = IntType(1);
+        const stl::ParseResult r = stl::fromChars(buf,end,parsed);
+        TEST_ASSERT_EQ(r.status,stl::cParseOk);
+        TEST_ASSERT_TRUE(r.ptr == end);
+        TEST_ASSERT_EQ(parsed,value);
+        TEST_ASSERT_EQ(stl::numberToCString(value),expected.c_str());
+    }
+}
+
+TEST_RUNNER_MAIN
+
+TEST_CASE_CREATE(testIntegers)
+{
+    std::mt19937_64 rng(18);
+    checkInts<stl::uint8_t>(rng);
+    checkInts<stl::sint8_t>(rng);
+    checkInts<stl::uint16_t>(rng);
+    checkInts<stl::sint16_t>(rng);
+    checkInts<stl::uint32_t>(rng);
+    checkInts<stl::sint32_t>(rng);
+    checkInts<stl::uint64_t>(rng);
+    checkInts<stl::sint64_t>(rng);
+    checkInts<char>(rng);
+    checkInts<stl::ull_t>(rng);
+    for (usize_t i = 0; i < 20; ++i)
+    {
+        // digit count at each power of 10
+        const stl::uint64_t p = stl::_detail::_cPow10[i];
+        TEST_ASSERT_EQ(stl::_detail::_decimalLen(p),i + 1);
+        TEST_ASSERT_EQ(stl::_detail::_decimalLen(p - 1),i ? i : 1);
+    }
+    static_assert(stl::cMaxNumberChars<stl::sint64_t> == 20);
+    static_assert(stl::cMaxNumberChars<stl::uint64_t> == 21);
+}
+
+TEST_CASE_CREATE(testParseErrors)
+{
+    auto parse = [](const char *s, stl::sint32_t &v)
+    {
+        return stl::fromChars(s,s + std::strlen(s),v);
+    };
+    stl::sint32_t v = 7;
+    TEST_ASSERT_EQ(parse("",v).status,stl::cParseInvalid);
+    TEST_ASSERT_EQ(parse("-",v).status,stl::cParseInvalid);
+    TEST_ASSERT_EQ(parse("+5",v).status,stl::cParseInvalid);
+    TEST_ASSERT_EQ(parse(" 5",v).status,stl::cParseInvalid);
+    TEST_ASSERT_EQ(v,7);
+    const char *s = "2147483648,";
+    TEST_ASSERT_EQ(parse(s,v).status,stl::cParseOutOfRange);
+    TEST_ASSERT_TRUE(parse(s,v).ptr == s + 10);
+    TEST_ASSERT_EQ(parse("99999999999999999999999999",v).status,
+        stl::cParseOutOfRange);
+    TEST_ASSERT_TRUE(parse("-2147483648",v));
+    TEST_ASSERT_EQ(v,std::numeric_limits<stl::sint32_t>::min());
+    TEST_ASSERT_TRUE(parse("00000000000000000000000042x",v));
+    TEST_ASSERT_EQ(v,42);
+    TEST_ASSERT_TRUE(parse("1234567890123",v).status == stl::cParseOutOfRange);
+    TEST_ASSERT_TRUE(parse("12345678:",v));
+    TEST_ASSERT_EQ(v,12345678);
+    stl::uint32_t u;
+    TEST_ASSERT_EQ(stl::fromChars(s,s + 1,u).status,stl::cParseOk);
+    const char *neg = "-1";
+    TEST_ASSERT_EQ(stl::fromChars(neg,neg + 2,u).status,stl::cParseInvalid);
+    stl::uint64_t big;
+    const char *max = "18446744073709551615";
+    TEST_ASSERT_TRUE(stl::fromChars(max,max + 20,big));
+    TEST_ASSERT_EQ(big,~0ull);
+    const char *over = "18446744073709551616";
+    TEST_ASSERT_EQ(stl::fromChars(over,over + 20,big).status,
+        stl::cParseOutOfRange);
+    TEST_ASSERT_EQ(stl::parseNumber<int>("-123"),-123);
+    TEST_EXCEPTION(stl::parseNumber<int>("12a"),stl::FormatError);
+    TEST_EXCEPTION(stl::parseNumber<int>(""),stl::FormatError);
+    TEST_EXCEPTION(stl::parseNumber<stl::uint8_t>("256"),stl::OverflowError);
+    TEST_EXCEPTION(stl::parseNumber<double>("1e999"),stl::OverflowError);
+}
+
+TEST_CASE_CREATE(testFloats)
+{
+    std::mt19937_64 rng(1818);
+    char buf[stl::cMaxNumberChars<double>];
+    for (int trial = 0; trial < 20000; ++trial)
+    {
+        // random bit patterns cover subnormals, infinities and NaN
+        const double d = std::bit_cast<double>(rng());
+        char *end = stl::toChars(buf,d);
+        TEST_ASSERT_EQ(std::string(buf,end),stdFormat(d));
+        double parsed;
+        TEST_ASSERT_TRUE(stl::fromChars(buf,end,parsed));
+        TEST_ASSERT_TRUE(d != d ? parsed != parsed : parsed == d);
+        const float f = std::bit_cast<float>(static_cast<stl::uint32_t>(rng()));
+        char fbuf[stl::cMaxNumberChars<float>];
+        end = stl::toChars(fbuf,f);
+        TEST_ASSERT_EQ(std::string(fbuf,end),stdFormat(f));
+    }
+    TEST_ASSERT_EQ(stl::numberToCString(0.1),"0.1");
+    TEST_ASSERT_EQ(stl::numberToCString(-1e300),"-1e+300");
+    TEST_ASSERT_EQ(stl::numberToCString(
+        std::numeric_limits<double>::denorm_min()),"5e-324");
+    TEST_ASSERT_EQ(stl::numberToCString(1.5f),"1.5");
+    TEST_ASSERT_EQ(stl::parseNumber<double>("2.5e-3"),0.0025);
+    const long double ld = 1.0L / 3;
+    TEST_ASSERT_EQ(stl::parseNumber<long double>(
+        stl::numberToCString(ld)),ld);
+}
+
+TEST_CASE_CREATE(testExplicitPrimitives)
+{
+    const stl::wrapper::ExplicitSInt i(-42);
+    char buf[16];
+    TEST_ASSERT_EQ(std::string(buf,stl::toChars(buf,i)),"-42");
+    TEST_ASSERT_EQ(stl::numberToCString(i),"-42");
+    const stl::wrapper::ExplicitDouble d(0.25);
+    TEST_ASSERT_EQ(stl::numberToCString(d),"0.25");
+    stl::wrapper::ExplicitULong u;
+    const char *s = "123456789012";
+    TEST_ASSERT_TRUE(stl::fromChars(s,s + 12,u));
+    TEST_ASSERT_EQ(u.value(),123456789012ul);
+    TEST_ASSERT_EQ(stl::parseNumber<stl::wrapper::ExplicitUShort>("65535")
+        .value(),65535);
+    TEST_EXCEPTION(stl::parseNumber<stl::wrapper::ExplicitUShort>("65536"),
+        stl::OverflowError);
+}
+
+TEST_CASE_CREATE(testBuilder)
+{
+    stl::CStringBuilder<char> builder;
+    stl::appendNumber(builder,-7);
+    builder += ',';
+    stl::appendNumber(builder,18446744073709551615ull);
+    builder += ',';
+    stl::appendNumber(builder,0.5);
+    builder += ',';
+    stl::appendNumber(builder,stl::wrapper::ExplicitUChar(200));
+    const CString s = builder.build();
+    TEST_ASSERT_EQ(s,"-7,18446744073709551615,0.5,200");
+}
@@ -0,0 +1,177 @@
+///
+/// unit tests for tkoz::stl::CompactMap
+///
+
+#include <tkoz/Test.hpp>
+
+#include <tkoz/stl/Allocator.hpp>
+#include <tkoz/stl/CompactMap.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace stl = tkoz::stl;
+using stl::usize_t;
+using stl::uint64_t;
+using Map = stl::CompactMap<uint64_t,uint64_t>;
+
+// instantiate template for accurate code coverage report
+template class stl::CompactMap<uint64_t,uint64_t>;
+template class stl::CompactMap<int,std::string,std::greater<int>>;
+
+// 16 byte entry and 13 bytes of links and height
+static_assert(Map::cNodeSize == 32);
+static_assert(stl::CompactMap<uint32_t,uint32_t>::cNodeSize == 24);
+
+// const access only gives const entries
+static_assert(std::is_same_v<decltype(std::declval<const Map&>().front()),
+    const Map::EntryType*>);
+static_assert(std::is_same_v<decltype(std::declval<const Map&>().back()),
+    const Map::EntryType*>);
+static_assert(std::is_same_v<
+    decltype(std::declval<const Map&>().lowerBound(1)),
+    const Map::EntryType*>);
+static_assert(std::is_same_v<decltype(std::declval<Map&>().lowerBound(1)),
+    Map::EntryType*>);
+
+TEST_RUNNER_MAIN
+
+TEST_CASE_CREATE(testBasic)
+{
+    Map m;
+    TEST_ASSERT_TRUE(m.empty());
+    TEST_ASSERT_TRUE(m.pool() == nullptr);
+    TEST_ASSERT_TRUE(m.find(1) == nullptr);
+    TEST_ASSERT_TRUE(m.front() == nullptr && m.back() == nullptr);
+    TEST_ASSERT_TRUE(m.insert(5,50));
+    TEST_ASSERT_FALSE(m.insert(5,51));
+    TEST_ASSERT_TRUE(m.insert(3,30));
+    TEST_ASSERT_TRUE(m.insert(9,90));
+    TEST_ASSERT_EQ(m.size(),3);
+    TEST_ASSERT_EQ(m.find(5)->value,50);
+    TEST_ASSERT_TRUE(m.contains(9));
+    TEST_ASSERT_FALSE(m.contains(4));
+    TEST_ASSERT_EQ(m.lowerBound(4)->key,5);
+    TEST_ASSERT_EQ(m.lowerBound(5)->key,5);
+    TEST_ASSERT_TRUE(m.lowerBound(10) == nullptr);
+    TEST_ASSERT_EQ(m.front()->key,3);
+    TEST_ASSERT_EQ(m.back()->key,9);
+    m[4] += 7;
+    TEST_ASSERT_EQ(m.find(4)->value,7);
+    m[4] += 7;
+    TEST_ASSERT_EQ(m[4],14);
+    TEST_ASSERT_EQ(m.size(),4);
+    std::vector<uint64_t> keys;
+    m.forEach([&](Map::EntryType &e) { keys.push_back(e.key); });
+    TEST_ASSERT_TRUE(keys == (std::vector<uint64_t>{3,4,5,9}));
+    const Map &c = m;
+    usize_t sum = 0;
+    c.forEach([&](auto &e)
+    {
+        static_assert(std::is_const_v<std::remove_reference_t<decltype(e)>>);
+        sum += e.value;
+    });
+    TEST_ASSERT_EQ(sum,30 + 14 + 50 + 90);
+    TEST_ASSERT_EQ(c.front()->key,3);
+    TEST_ASSERT_EQ(c.back()->key,9);
+    TEST_ASSERT_EQ(c.lowerBound(6)->key,9);
+    TEST_ASSERT_TRUE(m.erase(5));
+    TEST_ASSERT_FALSE(m.erase(5));
+    TEST_ASSERT_EQ(m.size(),3);
+    TEST_ASSERT_TRUE(m.find(5) == nullptr);
+    Map n = std::move(m);
+    TEST_ASSERT_TRUE(m.empty());
+    TEST_ASSERT_EQ(n.size(),3);
+    TEST_ASSERT_EQ(n.find(9)->value,90);
+    m.insert(1,1);
+    n = std::move(m);
+    TEST_ASSERT_EQ(n.size(),1);
+    n.clear();
+    TEST_ASSERT_TRUE(n.empty());
+    TEST_ASSERT_TRUE(n.insert(2,2));
+    TEST_ASSERT_EQ(n.height(),1);
+}
+
+TEST_CASE_CREATE(testRandom)
+{
+    // compare with std::map under random inserts and erases
+    std::mt19937_64 rng(25);
+    Map m;
+    std::map<uint64_t,uint64_t> ref;
+    for (usize_t i = 0; i < 20000; ++i)
+    {
+        const uint64_t key = rng() % 4096;
+        switch (rng() % 3)
+        {
+        case 0:
+            TEST_ASSERT_EQ(m.insert(key,i),ref.emplace(key,i).second);
+            break;
+        case 1:
+            TEST_ASSERT_EQ(m.erase(key),ref.erase(key) == 1);
+            break;
+        default:
+        {
+            const Map::EntryType *e = std::as_const(m).find(key);
+            auto it = ref.find(key);
+            TEST_ASSERT_EQ(e != nullptr,it != ref.end());
+            if (e)
+                TEST_ASSERT_EQ(e->value,it->second);
+            Map::EntryType *lb = m.lowerBound(key);
+            auto refLb = ref.lower_bound(key);
+            TEST_ASSERT_EQ(lb != nullptr,refLb != ref.end());
+            if (lb)
+                TEST_ASSERT_EQ(lb->key,refLb->first);
+        }
+        }
+        TEST_ASSERT_EQ(m.size(),ref.size());
+    }
+    auto it = ref.begin();
+    usize_t bad = 0;
+    m.forEach([&](const Map::EntryType &e)
+    {
+        bad += e.key != it->first || e.value != it->second;
+        ++it;
+    });
+    TEST_ASSERT_EQ(bad,0);
+    TEST_ASSERT_TRUE(it == ref.end());
+    // AVL height bound
+    TEST_ASSERT_LE(m.height(),18);
+    // sorted insertion stays balanced
+    Map s;
+    for (uint64_t k = 0; k < (1u << 16) - 1; ++k)
+        s.insert(k,k);
+    TEST_ASSERT_EQ(s.height(),16);
+    TEST_ASSERT_EQ(s.pool()->bytesInUse(),s.size() * 32);
+}
+
+TEST_CASE_CREATE(testSharedPool)
+{
+    // values with destructors and a reversed order
+    stl::Pool pool;
+    {
+        stl::CompactMap<int,std::string,std::greater<int>> a(pool);
+        stl::CompactMap<int,std::string,std::greater<int>> b(pool);
+        for (int i = 0; i < 100; ++i)
+        {
+            a[i] = std::string(40,static_cast<char>('a' + i % 26));
+            b.insert(i,"short");
+        }
+        TEST_ASSERT_EQ(a.front()->key,99);
+        TEST_ASSERT_EQ(a.back()->key,0);
+        TEST_ASSERT_EQ(a.lowerBound(50)->key,50);
+        TEST_ASSERT_EQ(a.find(27)->value,std::string(40,'b'));
+        TEST_ASSERT_TRUE(a.pool() == &pool);
+        for (int i = 0; i < 100; i += 2)
+            TEST_ASSERT_TRUE(b.erase(i));
+        TEST_ASSERT_EQ(b.size(),50);
+        b.clear();
+        TEST_ASSERT_GT(pool.bytesInUse(),0);
+    }
+    TEST_ASSERT_EQ(pool.bytesInUse(),0);
+}
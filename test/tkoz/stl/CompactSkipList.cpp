@@ -0,0 +1,179 @@
+///
+/// unit tests for tkoz::stl::CompactSkipList
+///
+
+#include <tkoz/Test.hpp>
+
+#include <tkoz/stl/Allocator.hpp>
+#include <tkoz/stl/CompactSkipList.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace stl = tkoz::stl;
+using stl::usize_t;
+using stl::uint64_t;
+using List = stl::CompactSkipList<uint64_t,uint64_t>;
+
+// instantiate template for accurate code coverage report
+template class stl::CompactSkipList<uint64_t,uint64_t>;
+template class stl::CompactSkipList<int,std::string,std::greater<int>>;
+
+// const access only gives const entries
+static_assert(std::is_same_v<decltype(std::declval<const List&>().front()),
+    const List::EntryType*>);
+static_assert(std::is_same_v<decltype(std::declval<const List&>().back()),
+    const List::EntryType*>);
+static_assert(std::is_same_v<
+    decltype(std::declval<const List&>().lowerBound(1)),
+    const List::EntryType*>);
+static_assert(std::is_same_v<decltype(std::declval<List&>().lowerBound(1)),
+    List::EntryType*>);
+
+TEST_RUNNER_MAIN
+
+TEST_CASE_CREATE(testBasic)
+{
+    List l;
+    TEST_ASSERT_TRUE(l.empty());
+    TEST_ASSERT_EQ(l.height(),0);
+    TEST_ASSERT_TRUE(l.pool() == nullptr);
+    TEST_ASSERT_TRUE(l.find(1) == nullptr);
+    TEST_ASSERT_TRUE(l.lowerBound(1) == nullptr);
+    TEST_ASSERT_TRUE(l.front() == nullptr && l.back() == nullptr);
+    TEST_ASSERT_FALSE(l.erase(1));
+    TEST_ASSERT_TRUE(l.insert(5,50));
+    TEST_ASSERT_FALSE(l.insert(5,51));
+    TEST_ASSERT_TRUE(l.insert(3,30));
+    TEST_ASSERT_TRUE(l.insert(9,90));
+    TEST_ASSERT_EQ(l.size(),3);
+    TEST_ASSERT_GE(l.height(),1);
+    TEST_ASSERT_EQ(l.find(5)->value,50);
+    TEST_ASSERT_TRUE(l.contains(9));
+    TEST_ASSERT_FALSE(l.contains(4));
+    TEST_ASSERT_EQ(l.lowerBound(4)->key,5);
+    TEST_ASSERT_EQ(l.lowerBound(5)->key,5);
+    TEST_ASSERT_TRUE(l.lowerBound(10) == nullptr);
+    TEST_ASSERT_EQ(l.front()->key,3);
+    TEST_ASSERT_EQ(l.back()->key,9);
+    l[4] += 7;
+    l[4] += 7;
+    TEST_ASSERT_EQ(std::as_const(l).find(4)->value,14);
+    TEST_ASSERT_EQ(l.size(),4);
+    std::vector<uint64_t> keys;
+    l.forEach([&](List::EntryType &e) { keys.push_back(e.key); });
+    TEST_ASSERT_TRUE(keys == (std::vector<uint64_t>{3,4,5,9}));
+    const List &c = l;
+    usize_t sum = 0;
+    c.forEach([&](auto &e)
+    {
+        static_assert(std::is_const_v<std::remove_reference_t<decltype(e)>>);
+        sum += e.value;
+    });
+    TEST_ASSERT_EQ(sum,30 + 14 + 50 + 90);
+    TEST_ASSERT_EQ(c.front()->key,3);
+    TEST_ASSERT_EQ(c.back()->key,9);
+    TEST_ASSERT_EQ(c.lowerBound(6)->key,9);
+    TEST_ASSERT_TRUE(l.erase(5));
+    TEST_ASSERT_FALSE(l.erase(5));
+    TEST_ASSERT_TRUE(l.find(5) == nullptr);
+    List m = std::move(l);
+    TEST_ASSERT_TRUE(l.empty());
+    TEST_ASSERT_TRUE(l.front() == nullptr);
+    TEST_ASSERT_EQ(m.size(),3);
+    TEST_ASSERT_EQ(m.find(9)->value,90);
+    l.insert(1,1);
+    m = std::move(l);
+    TEST_ASSERT_EQ(m.size(),1);
+    TEST_ASSERT_EQ(m.front()->key,1);
+    TEST_ASSERT_TRUE(m.erase(1));
+    TEST_ASSERT_EQ(m.height(),0);
+    m.insert(2,2);
+    m.clear();
+    TEST_ASSERT_TRUE(m.empty());
+    TEST_ASSERT_TRUE(m.front() == nullptr);
+}
+
+TEST_CASE_CREATE(testRandom)
+{
+    // compare with std::map under random inserts and erases
+    std::mt19937_64 rng(25);
+    List l;
+    std::map<uint64_t,uint64_t> ref;
+    for (usize_t i = 0; i < 20000; ++i)
+    {
+        const uint64_t key = rng() % 4096;
+        switch (rng() % 3)
+        {
+        case 0:
+            TEST_ASSERT_EQ(l.insert(key,i),ref.emplace(key,i).second);
+            break;
+        case 1:
+            TEST_ASSERT_EQ(l.erase(key),ref.erase(key) == 1);
+            break;
+        default:
+        {
+            const List::EntryType *e = l.find(key);
+            auto it = ref.find(key);
+            TEST_ASSERT_EQ(e != nullptr,it != ref.end());
+            if (e)
+                TEST_ASSERT_EQ(e->value,it->second);
+            List::EntryType *lb = l.lowerBound(key);
+            auto refLb = ref.lower_bound(key);
+            TEST_ASSERT_EQ(lb != nullptr,refLb != ref.end());
+            if (lb)
+                TEST_ASSERT_EQ(lb->key,refLb->first);
+        }
+        }
+        TEST_ASSERT_EQ(l.size(),ref.size());
+    }
+    auto it = ref.begin();
+    usize_t bad = 0;
+    l.forEach([&](const List::EntryType &e)
+    {
+        bad += e.key != it->first || e.value != it->second;
+        ++it;
+    });
+    TEST_ASSERT_EQ(bad,0);
+    TEST_ASSERT_TRUE(it == ref.end());
+    TEST_ASSERT_EQ(l.back()->key,ref.rbegin()->first);
+    // about 4^height entries
+    TEST_ASSERT_LE(l.height(),12);
+    // most nodes use the 32 byte size class
+    List s;
+    for (uint64_t k = 0; k < 10000; ++k)
+        s.insert(k,k);
+    TEST_ASSERT_LT(s.pool()->bytesInUse(),s.size() * 38);
+}
+
+TEST_CASE_CREATE(testSharedPool)
+{
+    // values with destructors and a reversed order
+    stl::Pool pool;
+    {
+        stl::CompactSkipList<int,std::string,std::greater<int>> a(pool);
+        stl::CompactSkipList<int,std::string,std::greater<int>> b(pool);
+        for (int i = 0; i < 100; ++i)
+        {
+            a[i] = std::string(40,static_cast<char>('a' + i % 26));
+            b.insert(i,"short");
+        }
+        TEST_ASSERT_EQ(a.front()->key,99);
+        TEST_ASSERT_EQ(a.back()->key,0);
+        TEST_ASSERT_EQ(a.lowerBound(50)->key,50);
+        TEST_ASSERT_EQ(a.find(27)->value,std::string(40,'b'));
+        TEST_ASSERT_TRUE(a.pool() == &pool);
+        for (int i = 0; i < 100; i += 2)
+            TEST_ASSERT_TRUE(b.erase(i));
+        TEST_ASSERT_EQ(b.size(),50);
+        b.clear();
+        TEST_ASSERT_GT(pool.bytesInUse(),0);
+    }
+    TEST_ASSERT_EQ(pool.bytesInUse(),0);
+}
@@ -0,0 +1,159 @@
+///
+/// unit tests for tkoz::stl::CompressedPointer and RegionArena
+///
+
+#include <tkoz/Test.hpp>
+
+#include <tkoz/stl/CompressedPointer.hpp>
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <compare>
+#include <new>
+#include <utility>
+
+namespace stl = tkoz::stl;
+using stl::usize_t;
+using stl::uint64_t;
+
+// independent bases for each test
+struct TagA;
+struct TagB;
+
+template <typename T, usize_t bits>
+using CP = stl::CompressedPointer<T,bits,TagA>;
+using P32 = CP<int,32>;
+using P40 = CP<int,40>;
+using P48 = CP<int,48>;
+
+// instantiate template for accurate code coverage report
+template class stl::CompressedPointer<int,32,TagA>;
+template class stl::CompressedPointer<int,40,TagA>;
+template class stl::CompressedPointer<int,48,TagA>;
+template class stl::RegionAllocator<char>;
+
+// no padding in arrays
+static_assert(sizeof(CP<int,32>) == 4 && alignof(CP<int,32>) == 4);
+static_assert(sizeof(CP<int,40>) == 5 && alignof(CP<int,40>) == 1);
+static_assert(sizeof(CP<int,48>) == 6 && alignof(CP<int,48>) == 2);
+static_assert(sizeof(CP<void,40>[3]) == 15);
+
+// graph node with 4 byte links
+struct Node
+{
+    int value;
+    stl::CompressedPointer<Node,32,TagB> next;
+};
+
+static_assert(sizeof(Node) == 8);
+
+TEST_RUNNER_MAIN
+
+TEST_CASE_CREATE(testRegionArena)
+{
+    stl::RegionArena arena(1ull << 32);
+    TEST_ASSERT_EQ(arena.capacity(),1ull << 32);
+    void *p1 = arena.allocate(10,1);
+    TEST_ASSERT_TRUE(arena.contains(p1));
+    TEST_ASSERT_TRUE(p1 != arena.base());
+    int *p2 = static_cast<int*>(arena.allocate(sizeof(int),alignof(int)));
+    TEST_ASSERT_EQ(reinterpret_cast<stl::uintptr_t>(p2) % alignof(int),0);
+    *p2 = 5;
+    TEST_ASSERT_EQ(arena.bytesUsed(),10 + sizeof(int));
+    TEST_ASSERT_FALSE(arena.contains(&arena));
+    arena.reset();
+    TEST_ASSERT_EQ(arena.bytesUsed(),0);
+    TEST_ASSERT_TRUE(arena.allocate(1,1) == p1);
+    TEST_EXCEPTION((void)arena.allocate(1ull << 32),std::bad_alloc);
+    // memory is given back and reads as zero
+    arena.reset();
+    (void)arena.allocate(10,1);
+    int *p3 = static_cast<int*>(arena.allocate(sizeof(int),alignof(int)));
+    TEST_ASSERT_TRUE(p3 == p2);
+    TEST_ASSERT_EQ(*p3,0);
+    stl::RegionArena moved = std::move(arena);
+    TEST_ASSERT_TRUE(moved.contains(p3));
+    TEST_ASSERT_FALSE(arena.contains(p3));
+    TEST_EXCEPTION((void)arena.allocate(1),std::bad_alloc);
+    stl::RegionArena small(4096);
+    TEST_EXCEPTION((void)small.allocate(4096),std::bad_alloc);
+    stl::RegionAllocator<char> alloc(small);
+    char *s = alloc.allocate(6);
+    stl::CString<char>::ptrCopy("hello",s);
+    TEST_ASSERT_TRUE(small.contains(s + 5));
+    alloc.deallocate(s);
+    TEST_ASSERT_TRUE(alloc == stl::RegionAllocator<char>(small));
+}
+
+TEST_CASE_CREATE(testPointer)
+{
+    stl::RegionArena arena(1ull << 30);
+    stl::CompressedBase<TagA>::set(arena);
+    TEST_ASSERT_TRUE(stl::CompressedBase<TagA>::get() == arena.base());
+    int *x = static_cast<int*>(arena.allocate(sizeof(int) * 4,alignof(int)));
+    x[0] = 10;
+    x[3] = 13;
+    const P32 p32(x);
+    const P40 p40(x + 3);
+    const P48 p48(x);
+    TEST_ASSERT_TRUE(p32.ptr() == x);
+    TEST_ASSERT_EQ(*p32,10);
+    TEST_ASSERT_EQ(*p40,13);
+    TEST_ASSERT_TRUE(p48 == x);
+    TEST_ASSERT_EQ(p32.offset(),static_cast<uint64_t>(
+        reinterpret_cast<stl::uchar_t*>(x) - arena.base()));
+    TEST_ASSERT_TRUE(static_cast<bool>(p32));
+    // null
+    const P32 n;
+    TEST_ASSERT_FALSE(n);
+    TEST_ASSERT_TRUE(n.ptr() == nullptr);
+    TEST_ASSERT_TRUE(P40(nullptr).ptr() == nullptr);
+    TEST_ASSERT_EQ(P48(nullptr).offset(),0);
+    TEST_ASSERT_TRUE(n < p32);
+    TEST_ASSERT_TRUE((P32(x + 1) <=> p32)
+        == std::strong_ordering::greater);
+    TEST_ASSERT_TRUE(P32(x) == p32);
+    int *full = p32;
+    TEST_ASSERT_TRUE(full == x);
+    // every offset width round trips
+    for (uint64_t off : {1ull,0xFFFFFFFFull,0x12345678ull})
+        TEST_ASSERT_EQ(P32::fromOffset(off).offset(),off);
+    for (uint64_t off : {0x100000000ull,0xFFFFFFFFFFull,0xABCDEF0123ull})
+        TEST_ASSERT_EQ(P40::fromOffset(off).offset(),off);
+    for (uint64_t off : {0x10000000000ull,0xFFFFFFFFFFFFull})
+        TEST_ASSERT_EQ(P48::fromOffset(off).offset(),off);
+    TEST_ASSERT_TRUE(P40::fromOffset(0xABCDEF0123ull).ptr()
+        == reinterpret_cast<int*>(arena.base() + 0xABCDEF0123ull));
+    // range check
+    TEST_ASSERT_TRUE(P32::fits(x));
+    TEST_ASSERT_TRUE(P32::fits(nullptr));
+    TEST_ASSERT_FALSE(P32::fits(reinterpret_cast<int*>(arena.base())));
+    TEST_ASSERT_FALSE(P32::fits(reinterpret_cast<int*>(
+        arena.base() + (1ull << 32))));
+    TEST_ASSERT_TRUE(P40::fits(reinterpret_cast<int*>(
+        arena.base() + (1ull << 32))));
+}
+
+TEST_CASE_CREATE(testLinkedNodes)
+{
+    stl::RegionArena arena(1ull << 32);
+    stl::CompressedBase<TagB>::set(arena);
+    stl::RegionAllocator<Node> alloc(arena);
+    Node *head = nullptr;
+    for (int i = 0; i < 1000; ++i)
+    {
+        Node *node = alloc.allocate(1);
+        node->value = i;
+        node->next = head;
+        head = node;
+    }
+    int expected = 999;
+    long sum = 0;
+    for (Node *node = head; node; node = node->next)
+    {
+        TEST_ASSERT_EQ(node->value,expected--);
+        sum += node->value;
+    }
+    TEST_ASSERT_EQ(sum,999 * 1000 / 2);
+    TEST_ASSERT_EQ(arena.bytesUsed(),1000 * sizeof(Node));
+}
@@ -0,0 +1,181 @@
+///
+/// unit tests for tkoz::stl::FrontCodedDict
+///
+
+#include <tkoz/Test.hpp>
+
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/CStringView.hpp>
+#include <tkoz/stl/Exceptions.hpp>
+#include <tkoz/stl/FrontCodedDict.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+using Dict = tkoz::stl::FrontCodedDict<char>;
+using View = tkoz::stl::CStringView<char>;
+using CString = tkoz::stl::CString<char>;
+using tkoz::stl::usize_t;
+
+// instantiate template for accurate code coverage report
+template class tkoz::stl::FrontCodedDict<char>;
+template class tkoz::stl::FrontCodedDict<unsigned char,3>;
+
+static_assert(std::forward_iterator<Dict::Iterator>);
+
+// order of CString (std::string compares chars as unsigned)
+struct KeyLess
+{
+    bool operator()(const std::string &a, const std::string &b) const
+    {
+        return CString::ptrCmpLt(a.c_str(),b.c_str());
+    }
+};
+
+using Set = std::set<std::string,KeyLess>;
+
+// random strings with shared prefixes over all byte values
+static Set randomSet(std::mt19937 &rng, const usize_t n, const usize_t alpha)
+{
+    static const std::string prefixes[] = {"","a","com.example.",
+        std::string(200,'p'),"com.example.app."};
+    Set ret;
+    while (ret.size() < n)
+    {
+        std::string s = prefixes[rng() % 5];
+        for (usize_t i = 0, l = rng() % 10; i < l; ++i)
+            s.push_back(static_cast<char>(1 + rng() % alpha));
+        ret.insert(s);
+    }
+    return ret;
+}
+
+// check every operation against a std::set
+template <usize_t bucketSize>
+static void checkSet(const Set &set, std::mt19937 &rng, const usize_t alpha)
+{
+    std::vector<const char*> sorted;
+    for (const std::string &s : set)
+        sorted.push_back(s.c_str());
+    const tkoz::stl::FrontCodedDict<char,bucketSize> dict(sorted);
+    TEST_ASSERT_EQ(dict.size(),set.size());
+    usize_t rank = 0;
+    for (View s : dict)
+    {
+        TEST_ASSERT_EQ(s,sorted[rank]);
+        TEST_ASSERT_EQ(dict.find(s),rank);
+        TEST_ASSERT_EQ(dict.lowerBound(s),rank);
+        ++rank;
+    }
+    TEST_ASSERT_EQ(rank,set.size());
+    for (usize_t i = 0; i < set.size(); i += 7)
+        TEST_ASSERT_EQ(dict.at(i),sorted[i]);
+    for (int trial = 0; trial < 150; ++trial)
+    {
+        std::string key = *randomSet(rng,1,alpha).begin();
+        key.resize(key.size() * (rng() % 3) / 2);
+        // absent keys and their lower bounds
+        const auto it = set.lower_bound(key);
+        const usize_t expected = static_cast<usize_t>(
+            std::distance(set.begin(),it));
+        TEST_ASSERT_EQ(dict.lowerBound(key.c_str()),expected);
+        const bool present = it != set.end() && *it == key;
+        TEST_ASSERT_EQ(dict.find(key.c_str()),present ? expected : Dict::npos);
+        TEST_ASSERT_EQ(dict.contains(key.c_str()),present);
+        // prefix scans (not a contiguous std::set range, "a\xff" < "a")
+        std::vector<std::string> want;
+        for (const std::string &s : set)
+            if (s.starts_with(key))
+                want.push_back(s);
+        std::vector<std::string> got;
+        const auto range = dict.prefixScan(key.c_str());
+        for (auto i = range.begin(); i != range.end(); ++i)
+        {
+            got.emplace_back((*i).ptr(),(*i).len());
+            TEST_ASSERT_EQ(dict.at(i.rank()),(*i).ptr());
+        }
+        TEST_ASSERT_TRUE(got == want);
+        TEST_ASSERT_EQ(range.size(),want.size());
+    }
+}
+
+TEST_RUNNER_MAIN
+
+TEST_CASE_CREATE(testBasic)
+{
+    const Dict empty;
+    TEST_ASSERT_TRUE(empty.empty());
+    TEST_ASSERT_EQ(empty.find("a"),Dict::npos);
+    TEST_ASSERT_TRUE(empty.begin() == empty.end());
+    TEST_ASSERT_TRUE(empty.prefixScan("").empty());
+    TEST_EXCEPTION(empty.at(0),tkoz::stl::IndexError);
+    const std::vector<CString> words = {CString(""),CString("apple"),
+        CString("applesauce"),CString("apply"),CString("apply"),
+        CString("banana"),CString("band"),CString("bandana")};
+    const Dict dict(words);
+    TEST_ASSERT_EQ(dict.size(),7);
+    TEST_ASSERT_EQ(dict.maxLen(),10);
+    TEST_ASSERT_EQ(dict.find(""),0);
+    TEST_ASSERT_EQ(dict.find("apply"),3);
+    TEST_ASSERT_EQ(dict.find(CString("bandana")),6);
+    TEST_ASSERT_EQ(dict.find("appl"),Dict::npos);
+    TEST_ASSERT_EQ(dict.find("zebra"),Dict::npos);
+    TEST_ASSERT_EQ(dict.lowerBound("appl"),1);
+    TEST_ASSERT_EQ(dict.lowerBound("zebra"),7);
+    TEST_ASSERT_EQ(dict[2],"applesauce");
+    TEST_EXCEPTION(dict.at(7),tkoz::stl::IndexError);
+    const auto range = dict.prefixScan("band");
+    TEST_ASSERT_EQ(range.first(),5);
+    TEST_ASSERT_EQ(range.size(),2);
+    TEST_ASSERT_EQ(*range.begin(),"band");
+    TEST_ASSERT_EQ(std::distance(dict.prefixScan("ap").begin(),
+        dict.prefixScan("ap").end()),3);
+    TEST_ASSERT_TRUE(dict.prefixScan("c").empty());
+    TEST_ASSERT_EQ(*dict.iteratorAt(4),"banana");
+    TEST_ASSERT_TRUE(dict.iteratorAt(100) == dict.end());
+    // views are null-terminated in the iterator buffer
+    TEST_ASSERT_EQ((*dict.iteratorAt(5)).ptr()[4],'\0');
+    const char *unsorted[] = {"b","a"};
+    TEST_EXCEPTION(Dict{unsorted},tkoz::stl::ArgumentError);
+}
+
+TEST_CASE_CREATE(testRandom)
+{
+    std::mt19937 rng(14);
+    for (usize_t alpha : {2,26,255})
+    {
+        const Set set = randomSet(rng,3000,alpha);
+        checkSet<16>(set,rng,alpha);
+        checkSet<1>(set,rng,alpha);
+        checkSet<5>(set,rng,alpha);
+    }
+}
+
+TEST_CASE_CREATE(testMemory)
+{
+    // sorted paths sharing long prefixes
+    std::vector<std::string> paths;
+    for (usize_t i = 0; i < 20000; ++i)
+        paths.push_back("/usr/share/locale/" + std::to_string(i / 100)
+            + "/LC_MESSAGES/file" + std::to_string(i % 100) + ".mo");
+    std::sort(paths.begin(),paths.end());
+    usize_t chars = 0;
+    std::vector<View> views;
+    for (const std::string &s : paths)
+    {
+        views.emplace_back(s.c_str());
+        chars += s.size() + 1;
+    }
+    const Dict dict(views);
+    TEST_ASSERT_EQ(dict.size(),paths.size());
+    // CString objects need a pointer and a heap block each
+    const usize_t cstrings = chars + paths.size() * sizeof(CString);
+    TEST_ASSERT_LT(dict.memoryUsage() * 4,cstrings);
+    TEST_ASSERT_EQ(dict.find(views[12345]),12345);
+    TEST_ASSERT_EQ(dict.prefixScan("/usr/share/locale/42/").size(),100);
+}
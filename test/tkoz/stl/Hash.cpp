@@ -0,0 +1,203 @@
+///
+/// unit tests for tkoz::stl hashing (one shot, streaming, SIMD levels)
+///
+
+#include <tkoz/Test.hpp>
+
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/Hash.hpp>
+#include <tkoz/stl/Simd.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+namespace simd = tkoz::stl::simd;
+using tkoz::stl::Hasher;
+using tkoz::stl::hashBytes;
+using tkoz::stl::uchar_t;
+using tkoz::stl::uint64_t;
+using tkoz::stl::usize_t;
+using CString = tkoz::stl::CString<char>;
+
+// all levels to compare, unsupported ones are clamped to the processor
+static const simd::SimdLevel LEVELS[] =
+{
+    simd::cSimdScalar,
+    simd::cSimdSse2,
+    simd::cSimdAvx2,
+    simd::cSimdAvx512
+};
+
+static std::vector<uchar_t> randomBytes(std::mt19937 &rng, const usize_t n)
+{
+    std::vector<uchar_t> ret(n);
+    for (uchar_t &b : ret)
+        b = static_cast<uchar_t>(rng());
+    return ret;
+}
+
+TEST_RUNNER_MAIN
+
+// every length category gives the same result at every SIMD level
+TEST_CASE_CREATE(testLevels)
+{
+    std::mt19937 rng(7);
+    const std::vector<uchar_t> data = randomBytes(rng,3000);
+    for (usize_t len = 0; len <= 2100; len += len < 300 ? 1 : 37)
+    {
+        const uchar_t *p = data.data() + rng() % 64;
+        const uint64_t seed = rng() % 2 ? 0 : rng();
+        const uint64_t expected = hashBytes(p,len,seed,simd::cSimdScalar);
+        for (simd::SimdLevel level : LEVELS)
+            TEST_ASSERT_EQ(hashBytes(p,len,seed,level),expected);
+        TEST_ASSERT_EQ(hashBytes(p,len,seed),expected);
+    }
+}
+
+// known values so changes to the hash function are noticed
+TEST_CASE_CREATE(testStable)
+{
+    TEST_ASSERT_EQ(hashBytes("",0),hashBytes(nullptr,0));
+    TEST_ASSERT_NE(hashBytes("",0),hashBytes("",0,1));
+    TEST_ASSERT_EQ(tkoz::stl::hashCString("Zen"),hashBytes("Zen",3));
+    TEST_ASSERT_EQ(tkoz::stl::hashCString(static_cast<const char*>(nullptr)),
+        hashBytes("",0));
+    TEST_ASSERT_EQ(tkoz::stl::hashCString(L"Zen"),
+        hashBytes(L"Zen",3*sizeof(wchar_t)));
+    TEST_ASSERT_EQ(tkoz::stl::hashChars(L"Zen 4",3),
+        tkoz::stl::hashCString(L"Zen"));
+}
+
+// no collisions among short inputs, each bit flip changes the hash
+TEST_CASE_CREATE(testDistinct)
+{
+    std::unordered_set<uint64_t> seen;
+    uchar_t buf[2];
+    for (usize_t i = 0; i < 256; ++i)
+    {
+        buf[0] = static_cast<uchar_t>(i);
+        seen.insert(hashBytes(buf,1));
+        for (usize_t j = 0; j < 256; ++j)
+        {
+            buf[1] = static_cast<uchar_t>(j);
+            seen.insert(hashBytes(buf,2));
+        }
+    }
+    seen.insert(hashBytes(buf,0));
+    TEST_ASSERT_EQ(seen.size(),1+256+256*256);
+    std::mt19937 rng(8);
+    for (usize_t len : {3,7,12,16,40,100,128,129,500,1024,1500})
+    {
+        std::vector<uchar_t> data = randomBytes(rng,len);
+        const uint64_t h = hashBytes(data.data(),len);
+        usize_t changedBits = 0;
+        for (usize_t bit = 0; bit < 8 * len; ++bit)
+        {
+            data[bit / 8] ^= static_cast<uchar_t>(1 << (bit % 8));
+            const uint64_t g = hashBytes(data.data(),len);
+            TEST_ASSERT_NE(g,h);
+            changedBits += static_cast<usize_t>(__builtin_popcountll(g ^ h));
+            data[bit / 8] ^= static_cast<uchar_t>(1 << (bit % 8));
+        }
+        // about half of the output bits change on average
+        const double avg = static_cast<double>(changedBits) / (8 * len);
+        TEST_INFO("length " << len << " average changed bits " << avg);
+        TEST_ASSERT_GT(avg,28.0);
+        TEST_ASSERT_LT(avg,36.0);
+    }
+}
+
+// streaming in random pieces equals hashing all at once
+TEST_CASE_CREATE(testStreaming)
+{
+    std::mt19937 rng(9);
+    const std::vector<uchar_t> data = randomBytes(rng,5000);
+    for (int trial = 0; trial < 3000; ++trial)
+    {
+        const usize_t len = trial < 1200 ? trial : rng() % 5000;
+        const uint64_t seed = rng() % 2 ? 0 : rng();
+        Hasher hasher(seed);
+        usize_t pos = 0;
+        while (pos < len)
+        {
+            const usize_t maxPiece = rng() % 4 ? 70 : 1000;
+            usize_t piece = rng() % (maxPiece + 1);
+            if (piece > len - pos)
+                piece = len - pos;
+            hasher.update(data.data() + pos,piece);
+            pos += piece;
+            if (rng() % 8 == 0)
+                TEST_ASSERT_EQ(hasher.digest(),hashBytes(data.data(),pos,seed));
+        }
+        TEST_ASSERT_EQ(hasher.len(),len);
+        TEST_ASSERT_EQ(hasher.digest(),hashBytes(data.data(),len,seed));
+    }
+    Hasher hasher;
+    hasher.update(data.data(),100);
+    hasher.reset(5);
+    TEST_ASSERT_EQ(hasher.digest(),hashBytes(nullptr,0,5));
+}
+
+// hashing pieces of a concatenation without building it
+TEST_CASE_CREATE(testStreamingStrings)
+{
+    const CString a("Threadripper ");
+    const char *b = "PRO ";
+    const CString c(300,'x');
+    const CString abc = a + b + c;
+    Hasher hasher;
+    hasher.update(a).update(b).update(c).update(static_cast<const char*>(nullptr));
+    TEST_ASSERT_EQ(hasher.digest(),tkoz::stl::hashCString(abc.ptr()));
+    TEST_ASSERT_EQ(hasher.digest(),std::hash<CString>()(abc));
+}
+
+TEST_CASE_CREATE(testStdHash)
+{
+    std::unordered_set<CString,tkoz::stl::CStringHash<char>,std::equal_to<>>
+        set;
+    set.insert(CString("Athlon"));
+    set.insert(CString("Duron"));
+    set.insert(CString("Athlon"));
+    TEST_ASSERT_EQ(set.size(),2);
+    // lookup with a C string without constructing a CString
+    TEST_ASSERT_TRUE(set.find("Duron") != set.end());
+    TEST_ASSERT_TRUE(set.find("Turion") == set.end());
+    std::unordered_set<tkoz::stl::CString<wchar_t,false>> wset;
+    wset.insert(L"Sempron");
+    TEST_ASSERT_EQ(wset.count(L"Sempron"),1);
+    TEST_ASSERT_EQ(std::hash<CString>()(CString()),
+        std::hash<CString>()(CString("")));
+}
+
+TEST_CASE_CREATE(testIgnoreCase)
+{
+    std::mt19937 rng(17);
+    std::vector<char> str(1500);
+    std::vector<char> lower(1500);
+    for (usize_t len = 0; len <= 1200; len += len < 300 ? 1 : 97)
+    {
+        for (usize_t i = 0; i < len; ++i)
+        {
+            str[i] = static_cast<char>(rng() % 3 ? 'A' + rng() % 58 : rng());
+            lower[i] = simd::toLowerAscii(str[i]);
+        }
+        const uint64_t seed = rng() % 2 ? 0 : rng();
+        TEST_ASSERT_EQ(tkoz::stl::hashCharsIgnoreCase(str.data(),len,seed),
+            tkoz::stl::hashChars(lower.data(),len,seed));
+    }
+    TEST_ASSERT_EQ(tkoz::stl::hashCStringIgnoreCase("Content-Type"),
+        tkoz::stl::hashCString("content-type"));
+    TEST_ASSERT_EQ(tkoz::stl::hashCStringIgnoreCase(L"WIDE"),
+        tkoz::stl::hashCString(L"wide"));
+    std::unordered_set<CString,tkoz::stl::CStringHashIgnoreCase<char>,
+        tkoz::stl::CStringEqualIgnoreCase<char>> set;
+    set.insert(CString("Accept"));
+    set.insert(CString("ACCEPT"));
+    set.insert(CString("Host"));
+    TEST_ASSERT_EQ(set.size(),2);
+    TEST_ASSERT_TRUE(set.find("accept") != set.end());
+    TEST_ASSERT_TRUE(set.find(CString("hOsT")) != set.end());
+    TEST_ASSERT_TRUE(set.find("Hosts") == set.end());
+}
@@ -0,0 +1,160 @@
+///
+/// unit tests for tkoz::stl::InternPool (interned C strings)
+///
+
+#include <tkoz/Test.hpp>
+
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/InternPool.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+// instantiate template for accurate code coverage report
+template class tkoz::stl::InternPool<char>;
+template class tkoz::stl::InternPool<wchar_t>;
+template class tkoz::stl::InternedCString<char>;
+
+using Pool = tkoz::stl::InternPool<char>;
+using Interned = tkoz::stl::InternedCString<char>;
+using CString = tkoz::stl::CString<char>;
+using tkoz::stl::usize_t;
+
+static_assert(sizeof(Interned) == sizeof(void*));
+
+TEST_RUNNER_MAIN
+
+TEST_CASE_CREATE(testIntern)
+{
+    Pool pool;
+    const Interned a = pool.intern("Opteron");
+    const Interned b = pool.intern(CString("Opteron"));
+    const Interned c = pool.intern("Opteron 6380",7);
+    const Interned d = pool.intern("Athlon");
+    TEST_ASSERT_TRUE(a == b);
+    TEST_ASSERT_TRUE(a == c);
+    TEST_ASSERT_FALSE(a == d);
+    TEST_ASSERT_EQ(a.ptr(),b.ptr());
+    TEST_ASSERT_EQ(a.len(),7);
+    TEST_ASSERT_EQ(a.hash(),Pool::hash("Opteron",7));
+    TEST_ASSERT_TRUE(a == "Opteron");
+    TEST_ASSERT_FALSE(a == "Opteron 6380");
+    TEST_ASSERT_TRUE(d < a);
+    TEST_ASSERT_EQ(a[2],'t');
+    TEST_ASSERT_EQ(a.ptr()[7],'\0');
+    TEST_ASSERT_EQ(a.toCString(),"Opteron");
+    TEST_ASSERT_EQ(pool.size(),2);
+    // empty and null
+    const Interned e = pool.intern("");
+    TEST_ASSERT_FALSE(e.isNull());
+    TEST_ASSERT_FALSE(static_cast<bool>(e));
+    TEST_ASSERT_TRUE(e == pool.intern(""));
+    const Interned n = pool.intern(static_cast<const char*>(nullptr));
+    TEST_ASSERT_TRUE(n.isNull());
+    TEST_ASSERT_TRUE(n == Interned());
+    TEST_ASSERT_TRUE(n < e);
+    TEST_ASSERT_EQ(n.len(),0);
+    TEST_ASSERT_EQ(std::hash<Interned>()(a),a.hash());
+}
+
+TEST_CASE_CREATE(testFind)
+{
+    Pool pool;
+    TEST_ASSERT_TRUE(pool.find("Sempron").isNull());
+    const Interned a = pool.intern("Sempron");
+    TEST_ASSERT_TRUE(pool.find("Sempron") == a);
+    TEST_ASSERT_TRUE(pool.find("Semp").isNull());
+    TEST_ASSERT_EQ(pool.stats().lookups,1);
+}
+
+TEST_CASE_CREATE(testStats)
+{
+    Pool pool;
+    std::vector<Interned> handles;
+    for (int i = 0; i < 10000; ++i)
+        handles.push_back(pool.intern(std::to_string(i % 2500).c_str()));
+    const tkoz::stl::InternStats stats = pool.stats();
+    TEST_ASSERT_EQ(stats.lookups,10000);
+    TEST_ASSERT_EQ(stats.hits,7500);
+    TEST_ASSERT_EQ(stats.strings,2500);
+    TEST_ASSERT_EQ(pool.size(),2500);
+    TEST_ASSERT_EQ(stats.hitRate(),0.75);
+    // "0" to "9", "10" to "99", "100" to "999", "1000" to "2499"
+    TEST_ASSERT_EQ(stats.bytesStored,10*2 + 90*3 + 900*4 + 1500*5);
+    TEST_ASSERT_GE(stats.bytesReserved,stats.bytesStored);
+    for (int i = 0; i < 10000; ++i)
+    {
+        TEST_ASSERT_TRUE(handles[i] == handles[i % 2500]);
+        TEST_ASSERT_EQ(handles[i],std::to_string(i % 2500).c_str());
+    }
+}
+
+TEST_CASE_CREATE(testHitNoGrow)
+{
+    // a string already interned never resizes its shard, even when the
+    // shard is at the load factor limit
+    Pool pool;
+    usize_t bad = 0;
+    for (int i = 0; i < 4000; ++i)
+    {
+        const std::string s = std::to_string(i);
+        const Interned h = pool.intern(s.c_str());
+        const usize_t reserved = pool.stats().bytesReserved;
+        bad += pool.intern(s.c_str()) != h;
+        bad += pool.stats().bytesReserved != reserved;
+    }
+    TEST_ASSERT_EQ(bad,0);
+    TEST_ASSERT_EQ(pool.size(),4000);
+}
+
+TEST_CASE_CREATE(testWide)
+{
+    tkoz::stl::InternPool<wchar_t> pool;
+    const auto a = pool.intern(L"Phenom");
+    TEST_ASSERT_TRUE(a == pool.intern(L"Phenom"));
+    TEST_ASSERT_EQ(a.len(),6);
+    TEST_ASSERT_EQ(pool.stats().bytesStored,7*sizeof(wchar_t));
+}
+
+// threads intern overlapping strings and must agree on the handles
+TEST_CASE_CREATE(testConcurrent)
+{
+    Pool pool;
+    const usize_t threads = 8;
+    const usize_t count = 20000;
+    std::vector<std::vector<Interned>> results(threads);
+    std::vector<std::thread> workers;
+    for (usize_t t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&pool,&results,t,count]()
+        {
+            for (usize_t i = 0; i < count; ++i)
+            {
+                const usize_t k = (i * 7 + t * 13) % count;
+                results[t].push_back(
+                    pool.intern(("key" + std::to_string(k)).c_str()));
+            }
+        });
+    }
+    for (std::thread &w : workers)
+        w.join();
+    TEST_ASSERT_EQ(pool.size(),count);
+    const tkoz::stl::InternStats stats = pool.stats();
+    TEST_ASSERT_EQ(stats.lookups,threads*count);
+    TEST_ASSERT_EQ(stats.hits,(threads-1)*count);
+    std::unordered_set<const char*> distinct;
+    for (usize_t t = 0; t < threads; ++t)
+    {
+        for (usize_t i = 0; i < count; ++i)
+        {
+            const usize_t k = (i * 7 + t * 13) % count;
+            TEST_ASSERT_TRUE(results[t][i] == pool.find(
+                ("key" + std::to_string(k)).c_str()));
+            distinct.insert(results[t][i].ptr());
+        }
+    }
+    TEST_ASSERT_EQ(distinct.size(),count);
+}
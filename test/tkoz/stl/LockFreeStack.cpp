@@ -0,0 +1,166 @@
+///
+/// unit tests for tkoz::stl::TreiberStack and LockFreeFreeList
+///
+
+#include <tkoz/Test.hpp>
+
+#include <tkoz/stl/LockFreeStack.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace stl = tkoz::stl;
+using stl::usize_t;
+using stl::uint64_t;
+
+// instantiate template for accurate code coverage report
+template class stl::LockFreeFreeList<int>;
+template class stl::TreiberStack<int>;
+
+static constexpr usize_t cThreads = 8;
+
+// construction fails for a chosen value
+struct Picky
+{
+    int value;
+    Picky(int v): value(v)
+    {
+        if (v < 0)
+            throw std::runtime_error("negative");
+    }
+};
+
+TEST_RUNNER_MAIN
+
+TEST_CASE_CREATE(testStack)
+{
+    stl::TreiberStack<int> s(4);
+    TEST_ASSERT_TRUE(s.empty());
+    int v = 0;
+    TEST_ASSERT_FALSE(s.tryPop(v));
+    for (int i = 0; i < 10; ++i)
+        s.push(i);
+    TEST_ASSERT_FALSE(s.empty());
+    for (int i = 9; i >= 0; --i)
+    {
+        TEST_ASSERT_TRUE(s.tryPop(v));
+        TEST_ASSERT_EQ(v,i);
+    }
+    TEST_ASSERT_TRUE(s.empty());
+    // elements left in the stack are destroyed
+    stl::TreiberStack<std::shared_ptr<int>> p;
+    std::shared_ptr<int> shared = std::make_shared<int>(5);
+    p.push(shared);
+    p.emplace(shared);
+    TEST_ASSERT_EQ(shared.use_count(),3);
+    std::shared_ptr<int> out;
+    TEST_ASSERT_TRUE(p.tryPop(out));
+    TEST_ASSERT_EQ(shared.use_count(),3);
+    out.reset();
+    {
+        stl::TreiberStack<std::shared_ptr<int>> q;
+        q.push(shared);
+        TEST_ASSERT_EQ(shared.use_count(),3);
+    }
+    TEST_ASSERT_EQ(shared.use_count(),2);
+    // failed construction returns the node
+    stl::TreiberStack<Picky> r(1);
+    r.emplace(1);
+    TEST_EXCEPTION(r.emplace(-1),std::runtime_error);
+    Picky picky(0);
+    TEST_ASSERT_TRUE(r.tryPop(picky));
+    TEST_ASSERT_EQ(picky.value,1);
+    TEST_ASSERT_FALSE(r.tryPop(picky));
+}
+
+TEST_CASE_CREATE(testFreeList)
+{
+    stl::LockFreeFreeList<uint64_t> f(3);
+    TEST_ASSERT_EQ(f.capacity(),0);
+    uint64_t *a = f.allocate();
+    TEST_ASSERT_EQ(f.capacity(),3);
+    uint64_t *b = f.allocate();
+    uint64_t *c = f.allocate();
+    TEST_ASSERT_TRUE(a != b && b != c && a != c);
+    *a = *b = *c = 1;
+    uint64_t *d = f.allocate();
+    TEST_ASSERT_EQ(f.capacity(),6);
+    f.deallocate(b);
+    TEST_ASSERT_TRUE(f.allocate() == b);
+    f.deallocate(a);
+    f.deallocate(d);
+    TEST_ASSERT_TRUE(f.allocate() == d);
+    TEST_ASSERT_TRUE(f.allocate() == a);
+    TEST_ASSERT_EQ(f.capacity(),6);
+    stl::LockFreeFreeList<char> g(0);
+    char *x = g.allocate();
+    char *y = g.allocate();
+    TEST_ASSERT_TRUE(x != y);
+    TEST_ASSERT_EQ(g.capacity(),2);
+}
+
+TEST_CASE_CREATE(testStackStress)
+{
+    // every pushed value is popped exactly once
+    constexpr usize_t perThread = 20000;
+    stl::TreiberStack<uint64_t> s(16);
+    std::vector<std::atomic<int>> seen(cThreads * perThread);
+    std::vector<std::thread> threads;
+    for (usize_t t = 0; t < cThreads; ++t)
+        threads.emplace_back([&s, &seen, t]()
+        {
+            uint64_t v;
+            for (usize_t i = 0; i < perThread; ++i)
+            {
+                s.push(t * perThread + i);
+                // pop about as often as push to keep the top contended
+                if (i % 4 != 3 && s.tryPop(v))
+                    seen[v].fetch_add(1,std::memory_order_relaxed);
+            }
+        });
+    for (std::thread &thread : threads)
+        thread.join();
+    uint64_t v;
+    while (s.tryPop(v))
+        seen[v].fetch_add(1,std::memory_order_relaxed);
+    usize_t bad = 0;
+    for (std::atomic<int> &count : seen)
+        bad += count.load() != 1;
+    TEST_ASSERT_EQ(bad,0);
+}
+
+TEST_CASE_CREATE(testFreeListStress)
+{
+    // a block is never handed to 2 threads at the same time
+    constexpr usize_t perThread = 20000;
+    stl::LockFreeFreeList<uint64_t> f(8);
+    std::atomic<usize_t> bad = 0;
+    std::vector<std::thread> threads;
+    for (usize_t t = 0; t < cThreads; ++t)
+        threads.emplace_back([&f, &bad, t]()
+        {
+            uint64_t *held[4];
+            for (usize_t i = 0; i < perThread; ++i)
+            {
+                for (uint64_t *&p : held)
+                {
+                    p = f.allocate();
+                    *p = t;
+                }
+                for (uint64_t *p : held)
+                {
+                    bad.fetch_add(*p != t,std::memory_order_relaxed);
+                    f.deallocate(p);
+                }
+            }
+        });
+    for (std::thread &thread : threads)
+        thread.join();
+    TEST_ASSERT_EQ(bad.load(),0);
+    // at most 4 blocks per thread were used at the same time
+    TEST_ASSERT_LE(f.capacity(),cThreads * 4 + cThreads * 8);
+}
@@ -0,0 +1,108 @@
+///
+/// unit tests for tkoz::stl::PerfectHash
+///
+
+#include <tkoz/Test.hpp>
+
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/CStringView.hpp>
+#include <tkoz/stl/PerfectHash.hpp>
+#include <tkoz/stl/SmallCString.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <array>
+#include <string>
+
+namespace stl = tkoz::stl;
+using stl::usize_t;
+
+static constexpr const char *cmds[] = {"get","set","del","exists","expire",
+    "","incr","decr","append","getrange","setrange","strlen","lpush","rpush",
+    "lpop","rpop","llen","lrange","sadd","srem","smembers","hset","hget"};
+static constexpr auto cmdTable = stl::makePerfectHash<cmds>();
+
+static constexpr const char *one[] = {"only"};
+static constexpr auto oneTable = stl::makePerfectHash<one>();
+
+static constexpr const char32_t *wide[] = {U"\U0001F600",U"x",U"xy"};
+static constexpr auto wideTable = stl::makePerfectHash<wide>();
+
+// generated keys for a larger table
+static constexpr auto bigKeys = []()
+{
+    std::array<std::array<char,8>,400> ret{};
+    for (usize_t i = 0; i < ret.size(); ++i)
+    {
+        ret[i][0] = 'c';
+        ret[i][1] = 'm';
+        ret[i][2] = 'd';
+        ret[i][3] = static_cast<char>('0' + i / 100);
+        ret[i][4] = static_cast<char>('0' + i / 10 % 10);
+        ret[i][5] = static_cast<char>('0' + i % 10);
+    }
+    return ret;
+}();
+static constexpr auto bigPtrs = []()
+{
+    std::array<const char*,400> ret{};
+    for (usize_t i = 0; i < ret.size(); ++i)
+        ret[i] = bigKeys[i].data();
+    return ret;
+}();
+static constexpr auto bigTable = stl::makePerfectHash<bigPtrs>();
+
+// lookup works during constant evaluation
+static_assert(cmdTable.find("set",3) == 1);
+static_assert(cmdTable.find("",0) == 5);
+static_assert(cmdTable.find("sets",4) == decltype(cmdTable)::npos);
+static_assert(cmdTable.size() == 23);
+static_assert(decltype(cmdTable)::cSlots == 64);
+static_assert(decltype(oneTable)::cSlots == 1);
+
+TEST_RUNNER_MAIN
+
+TEST_CASE_CREATE(testFind)
+{
+    for (usize_t i = 0; i < std::size(cmds); ++i)
+    {
+        TEST_ASSERT_EQ(cmdTable.find(cmds[i]),i);
+        TEST_ASSERT_EQ(cmdTable.key(i),stl::CStringView<char>(cmds[i]));
+        TEST_ASSERT_TRUE(stl::CString<char>::ptrCmpEq(cmdTable.key(i).ptr(),
+            cmds[i]));
+    }
+    const usize_t npos = decltype(cmdTable)::npos;
+    const char *missing[] = {"GET","ge","gett","hdel","lpushx","x","set "};
+    for (const char *s : missing)
+        TEST_ASSERT_EQ(cmdTable.find(s),npos);
+    TEST_ASSERT_EQ(cmdTable.find(nullptr,0),5);
+    TEST_ASSERT_EQ(cmdTable.find(stl::CString<char>("lrange")),17);
+    TEST_ASSERT_EQ(cmdTable.find(stl::SmallCString<char>("hget")),22);
+    TEST_ASSERT_TRUE(cmdTable.contains("strlen"));
+    TEST_ASSERT_FALSE(cmdTable.contains("strlen2"));
+    // embedded prefix of a key
+    const std::string s = "getrange";
+    TEST_ASSERT_EQ(cmdTable.find(s.data(),3),0);
+    TEST_ASSERT_EQ(oneTable.find("only"),0);
+    TEST_ASSERT_EQ(oneTable.find("other"),npos);
+    TEST_ASSERT_EQ(oneTable.find(""),npos);
+    TEST_ASSERT_EQ(wideTable.find(U"\U0001F600"),0);
+    TEST_ASSERT_EQ(wideTable.find(U"xy"),2);
+    TEST_ASSERT_EQ(wideTable.find(U"y"),npos);
+}
+
+TEST_CASE_CREATE(testLarge)
+{
+    static_assert(decltype(bigTable)::cSlots == 1024);
+    for (usize_t i = 0; i < bigPtrs.size(); ++i)
+        TEST_ASSERT_EQ(bigTable.find(bigPtrs[i]),i);
+    TEST_ASSERT_EQ(bigTable.find("cmd400"),decltype(bigTable)::npos);
+    TEST_ASSERT_EQ(bigTable.find("cmd"),decltype(bigTable)::npos);
+    // only the first 400 of cmd000 to cmd999 are keys
+    usize_t found = 0;
+    for (usize_t i = 0; i < 1000; ++i)
+    {
+        const std::string s = "cmd" + std::to_string(1000 + i).substr(1);
+        found += bigTable.find(s.data(),s.size()) != decltype(bigTable)::npos;
+    }
+    TEST_ASSERT_EQ(found,400);
+}
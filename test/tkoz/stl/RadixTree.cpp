@@ -0,0 +1,286 @@
+///
+/// unit tests for tkoz::stl::RadixTree
+///
+
+#include <tkoz/Test.hpp>
+
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/CStringView.hpp>
+#include <tkoz/stl/Exceptions.hpp>
+#include <tkoz/stl/Meta.hpp>
+#include <tkoz/stl/RadixTree.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <iterator>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using Tree = tkoz::stl::RadixTree<int>;
+using View = tkoz::stl::CStringView<char>;
+using CString = tkoz::stl::CString<char>;
+using tkoz::stl::usize_t;
+
+// instantiate template for accurate code coverage report
+template class tkoz::stl::RadixTree<int>;
+template class tkoz::stl::RadixTree<std::string,unsigned char>;
+
+static_assert(std::forward_iterator<Tree::Iterator>);
+static_assert(std::forward_iterator<Tree::ConstIterator>);
+
+// const trees only give const entries
+static_assert(tkoz::stl::meta::isSame<
+    decltype(*std::declval<const Tree&>().begin()),const Tree::Entry&>);
+static_assert(tkoz::stl::meta::isSame<
+    decltype(*std::declval<const Tree&>().prefixScan("").begin()),
+    const Tree::Entry&>);
+static_assert(tkoz::stl::meta::isSame<
+    decltype(*std::declval<Tree&>().begin()),Tree::Entry&>);
+
+// order of CString (std::string compares chars as unsigned)
+struct KeyLess
+{
+    bool operator()(const std::string &a, const std::string &b) const
+    {
+        return CString::ptrCmpLt(a.c_str(),b.c_str());
+    }
+};
+
+using Map = std::map<std::string,int,KeyLess>;
+
+// compare all entries (in order) with a std::map
+static void checkEqual(const Tree &tree, const Map &m)
+{
+    TEST_ASSERT_EQ(tree.size(),m.size());
+    auto it = m.begin();
+    for (const Tree::Entry &e : tree)
+    {
+        TEST_ASSERT_TRUE(it != m.end());
+        TEST_ASSERT_EQ(e.key(),it->first.c_str());
+        TEST_ASSERT_EQ(e.value(),it->second);
+        ++it;
+    }
+    TEST_ASSERT_TRUE(it == m.end());
+}
+
+// random keys from a small alphabet with shared prefixes of all lengths
+static std::string randomKey(std::mt19937 &rng, const usize_t alphabet)
+{
+    static const std::string prefixes[] = {"","a","user/","abcdefghijklmno",
+        "/api/v1/routes/"};
+    std::string ret = prefixes[rng() % 5];
+    for (usize_t i = 0, l = rng() % 12; i < l; ++i)
+        ret.push_back(static_cast<char>(1 + rng() % alphabet));
+    return ret;
+}
+
+TEST_RUNNER_MAIN
+
+TEST_CASE_CREATE(testBasic)
+{
+    Tree tree;
+    TEST_ASSERT_TRUE(tree.empty());
+    TEST_ASSERT_EQ(tree.find("a"),nullptr);
+    TEST_ASSERT_TRUE(tree.begin() == tree.end());
+    TEST_ASSERT_TRUE(tree.insert("romane",1).second);
+    TEST_ASSERT_TRUE(tree.insert("romanus",2).second);
+    TEST_ASSERT_TRUE(tree.insert("romulus",3).second);
+    TEST_ASSERT_TRUE(tree.insert("rubens",4).second);
+    TEST_ASSERT_TRUE(tree.insert("ruber",5).second);
+    TEST_ASSERT_TRUE(tree.insert("r",6).second);
+    TEST_ASSERT_TRUE(tree.insert("",7).second);
+    const auto [value,inserted] = tree.insert("ruber",50);
+    TEST_ASSERT_FALSE(inserted);
+    TEST_ASSERT_EQ(*value,5);
+    TEST_ASSERT_EQ(tree.size(),7);
+    TEST_ASSERT_EQ(*tree.find("romulus"),3);
+    TEST_ASSERT_EQ(*tree.find(CString("")),7);
+    TEST_ASSERT_EQ(*tree.find(View("rubensx",6)),4);
+    TEST_ASSERT_EQ(tree.find("roman"),nullptr);
+    TEST_ASSERT_EQ(tree.find("rubensx"),nullptr);
+    TEST_ASSERT_FALSE(tree.contains("ro"));
+    TEST_ASSERT_TRUE(tree.contains("r"));
+    TEST_ASSERT_FALSE(tree.insertOrAssign("r",60));
+    TEST_ASSERT_EQ(*tree.find("r"),60);
+    TEST_ASSERT_TRUE(tree.insertOrAssign("s",8));
+    tree["t"] += 9;
+    TEST_ASSERT_EQ(tree["t"],9);
+    std::vector<std::string> keys;
+    for (const Tree::Entry &e : tree)
+        keys.emplace_back(e.key().ptr());
+    TEST_ASSERT_TRUE((keys == std::vector<std::string>{"","r","romane",
+        "romanus","romulus","rubens","ruber","s","t"}));
+    // keys are stored null-terminated
+    TEST_ASSERT_EQ(tree.begin()->key().ptr()[0],'\0');
+    TEST_ASSERT_TRUE(tree.erase("romanus"));
+    TEST_ASSERT_FALSE(tree.erase("romanus"));
+    TEST_ASSERT_FALSE(tree.erase("roma"));
+    TEST_ASSERT_EQ(*tree.find("romane"),1);
+    TEST_ASSERT_EQ(tree.size(),8);
+    const usize_t bytes = tree.memoryUsage();
+    TEST_ASSERT_GT(bytes,sizeof(Tree));
+    Tree other = std::move(tree);
+    TEST_ASSERT_TRUE(tree.empty());
+    TEST_ASSERT_EQ(tree.memoryUsage(),sizeof(Tree));
+    TEST_ASSERT_EQ(other.memoryUsage(),bytes);
+    other.clear();
+    TEST_ASSERT_EQ(other.memoryUsage(),sizeof(Tree));
+    // a null character would match the terminator of a shorter key
+    other.insert("a",1);
+    TEST_EXCEPTION(other.insert(View("a\0",2),2),tkoz::stl::ArgumentError);
+    TEST_EXCEPTION(other[View("b\0c",3)],tkoz::stl::ArgumentError);
+    TEST_ASSERT_FALSE(other.contains(View("a\0",2)));
+    TEST_ASSERT_EQ(other.size(),1);
+    Tree::ConstIterator it = other.begin();
+    TEST_ASSERT_EQ(it->key(),"a");
+}
+
+TEST_CASE_CREATE(testPrefixScan)
+{
+    Tree tree;
+    const char *routes[] = {"/api/v1/users","/api/v1/users/list",
+        "/api/v1/groups","/api/v2/users","/static/app.js","/"};
+    int i = 0;
+    for (const char *r : routes)
+        tree.insert(r,i++);
+    std::vector<int> values;
+    for (const Tree::Entry &e : tree.prefixScan("/api/v1/"))
+        values.push_back(e.value());
+    TEST_ASSERT_TRUE((values == std::vector<int>{2,0,1}));
+    values.clear();
+    for (const Tree::Entry &e : tree.prefixScan("/api/v1/users"))
+        values.push_back(e.value());
+    TEST_ASSERT_TRUE((values == std::vector<int>{0,1}));
+    TEST_ASSERT_TRUE(tree.prefixScan("/api/v3").empty());
+    TEST_ASSERT_TRUE(tree.prefixScan("/api/v1/usersx").empty());
+    TEST_ASSERT_EQ(std::distance(tree.prefixScan("").begin(),
+        tree.prefixScan("").end()),6);
+    TEST_ASSERT_EQ(std::distance(tree.prefixScan("/s").begin(),
+        tree.prefixScan("/s").end()),1);
+    // prefix ending inside a long compressed path
+    Tree deep;
+    deep.insert("abcdefghijklmnopqrstuvwxyz1",1);
+    deep.insert("abcdefghijklmnopqrstuvwxyz2",2);
+    TEST_ASSERT_FALSE(deep.prefixScan("abcdefghijklmnopq").empty());
+    TEST_ASSERT_TRUE(deep.prefixScan("abcdefghijklmnopqX").empty());
+    TEST_ASSERT_TRUE(deep.prefixScan("abcdefghijklmnopqrstuvwxyz3").empty());
+}
+
+TEST_CASE_CREATE(testNodeSizes)
+{
+    // children of one node grow through all sizes and shrink back
+    Tree tree;
+    usize_t counts[4];
+    for (int c = 1; c < 256; ++c)
+    {
+        const char key[] = {'k',static_cast<char>(c),'\0'};
+        tree.insert(key,c);
+        tree.nodeCounts(counts);
+        const usize_t n = static_cast<usize_t>(c);
+        const usize_t type = n <= 4 ? 0 : n <= 16 ? 1 : n <= 48 ? 2 : 3;
+        TEST_ASSERT_EQ(counts[type],n > 1 ? 1 : 0);
+    }
+    int prev = -1;
+    for (const Tree::Entry &e : tree)
+    {
+        // signed char order: 0x80-0xff before 0x01-0x7f
+        const int c = static_cast<signed char>(e.key()[1]);
+        TEST_ASSERT_LT(prev == -1 ? -1000 : prev,c);
+        prev = c;
+    }
+    for (int c = 255; c > 1; --c)
+    {
+        const char key[] = {'k',static_cast<char>(c),'\0'};
+        TEST_ASSERT_TRUE(tree.erase(key));
+        for (int d = 1; d < c; d += 17)
+        {
+            const char other[] = {'k',static_cast<char>(d),'\0'};
+            TEST_ASSERT_EQ(*tree.find(other),d);
+        }
+    }
+    tree.nodeCounts(counts);
+    TEST_ASSERT_EQ(counts[0] + counts[1] + counts[2] + counts[3],0);
+    TEST_ASSERT_EQ(tree.size(),1);
+    TEST_ASSERT_EQ(tree.begin()->key(),"k\x01");
+}
+
+TEST_CASE_CREATE(testRandom)
+{
+    std::mt19937 rng(13);
+    for (usize_t alphabet : {2,4,255})
+    {
+        Tree tree;
+        Map expected;
+        for (int op = 0; op < 30000; ++op)
+        {
+            const std::string key = randomKey(rng,alphabet);
+            const int r = static_cast<int>(rng() % 10);
+            if (r < 5)
+            {
+                const bool inserted = tree.insertOrAssign(key.c_str(),op);
+                TEST_ASSERT_EQ(inserted,!expected.contains(key));
+                expected[key] = op;
+            }
+            else if (r < 8)
+            {
+                TEST_ASSERT_EQ(tree.erase(key.c_str()),
+                    expected.erase(key) == 1);
+            }
+            else
+            {
+                const int *value = tree.find(key.c_str());
+                const auto it = expected.find(key);
+                TEST_ASSERT_EQ(value == nullptr,it == expected.end());
+                if (value)
+                    TEST_ASSERT_EQ(*value,it->second);
+            }
+            if (op % 5000 == 0)
+                checkEqual(tree,expected);
+        }
+        checkEqual(tree,expected);
+        // prefix scans match the std::map range
+        for (int trial = 0; trial < 300; ++trial)
+        {
+            std::string prefix = randomKey(rng,alphabet);
+            prefix.resize(prefix.size() / 2);
+            std::vector<int> values;
+            for (const Tree::Entry &e : tree.prefixScan(prefix.c_str()))
+                values.push_back(e.value());
+            // not a contiguous std::map range ("a\xff" < "a" < "ab")
+            std::vector<int> want;
+            for (const auto &[key,value] : expected)
+                if (key.starts_with(prefix))
+                    want.push_back(value);
+            TEST_ASSERT_TRUE(values == want);
+        }
+        for (const auto &[key,value] : expected)
+            TEST_ASSERT_TRUE(tree.erase(key.c_str()));
+        TEST_ASSERT_TRUE(tree.empty());
+        TEST_ASSERT_EQ(tree.memoryUsage(),sizeof(Tree));
+    }
+}
+
+TEST_CASE_CREATE(testValues)
+{
+    // non trivial values are destroyed with their entries
+    auto counter = std::make_shared<int>(0);
+    {
+        tkoz::stl::RadixTree<std::shared_ptr<int>> tree;
+        for (int i = 0; i < 100; ++i)
+            tree.emplace(std::to_string(i).c_str(),counter);
+        TEST_ASSERT_EQ(counter.use_count(),101);
+        tree.erase("42");
+        TEST_ASSERT_EQ(counter.use_count(),100);
+        tree.emplace("7",nullptr);
+        TEST_ASSERT_EQ(counter.use_count(),100);
+    }
+    TEST_ASSERT_EQ(counter.use_count(),1);
+    tkoz::stl::RadixTree<std::string,unsigned char> bytes;
+    const unsigned char k1[] = {0xff,0};
+    const unsigned char k2[] = {0x01,0};
+    bytes.insert(k1,"high");
+    bytes.insert(k2,"low");
+    TEST_ASSERT_EQ(bytes.begin()->value(),"low");
+}
@@ -0,0 +1,225 @@
+///
+/// unit tests for tkoz::stl::Rope (balanced tree of string chunks)
+///
+
+#include <tkoz/Test.hpp>
+
+#include <tkoz/stl/Allocator.hpp>
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/CStringView.hpp>
+#include <tkoz/stl/Exceptions.hpp>
+#include <tkoz/stl/Rope.hpp>
+
+#include <random>
+#include <string>
+#include <thread>
+
+// instantiate template for accurate code coverage report
+template class tkoz::stl::Rope<char>;
+template class tkoz::stl::Rope<wchar_t>;
+
+using Rope = tkoz::stl::Rope<char>;
+using View = tkoz::stl::CStringView<char>;
+using tkoz::stl::usize_t;
+using IE = tkoz::stl::IndexError;
+
+// destroyed after the thread local pool (which it keeps alive)
+static Rope gRope(View("a static rope"));
+
+// check all ways of reading the rope against the expected value
+static bool matches(const Rope &rope, const std::string &expected)
+{
+    if (rope.len() != expected.size())
+        return false;
+    if (!(rope == View(expected.c_str(),expected.size())))
+        return false;
+    if (rope.toCString() != expected.c_str())
+        return false;
+    return expected.empty() || rope[expected.size()-1] == expected.back();
+}
+
+TEST_RUNNER_MAIN
+
+TEST_CASE_CREATE(testBasic)
+{
+    Rope r;
+    TEST_ASSERT_TRUE(r.empty());
+    TEST_ASSERT_EQ(r.len(),0);
+    TEST_ASSERT_EQ(r.chunkCount(),0);
+    TEST_ASSERT_EQ(r.toCString(),"");
+    r += "Vermeer";
+    r.prepend("Ryzen ");
+    r.insert(5," 7");
+    TEST_ASSERT_EQ(r.toCString(),"Ryzen 7 Vermeer");
+    TEST_ASSERT_EQ(r.chunkCount(),1);
+    TEST_ASSERT_EQ(r[6],'7');
+    TEST_ASSERT_EQ(r.at(14),'r');
+    TEST_EXCEPTION(r.at(15),IE);
+    TEST_EXCEPTION(r.insert(16,"x"),IE);
+    TEST_EXCEPTION(r.erase(16),IE);
+    r.erase(5,2);
+    TEST_ASSERT_EQ(r.toCString(),"Ryzen Vermeer");
+    TEST_ASSERT_EQ(r.substr(6),"Vermeer");
+    TEST_ASSERT_EQ(r.substr(0,5),"Ryzen");
+    TEST_ASSERT_EQ(r.substr(13),"");
+    TEST_EXCEPTION(r.substr(14),IE);
+    r.erase(5);
+    TEST_ASSERT_EQ(r.toCString(),"Ryzen");
+    r.clear();
+    TEST_ASSERT_TRUE(r.empty());
+}
+
+TEST_CASE_CREATE(testChunks)
+{
+    const std::string big(3000,'a');
+    Rope r{View(big.c_str())};
+    TEST_ASSERT_EQ(r.len(),3000);
+    TEST_ASSERT_EQ(r.chunkCount(),3);
+    usize_t maxChunk = 0;
+    r.forEachChunk([&maxChunk](const View chunk)
+    {
+        if (chunk.len() > maxChunk)
+            maxChunk = chunk.len();
+    });
+    TEST_ASSERT_EQ(maxChunk,Rope::cMaxChunk);
+    // inserting into a full chunk splits it
+    r.insert(10,"bbb");
+    TEST_ASSERT_EQ(r.chunkCount(),5);
+    TEST_ASSERT_EQ(r.substr(8,7),"aabbbaa");
+    // small insertions go into a chunk with room
+    r.insert(12,"c");
+    TEST_ASSERT_EQ(r.chunkCount(),5);
+    TEST_ASSERT_EQ(r.substr(8,8),"aabbcbaa");
+    // erasing across chunks
+    r.erase(5,2000);
+    TEST_ASSERT_EQ(r.len(),1004);
+    TEST_ASSERT_TRUE(matches(r,std::string(1004,'a')));
+}
+
+TEST_CASE_CREATE(testFlatten)
+{
+    Rope r(View("Cezanne"));
+    const char *p1 = r.ptr();
+    TEST_ASSERT_EQ(View(p1),"Cezanne");
+    // cached until modified
+    TEST_ASSERT_EQ(r.ptr(),p1);
+    r += " APU";
+    TEST_ASSERT_EQ(View(r.ptr()),"Cezanne APU");
+    TEST_ASSERT_EQ(r.ptr()[11],'\0');
+}
+
+TEST_CASE_CREATE(testConcat)
+{
+    tkoz::stl::Pool pool;
+    Rope a(View("Rembrandt"),pool);
+    Rope b(View(" Phoenix"),pool);
+    a += static_cast<Rope&&>(b);
+    TEST_ASSERT_TRUE(b.empty());
+    TEST_ASSERT_EQ(a.toCString(),"Rembrandt Phoenix");
+    TEST_ASSERT_EQ(a.chunkCount(),2);
+    // different pools copy the chunks
+    Rope c(View(" Dragon"));
+    a += static_cast<Rope&&>(c);
+    TEST_ASSERT_TRUE(c.empty());
+    TEST_ASSERT_EQ(a.toCString(),"Rembrandt Phoenix Dragon");
+    // moved from rope is usable
+    c += "Range";
+    TEST_ASSERT_EQ(c.toCString(),"Range");
+    Rope d(static_cast<Rope&&>(c));
+    c += "Hawk";
+    TEST_ASSERT_EQ(c.toCString(),"Hawk");
+    TEST_ASSERT_EQ(d.toCString(),"Range");
+    Rope e(a);
+    e.erase(0,10);
+    TEST_ASSERT_EQ(e.toCString(),"Phoenix Dragon");
+    TEST_ASSERT_EQ(a.toCString(),"Rembrandt Phoenix Dragon");
+    d = e;
+    TEST_ASSERT_EQ(d.toCString(),"Phoenix Dragon");
+    a.clear();
+    e.clear();
+    d.clear();
+    TEST_ASSERT_EQ(pool.bytesInUse(),0);
+    // ropes without a pool share the thread local one and do not copy
+    tkoz::stl::Pool &local = *tkoz::stl::Pool::threadLocal();
+    const usize_t before = local.bytesInUse();
+    Rope f(View("Strix"));
+    Rope g(View(" Point"));
+    TEST_ASSERT_EQ(View(g.ptr()),View(" Point"));
+    f += static_cast<Rope&&>(g);
+    TEST_ASSERT_EQ(f.chunkCount(),2);
+    TEST_ASSERT_GT(local.bytesInUse(),before);
+    {
+        Rope::StringType s = f.substr(2,6);
+        TEST_ASSERT_EQ(s,"rix Po");
+        TEST_ASSERT_TRUE(&s.allocator().pool() == &local);
+    }
+    f.clear();
+    TEST_ASSERT_EQ(local.bytesInUse(),before);
+}
+
+// ropes using the thread local pool may outlive the thread
+TEST_CASE_CREATE(testPoolLifetime)
+{
+    static Rope s(View("function local"));
+    s.insert(8,View(" static"));
+    TEST_ASSERT_EQ(s.toCString(),"function static local");
+    gRope.insert(0,View("still "));
+    TEST_ASSERT_EQ(gRope.toCString(),"still a static rope");
+    Rope moved;
+    std::thread thread([&moved]()
+    {
+        Rope r(View("made on "));
+        r.insert(r.len(),View("another thread"));
+        moved = static_cast<Rope&&>(r);
+    });
+    thread.join();
+    TEST_ASSERT_EQ(moved.toCString(),"made on another thread");
+    moved.insert(0,View("and "));
+    TEST_ASSERT_EQ(moved.toCString(),"and made on another thread");
+}
+
+// random edits compared to std::string
+TEST_CASE_CREATE(testRandom)
+{
+    std::mt19937 rng(11);
+    Rope r;
+    std::string expected;
+    for (int step = 0; step < 4000; ++step)
+    {
+        const int op = static_cast<int>(rng() % 10);
+        if (op < 6 || expected.size() < 100)
+        {
+            const usize_t pos = rng() % (expected.size() + 1);
+            const usize_t n = rng() % 4 ? rng() % 20 + 1 : rng() % 3000 + 1;
+            const std::string text(n,static_cast<char>('a' + rng() % 26));
+            r.insert(pos,View(text.c_str(),n));
+            expected.insert(pos,text);
+        }
+        else if (op < 9)
+        {
+            const usize_t pos = rng() % (expected.size() + 1);
+            const usize_t n = rng() % 500;
+            r.erase(pos,n);
+            expected.erase(pos,n);
+        }
+        else
+        {
+            const usize_t pos = rng() % (expected.size() + 1);
+            const usize_t n = rng() % 100;
+            TEST_ASSERT_EQ(r.substr(pos,n),expected.substr(pos,n).c_str());
+        }
+        if (step % 100 == 0)
+            TEST_ASSERT_TRUE(matches(r,expected));
+    }
+    TEST_ASSERT_TRUE(matches(r,expected));
+    TEST_INFO("final length " << r.len() << " in " << r.chunkCount()
+        << " chunks");
+}
+
+TEST_CASE_CREATE(testWide)
+{
+    tkoz::stl::Rope<wchar_t> r(tkoz::stl::CStringView<wchar_t>(L"Zen"));
+    r += L" 5";
+    r.insert(3,L"+");
+    TEST_ASSERT_EQ(r.toCString(),L"Zen+ 5");
+}
@@ -0,0 +1,189 @@
+///
+/// unit tests for tkoz::stl::SharedCString (reference counted C string)
+///
+
+#include <tkoz/Test.hpp>
+
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/Exceptions.hpp>
+#include <tkoz/stl/SharedCString.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <compare>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// instantiate template for accurate code coverage report
+template class tkoz::stl::SharedCString<char>;
+template class tkoz::stl::SharedCString<char32_t>;
+template class tkoz::stl::SharedCString<char,false>;
+template class tkoz::stl::SharedCString<char,true,tkoz::stl::PlainRefCount>;
+
+using SString = tkoz::stl::SharedCString<char>;
+using PString = tkoz::stl::SharedCString<char,true,tkoz::stl::PlainRefCount>;
+using CString = tkoz::stl::CString<char>;
+using tkoz::stl::usize_t;
+
+// a copy is a single pointer
+static_assert(sizeof(SString) == sizeof(void*));
+static_assert(sizeof(PString) == sizeof(void*));
+
+TEST_RUNNER_MAIN
+
+TEST_CASE_CREATE(testCtor)
+{
+    SString s1;
+    TEST_ASSERT_TRUE(s1.isNull());
+    TEST_ASSERT_EQ(s1.ptr(),nullptr);
+    TEST_ASSERT_EQ(s1.len(),0);
+    TEST_ASSERT_EQ(s1.useCount(),0);
+    TEST_ASSERT_EQ(s1,nullptr);
+    TEST_ASSERT_FALSE(s1);
+    SString s2("");
+    TEST_ASSERT_FALSE(s2.isNull());
+    TEST_ASSERT_EQ(s2,"");
+    TEST_ASSERT_NE(s1,s2);
+    SString s3("hello world");
+    TEST_ASSERT_EQ(s3.len(),11);
+    TEST_ASSERT_EQ(s3.size(),11);
+    TEST_ASSERT_EQ(s3,"hello world");
+    TEST_ASSERT_TRUE(s3);
+    TEST_ASSERT_EQ(SString("abcdef",3),"abc");
+    TEST_ASSERT_EQ(SString(4,'z'),"zzzz");
+    const CString c("from cstring");
+    const SString s4(c);
+    TEST_ASSERT_EQ(s4,c.ptr());
+    TEST_ASSERT_EQ(s4.toCString(),"from cstring");
+    TEST_ASSERT_TRUE(SString(CString()).isNull());
+    TEST_ASSERT_TRUE(SString().toCString().isNull());
+    const tkoz::stl::SharedCString<char32_t> w(U"\U0001F600 wide");
+    TEST_ASSERT_EQ(w.len(),6);
+    TEST_ASSERT_EQ(w[0],U'\U0001F600');
+}
+
+TEST_CASE_CREATE(testSharing)
+{
+    SString s1("shared value");
+    const char *p = std::as_const(s1).ptr();
+    SString s2(s1);
+    SString s3;
+    s3 = s2;
+    TEST_ASSERT_EQ(s1.useCount(),3);
+    TEST_ASSERT_FALSE(s3.isUnique());
+    TEST_ASSERT_EQ(std::as_const(s3).ptr(),p);
+    TEST_ASSERT_EQ(s1,s3);
+    s3 = s3;
+    TEST_ASSERT_EQ(s1.useCount(),3);
+    // moving transfers the reference
+    SString s4(std::move(s3));
+    TEST_ASSERT_TRUE(s3.isNull());
+    TEST_ASSERT_EQ(s1.useCount(),3);
+    s4 = SString("other");
+    TEST_ASSERT_EQ(s1.useCount(),2);
+    TEST_ASSERT_TRUE(s4.isUnique());
+    s2 = SString();
+    TEST_ASSERT_TRUE(s1.isUnique());
+    // unique strings are modified in place
+    s1[0] = 'S';
+    TEST_ASSERT_EQ(std::as_const(s1).ptr(),p);
+    TEST_ASSERT_EQ(s1,"Shared value");
+}
+
+TEST_CASE_CREATE(testCopyOnWrite)
+{
+    const SString original("copy on write");
+    SString copy = original;
+    TEST_ASSERT_EQ(original.useCount(),2);
+    // const access does not copy
+    TEST_ASSERT_EQ(std::as_const(copy)[0],'c');
+    TEST_ASSERT_EQ(std::as_const(copy).ptr(),original.ptr());
+    copy[0] = 'C';
+    TEST_ASSERT_NE(std::as_const(copy).ptr(),original.ptr());
+    TEST_ASSERT_EQ(original,"copy on write");
+    TEST_ASSERT_EQ(copy,"Copy on write");
+    TEST_ASSERT_EQ(original.useCount(),1);
+    TEST_ASSERT_EQ(copy.useCount(),1);
+    // non const ptr() and at() also copy
+    SString c2 = original;
+    c2.ptr()[1] = 'O';
+    SString c3 = original;
+    c3.at(-1) = 'E';
+    c3.at(false) = 'K';
+    TEST_ASSERT_EQ(c2,"cOpy on write");
+    TEST_ASSERT_EQ(c3,"Kopy on writE");
+    TEST_ASSERT_EQ(original,"copy on write");
+    SString c4 = original;
+    c4.makeUnique();
+    TEST_ASSERT_TRUE(c4.isUnique());
+    TEST_ASSERT_TRUE(original.isUnique());
+    TEST_ASSERT_EQ(c4,original);
+    PString p1("plain");
+    PString p2 = p1;
+    TEST_ASSERT_EQ(p1.useCount(),2);
+    p2[4] = 'N';
+    TEST_ASSERT_EQ(p1,"plain");
+    TEST_ASSERT_EQ(p2,"plaiN");
+    TEST_ASSERT_EQ(p1.useCount(),1);
+}
+
+TEST_CASE_CREATE(testAccess)
+{
+    const SString s("abc");
+    TEST_ASSERT_EQ(s.at(0),'a');
+    TEST_ASSERT_EQ(s.at(3),'\0');
+    TEST_ASSERT_EQ(s.at(-3),'a');
+    TEST_ASSERT_EQ(s.at(true),'b');
+    TEST_EXCEPTION(s.at(4),tkoz::stl::IndexError);
+    TEST_EXCEPTION(s.at(-4),tkoz::stl::IndexError);
+    TEST_EXCEPTION(SString().at(0),tkoz::stl::NullError);
+    TEST_EXCEPTION(SString("").at(true),tkoz::stl::IndexError);
+    SString t = s;
+    TEST_EXCEPTION(t.at(9),tkoz::stl::IndexError);
+    TEST_ASSERT_EQ(s.useCount(),2);
+}
+
+TEST_CASE_CREATE(testCompare)
+{
+    const SString a("apple");
+    const SString b("banana");
+    const SString a2("apple");
+    TEST_ASSERT_EQ(a,a2);
+    TEST_ASSERT_NE(a,b);
+    TEST_ASSERT_LT(a,b);
+    TEST_ASSERT_TRUE((b <=> a) == std::strong_ordering::greater);
+    TEST_ASSERT_EQ("apple",a);
+    TEST_ASSERT_LT("aardvark",a);
+    TEST_ASSERT_GT(a,"aardvark");
+    TEST_ASSERT_NE(a,SString("apples"));
+    TEST_ASSERT_NE(SString(),a);
+    TEST_ASSERT_EQ(SString(),SString());
+    TEST_ASSERT_LT(SString(),SString(""));
+}
+
+TEST_CASE_CREATE(testThreads)
+{
+    const SString s("shared between threads");
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+        threads.emplace_back([&s, t]()
+        {
+            std::vector<SString> copies;
+            for (int i = 0; i < 10000; ++i)
+            {
+                copies.push_back(s);
+                if (i % 100 == 0)
+                {
+                    SString mine = s;
+                    mine[0] = static_cast<char>('0' + t);
+                    TEST_ASSERT_EQ(mine[1],'h');
+                }
+                if (copies.size() > 50)
+                    copies.clear();
+            }
+        });
+    for (std::thread &thread : threads)
+        thread.join();
+    TEST_ASSERT_EQ(s.useCount(),1);
+    TEST_ASSERT_EQ(s,"shared between threads");
+}
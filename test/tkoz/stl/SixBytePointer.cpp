@@ -150,6 +150,10 @@ TEST_CASE_CREATE(testBool)
     TEST_ASSERT_TRUE(static_cast<bool>(p2));
     TEST_ASSERT_FALSE(p1);
     TEST_ASSERT_TRUE(p2);
+    // non null with some 16 bit parts zero
+    TEST_ASSERT_TRUE(SBP<char>::fromInt(0x10000ul));
+    TEST_ASSERT_TRUE(SBP<char>::fromInt(0x100000000ul));
+    TEST_ASSERT_TRUE(SBP<char>::fromInt(0x1ul));
 }
 
 TEST_CASE_CREATE(testCastPtr) // to T*
@@ -0,0 +1,158 @@
+///
+/// unit tests for tkoz::stl::SixBytePointerArray
+///
+
+#include <tkoz/Test.hpp>
+
+#include <tkoz/stl/Allocator.hpp>
+#include <tkoz/stl/Exceptions.hpp>
+#include <tkoz/stl/Simd.hpp>
+#include <tkoz/stl/SixBytePointer.hpp>
+#include <tkoz/stl/SixBytePointerArray.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace stl = tkoz::stl;
+namespace simd = tkoz::stl::simd;
+using stl::usize_t;
+using stl::uint64_t;
+using Array = stl::SixBytePointerArray<int>;
+
+// instantiate template for accurate code coverage report
+template class stl::SixBytePointerArray<int>;
+template class stl::SixBytePointerArray<void>;
+
+static const simd::SimdLevel levels[] = {simd::cSimdScalar,simd::cSimdSse2,
+    simd::cSimdAvx2,simd::cSimdAvx512};
+
+// random 48 bit pointer values (not dereferenced)
+static std::vector<int*> randomPtrs(std::mt19937_64 &rng, const usize_t n)
+{
+    std::vector<int*> ret(n);
+    for (int *&p : ret)
+        p = reinterpret_cast<int*>(rng() & 0xFFFFFFFFFFFFull);
+    return ret;
+}
+
+TEST_RUNNER_MAIN
+
+TEST_CASE_CREATE(testBasic)
+{
+    Array a;
+    TEST_ASSERT_TRUE(a.empty());
+    TEST_ASSERT_EQ(a.capacity(),0);
+    int x[100];
+    for (int i = 0; i < 100; ++i)
+        a.pushBack(x + i);
+    TEST_ASSERT_EQ(a.size(),100);
+    TEST_ASSERT_GE(a.capacity(),100);
+    TEST_ASSERT_EQ(a.bytes(),a.capacity() * 6);
+    for (int i = 0; i < 100; ++i)
+    {
+        TEST_ASSERT_TRUE(a.get(i) == x + i);
+        TEST_ASSERT_TRUE(a[i] == x + i);
+    }
+    a.set(5,nullptr);
+    TEST_ASSERT_FALSE(a[5]);
+    TEST_ASSERT_TRUE(a.at(6) == x + 6);
+    TEST_EXCEPTION((void)a.at(100),stl::IndexError);
+    // elements convert to pointers when iterating
+    usize_t i = 0;
+    for (int *p : std::as_const(a))
+    {
+        TEST_ASSERT_TRUE(i == 5 ? !p : p == x + i);
+        ++i;
+    }
+    TEST_ASSERT_EQ(i,100);
+    a.popBack();
+    TEST_ASSERT_EQ(a.size(),99);
+    Array b = a;
+    a.clear();
+    TEST_ASSERT_TRUE(a.empty());
+    TEST_ASSERT_EQ(b.size(),99);
+    TEST_ASSERT_TRUE(b.get(98) == x + 98);
+    a = std::move(b);
+    TEST_ASSERT_EQ(a.size(),99);
+    a.resize(120);
+    TEST_ASSERT_TRUE(a.get(110) == nullptr);
+    TEST_ASSERT_TRUE(a.get(10) == x + 10);
+    a.resize(3);
+    a.shrinkToFit();
+    TEST_ASSERT_EQ(a.capacity(),3);
+    TEST_ASSERT_EQ(a.bytes(),18);
+    a.resize(0);
+    a.shrinkToFit();
+    TEST_ASSERT_EQ(a.capacity(),0);
+    const Array c = {x,nullptr,x + 2};
+    TEST_ASSERT_EQ(c.size(),3);
+    TEST_ASSERT_TRUE(c.get(1) == nullptr);
+    const Array d(4);
+    TEST_ASSERT_TRUE(d.get(3) == nullptr);
+    // arena storage
+    using ArenaAlloc = stl::ArenaAllocator<stl::SixBytePointer<char>>;
+    stl::Arena arena;
+    stl::SixBytePointerArray<char,ArenaAlloc> e{ArenaAlloc(arena)};
+    char s[50];
+    for (int k = 0; k < 50; ++k)
+        e.pushBack(s + k);
+    TEST_ASSERT_TRUE(e.get(49) == s + 49);
+}
+
+TEST_CASE_CREATE(testBulk)
+{
+    std::mt19937_64 rng(21);
+    for (usize_t n = 0; n < 70; ++n)
+    {
+        const std::vector<int*> ptrs = randomPtrs(rng,n);
+        for (simd::SimdLevel level : levels)
+        {
+            // exact sized buffers so sanitizers catch any overrun
+            std::vector<stl::SixBytePointer<int>> packed(n);
+            stl::encodeSixBytePointers(ptrs.data(),n,packed.data(),level);
+            for (usize_t i = 0; i < n; ++i)
+                TEST_ASSERT_TRUE(packed[i].ptr() == ptrs[i]);
+            std::vector<int*> out(n);
+            stl::decodeSixBytePointers(packed.data(),n,out.data(),level);
+            TEST_ASSERT_TRUE(out == ptrs);
+        }
+    }
+    const std::vector<int*> ptrs = randomPtrs(rng,1000);
+    Array a;
+    a.pushBack(nullptr);
+    a.append(ptrs.data(),ptrs.size());
+    TEST_ASSERT_EQ(a.size(),1001);
+    std::vector<int*> out(500);
+    a.decode(301,500,out.data());
+    TEST_ASSERT_TRUE(std::vector<int*>(ptrs.begin() + 300,ptrs.begin() + 800)
+        == out);
+}
+
+TEST_CASE_CREATE(testForEach)
+{
+    std::vector<uint64_t> values(1000);
+    Array a;
+    for (usize_t n = 0; n <= 40; ++n)
+    {
+        a.clear();
+        for (usize_t i = 0; i < n; ++i)
+        {
+            values[i] = i * 3;
+            a.pushBack(reinterpret_cast<int*>(values.data() + i));
+        }
+        uint64_t sum = 0;
+        usize_t count = 0;
+        a.forEach([&](int *p)
+        {
+            sum += *reinterpret_cast<uint64_t*>(p);
+            ++count;
+        });
+        TEST_ASSERT_EQ(count,n);
+        TEST_ASSERT_EQ(sum,3 * n * (n ? n - 1 : 0) / 2);
+        count = 0;
+        a.forEach([&](int*) { ++count; },false);
+        TEST_ASSERT_EQ(count,n);
+    }
+}
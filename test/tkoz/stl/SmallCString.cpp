@@ -0,0 +1,243 @@
+///
+/// unit tests for tkoz::stl::SmallCString (C string with inline storage)
+///
+
+#include <tkoz/Test.hpp>
+
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/Exceptions.hpp>
+#include <tkoz/stl/Meta.hpp>
+#include <tkoz/stl/SmallCString.hpp>
+#include <tkoz/stl/Utils.hpp>
+
+#include <compare>
+
+// instantiate template for accurate code coverage report
+template class tkoz::stl::SmallCString<char>;
+template class tkoz::stl::SmallCString<wchar_t>;
+template class tkoz::stl::SmallCString<int>;
+template class tkoz::stl::SmallCString<char,false>;
+template class tkoz::stl::SmallCString<char,true,1>;
+template class tkoz::stl::SmallCString<char,true,40>;
+
+using SString = tkoz::stl::SmallCString<char>;
+using SStringNoNull = tkoz::stl::SmallCString<char,false>;
+using SStringTiny = tkoz::stl::SmallCString<char,true,1>;
+using WSString = tkoz::stl::SmallCString<wchar_t>;
+using CString = tkoz::stl::CString<char>;
+using tkoz::stl::usize_t;
+
+// default inline storage reuses the space of 2 pointers
+static_assert(SString::cInlineCapacity == 16);
+static_assert(sizeof(SString) == 24);
+static_assert(sizeof(WSString) == 24);
+static_assert(sizeof(SStringTiny) == 16);
+
+TEST_RUNNER_MAIN
+
+TEST_CASE_CREATE(testCtorDefault)
+{
+    SString s1;
+    TEST_ASSERT_TRUE(s1.isNull());
+    TEST_ASSERT_TRUE(s1.isInline());
+    TEST_ASSERT_EQ(s1.ptr(),nullptr);
+    TEST_ASSERT_EQ(s1.len(),0);
+    TEST_ASSERT_EQ(s1,nullptr);
+    TEST_ASSERT_NE(s1,"");
+    TEST_ASSERT_FALSE(s1);
+}
+
+TEST_CASE_CREATE(testCtorCstr)
+{
+    SString s1(nullptr);
+    TEST_ASSERT_TRUE(s1.isNull());
+
+    SString s2("");
+    TEST_ASSERT_FALSE(s2.isNull());
+    TEST_ASSERT_TRUE(s2.isInline());
+    TEST_ASSERT_NE(s2.ptr(),nullptr);
+    TEST_ASSERT_EQ(s2.len(),0);
+    TEST_ASSERT_EQ(s2,"");
+    TEST_ASSERT_EQ(s2.ptr()[0],'\0');
+
+    // longest inline string
+    SString s3("fifteen chars!!");
+    TEST_ASSERT_EQ(s3.len(),15);
+    TEST_ASSERT_TRUE(s3.isInline());
+    TEST_ASSERT_EQ(s3,"fifteen chars!!");
+    TEST_ASSERT_EQ(s3.ptr()[15],'\0');
+    const char *obj = reinterpret_cast<const char*>(&s3);
+    TEST_ASSERT_TRUE(s3.ptr() >= obj && s3.ptr() < obj + sizeof(s3));
+
+    // shortest heap string
+    SString s4("sixteen chars!!!");
+    TEST_ASSERT_EQ(s4.len(),16);
+    TEST_ASSERT_FALSE(s4.isInline());
+    TEST_ASSERT_EQ(s4,"sixteen chars!!!");
+    TEST_ASSERT_EQ(s4.ptr()[16],'\0');
+
+    SString s5("string",3);
+    TEST_ASSERT_EQ(s5.len(),3);
+    TEST_ASSERT_EQ(s5,"str");
+
+    SStringTiny s6("a");
+    TEST_ASSERT_FALSE(s6.isInline());
+    TEST_ASSERT_EQ(s6,"a");
+    SStringTiny s7("");
+    TEST_ASSERT_TRUE(s7.isInline());
+    TEST_ASSERT_EQ(s7,"");
+}
+
+TEST_CASE_CREATE(testCtorRepchar)
+{
+    SString s1(0,'0');
+    TEST_ASSERT_FALSE(s1.isNull());
+    TEST_ASSERT_EQ(s1,"");
+
+    SString s2(12,'_');
+    TEST_ASSERT_TRUE(s2.isInline());
+    TEST_ASSERT_EQ(s2.len(),12);
+    TEST_ASSERT_EQ(s2,"____________");
+
+    SString s3(100,'x');
+    TEST_ASSERT_FALSE(s3.isInline());
+    TEST_ASSERT_EQ(s3.len(),100);
+    TEST_ASSERT_EQ(s3,CString(100,'x').ptr());
+}
+
+TEST_CASE_CREATE(testCtorCString)
+{
+    SString s1{CString()};
+    TEST_ASSERT_TRUE(s1.isNull());
+    SString s2{CString("Hoshino")};
+    TEST_ASSERT_EQ(s2,"Hoshino");
+    TEST_ASSERT_EQ(s2.len(),7);
+    TEST_ASSERT_EQ(s2.toCString(),CString("Hoshino"));
+    TEST_ASSERT_TRUE(SString().toCString().isNull());
+}
+
+TEST_CASE_CREATE(testCopyMove)
+{
+    const char *values[] = {nullptr,"","Shiroko","a string long enough to be"
+        " allocated on the heap"};
+    for (const char *v : values)
+    {
+        SString s1(v);
+        SString s2(s1);
+        TEST_ASSERT_EQ(s1,s2);
+        TEST_ASSERT_EQ(s2.len(),s1.len());
+        if (v)
+            TEST_ASSERT_NE(s1.ptr(),s2.ptr());
+
+        SString s3(tkoz::stl::move(s2)); // s2 is now null
+        TEST_ASSERT_EQ(s3,s1);
+        TEST_ASSERT_TRUE(s2.isNull());
+
+        SString s4("previous value that is also long enough for the heap");
+        s4 = s3;
+        TEST_ASSERT_EQ(s4,s1);
+        s4 = s4;
+        TEST_ASSERT_EQ(s4,s1);
+
+        SString s5("short");
+        s5 = tkoz::stl::move(s4);
+        TEST_ASSERT_EQ(s5,s1);
+        TEST_ASSERT_EQ(s5.ptr() == nullptr,v == nullptr);
+    }
+}
+
+TEST_CASE_CREATE(testCompare)
+{
+    using so = std::strong_ordering;
+    TEST_ASSERT_EQ(SString("abc"),SString("abc"));
+    TEST_ASSERT_NE(SString("abc"),SString("abcd"));
+    TEST_ASSERT_NE(SString("abc"),SString("abd"));
+    TEST_ASSERT_NE(SString(),SString(""));
+    TEST_ASSERT_EQ(SString(),SString());
+    TEST_ASSERT_EQ(SString("abc") <=> SString("abd"),so::less);
+    TEST_ASSERT_EQ(SString("abc") <=> SString("ab"),so::greater);
+    TEST_ASSERT_EQ(SString() <=> SString(""),so::less);
+    TEST_ASSERT_EQ("abc" <=> SString("abc"),so::equal);
+    TEST_ASSERT_EQ(SString("b") <=> "abc",so::greater);
+    TEST_ASSERT_EQ("Arona",SString("Arona"));
+    TEST_ASSERT_NE(SString("Arona"),"Plana");
+    // longer heap strings compare the same way
+    SString s1("the same long string stored on the heap");
+    SString s2("the same long string stored on the heap");
+    TEST_ASSERT_EQ(s1,s2);
+    s2[5] = 'S';
+    TEST_ASSERT_GT(s1,s2);
+}
+
+TEST_CASE_CREATE(testConcat)
+{
+    SString s1;
+    s1 += nullptr;
+    TEST_ASSERT_TRUE(s1.isNull());
+    s1 += "";
+    TEST_ASSERT_FALSE(s1.isNull());
+    TEST_ASSERT_EQ(s1,"");
+    s1 += "Lycoris";
+    TEST_ASSERT_TRUE(s1.isInline());
+    TEST_ASSERT_EQ(s1,"Lycoris");
+    s1 += SString(" Recoil");
+    TEST_ASSERT_TRUE(s1.isInline());
+    TEST_ASSERT_EQ(s1,"Lycoris Recoil");
+    TEST_ASSERT_EQ(s1.len(),14);
+    s1 += s1;
+    TEST_ASSERT_FALSE(s1.isInline());
+    TEST_ASSERT_EQ(s1,"Lycoris RecoilLycoris Recoil");
+    TEST_ASSERT_EQ(s1.len(),28);
+    s1 += SString();
+    TEST_ASSERT_EQ(s1.len(),28);
+
+    TEST_ASSERT_TRUE((SString() + SString()).isNull());
+    TEST_ASSERT_EQ(SString() + "",SString(""));
+    TEST_ASSERT_EQ("Think" + SString("Pad"),"ThinkPad");
+    TEST_ASSERT_EQ(SString("Think") + "Pad","ThinkPad");
+    TEST_ASSERT_EQ(SString("some") + SString("thing"),"something");
+    SString s2 = SString("a longer string ") + "concatenated to another";
+    TEST_ASSERT_EQ(s2.len(),39);
+    TEST_ASSERT_EQ(s2,"a longer string concatenated to another");
+
+    SStringNoNull s3("no");
+    s3.append("null",4);
+    TEST_ASSERT_EQ(s3,"nonull");
+}
+
+TEST_CASE_CREATE(testSubscriptAt)
+{
+    SString s1("Mika");
+    TEST_ASSERT_EQ(s1[0],'M');
+    TEST_ASSERT_EQ(s1[4],'\0');
+    s1[0] = 'm';
+    TEST_ASSERT_EQ(s1,"mika");
+    TEST_ASSERT_EQ(s1.at(0),'m');
+    TEST_ASSERT_EQ(s1.at(4u),'\0');
+    TEST_ASSERT_EQ(s1.at(-1),'a');
+    TEST_ASSERT_EQ(s1.at(-4L),'m');
+    TEST_ASSERT_EQ(s1.at(true),'i');
+    TEST_EXCEPTION(s1.at(5),tkoz::stl::IndexError);
+    TEST_EXCEPTION(s1.at(-5),tkoz::stl::IndexError);
+    TEST_EXCEPTION(SString().at(0),tkoz::stl::NullError);
+    TEST_EXCEPTION(SString("").at(true),tkoz::stl::IndexError);
+    const SString s2("a heap allocated string for indexing");
+    TEST_ASSERT_EQ(s2.at(-1),'g');
+    TEST_ASSERT_EQ(s2[2],'h');
+    using tkoz::stl::meta::isSame;
+    static_assert(isSame<const char&,decltype(s2.at(0))>);
+    static_assert(isSame<char&,decltype(s1.at(0))>);
+}
+
+TEST_CASE_CREATE(testWide)
+{
+    // 4 byte wchar_t only fits 3 characters inline
+    WSString s1(L"wid");
+    TEST_ASSERT_TRUE(s1.isInline());
+    TEST_ASSERT_EQ(s1.len(),3);
+    WSString s2(L"wide");
+    TEST_ASSERT_FALSE(s2.isInline());
+    TEST_ASSERT_EQ(s2.len(),4);
+    TEST_ASSERT_EQ(s2,L"wide");
+    TEST_ASSERT_LT(s1,s2);
+}
@@ -0,0 +1,155 @@
+///
+/// unit tests for tkoz::stl::AhoCorasick (multiple pattern search)
+///
+
+#include <tkoz/Test.hpp>
+
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/CStringView.hpp>
+#include <tkoz/stl/Exceptions.hpp>
+#include <tkoz/stl/StringSearch.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+// instantiate template for accurate code coverage report
+template class tkoz::stl::AhoCorasick<char>;
+template class tkoz::stl::AhoCorasick<unsigned char>;
+
+using Matcher = tkoz::stl::AhoCorasick<char>;
+using View = tkoz::stl::CStringView<char>;
+using tkoz::stl::SearchMatch;
+using tkoz::stl::usize_t;
+
+// all occurrences by checking every pattern at every position
+static std::vector<SearchMatch> naiveFindAll(
+    const std::vector<std::string> &patterns, const std::string &text)
+{
+    std::vector<SearchMatch> ret;
+    for (usize_t p = 0; p < patterns.size(); ++p)
+        for (usize_t i = 0; i + patterns[p].size() <= text.size(); ++i)
+            if (text.compare(i,patterns[p].size(),patterns[p]) == 0)
+                ret.push_back({p,i,patterns[p].size()});
+    return ret;
+}
+
+// order by end position, then by pattern
+static void sortMatches(std::vector<SearchMatch> &matches)
+{
+    std::sort(matches.begin(),matches.end(),
+        [](const SearchMatch &a, const SearchMatch &b)
+        {
+            if (a.pos + a.len != b.pos + b.len)
+                return a.pos + a.len < b.pos + b.len;
+            return a.pattern < b.pattern;
+        });
+}
+
+TEST_RUNNER_MAIN
+
+TEST_CASE_CREATE(testBasic)
+{
+    const Matcher ac{"he","she","his","hers"};
+    TEST_ASSERT_EQ(ac.patternCount(),4);
+    TEST_ASSERT_EQ(ac.stateCount(),10);
+    // classes for e,h,i,r,s and everything else
+    TEST_ASSERT_EQ(ac.classCount(),6);
+    const std::vector<SearchMatch> m = ac.findAll("ushers");
+    TEST_ASSERT_EQ(m.size(),3);
+    // longer pattern first at the same end position
+    TEST_ASSERT_EQ(m[0],(SearchMatch{1,1,3}));
+    TEST_ASSERT_EQ(m[1],(SearchMatch{0,2,2}));
+    TEST_ASSERT_EQ(m[2],(SearchMatch{3,2,4}));
+    TEST_ASSERT_EQ(ac.countMatches("ushers his hers"),6);
+    TEST_ASSERT_TRUE(ac.containsAny("this"));
+    TEST_ASSERT_FALSE(ac.containsAny("ash rot"));
+    TEST_ASSERT_FALSE(ac.containsAny(View()));
+    const SearchMatch first = ac.findFirst("a fishery");
+    TEST_ASSERT_EQ(first,(SearchMatch{1,4,3}));
+    TEST_ASSERT_EQ(ac.findFirst("none").pattern,Matcher::npos);
+    TEST_ASSERT_GT(ac.memoryUsage(),10*6*sizeof(uint32_t));
+}
+
+TEST_CASE_CREATE(testInputTypes)
+{
+    const tkoz::stl::CString<char> p1("needle");
+    const std::vector<View> patterns{p1,View("hay"),View("stack",3)};
+    const Matcher ac(patterns);
+    const tkoz::stl::CString<char> text("haystack with a needle");
+    TEST_ASSERT_EQ(ac.countMatches(text),3);
+    TEST_ASSERT_EQ(ac.countMatches(View(text).substr(3)),2);
+    const tkoz::stl::AhoCorasick<unsigned char> uac{
+        tkoz::stl::CStringView<unsigned char>(
+            reinterpret_cast<const unsigned char*>("\xff\x80"),2)};
+    const unsigned char bytes[] = {0x7f,0xff,0x80,0xff,0x80};
+    TEST_ASSERT_EQ(uac.countMatches({bytes,5}),2);
+}
+
+TEST_CASE_CREATE(testEarlyStop)
+{
+    const Matcher ac{"a","aa"};
+    usize_t calls = 0;
+    const bool done = ac.forEachMatch("aaaa",[&calls](const SearchMatch&)
+    {
+        return ++calls < 3;
+    });
+    TEST_ASSERT_FALSE(done);
+    TEST_ASSERT_EQ(calls,3);
+    TEST_ASSERT_TRUE(ac.forEachMatch("bab",[](const SearchMatch&) {}));
+}
+
+TEST_CASE_CREATE(testDuplicatesAndErrors)
+{
+    const Matcher ac{"ab","ab","b"};
+    std::vector<SearchMatch> m = ac.findAll("abab");
+    TEST_ASSERT_EQ(m.size(),6);
+    sortMatches(m);
+    TEST_ASSERT_EQ(m[0],(SearchMatch{0,0,2}));
+    TEST_ASSERT_EQ(m[1],(SearchMatch{1,0,2}));
+    TEST_ASSERT_EQ(m[2],(SearchMatch{2,1,1}));
+    TEST_EXCEPTION(Matcher({"a",""}),tkoz::stl::ArgumentError);
+    // no patterns matches nothing
+    const Matcher none(nullptr,0);
+    TEST_ASSERT_EQ(none.countMatches("anything"),0);
+    TEST_ASSERT_EQ(none.stateCount(),1);
+}
+
+TEST_CASE_CREATE(testRandom)
+{
+    std::mt19937 rng(10);
+    for (int trial = 0; trial < 300; ++trial)
+    {
+        // small alphabet (including null and high bytes) for many overlaps
+        const char alpha[] = {'a','b','c','\0','\xff'};
+        const usize_t alphaSize = trial % 3 ? 3 : 5;
+        std::vector<std::string> patterns(1 + rng() % 40);
+        for (std::string &p : patterns)
+            for (usize_t i = 0, l = 1 + rng() % 6; i < l; ++i)
+                p.push_back(alpha[rng() % alphaSize]);
+        std::vector<View> views;
+        for (const std::string &p : patterns)
+            views.push_back(View(p.data(),p.size()));
+        const Matcher ac(views);
+        for (int t = 0; t < 10; ++t)
+        {
+            std::string text;
+            for (usize_t i = 0, l = rng() % 200; i < l; ++i)
+                text.push_back(alpha[rng() % alphaSize]);
+            std::vector<SearchMatch> expected = naiveFindAll(patterns,text);
+            std::vector<SearchMatch> actual =
+                ac.findAll(View(text.data(),text.size()));
+            // end positions must already be in order
+            for (usize_t i = 1; i < actual.size(); ++i)
+                TEST_ASSERT_LE(actual[i-1].pos + actual[i-1].len,
+                    actual[i].pos + actual[i].len);
+            sortMatches(expected);
+            sortMatches(actual);
+            TEST_ASSERT_TRUE(actual == expected);
+            TEST_ASSERT_EQ(ac.containsAny(View(text.data(),text.size())),
+                !expected.empty());
+        }
+    }
+}
@@ -0,0 +1,227 @@
+///
+/// unit tests for tkoz::stl string sorting
+///
+
+#include <tkoz/Test.hpp>
+
+#include <tkoz/stl/Allocator.hpp>
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/CStringView.hpp>
+#include <tkoz/stl/StringSort.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+using CString = tkoz::stl::CString<char>;
+using View = tkoz::stl::CStringView<char>;
+using tkoz::stl::usize_t;
+
+// instantiate template for accurate code coverage report
+template void tkoz::stl::msdRadixSort(const char**, usize_t);
+template void tkoz::stl::multikeyQuicksort(const char**, usize_t);
+template void tkoz::stl::stringSort(View*, usize_t);
+template void tkoz::stl::parallelStringSort(
+    tkoz::stl::CString<char>*, usize_t, usize_t);
+
+static_assert(tkoz::stl::concepts::isSortableString<const char*>);
+static_assert(tkoz::stl::concepts::isSortableString<char8_t*>);
+static_assert(tkoz::stl::concepts::isSortableString<CString>);
+static_assert(tkoz::stl::concepts::isSortableString<
+    tkoz::stl::CString<wchar_t,false>>);
+static_assert(tkoz::stl::concepts::isSortableString<View>);
+static_assert(!tkoz::stl::concepts::isSortableString<int>);
+static_assert(!tkoz::stl::concepts::isSortableString<std::string>);
+
+// random strings with long shared prefixes and all byte values
+static std::vector<std::string> randomStrings(std::mt19937 &rng,
+    const usize_t n, const bool allBytes)
+{
+    std::vector<std::string> ret(n);
+    const std::string prefixes[] = {"","a","aaaaaaaa","abcabcabcabcabcabc",
+        std::string(300,'z')};
+    for (std::string &s : ret)
+    {
+        s = prefixes[rng() % 5];
+        for (usize_t i = 0, l = rng() % 8; i < l; ++i)
+            s.push_back(allBytes ? static_cast<char>(1 + rng() % 255)
+                : static_cast<char>('a' + rng() % 3));
+    }
+    return ret;
+}
+
+// apply a sort to C string pointers and compare with std::sort
+template <typename SortFunc>
+static void checkPointers(SortFunc sortFunc, const int seed)
+{
+    std::mt19937 rng(seed);
+    for (usize_t n : {0,1,2,15,16,63,64,500,5000,30000})
+    {
+        const std::vector<std::string> strs = randomStrings(rng,n,n % 2);
+        std::vector<const char*> ptrs;
+        for (const std::string &s : strs)
+            ptrs.push_back(s.c_str());
+        std::vector<const char*> expected = ptrs;
+        std::sort(expected.begin(),expected.end(),
+            [](const char *a, const char *b)
+            { return CString::ptrCmpLt(a,b); });
+        sortFunc(ptrs.data(),ptrs.size());
+        for (usize_t i = 0; i < n; ++i)
+            TEST_ASSERT_TRUE(CString::ptrCmpEq(ptrs[i],expected[i]));
+    }
+}
+
+TEST_RUNNER_MAIN
+
+TEST_CASE_CREATE(testPointers)
+{
+    checkPointers([](const char **a, usize_t n)
+        { tkoz::stl::msdRadixSort(a,n); },1);
+    checkPointers([](const char **a, usize_t n)
+        { tkoz::stl::multikeyQuicksort(a,n); },2);
+    checkPointers([](const char **a, usize_t n)
+        { tkoz::stl::stringSort(a,n); },3);
+    checkPointers([](const char **a, usize_t n)
+        { tkoz::stl::parallelStringSort(a,n,4); },4);
+    checkPointers([](const char **a, usize_t n)
+        { tkoz::stl::parallelStringSort(a,n,3); },5);
+    // null pointers are first
+    const char *p[] = {"b",nullptr,"a",nullptr,""};
+    tkoz::stl::stringSort(p,5);
+    TEST_ASSERT_EQ(p[0],nullptr);
+    TEST_ASSERT_EQ(p[1],nullptr);
+    TEST_ASSERT_TRUE(CString::ptrCmpEq(p[2],""));
+    TEST_ASSERT_TRUE(CString::ptrCmpEq(p[4],"b"));
+}
+
+TEST_CASE_CREATE(testSignedOrder)
+{
+    // high bytes are negative chars and come before the null terminator
+    const char *p[] = {"a","a\xff","a\x01","\x80",""};
+    tkoz::stl::msdRadixSort(p,5);
+    TEST_ASSERT_TRUE(CString::ptrCmpEq(p[0],"\x80"));
+    TEST_ASSERT_TRUE(CString::ptrCmpEq(p[1],""));
+    TEST_ASSERT_TRUE(CString::ptrCmpEq(p[2],"a\xff"));
+    TEST_ASSERT_TRUE(CString::ptrCmpEq(p[3],"a"));
+    TEST_ASSERT_TRUE(CString::ptrCmpEq(p[4],"a\x01"));
+    const unsigned char *u[] = {
+        reinterpret_cast<const unsigned char*>("a\xff"),
+        reinterpret_cast<const unsigned char*>("a")};
+    tkoz::stl::multikeyQuicksort(u,2);
+    TEST_ASSERT_EQ(u[0][1],0);
+}
+
+TEST_CASE_CREATE(testCString)
+{
+    std::mt19937 rng(6);
+    const std::vector<std::string> strs = randomStrings(rng,20000,true);
+    std::vector<CString> a;
+    for (const std::string &s : strs)
+        a.emplace_back(s.c_str());
+    // null strings spread through the array
+    for (usize_t i = 0; i < 50; ++i)
+        a.emplace(a.begin() + static_cast<tkoz::stl::ssize_t>(rng() % a.size()));
+    // sort pointers (std::sort on CString finds std::swap and stl::swap)
+    std::vector<const char*> expected;
+    for (const CString &s : a)
+        expected.push_back(s.ptr());
+    std::sort(expected.begin(),expected.end(),
+        [](const char *x, const char *y) { return CString::ptrCmpLt(x,y); });
+    std::vector<CString> b = a;
+    std::vector<CString> c = a;
+    tkoz::stl::stringSort(a.data(),a.size());
+    tkoz::stl::multikeyQuicksort(b.data(),b.size());
+    tkoz::stl::parallelStringSort(c.data(),c.size(),8);
+    for (usize_t i = 0; i < 50; ++i)
+        TEST_ASSERT_TRUE(a[i].isNull());
+    TEST_ASSERT_FALSE(a[50].isNull());
+    for (usize_t i = 0; i < a.size(); ++i)
+    {
+        TEST_ASSERT_EQ(a[i],expected[i]);
+        TEST_ASSERT_EQ(b[i],expected[i]);
+        TEST_ASSERT_EQ(c[i],expected[i]);
+    }
+    // allocator aware strings are swapped with their allocators
+    tkoz::stl::Pool pool;
+    using PoolString = tkoz::stl::CString<char,false,
+        tkoz::stl::PoolAllocator<char>>;
+    std::vector<PoolString> d;
+    for (const char *s : {"pear","apple","fig"})
+        d.emplace_back(s,tkoz::stl::PoolAllocator<char>(pool));
+    tkoz::stl::stringSort(d.data(),d.size());
+    TEST_ASSERT_EQ(d[0],"apple");
+    TEST_ASSERT_EQ(d[2],"pear");
+}
+
+TEST_CASE_CREATE(testViews)
+{
+    std::mt19937 rng(7);
+    // views with embedded nulls and prefixes of each other
+    std::string text;
+    for (usize_t i = 0; i < 100000; ++i)
+        text.push_back("ab\0\xff"[rng() % 4]);
+    std::vector<View> views;
+    for (usize_t i = 0; i < 20000; ++i)
+        views.emplace_back(text.data() + rng() % 50000,rng() % 30);
+    views.emplace_back();
+    std::vector<usize_t> order(views.size());
+    for (usize_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::sort(order.begin(),order.end(),
+        [&views](usize_t x, usize_t y) { return views[x] < views[y]; });
+    std::vector<View> expected;
+    for (usize_t i : order)
+        expected.push_back(views[i]);
+    std::vector<View> a = views, b = views, c = views;
+    tkoz::stl::msdRadixSort(a.data(),a.size());
+    tkoz::stl::multikeyQuicksort(b.data(),b.size());
+    tkoz::stl::parallelStringSort(c.data(),c.size(),5);
+    for (usize_t i = 0; i < views.size(); ++i)
+    {
+        TEST_ASSERT_EQ(a[i],expected[i]);
+        TEST_ASSERT_EQ(b[i],expected[i]);
+        TEST_ASSERT_EQ(c[i],expected[i]);
+    }
+}
+
+TEST_CASE_CREATE(testWide)
+{
+    std::mt19937 rng(8);
+    std::vector<std::wstring> strs(3000);
+    for (std::wstring &s : strs)
+        for (usize_t i = 0, l = rng() % 6; i < l; ++i)
+            s.push_back(static_cast<wchar_t>(rng() % 2 ? -5 + rng() % 10
+                : 0x10000 + rng() % 3));
+    std::vector<const wchar_t*> a;
+    for (const std::wstring &s : strs)
+        a.push_back(s.c_str());
+    std::vector<const wchar_t*> b = a;
+    tkoz::stl::stringSort(a.data(),a.size());
+    tkoz::stl::parallelStringSort(b.data(),b.size(),4);
+    for (usize_t i = 1; i < a.size(); ++i)
+        TEST_ASSERT_TRUE(tkoz::stl::CString<wchar_t>::ptrCmpLe(a[i-1],a[i]));
+    for (usize_t i = 0; i < a.size(); ++i)
+        TEST_ASSERT_TRUE(tkoz::stl::CString<wchar_t>::ptrCmpEq(a[i],b[i]));
+}
+
+TEST_CASE_CREATE(testLongPrefix)
+{
+    // deep common prefixes must not recurse per character
+    std::vector<std::string> strs;
+    for (usize_t i = 0; i < 3000; ++i)
+        strs.push_back(std::string(i,'q'));
+    std::shuffle(strs.begin(),strs.end(),std::mt19937(9));
+    std::vector<const char*> a;
+    for (const std::string &s : strs)
+        a.push_back(s.c_str());
+    std::vector<const char*> b = a;
+    tkoz::stl::msdRadixSort(a.data(),a.size());
+    tkoz::stl::multikeyQuicksort(b.data(),b.size());
+    for (usize_t i = 0; i < a.size(); ++i)
+    {
+        TEST_ASSERT_EQ(CString::ptrLen(a[i]),i);
+        TEST_ASSERT_EQ(CString::ptrLen(b[i]),i);
+    }
+}
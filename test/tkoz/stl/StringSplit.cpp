@@ -0,0 +1,152 @@
+///
+/// unit tests for tkoz::stl split and tokenize ranges
+///
+
+#include <tkoz/Test.hpp>
+
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/CStringSimd.hpp>
+#include <tkoz/stl/CStringView.hpp>
+#include <tkoz/stl/Exceptions.hpp>
+#include <tkoz/stl/SmallCString.hpp>
+#include <tkoz/stl/StringSplit.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <ranges>
+#include <string>
+#include <vector>
+
+using View = tkoz::stl::CStringView<char>;
+using CString = tkoz::stl::CString<char>;
+using tkoz::stl::split;
+using tkoz::stl::tokenize;
+using tkoz::stl::usize_t;
+using tkoz::stl::simd::ByteSet;
+
+// instantiate template for accurate code coverage report
+template class tkoz::stl::SplitRange<char,
+    tkoz::stl::_detail::_SplitChar<char>,false>;
+template class tkoz::stl::SplitRange<char,
+    tkoz::stl::_detail::_SplitString<char>,true>;
+template class tkoz::stl::SplitRange<char,
+    tkoz::stl::_detail::_SplitByteSet<char>,false>;
+template class tkoz::stl::SplitRange<wchar_t,
+    tkoz::stl::_detail::_SplitChar<wchar_t>,true>;
+
+using CharSplit = decltype(split(View(),','));
+static_assert(std::ranges::forward_range<CharSplit>);
+static_assert(std::ranges::view<CharSplit>);
+static_assert(std::forward_iterator<CharSplit::Iterator>);
+
+// collect fields as std::string
+template <typename RangeType>
+static std::vector<std::string> fields(const RangeType &range)
+{
+    std::vector<std::string> ret;
+    for (View f : range)
+        ret.emplace_back(f.ptr(),f.len());
+    return ret;
+}
+
+TEST_RUNNER_MAIN
+
+TEST_CASE_CREATE(testSplitChar)
+{
+    const CString line("id,name,,score,");
+    const auto range = split(line,',');
+    TEST_ASSERT_TRUE((fields(range) ==
+        std::vector<std::string>{"id","name","","score",""}));
+    TEST_ASSERT_EQ(range.count(),5);
+    // fields point into the original string
+    auto it = range.begin();
+    ++it;
+    TEST_ASSERT_EQ((*it).ptr(),line.ptr()+3);
+    TEST_ASSERT_EQ(it.pos(),3);
+    TEST_ASSERT_TRUE(fields(split(View(""),',')) ==
+        std::vector<std::string>{""});
+    TEST_ASSERT_TRUE(fields(split(View(),',')) ==
+        std::vector<std::string>{""});
+    TEST_ASSERT_TRUE((fields(split(View(","),',')) ==
+        std::vector<std::string>{"",""}));
+    TEST_ASSERT_TRUE((fields(tokenize(line,',')) ==
+        std::vector<std::string>{"id","name","score"}));
+    TEST_ASSERT_EQ(tokenize(View(",,,"),',').count(),0);
+    TEST_ASSERT_TRUE(tokenize(View(""),',').empty());
+    const tkoz::stl::SmallCString<char> small("a b");
+    TEST_ASSERT_EQ(split(small,' ').count(),2);
+    const wchar_t *w = L"x;yy;;z";
+    TEST_ASSERT_EQ(tokenize(tkoz::stl::CStringView<wchar_t>(w),L';').count(),
+        3);
+}
+
+TEST_CASE_CREATE(testSplitString)
+{
+    const View text("a::b:c::::d::");
+    TEST_ASSERT_TRUE((fields(split(text,"::")) ==
+        std::vector<std::string>{"a","b:c","","d",""}));
+    TEST_ASSERT_TRUE((fields(tokenize(text,"::")) ==
+        std::vector<std::string>{"a","b:c","d"}));
+    // non overlapping from the left
+    TEST_ASSERT_TRUE((fields(split(View("aaaaa"),"aa")) ==
+        std::vector<std::string>{"","","a"}));
+    TEST_EXCEPTION(split(text,""),tkoz::stl::ArgumentError);
+    TEST_EXCEPTION(tokenize(text,View()),tkoz::stl::ArgumentError);
+}
+
+TEST_CASE_CREATE(testSplitByteSet)
+{
+    const View text("  the quick\tbrown\n\nfox ");
+    TEST_ASSERT_TRUE((fields(tokenize(text,ByteSet::whitespace())) ==
+        std::vector<std::string>{"the","quick","brown","fox"}));
+    TEST_ASSERT_EQ(split(text,ByteSet::whitespace()).count(),8);
+    ByteSet digits;
+    digits.addRange('0','9');
+    TEST_ASSERT_TRUE((fields(tokenize(View("ab12cd3e"),digits)) ==
+        std::vector<std::string>{"ab","cd","e"}));
+}
+
+TEST_CASE_CREATE(testAlgorithms)
+{
+    const View text("3,1,4,1,5,9,2,6");
+    const auto range = split(text,',');
+    TEST_ASSERT_EQ(std::ranges::distance(range),8);
+    TEST_ASSERT_EQ(std::ranges::count(range,View("1")),2);
+    const auto it = std::ranges::find(range,View("9"));
+    TEST_ASSERT_EQ(it.pos(),10);
+    TEST_ASSERT_EQ(range.front(),"3");
+    usize_t sum = 0;
+    for (View f : range | std::views::take(3))
+        sum += static_cast<usize_t>(f[0] - '0');
+    TEST_ASSERT_EQ(sum,8);
+    std::vector<View> all(range.begin(),range.end());
+    TEST_ASSERT_EQ(all.size(),8);
+    TEST_ASSERT_EQ(all.back(),"6");
+}
+
+TEST_CASE_CREATE(testRandom)
+{
+    std::mt19937 rng(11);
+    const ByteSet set(",;");
+    for (int trial = 0; trial < 2000; ++trial)
+    {
+        std::string text;
+        for (usize_t i = 0, n = rng() % 300; i < n; ++i)
+            text.push_back(",;ab"[rng() % (trial % 2 ? 4 : 3)]);
+        const View view(text.data(),text.size());
+        // expected fields by scanning characters
+        std::vector<std::string> expected(1);
+        for (char c : text)
+        {
+            if (c == ',' || c == ';')
+                expected.emplace_back();
+            else
+                expected.back().push_back(c);
+        }
+        TEST_ASSERT_TRUE(fields(split(view,set)) == expected);
+        std::erase(expected,std::string());
+        TEST_ASSERT_TRUE(fields(tokenize(view,set)) == expected);
+    }
+}
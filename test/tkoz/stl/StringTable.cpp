@@ -0,0 +1,170 @@
+///
+/// unit tests for tkoz::stl::StringTable
+///
+
+#include <tkoz/Test.hpp>
+
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/CStringView.hpp>
+#include <tkoz/stl/Exceptions.hpp>
+#include <tkoz/stl/StringTable.hpp>
+#include <tkoz/stl/Types.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <iterator>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+using Table = tkoz::stl::StringTable<char>;
+using View = tkoz::stl::CStringView<char>;
+using CString = tkoz::stl::CString<char>;
+using tkoz::stl::usize_t;
+using tkoz::stl::uint64_t;
+
+// instantiate template for accurate code coverage report
+template class tkoz::stl::StringTable<char>;
+template class tkoz::stl::StringTable<char32_t>;
+
+static_assert(std::random_access_iterator<Table::Iterator>);
+
+// C strings that can only be read once
+struct SinglePassRange
+{
+    struct Iterator
+    {
+        using iterator_concept = std::input_iterator_tag;
+        using value_type = const char*;
+        using difference_type = std::ptrdiff_t;
+        const char * const *p;
+        const char* operator*() const { return *p; }
+        Iterator& operator++() { ++p; return *this; }
+        void operator++(int) { ++p; }
+    };
+    const char * const *first;
+    const char * const *last;
+    Iterator begin() const { return Iterator{first}; }
+    const char * const *end() const { return last; }
+};
+
+inline bool operator==(const SinglePassRange::Iterator &it,
+    const char * const *end)
+{
+    return it.p == end;
+}
+
+template <typename RangeType>
+concept Encodable = requires (const RangeType &strs) { Table::encode(strs); };
+
+// encoding reads the strings twice, so single pass ranges are rejected
+static_assert(std::ranges::input_range<const SinglePassRange>);
+static_assert(!std::ranges::forward_range<const SinglePassRange>);
+static_assert(!Encodable<SinglePassRange>);
+static_assert(Encodable<std::vector<const char*>>);
+
+// temporary file path for this process
+static std::string tempPath(const char *name)
+{
+    return "/tmp/tkoz_" + std::to_string(getpid()) + "_" + name;
+}
+
+TEST_RUNNER_MAIN
+
+TEST_CASE_CREATE(testMemory)
+{
+    const std::vector<CString> strs = {CString("alpha"),CString(""),
+        CString("gamma"),CString("delta epsilon")};
+    const std::vector<uint64_t> data = Table::encode(strs);
+    const Table table(data.data(),data.size() * 8);
+    TEST_ASSERT_EQ(table.size(),4);
+    TEST_ASSERT_EQ(table[0],"alpha");
+    TEST_ASSERT_EQ(table[1].len(),0);
+    TEST_ASSERT_EQ(table.at(3),"delta epsilon");
+    TEST_EXCEPTION(table.at(4),tkoz::stl::IndexError);
+    // entries are null-terminated C strings
+    TEST_ASSERT_TRUE(CString::ptrCmpEq(table[2].ptr(),"gamma"));
+    TEST_ASSERT_EQ(table[2].len(),CString::ptrLen(table[2].ptr()));
+    table.validate();
+    std::vector<View> views(table.begin(),table.end());
+    TEST_ASSERT_EQ(views.size(),4);
+    TEST_ASSERT_EQ(table.end() - table.begin(),4);
+    TEST_ASSERT_EQ(table.begin()[3],"delta epsilon");
+    TEST_ASSERT_EQ(*std::ranges::find(table,View("gamma")),"gamma");
+    // empty table
+    const std::vector<View> none;
+    const std::vector<uint64_t> empty = Table::encode(none);
+    const Table t0(empty.data(),empty.size() * 8);
+    TEST_ASSERT_TRUE(t0.empty());
+    TEST_ASSERT_TRUE(t0.begin() == t0.end());
+    const Table t1;
+    TEST_ASSERT_EQ(t1.size(),0);
+    // wide characters
+    const char32_t *wide[] = {U"\U0001F600x",U"y"};
+    const std::vector<uint64_t> wdata =
+        tkoz::stl::StringTable<char32_t>::encode(wide);
+    const tkoz::stl::StringTable<char32_t> wt(wdata.data(),wdata.size() * 8);
+    TEST_ASSERT_EQ(wt[0].len(),2);
+    TEST_ASSERT_EQ(wt[1][0],U'y');
+}
+
+TEST_CASE_CREATE(testFormatErrors)
+{
+    const char *strs[] = {"a","bc"};
+    std::vector<uint64_t> data = Table::encode(strs);
+    TEST_EXCEPTION(Table(data.data(),16),tkoz::stl::FormatError);
+    TEST_EXCEPTION(Table(data.data(),40),tkoz::stl::FormatError);
+    TEST_EXCEPTION(tkoz::stl::StringTable<char16_t>(data.data(),
+        data.size() * 8),tkoz::stl::FormatError);
+    std::vector<uint64_t> bad = data;
+    reinterpret_cast<char*>(bad.data())[0] = 'X';
+    TEST_EXCEPTION(Table(bad.data(),bad.size() * 8),tkoz::stl::FormatError);
+    bad = data;
+    bad[2] = 1000000; // count
+    TEST_EXCEPTION(Table(bad.data(),bad.size() * 8),tkoz::stl::FormatError);
+    bad = data;
+    bad[5] = 1; // first string without its terminator
+    const Table corrupt(bad.data(),bad.size() * 8);
+    TEST_EXCEPTION(corrupt.validate(),tkoz::stl::FormatError);
+}
+
+TEST_CASE_CREATE(testFile)
+{
+    std::mt19937 rng(15);
+    std::vector<std::string> strs(50000);
+    for (std::string &s : strs)
+        for (usize_t i = 0, l = rng() % 40; i < l; ++i)
+            s.push_back(static_cast<char>(1 + rng() % 255));
+    std::vector<View> views;
+    for (const std::string &s : strs)
+        views.emplace_back(s.c_str());
+    const std::string path = tempPath("table.bin");
+    Table::write(path.c_str(),views);
+    {
+        Table table(path.c_str());
+        TEST_ASSERT_EQ(table.size(),strs.size());
+        table.validate();
+        for (usize_t i = 0; i < strs.size(); ++i)
+            TEST_ASSERT_EQ(table[i],views[i]);
+        Table moved = std::move(table);
+        TEST_ASSERT_TRUE(table.empty());
+        TEST_ASSERT_EQ(moved[777],views[777]);
+        TEST_ASSERT_GT(moved.bytes(),50000 * 9);
+    }
+    // a file that is not a table
+    std::FILE *f = std::fopen(path.c_str(),"wb");
+    std::fputs("not a string table, but longer than its header",f);
+    std::fclose(f);
+    TEST_EXCEPTION(Table(path.c_str()),tkoz::stl::FormatError);
+    f = std::fopen(path.c_str(),"wb");
+    std::fclose(f);
+    TEST_EXCEPTION(Table(path.c_str()),tkoz::stl::FormatError);
+    std::remove(path.c_str());
+    TEST_EXCEPTION(Table(path.c_str()),tkoz::stl::IOError);
+    TEST_EXCEPTION(Table::write("/nonexistent/dir/table.bin",views),
+        tkoz::stl::IOError);
+}
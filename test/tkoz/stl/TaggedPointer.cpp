@@ -0,0 +1,156 @@
+///
+/// unit tests for tkoz::stl::TaggedPointer
+///
+
+#include <tkoz/Test.hpp>
+
+#include <tkoz/stl/TaggedPointer.hpp>
+#include <tkoz/stl/Types.hpp>
+
+namespace stl = tkoz::stl;
+using stl::uint64_t;
+
+struct alignas(16) Node
+{
+    int value;
+};
+
+// self referential nodes (Type is incomplete where the class is used)
+struct ListNode
+{
+    stl::TaggedPointer<ListNode> next;
+    int value;
+};
+
+struct ListNode2
+{
+    stl::TaggedPointer<ListNode2,2> next;
+    int value;
+};
+
+using TP = stl::TaggedPointer<Node>;
+using TP57 = stl::TaggedPointer<Node,2,57>;
+using TPInt = stl::TaggedPointer<int>;
+using TPVoid = stl::TaggedPointer<void>;
+
+// instantiate template for accurate code coverage report
+template class stl::TaggedPointer<Node>;
+template class stl::TaggedPointer<Node,2,57>;
+template class stl::TaggedPointer<void>;
+
+static_assert(sizeof(TP) == 8 && sizeof(TP57) == 8);
+static_assert(TP::cHighBits == 16 && TP::cLowBits == 4);
+static_assert(TP57::cHighBits == 7 && TP57::cLowBits == 2);
+static_assert(TPInt::cLowBits == 2 && TPVoid::cLowBits == 0);
+static_assert(stl::TaggedPointer<char>::cLowBits == 0);
+static_assert(stl::TaggedPointer<double,1>::cMaxLowTag == 1);
+static_assert(TP::cAddressMask == 0xFFFFFFFFFFF0ull);
+static_assert(TP57::cAddressMask == 0x1FFFFFFFFFFFFFCull);
+static_assert(sizeof(ListNode) == 16);
+static_assert(stl::TaggedPointer<ListNode>::cLowBits == 3);
+static_assert(stl::TaggedPointer<ListNode2,2>::cLowBits == 2);
+
+TEST_RUNNER_MAIN
+
+TEST_CASE_CREATE(testTags)
+{
+    Node nodes[4];
+    nodes[1].value = 7;
+    TP p(nodes + 1,0xBEEF,9);
+    TEST_ASSERT_TRUE(p.ptr() == nodes + 1);
+    TEST_ASSERT_EQ(p.highTag(),0xBEEF);
+    TEST_ASSERT_EQ(p.lowTag(),9);
+    TEST_ASSERT_EQ(p->value,7);
+    TEST_ASSERT_EQ((*p).value,7);
+    TEST_ASSERT_TRUE(static_cast<Node*>(p) == nodes + 1);
+    // setters leave the other fields alone
+    p.setHighTag(0xFFFF);
+    TEST_ASSERT_TRUE(p.ptr() == nodes + 1);
+    TEST_ASSERT_EQ(p.lowTag(),9);
+    p.setLowTag(0xF);
+    TEST_ASSERT_EQ(p.highTag(),0xFFFF);
+    p.setPtr(nodes + 3);
+    TEST_ASSERT_TRUE(p.ptr() == nodes + 3);
+    TEST_ASSERT_EQ(p.highTag(),0xFFFF);
+    TEST_ASSERT_EQ(p.lowTag(),0xF);
+    // version counter wraps around
+    p.setHighTag(static_cast<TP::HighTagType>(p.highTag() + 1));
+    TEST_ASSERT_EQ(p.highTag(),0);
+    TEST_ASSERT_TRUE(p.ptr() == nodes + 3);
+    // low tag is truncated
+    p.setLowTag(0x13);
+    TEST_ASSERT_EQ(p.lowTag(),3);
+    TEST_ASSERT_TRUE(p.ptr() == nodes + 3);
+    // raw representation
+    TEST_ASSERT_TRUE(TP::fromBits(p.bits()) == p);
+    TEST_ASSERT_EQ(p.bits(),reinterpret_cast<uint64_t>(nodes + 3) | 3);
+    TEST_ASSERT_FALSE(TP(nodes + 3) == p);
+    TEST_ASSERT_TRUE(TP(nodes + 3,0,3) == p);
+}
+
+TEST_CASE_CREATE(testNull)
+{
+    const TP n;
+    TEST_ASSERT_FALSE(n);
+    TEST_ASSERT_EQ(n.bits(),0);
+    TEST_ASSERT_TRUE(n.ptr() == nullptr);
+    // tags do not make the pointer non null
+    const TP t(nullptr,5,1);
+    TEST_ASSERT_FALSE(t);
+    TEST_ASSERT_TRUE(t.ptr() == nullptr);
+    TEST_ASSERT_EQ(t.highTag(),5);
+    TEST_ASSERT_EQ(t.lowTag(),1);
+    TEST_ASSERT_FALSE(t == n);
+    int x = 0;
+    TEST_ASSERT_TRUE(static_cast<bool>(TPInt(&x)));
+    TEST_ASSERT_TRUE(TPVoid(&x).ptr() == &x);
+}
+
+TEST_CASE_CREATE(testFits)
+{
+    Node node;
+    TEST_ASSERT_TRUE(TP::fits(&node));
+    TEST_ASSERT_TRUE(TP::fits(nullptr));
+    Node *misaligned = reinterpret_cast<Node*>(
+        reinterpret_cast<stl::uchar_t*>(&node) + 4);
+    TEST_ASSERT_FALSE(TP::fits(misaligned));
+    TEST_ASSERT_TRUE(TP57::fits(misaligned));
+    // address above 48 bits (not dereferenced)
+    Node *high = reinterpret_cast<Node*>(0x10000000000000ull);
+    TEST_ASSERT_FALSE(TP::fits(high));
+    TEST_ASSERT_TRUE(TP57::fits(high));
+    const TP57 p(high,0x7F,3);
+    TEST_ASSERT_TRUE(p.ptr() == high);
+    TEST_ASSERT_EQ(p.highTag(),0x7F);
+    TEST_ASSERT_EQ(p.lowTag(),3);
+    // high tag is truncated to 7 bits
+    const TP57 q(high,0xFF,0);
+    TEST_ASSERT_EQ(q.highTag(),0x7F);
+    TEST_ASSERT_TRUE(q.ptr() == high);
+}
+
+TEST_CASE_CREATE(testSelfReferential)
+{
+    ListNode nodes[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        nodes[i].value = i;
+        nodes[i].next = stl::TaggedPointer<ListNode>(
+            i < 2 ? nodes + i + 1 : nullptr,static_cast<stl::ushort_t>(i),7);
+    }
+    int sum = 0;
+    int count = 0;
+    for (const ListNode *n = nodes; n; n = n->next.ptr())
+    {
+        sum += n->value + n->next.highTag();
+        TEST_ASSERT_EQ(n->next.lowTag(),7);
+        ++count;
+    }
+    TEST_ASSERT_EQ(count,3);
+    TEST_ASSERT_EQ(sum,6);
+    ListNode2 a{{},1};
+    ListNode2 b{{&a,0,3},2};
+    TEST_ASSERT_EQ(b.next->value,1);
+    TEST_ASSERT_EQ(b.next.lowTag(),3);
+    TEST_ASSERT_FALSE(a.next);
+}
@@ -0,0 +1,208 @@
+///
+/// unit tests for tkoz::stl::utf
+///
+
+#include <tkoz/Test.hpp>
+
+#include <tkoz/stl/CString.hpp>
+#include <tkoz/stl/Exceptions.hpp>
+#include <tkoz/stl/Simd.hpp>
+#include <tkoz/stl/Types.hpp>
+#include <tkoz/stl/Utf.hpp>
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace utf = tkoz::stl::utf;
+namespace simd = tkoz::stl::simd;
+using tkoz::stl::CString;
+using tkoz::stl::usize_t;
+
+static const simd::SimdLevel levels[] = {simd::cSimdScalar,simd::cSimdSse2,
+    simd::cSimdAvx2,simd::cSimdAvx512};
+
+// reference validator: decode and check every rule separately
+static bool refValid(const std::u8string &s)
+{
+    usize_t i = 0;
+    while (i < s.size())
+    {
+        const unsigned b = s[i];
+        usize_t len;
+        char32_t c;
+        if (b < 0x80)
+            len = 1, c = b;
+        else if ((b & 0xE0) == 0xC0)
+            len = 2, c = b & 0x1F;
+        else if ((b & 0xF0) == 0xE0)
+            len = 3, c = b & 0x0F;
+        else if ((b & 0xF8) == 0xF0)
+            len = 4, c = b & 0x07;
+        else
+            return false;
+        if (i + len > s.size())
+            return false;
+        for (usize_t j = 1; j < len; ++j)
+        {
+            if ((s[i+j] & 0xC0) != 0x80)
+                return false;
+            c = (c << 6) | (s[i+j] & 0x3F);
+        }
+        const char32_t minimum[] = {0,0,0x80,0x800,0x10000};
+        if (c < minimum[len] || c > 0x10FFFF || (c >= 0xD800 && c < 0xE000))
+            return false;
+        i += len;
+    }
+    return true;
+}
+
+// random code point, mostly ASCII
+static char32_t randomCodePoint(std::mt19937 &rng)
+{
+    switch (rng() % 6)
+    {
+    case 0: return static_cast<char32_t>(0x80 + rng() % 0x780);
+    case 1: return static_cast<char32_t>(0x800 + rng() % 0xD000);
+    case 2: return static_cast<char32_t>(0xE000 + rng() % 0x2000);
+    case 3: return static_cast<char32_t>(0x10000 + rng() % 0x100000);
+    default: return static_cast<char32_t>(1 + rng() % 0x7F);
+    }
+}
+
+static std::u32string randomUtf32(std::mt19937 &rng, const usize_t n)
+{
+    std::u32string ret;
+    const bool ascii = rng() % 2;
+    for (usize_t i = 0; i < n; ++i)
+        ret.push_back(ascii && rng() % 64 ? static_cast<char32_t>(1 + rng()
+            % 0x7F) : randomCodePoint(rng));
+    return ret;
+}
+
+static std::u8string encode(const std::u32string &s)
+{
+    std::u8string ret(utf::utf8LenOfUtf32(s.data(),s.size()),u8'\0');
+    TEST_ASSERT_EQ(utf::utf32ToUtf8(s.data(),s.size(),ret.data()),
+        ret.size());
+    return ret;
+}
+
+TEST_RUNNER_MAIN
+
+TEST_CASE_CREATE(testValidate)
+{
+    const std::u8string valid[] = {u8"",u8"hello",u8"été",
+        u8"€￿\U0001F600\U0010FFFF",u8"\x7f\u0080߿ࠀ"};
+    const std::u8string invalid[] = {u8"\x80",u8"\xc0\x80",u8"\xc1\xbf",
+        u8"\xe0\x9f\xbf",u8"\xed\xa0\x80",u8"\xf0\x8f\xbf\xbf",
+        u8"\xf4\x90\x80\x80",u8"\xf5\x80\x80\x80",u8"\xff",u8"\xe2\x82",
+        u8"\xf0\x9f\x98",u8"\xc3",u8"\xe2\x28\xa1",u8"\xc3\xa9\xa9"};
+    for (simd::SimdLevel level : levels)
+    {
+        for (usize_t pad = 0; pad < 70; ++pad)
+        {
+            // place every sequence across block boundaries
+            const std::u8string before(pad,u8'a');
+            for (const std::u8string &s : valid)
+            {
+                const std::u8string t = before + s + u8"z";
+                TEST_ASSERT_TRUE(utf::validateUtf8(t.data(),t.size(),level));
+            }
+            for (const std::u8string &s : invalid)
+            {
+                TEST_ASSERT_FALSE(refValid(s));
+                const std::u8string t = before + s;
+                TEST_ASSERT_FALSE(utf::validateUtf8(t.data(),t.size(),level));
+                TEST_ASSERT_EQ(utf::utf8ErrorIndex(t.data(),t.size()) >= pad,
+                    true);
+                const std::u8string u = t + std::u8string(40,u8'b');
+                TEST_ASSERT_FALSE(utf::validateUtf8(u.data(),u.size(),level));
+            }
+        }
+    }
+    TEST_ASSERT_EQ(utf::utf8ErrorIndex(u8"ab\xe2\x82",4),2);
+    TEST_ASSERT_EQ(utf::utf8ErrorIndex(u8"é\xa9",3),2);
+    TEST_ASSERT_EQ(utf::utf8ErrorIndex(u8"éx",3),3);
+    const std::u16string u16 = {u'a',0xD83D,0xDE00,0xD800,u'b',0xDC00};
+    TEST_ASSERT_TRUE(utf::validateUtf16(u16.data(),3));
+    TEST_ASSERT_FALSE(utf::validateUtf16(u16.data(),4));
+    TEST_ASSERT_FALSE(utf::validateUtf16(u16.data()+3,2));
+    TEST_ASSERT_FALSE(utf::validateUtf16(u16.data()+5,1));
+    const std::u32string u32 = {0x10FFFF,0xD7FF,0xE000,0xDFFF,0x110000};
+    TEST_ASSERT_TRUE(utf::validateUtf32(u32.data(),3));
+    TEST_ASSERT_FALSE(utf::validateUtf32(u32.data()+3,1));
+    TEST_ASSERT_FALSE(utf::validateUtf32(u32.data()+4,1));
+}
+
+TEST_CASE_CREATE(testRandomValidate)
+{
+    std::mt19937 rng(16);
+    for (int trial = 0; trial < 3000; ++trial)
+    {
+        std::u8string s = encode(randomUtf32(rng,rng() % 200));
+        TEST_ASSERT_TRUE(refValid(s));
+        // corrupt some strings with random bytes
+        if (trial % 3 && !s.empty())
+            for (usize_t i = 0, m = 1 + rng() % 3; i < m; ++i)
+                s[rng() % s.size()] = static_cast<char8_t>(rng());
+        const bool expected = refValid(s);
+        for (simd::SimdLevel level : levels)
+            TEST_ASSERT_EQ(utf::validateUtf8(s.data(),s.size(),level),
+                expected);
+        TEST_ASSERT_EQ(utf::validateUtf8(s.data(),s.size()),expected);
+        const usize_t error = utf::utf8ErrorIndex(s.data(),s.size());
+        TEST_ASSERT_EQ(error == s.size(),expected);
+        TEST_ASSERT_TRUE(refValid(s.substr(0,error)));
+    }
+}
+
+TEST_CASE_CREATE(testTranscode)
+{
+    std::mt19937 rng(1616);
+    for (int trial = 0; trial < 2000; ++trial)
+    {
+        const std::u32string s32 = randomUtf32(rng,rng() % 300);
+        const std::u8string s8 = encode(s32);
+        for (simd::SimdLevel level : levels)
+            TEST_ASSERT_EQ(utf::countUtf8(s8.data(),s8.size(),level),
+                s32.size());
+        // UTF-8 to UTF-32 and back
+        std::u32string t32(utf::countUtf8(s8.data(),s8.size()),U'\0');
+        TEST_ASSERT_EQ(utf::utf8ToUtf32(s8.data(),s8.size(),t32.data()),
+            t32.size());
+        TEST_ASSERT_TRUE(t32 == s32);
+        // UTF-8 to UTF-16 and back
+        std::u16string t16(utf::utf16LenOfUtf8(s8.data(),s8.size()),u'\0');
+        TEST_ASSERT_EQ(utf::utf8ToUtf16(s8.data(),s8.size(),t16.data()),
+            t16.size());
+        TEST_ASSERT_TRUE(utf::validateUtf16(t16.data(),t16.size()));
+        TEST_ASSERT_EQ(utf::countUtf16(t16.data(),t16.size()),s32.size());
+        std::u8string t8(utf::utf8LenOfUtf16(t16.data(),t16.size()),u8'\0');
+        TEST_ASSERT_EQ(t8.size(),s8.size());
+        TEST_ASSERT_EQ(utf::utf16ToUtf8(t16.data(),t16.size(),t8.data()),
+            t8.size());
+        TEST_ASSERT_TRUE(t8 == s8);
+    }
+}
+
+TEST_CASE_CREATE(testStrings)
+{
+    const CString<char8_t> s8(u8"café € \U0001F600");
+    const CString<char16_t> s16 = utf::toUtf16(s8);
+    TEST_ASSERT_TRUE(s16 == u"café € \U0001F600");
+    TEST_ASSERT_EQ(s16.len(),9);
+    const CString<char32_t> s32 = utf::toUtf32(s8);
+    TEST_ASSERT_EQ(s32.len(),8);
+    TEST_ASSERT_EQ(s32.ptr()[7],U'\U0001F600');
+    TEST_ASSERT_TRUE(utf::toUtf8(s16) == s8);
+    TEST_ASSERT_TRUE(utf::toUtf8(s32) == s8);
+    TEST_ASSERT_EQ(utf::toUtf16(u8"").len(),0);
+    TEST_EXCEPTION((void)utf::toUtf16(u8"a\xc0\xaf"),tkoz::stl::FormatError);
+    TEST_EXCEPTION((void)utf::toUtf32(u8"\xed\xbf\xbf"),
+        tkoz::stl::FormatError);
+    const std::u16string lone = {u'x',0xDC00};
+    TEST_EXCEPTION((void)utf::toUtf8(lone.c_str()),tkoz::stl::FormatError);
+    const std::u32string big = {0x110000};
+    TEST_EXCEPTION((void)utf::toUtf8(big.c_str()),tkoz::stl::FormatError);
+}